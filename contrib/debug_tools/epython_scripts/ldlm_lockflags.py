@@ -9,7 +9,7 @@ from crashlib.input import toint
 import argparse
 
 description_short  = "Prints string identifiers for specified LDLM flags."
-LDLM_FL_ALL_FLAGS_MASK = 0x00FFFFFFC28F932F
+LDLM_FL_ALL_FLAGS_MASK = 0x00FFFFFFC28F936F
 
 ldlm_flags_tbl = {
     0x0000000000000001:  "LOCK_CHANGED",            # bit  0
@@ -18,6 +18,7 @@ ldlm_flags_tbl = {
     0x0000000000000008:  "BLOCK_WAIT",              # bit  3
     0x0000000000000010:  "SPECULATIVE",             # bit  4
     0x0000000000000020:  "AST_SENT",                # bit  5
+    0x0000000000000040:  "BL_BATCH",                # bit  6
     0x0000000000000100:  "REPLAY",                  # bit  8
     0x0000000000000200:  "INTENT_ONLY",             # bit  9
     0x0000000000001000:  "HAS_INTENT",              # bit 12
@@ -38,6 +38,7 @@
 
 /* LNET has 0xeXXX */
 #define CFS_FAIL_PTLRPC_OST_BULK_CB2	0xe000
+#define CFS_FAIL_LNET_RTRPOOL_BUSY	0xe001
 
 #include <linux/netdevice.h>
 
@@ -520,6 +521,7 @@ extern unsigned int lnet_recovery_interval;
 extern unsigned int lnet_recovery_limit;
 extern unsigned int lnet_peer_discovery_disabled;
 extern unsigned int lnet_drop_asym_route;
+extern unsigned int lnet_select_policy;
 extern unsigned int router_sensitivity_percentage;
 extern int alive_router_check_interval;
 extern int live_router_check_interval;
@@ -542,6 +544,7 @@ int lnet_get_route(int idx, __u32 *net, __u32 *hops,
 		   lnet_nid_t *gateway, __u32 *alive, __u32 *priority,
 		   __u32 *sensitivity);
 int lnet_get_rtr_pool_cfg(int idx, struct lnet_ioctl_pool_cfg *pool_cfg);
+int lnet_get_rtr_pool_stats(struct lnet_ioctl_pool_stats *stats);
 struct lnet_ni *lnet_get_next_ni_locked(struct lnet_net *mynet,
 					struct lnet_ni *prev);
 struct lnet_ni *lnet_get_ni_idx_locked(int idx);
@@ -566,6 +569,7 @@ void lnet_router_debugfs_fini(void);
 int  lnet_rtrpools_alloc(int im_a_router);
 void lnet_destroy_rtrbuf(struct lnet_rtrbuf *rb, int npages);
 int  lnet_rtrpools_adjust(int tiny, int small, int large);
+void lnet_rtrpools_autosize(void);
 int lnet_rtrpools_enable(void);
 void lnet_rtrpools_disable(void);
 void lnet_rtrpools_free(int keep_pools);
@@ -646,6 +650,7 @@ struct lnet_match_table *lnet_mt_of_attach(unsigned int index,
 					   enum lnet_ins_pos pos);
 int lnet_mt_match_md(struct lnet_match_table *mtable,
 		     struct lnet_match_info *info, struct lnet_msg *msg);
+void lnet_mt_uhash_grow(struct lnet_match_table *mtable);
 
 /* portals match/attach functions */
 void lnet_ptl_attach_md(struct lnet_me *me, struct lnet_libmd *md,
@@ -1113,6 +1118,9 @@ __u32 lnet_sum_stats(struct lnet_element_stats *stats,
 void lnet_usr_translate_stats(struct lnet_ioctl_element_msg_stats *msg_stats,
 			      struct lnet_element_stats *stats);
 
+void lnet_sel_stats_start(struct lnet_msg *msg);
+void lnet_sel_stats_done(struct lnet_msg *msg, int status);
+
 static inline void
 lnet_set_route_aliveness(struct lnet_route *route, bool alive)
 {
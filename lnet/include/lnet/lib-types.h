@@ -127,6 +127,10 @@ struct lnet_msg {
 	int			msg_retry_count;
 	/* flag to indicate that we do not want to resend this message */
 	bool			msg_no_resend;
+	/* when the message was handed to its NI, for selection stats */
+	ktime_t			msg_sel_start;
+	/* when the message started to wait for a router buffer */
+	ktime_t			msg_rtrbuf_start;
 
 	/* committed for sending */
 	unsigned int		msg_tx_committed:1;
@@ -375,6 +379,34 @@ struct lnet_health_remote_stats {
 	atomic_t hlt_network_timeout;
 };
 
+/* NI selection policies, see lnet_select_policy */
+enum lnet_select_policy {
+	/* health, priority, NUMA distance, then credits */
+	LNET_SEL_POLICY_CREDITS = 0,
+	/* as above, but credits are preceded by expected completion time */
+	LNET_SEL_POLICY_LATENCY,
+	LNET_SEL_POLICY_MAX = LNET_SEL_POLICY_LATENCY,
+};
+
+/* weight of a new sample in the selection EWMAs is 1/2^shift */
+#define LNET_SEL_EWMA_SHIFT	3
+/* smallest message used to sample the transfer rate */
+#define LNET_SEL_RATE_MIN_NOB	4096
+
+/*
+ * Statistics used to estimate when a message would complete if it
+ * were sent over a NI or to a peer NI. Updated without locking, as
+ * they are only used as a hint.
+ */
+struct lnet_sel_stats {
+	/* bytes of messages sent but not completed yet */
+	atomic64_t lss_nob;
+	/* EWMA of the message completion latency, in usec */
+	atomic_t lss_latency;
+	/* EWMA of the transfer rate, in bytes per usec */
+	atomic_t lss_rate;
+};
+
 struct lnet_net {
 	/* chain on the ln_nets */
 	struct list_head	net_list;
@@ -482,6 +514,7 @@ struct lnet_ni {
 	/* NI statistics */
 	struct lnet_element_stats ni_stats;
 	struct lnet_health_local_stats ni_hstats;
+	struct lnet_sel_stats	ni_sel_stats;
 
 	/* physical device CPT */
 	int			ni_dev_cpt;
@@ -559,6 +592,7 @@ struct lnet_peer_ni {
 	/* statistics kept on each peer NI */
 	struct lnet_element_stats lpni_stats;
 	struct lnet_health_remote_stats lpni_hstats;
+	struct lnet_sel_stats	lpni_sel_stats;
 	/* spin lock protecting credits and lpni_txq */
 	spinlock_t		lpni_lock;
 	/* # tx credits available */
@@ -900,6 +934,19 @@ struct lnet_rtrbufpool {
 	int			rbp_credits;
 	/* low water mark */
 	int			rbp_mincredits;
+	/* configured number of buffers, autosizing never goes below it */
+	int			rbp_cfg_nbuffers;
+	/* low water mark since the pool was last autosized */
+	int			rbp_tick_mincredits;
+	/* # buffers in use at the peak of the last autosize period */
+	int			rbp_peak_nbuffers;
+	/* # consecutive autosize periods the pool was underused */
+	int			rbp_nidle;
+	/* # messages which blocked for a buffer */
+	__u64			rbp_nblocked;
+	/* total and longest time messages blocked for a buffer, usec */
+	__u64			rbp_wait_total;
+	__u32			rbp_wait_max;
 };
 
 struct lnet_rtrbuf {
@@ -952,6 +999,11 @@ struct lnet_match_info {
 #define LNET_MT_BITS_U64		6	/* 2^6 bits */
 #define LNET_MT_EXHAUSTED_BITS		(LNET_MT_HASH_BITS - LNET_MT_BITS_U64)
 #define LNET_MT_EXHAUSTED_BMAP		((1 << LNET_MT_EXHAUSTED_BITS) + 1)
+/* ME hash of unique portal starts on mt_mhash with LNET_MT_HASH_BITS, and
+ * grows up to LNET_MT_UHASH_BITS_MAX when it has more than
+ * LNET_MT_UHASH_LOAD MEs per bucket, so bulk MEs are found in O(1) */
+#define LNET_MT_UHASH_BITS_MAX		16
+#define LNET_MT_UHASH_LOAD		2
 
 /* portal match table */
 struct lnet_match_table {
@@ -964,6 +1016,10 @@ struct lnet_match_table {
 	/* bitmap to flag whether MEs on mt_hash are exhausted or not */
 	__u64			mt_exhausted[LNET_MT_EXHAUSTED_BMAP];
 	struct list_head	*mt_mhash;	/* matching hash */
+	/* matching hash of unique portal, it's mt_mhash until it grows */
+	struct list_head	*mt_uhash;
+	unsigned int		mt_uhash_bits;	/* log2 of # mt_uhash buckets */
+	unsigned int		mt_nmes;	/* # attached MEs */
 };
 
 /* these are only useful for wildcard portal */
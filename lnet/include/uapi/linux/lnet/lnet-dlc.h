@@ -116,6 +116,18 @@ struct lnet_ioctl_pool_cfg {
 	__u32 pl_routing;
 };
 
+/* messages which waited for a router buffer, per pool of a CPT */
+struct lnet_ioctl_pool_stats {
+	struct libcfs_ioctl_hdr ps_hdr;
+	__u32 ps_cpt;
+	__u32 ps_padding;
+	struct {
+		__u64 ps_nblocked;
+		__u32 ps_wait_avg;	/* usec */
+		__u32 ps_wait_max;	/* usec */
+	} ps_pools[LNET_NRBPOOLS];
+};
+
 struct lnet_ioctl_ping_data {
 	struct libcfs_ioctl_hdr ping_hdr;
 
@@ -201,6 +213,17 @@ struct lnet_ioctl_peer_ni_hstats {
 	__s32 hlpni_health_value;
 };
 
+/* statistics of a local or peer NI used by the latency selection policy */
+struct lnet_ioctl_sel_stats {
+	struct libcfs_ioctl_hdr sel_hdr;
+	lnet_nid_t sel_nid;
+	__u64 sel_nob;
+	__u32 sel_peer;
+	__u32 sel_latency;
+	__u32 sel_rate;
+	__u32 sel_padding;
+};
+
 struct lnet_ioctl_element_msg_stats {
 	struct libcfs_ioctl_hdr im_hdr;
 	__u32 im_idx;
@@ -131,6 +131,11 @@ ksocknal_create_conn_cb(struct sockaddr *addr)
 	conn_cb->ksnr_connected = 0;
 	conn_cb->ksnr_deleted = 0;
 	conn_cb->ksnr_conn_count = 0;
+	/* the tunable can change at runtime, only bound it here */
+	conn_cb->ksnr_max_bulk_conns =
+		clamp(*ksocknal_tunables.ksnd_conns_per_peer, 1,
+		      SOCKNAL_CONNS_PER_PEER_MAX);
+	memset(conn_cb->ksnr_ntyped, 0, sizeof(conn_cb->ksnr_ntyped));
 
 	return conn_cb;
 }
@@ -404,7 +409,10 @@ ksocknal_associate_cb_conn_locked(struct ksock_conn_cb *conn_cb,
 			iface->ksni_nroutes++;
 	}
 
-	conn_cb->ksnr_connected |= (1<<type);
+	/* only connected by type once all conns of the type are there */
+	if (++conn_cb->ksnr_ntyped[type] >=
+	    ksocknal_conn_cb_max_conns(conn_cb, type))
+		conn_cb->ksnr_connected |= BIT(type);
 	conn_cb->ksnr_conn_count++;
 
 	/* Successful connection => further attempts can
@@ -722,6 +730,8 @@ ksocknal_create_conn(struct lnet_ni *ni, struct ksock_conn_cb *conn_cb,
 	struct ksock_sched *sched;
 	struct ksock_hello_msg *hello;
 	int cpt;
+	int ndup;
+	int ntyped;
 	struct ksock_tx *tx;
 	struct ksock_tx *txtmp;
 	int rc;
@@ -907,31 +917,42 @@ ksocknal_create_conn(struct lnet_ni *ni, struct ksock_conn_cb *conn_cb,
         }
 
 	/* Refuse to duplicate an existing connection, unless this is a
-	 * loopback connection */
-	if (!rpc_cmp_addr((struct sockaddr *)&conn->ksnc_peeraddr,
-			  (struct sockaddr *)&conn->ksnc_myaddr)) {
-		list_for_each(tmp, &peer_ni->ksnp_conns) {
-			conn2 = list_entry(tmp, struct ksock_conn, ksnc_list);
-
-			if (!rpc_cmp_addr(
-				    (struct sockaddr *)&conn2->ksnc_peeraddr,
-				    (struct sockaddr *)&conn->ksnc_peeraddr) ||
-			    !rpc_cmp_addr(
-				    (struct sockaddr *)&conn2->ksnc_myaddr,
-				    (struct sockaddr *)&conn->ksnc_myaddr) ||
-			    conn2->ksnc_type != conn->ksnc_type)
-				continue;
+	 * loopback connection.  Several bulk connections are allowed, the
+	 * active side decides how many of them it wants.
+	 */
+	ndup = 0;
+	ntyped = 0;
+	list_for_each(tmp, &peer_ni->ksnp_conns) {
+		conn2 = list_entry(tmp, struct ksock_conn, ksnc_list);
 
-                        /* Reply on a passive connection attempt so the peer_ni
-                         * realises we're connected. */
-                        LASSERT (rc == 0);
-                        if (!active)
-                                rc = EALREADY;
+		if (conn2->ksnc_type != conn->ksnc_type)
+			continue;
 
-                        warn = "duplicate";
-                        goto failed_2;
-                }
-        }
+		ntyped++;
+		if (rpc_cmp_addr((struct sockaddr *)&conn2->ksnc_peeraddr,
+				 (struct sockaddr *)&conn->ksnc_peeraddr) &&
+		    rpc_cmp_addr((struct sockaddr *)&conn2->ksnc_myaddr,
+				 (struct sockaddr *)&conn->ksnc_myaddr))
+			ndup++;
+	}
+
+	if (ndup > 0 &&
+	    !rpc_cmp_addr((struct sockaddr *)&conn->ksnc_peeraddr,
+			  (struct sockaddr *)&conn->ksnc_myaddr) &&
+	    (!ksocknal_bulk_conn_type(conn->ksnc_type) ||
+	     ndup >= (active ? ksocknal_conn_cb_max_conns(conn_cb,
+							  conn->ksnc_type) :
+			       SOCKNAL_CONNS_PER_PEER_MAX))) {
+		/* Reply on a passive connection attempt so the peer_ni
+		 * realises we're connected.
+		 */
+		LASSERT(rc == 0);
+		if (!active)
+			rc = EALREADY;
+
+		warn = "duplicate";
+		goto failed_2;
+	}
 
         /* If the connection created by this route didn't bind to the IP
          * address the route connected to, the connection/route matching
@@ -962,6 +983,12 @@ ksocknal_create_conn(struct lnet_ni *ni, struct ksock_conn_cb *conn_cb,
 	peer_ni->ksnp_send_keepalive = 0;
 	peer_ni->ksnp_error = 0;
 
+	/* spread bulk conns of the same type to the schedulers of other
+	 * CPTs, so they don't compete for the threads of a single one
+	 */
+	if (ksocknal_bulk_conn_type(conn->ksnc_type))
+		cpt = (cpt + ntyped) % cfs_cpt_number(lnet_cpt_table());
+
 	sched = ksocknal_choose_scheduler_locked(cpt);
 	if (!sched) {
 		CERROR("no schedulers available. node is unhealthy\n");
@@ -1125,8 +1152,6 @@ ksocknal_close_conn_locked(struct ksock_conn *conn, int error)
          * Caller holds ksnd_global_lock exclusively in irq context */
 	struct ksock_peer_ni *peer_ni = conn->ksnc_peer;
 	struct ksock_conn_cb *conn_cb;
-	struct ksock_conn *conn2;
-	struct list_head *tmp;
 
 	LASSERT(peer_ni->ksnp_error == 0);
 	LASSERT(!conn->ksnc_closing);
@@ -1139,19 +1164,11 @@ ksocknal_close_conn_locked(struct ksock_conn *conn, int error)
 	if (conn_cb != NULL) {
 		/* dissociate conn from cb... */
 		LASSERT(!conn_cb->ksnr_deleted);
-		LASSERT((conn_cb->ksnr_connected & BIT(conn->ksnc_type)) != 0);
+		LASSERT(conn_cb->ksnr_ntyped[conn->ksnc_type] > 0);
 
-		conn2 = NULL;
-		list_for_each(tmp, &peer_ni->ksnp_conns) {
-			conn2 = list_entry(tmp, struct ksock_conn, ksnc_list);
-
-			if (conn2->ksnc_conn_cb == conn_cb &&
-			    conn2->ksnc_type == conn->ksnc_type)
-				break;
-
-			conn2 = NULL;
-		}
-		if (conn2 == NULL)
+		/* let connd bring the missing conn of this type back */
+		if (--conn_cb->ksnr_ntyped[conn->ksnc_type] <
+		    ksocknal_conn_cb_max_conns(conn_cb, conn->ksnc_type))
 			conn_cb->ksnr_connected &= ~BIT(conn->ksnc_type);
 
 		conn->ksnc_conn_cb = NULL;
@@ -1346,7 +1363,8 @@ ksocknal_destroy_conn(struct ksock_conn *conn)
 	time64_t last_rcv;
 
 	/* Final coup-de-grace of the reaper */
-	CDEBUG(D_NET, "connection %p\n", conn);
+	CDEBUG(D_NET, "connection %p page rx vmap %llu bvec %llu\n", conn,
+	       conn->ksnc_rx_vmap, conn->ksnc_rx_bvec);
 
 	LASSERT(refcount_read(&conn->ksnc_conn_refcount) == 0);
 	LASSERT(refcount_read(&conn->ksnc_sock_refcount) == 0);
@@ -1693,6 +1711,7 @@ ksocknal_ctl(struct lnet_ni *ni, unsigned int cmd, void *arg)
 		data->ioc_u32[4] = conn->ksnc_scheduler->kss_cpt;
                 data->ioc_u32[5] = rxmem;
                 data->ioc_u32[6] = conn->ksnc_peer->ksnp_id.pid;
+		data->ioc_u64[0] = conn->ksnc_rx_vmap;
                 ksocknal_conn_decref(conn);
                 return 0;
         }
@@ -69,6 +69,7 @@
 #define SOCKNAL_PEER_HASH_BITS	7	/* log2 of # peer_ni lists */
 #define SOCKNAL_INSANITY_RECONN	5000	/* connd is trying on reconn infinitely */
 #define SOCKNAL_ENOMEM_RETRY	1	/* seconds between retries */
+#define SOCKNAL_CONNS_PER_PEER_MAX 127	/* max bulk conns of a type per peer */
 
 #define SOCKNAL_SINGLE_FRAG_TX      0	/* disable multi-fragment sends */
 #define SOCKNAL_SINGLE_FRAG_RX      0	/* disable multi-fragment receives */
@@ -129,6 +130,7 @@ struct ksock_tunables {
         int              *ksnd_max_reconnectms; /* ...exponentially increasing to this */
         int              *ksnd_eager_ack;       /* make TCP ack eagerly? */
         int              *ksnd_typed_conns;     /* drive sockets by type? */
+	int		 *ksnd_conns_per_peer;	/* # bulk sockets of a type */
         int              *ksnd_min_bulk;        /* smallest "large" message */
         int              *ksnd_tx_buffer_size;  /* socket tx buffer size */
         int              *ksnd_rx_buffer_size;  /* socket rx buffer size */
@@ -328,6 +330,10 @@ struct ksock_conn {
 	union ksock_rxiovspace	ksnc_rx_iov_space;/* space for frag descriptors */
 	__u32                 ksnc_rx_csum;     /* partial checksum for incoming
 						 * data */
+	__u64			ksnc_rx_vmap;	/* # page frag receives
+						 * through a vmap() */
+	__u64			ksnc_rx_bvec;	/* # page frag receives
+						 * into the bio_vec */
 	struct lnet_msg      *ksnc_lnet_msg;    /* rx lnet_finalize arg*/
 	struct ksock_msg	ksnc_msg;	/* incoming message buffer:
 						 * V2.x message takes the
@@ -372,6 +378,10 @@ struct ksock_conn_cb {
 	unsigned int		ksnr_connected:4;/* connections by type */
 	unsigned int		ksnr_deleted:1;	/* been removed from peer_ni? */
 	int			ksnr_conn_count;/* # conns for this route */
+	/* # bulk conns of each bulk type to establish */
+	int			ksnr_max_bulk_conns;
+	/* # current conns by type */
+	__u8			ksnr_ntyped[SOCKLND_CONN_NTYPES];
 };
 
 #define SOCKNAL_KEEPALIVE_PING          1       /* cookie for keepalive ping */
@@ -467,6 +477,19 @@ ksocknal_conn_cb_mask(void)
 		BIT(SOCKLND_CONN_BULK_OUT));
 }
 
+static inline int
+ksocknal_bulk_conn_type(int type)
+{
+	return type == SOCKLND_CONN_BULK_IN || type == SOCKLND_CONN_BULK_OUT;
+}
+
+/* # of conns of \a type a conn_cb wants, several for bulk types */
+static inline int
+ksocknal_conn_cb_max_conns(struct ksock_conn_cb *conn_cb, int type)
+{
+	return ksocknal_bulk_conn_type(type) ? conn_cb->ksnr_max_bulk_conns : 1;
+}
+
 static inline void
 ksocknal_conn_addref(struct ksock_conn *conn)
 {
@@ -243,6 +243,7 @@ ksocknal_lib_recv_iov(struct ksock_conn *conn, struct kvec *scratchiov)
         return rc;
 }
 
+#ifndef HAVE_IOV_ITER_TYPE
 static void
 ksocknal_lib_kiov_vunmap(void *addr)
 {
@@ -288,7 +289,75 @@ ksocknal_lib_kiov_vmap(struct bio_vec *kiov, int niov,
 
 	return addr;
 }
+#endif
+
+static void
+ksocknal_lib_csum_rx_kiov(struct ksock_conn *conn, struct bio_vec *kiov,
+			  unsigned int niov, int nob)
+{
+	void *base;
+	int fragnob;
+	int i;
+
+	for (i = 0; nob > 0; i++, nob -= fragnob) {
+		LASSERT(i < niov);
+
+		/* Dang! have to kmap again because I have nowhere to
+		 * stash the mapped address.  But by doing it while the
+		 * page is still mapped, the kernel just bumps the map
+		 * count and returns me the address it stashed.
+		 */
+		base = kmap(kiov[i].bv_page) + kiov[i].bv_offset;
+		fragnob = kiov[i].bv_len;
+		if (fragnob > nob)
+			fragnob = nob;
+
+		conn->ksnc_rx_csum = ksocknal_csum(conn->ksnc_rx_csum,
+						   base, fragnob);
+
+		kunmap(kiov[i].bv_page);
+	}
+}
 
+#ifdef HAVE_IOV_ITER_TYPE
+/*
+ * Receive straight into the page frags, no need to map them. iov_iter_type()
+ * came with the kernels where the iov_iter type and direction are separated,
+ * older ones need ITER_BVEC in the direction of iov_iter_bvec(). This is
+ * preferred over the zc_recv vmap() too, which still copies from the skbs.
+ */
+int
+ksocknal_lib_recv_kiov(struct ksock_conn *conn, struct page **pages,
+		       struct kvec *scratchiov)
+{
+#if SOCKNAL_SINGLE_FRAG_RX
+	unsigned int niov = 1;
+#else
+	unsigned int niov = conn->ksnc_rx_nkiov;
+#endif
+	struct bio_vec *kiov = conn->ksnc_rx_kiov;
+	struct msghdr msg = {
+		.msg_flags	= 0
+	};
+	int nob;
+	int rc;
+	int i;
+
+	for (nob = i = 0; i < niov; i++)
+		nob += kiov[i].bv_len;
+
+	LASSERT(nob <= conn->ksnc_rx_nob_wanted);
+
+	iov_iter_bvec(&msg.msg_iter, READ, kiov, niov, nob);
+	rc = sock_recvmsg(conn->ksnc_sock, &msg, MSG_DONTWAIT);
+	conn->ksnc_rx_bvec++;
+
+	if (conn->ksnc_msg.ksm_csum != 0)
+		ksocknal_lib_csum_rx_kiov(conn, kiov, niov, rc);
+
+	return rc;
+}
+#else /* !HAVE_IOV_ITER_TYPE */
 int
 ksocknal_lib_recv_kiov(struct ksock_conn *conn, struct page **pages,
 		       struct kvec *scratchiov)
@@ -311,10 +380,7 @@ ksocknal_lib_recv_kiov(struct ksock_conn *conn, struct page **pages,
         int          nob;
         int          i;
         int          rc;
-        void        *base;
         void        *addr;
-        int          sum;
-        int          fragnob;
 	int n;
 
         /* NB we can't trust socket ops to either consume our iovs
@@ -322,7 +388,7 @@ ksocknal_lib_recv_kiov(struct ksock_conn *conn, struct page **pages,
 	if ((addr = ksocknal_lib_kiov_vmap(kiov, niov, scratchiov, pages)) != NULL) {
 		nob = scratchiov[0].iov_len;
 		n = 1;
-
+		conn->ksnc_rx_vmap++;
 	} else {
 		for (nob = i = 0; i < niov; i++) {
 			nob += scratchiov[i].iov_len = kiov[i].bv_len;
@@ -337,26 +403,8 @@ ksocknal_lib_recv_kiov(struct ksock_conn *conn, struct page **pages,
 	rc = kernel_recvmsg(conn->ksnc_sock, &msg, scratchiov, n, nob,
 			    MSG_DONTWAIT);
 
-	if (conn->ksnc_msg.ksm_csum != 0) {
-		for (i = 0, sum = rc; sum > 0; i++, sum -= fragnob) {
-			LASSERT(i < niov);
-
-			/* Dang! have to kmap again because I have nowhere to
-			 * stash the mapped address.  But by doing it while the
-			 * page is still mapped, the kernel just bumps the map
-			 * count and returns me the address it stashed.
-			 */
-			base = kmap(kiov[i].bv_page) + kiov[i].bv_offset;
-			fragnob = kiov[i].bv_len;
-			if (fragnob > sum)
-				fragnob = sum;
-
-			conn->ksnc_rx_csum = ksocknal_csum(conn->ksnc_rx_csum,
-							   base, fragnob);
-
-			kunmap(kiov[i].bv_page);
-		}
-	}
+	if (conn->ksnc_msg.ksm_csum != 0)
+		ksocknal_lib_csum_rx_kiov(conn, kiov, niov, rc);
 
 	if (addr != NULL) {
 		ksocknal_lib_kiov_vunmap(addr);
@@ -367,6 +415,7 @@ ksocknal_lib_recv_kiov(struct ksock_conn *conn, struct page **pages,
 
 	return rc;
 }
+#endif /* HAVE_IOV_ITER_TYPE */
 
 void
 ksocknal_lib_csum_tx(struct ksock_tx *tx)
@@ -76,6 +76,10 @@ static int typed_conns = 1;
 module_param(typed_conns, int, 0444);
 MODULE_PARM_DESC(typed_conns, "use different sockets for bulk");
 
+static int conns_per_peer = 1;
+module_param(conns_per_peer, int, 0644);
+MODULE_PARM_DESC(conns_per_peer, "# of bulk sockets of each direction per peer");
+
 static int min_bulk = (1<<10);
 module_param(min_bulk, int, 0644);
 MODULE_PARM_DESC(min_bulk, "smallest 'large' message");
@@ -182,6 +186,7 @@ int ksocknal_tunables_init(void)
 	ksocknal_tunables.ksnd_max_reconnectms    = &max_reconnectms;
 	ksocknal_tunables.ksnd_eager_ack          = &eager_ack;
 	ksocknal_tunables.ksnd_typed_conns        = &typed_conns;
+	ksocknal_tunables.ksnd_conns_per_peer	  = &conns_per_peer;
 	ksocknal_tunables.ksnd_min_bulk           = &min_bulk;
 	ksocknal_tunables.ksnd_tx_buffer_size     = &tx_buffer_size;
 	ksocknal_tunables.ksnd_rx_buffer_size     = &rx_buffer_size;
@@ -219,6 +224,13 @@ int ksocknal_tunables_init(void)
 	ksocknal_tunables.ksnd_protocol           = &protocol;
 #endif
 
+	if (*ksocknal_tunables.ksnd_conns_per_peer < 1)
+		*ksocknal_tunables.ksnd_conns_per_peer = 1;
+	else if (*ksocknal_tunables.ksnd_conns_per_peer >
+		 SOCKNAL_CONNS_PER_PEER_MAX)
+		*ksocknal_tunables.ksnd_conns_per_peer =
+			SOCKNAL_CONNS_PER_PEER_MAX;
+
 	if (*ksocknal_tunables.ksnd_zc_min_payload < (2 << 10))
 		*ksocknal_tunables.ksnd_zc_min_payload = (2 << 10);
 
@@ -244,6 +244,25 @@ module_param_call(lnet_response_tracking, response_tracking_set, param_get_int,
 MODULE_PARM_DESC(lnet_response_tracking,
 		 "(0|1|2|3) LNet Internal Only|GET Reply only|PUT ACK only|Full Tracking (default)");
 
+unsigned int lnet_select_policy = LNET_SEL_POLICY_CREDITS;
+static int select_policy_set(const char *val, cfs_kernel_param_arg_t *kp);
+
+#ifdef HAVE_KERNEL_PARAM_OPS
+static struct kernel_param_ops param_ops_select_policy = {
+	.set = select_policy_set,
+	.get = param_get_int,
+};
+
+#define param_check_select_policy(name, p)  \
+	__param_check(name, p, int)
+module_param(lnet_select_policy, select_policy, 0644);
+#else
+module_param_call(lnet_select_policy, select_policy_set, param_get_int,
+		  &lnet_select_policy, 0644);
+#endif
+MODULE_PARM_DESC(lnet_select_policy,
+		 "(0|1) NI selection by credits (default)|expected completion time");
+
 #define LNET_LND_TIMEOUT_DEFAULT ((LNET_TRANSACTION_TIMEOUT_DEFAULT - 1) / \
 				  (LNET_RETRY_COUNT_DEFAULT + 1))
 unsigned int lnet_lnd_timeout = LNET_LND_TIMEOUT_DEFAULT;
@@ -563,6 +582,29 @@ response_tracking_set(const char *val, cfs_kernel_param_arg_t *kp)
 	return 0;
 }
 
+static int
+select_policy_set(const char *val, cfs_kernel_param_arg_t *kp)
+{
+	int rc;
+	unsigned long new_value;
+
+	rc = kstrtoul(val, 0, &new_value);
+	if (rc) {
+		CERROR("Invalid value for 'lnet_select_policy'\n");
+		return -EINVAL;
+	}
+
+	if (new_value > LNET_SEL_POLICY_MAX) {
+		CWARN("Invalid value (%lu) for 'lnet_select_policy'\n",
+		      new_value);
+		return -EINVAL;
+	}
+
+	lnet_select_policy = new_value;
+
+	return 0;
+}
+
 static const char *
 lnet_get_routes(void)
 {
@@ -3732,6 +3774,43 @@ unlock:
 	return rc;
 }
 
+static int
+lnet_get_sel_stats(struct lnet_ioctl_sel_stats *stats)
+{
+	struct lnet_peer_ni *lpni = NULL;
+	struct lnet_sel_stats *sel;
+	struct lnet_ni *ni;
+	int rc = 0;
+
+	lnet_net_lock(0);
+	if (stats->sel_peer) {
+		lpni = lnet_find_peer_ni_locked(stats->sel_nid);
+		if (!lpni) {
+			rc = -ENOENT;
+			goto unlock;
+		}
+		sel = &lpni->lpni_sel_stats;
+	} else {
+		ni = lnet_nid2ni_locked(stats->sel_nid, 0);
+		if (!ni) {
+			rc = -ENOENT;
+			goto unlock;
+		}
+		sel = &ni->ni_sel_stats;
+	}
+
+	stats->sel_latency = atomic_read(&sel->lss_latency);
+	stats->sel_rate = atomic_read(&sel->lss_rate);
+	stats->sel_nob = atomic64_read(&sel->lss_nob);
+
+	if (lpni)
+		lnet_peer_ni_decref_locked(lpni);
+unlock:
+	lnet_net_unlock(0);
+
+	return rc;
+}
+
 static int
 lnet_get_local_ni_recovery_list(struct lnet_ioctl_recovery_list *list)
 {
@@ -3997,6 +4076,32 @@ LNetCtl(unsigned int cmd, void *arg)
 		return rc;
 	}
 
+	case IOC_LIBCFS_GET_BUF_STATS: {
+		struct lnet_ioctl_pool_stats *stats = arg;
+
+		if (stats->ps_hdr.ioc_len < sizeof(*stats))
+			return -EINVAL;
+
+		mutex_lock(&the_lnet.ln_api_mutex);
+		rc = lnet_get_rtr_pool_stats(stats);
+		mutex_unlock(&the_lnet.ln_api_mutex);
+
+		return rc;
+	}
+
+	case IOC_LIBCFS_GET_SEL_STATS: {
+		struct lnet_ioctl_sel_stats *stats = arg;
+
+		if (stats->sel_hdr.ioc_len < sizeof(*stats))
+			return -EINVAL;
+
+		mutex_lock(&the_lnet.ln_api_mutex);
+		rc = lnet_get_sel_stats(stats);
+		mutex_unlock(&the_lnet.ln_api_mutex);
+
+		return rc;
+	}
+
 	case IOC_LIBCFS_GET_RECOVERY_QUEUE: {
 		struct lnet_ioctl_recovery_list *list = arg;
 		if (list->rlst_hdr.ioc_len < sizeof(*list))
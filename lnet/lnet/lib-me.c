@@ -84,6 +84,9 @@ LNetMEAttach(unsigned int portal,
 	if (mtable == NULL) /* can't match portal type */
 		return ERR_PTR(-EPERM);
 
+	if (lnet_ptl_is_unique(the_lnet.ln_portals[portal]))
+		lnet_mt_uhash_grow(mtable);
+
 	me = kmem_cache_zalloc(lnet_mes_cachep, GFP_NOFS);
 	if (me == NULL) {
 		CDEBUG(D_MALLOC, "failed to allocate 'me'\n");
@@ -107,11 +110,14 @@ LNetMEAttach(unsigned int portal,
 	else
 		head = lnet_mt_match_head(mtable, match_id, match_bits);
 
-	me->me_pos = head - &mtable->mt_mhash[0];
+	/* only used by wildcard portal, see lnet_mt_test_exhausted() */
+	me->me_pos = lnet_ptl_is_unique(the_lnet.ln_portals[portal]) ?
+		     0 : head - &mtable->mt_mhash[0];
 	if (pos == LNET_INS_AFTER || pos == LNET_INS_LOCAL)
 		list_add_tail(&me->me_list, head);
 	else
 		list_add(&me->me_list, head);
+	mtable->mt_nmes++;
 
 	lnet_res_unlock(mtable->mt_cpt);
 	return me;
@@ -122,7 +128,10 @@ EXPORT_SYMBOL(LNetMEAttach);
 void
 lnet_me_unlink(struct lnet_me *me)
 {
+	struct lnet_portal *ptl = the_lnet.ln_portals[me->me_portal];
+
 	list_del(&me->me_list);
+	ptl->ptl_mtables[me->me_cpt]->mt_nmes--;
 
 	if (me->me_md != NULL) {
 		struct lnet_libmd *md = me->me_md;
@@ -188,6 +188,74 @@ void lnet_usr_translate_stats(struct lnet_ioctl_element_msg_stats *msg_stats,
 	assign_stats(&msg_stats->im_drop_stats, counts);
 }
 
+static void
+lnet_sel_ewma(atomic_t *avg, __u64 sample)
+{
+	int old = atomic_read(avg);
+	int new = min_t(__u64, sample, INT_MAX);
+
+	/* the first sample seeds the average */
+	if (old)
+		new = old + ((new - old) >> LNET_SEL_EWMA_SHIFT);
+	atomic_set(avg, max(new, 1));
+}
+
+/*
+ * Account a message handed to msg_txni/msg_txpeer as in flight. It is
+ * accounted as completed by lnet_sel_stats_done() when it is
+ * decommitted, either finalized or to be resent.
+ */
+void
+lnet_sel_stats_start(struct lnet_msg *msg)
+{
+	msg->msg_sel_start = ktime_get();
+	atomic64_add(msg->msg_len, &msg->msg_txni->ni_sel_stats.lss_nob);
+	atomic64_add(msg->msg_len, &msg->msg_txpeer->lpni_sel_stats.lss_nob);
+}
+
+void
+lnet_sel_stats_done(struct lnet_msg *msg, int status)
+{
+	struct lnet_sel_stats *stats[2];
+	__u64 latency;
+	int i;
+
+	if (!ktime_to_ns(msg->msg_sel_start))
+		return;
+
+	latency = ktime_us_delta(ktime_get(), msg->msg_sel_start);
+	msg->msg_sel_start = ktime_set(0, 0);
+
+	stats[0] = &msg->msg_txni->ni_sel_stats;
+	stats[1] = &msg->msg_txpeer->lpni_sel_stats;
+
+	for (i = 0; i < ARRAY_SIZE(stats); i++) {
+		atomic64_sub(msg->msg_len, &stats[i]->lss_nob);
+		/* failures are accounted for by the health values */
+		if (status != 0)
+			continue;
+		lnet_sel_ewma(&stats[i]->lss_latency, latency);
+		if (msg->msg_len >= LNET_SEL_RATE_MIN_NOB)
+			lnet_sel_ewma(&stats[i]->lss_rate,
+				      div64_u64(msg->msg_len,
+						max_t(__u64, latency, 1)));
+	}
+}
+
+/*
+ * Expected time, in usec, to complete a message sent over an element
+ * with these stats: the recent completion latency plus the time to
+ * drain the bytes already in flight.
+ */
+static __u64
+lnet_sel_cost(struct lnet_sel_stats *stats)
+{
+	__u64 nob = atomic64_read(&stats->lss_nob);
+	int rate = atomic_read(&stats->lss_rate);
+
+	return atomic_read(&stats->lss_latency) + div_u64(nob, max(rate, 1));
+}
+
 int
 lnet_fail_nid(lnet_nid_t nid, unsigned int threshold)
 {
@@ -1014,11 +1082,14 @@ lnet_post_routed_recv_locked(struct lnet_msg *msg, int do_recv)
 		rbp->rbp_credits--;
 		if (rbp->rbp_credits < rbp->rbp_mincredits)
 			rbp->rbp_mincredits = rbp->rbp_credits;
+		if (rbp->rbp_credits < rbp->rbp_tick_mincredits)
+			rbp->rbp_tick_mincredits = rbp->rbp_credits;
 
 		if (rbp->rbp_credits < 0) {
 			/* must have checked eager_recv before here */
 			LASSERT(msg->msg_rx_ready_delay);
 			msg->msg_rx_delayed = 1;
+			msg->msg_rtrbuf_start = ktime_get();
 			list_add_tail(&msg->msg_list, &rbp->rbp_msgs);
 			return LNET_CREDIT_WAIT;
 		}
@@ -1142,6 +1213,7 @@ void
 lnet_schedule_blocked_locked(struct lnet_rtrbufpool *rbp)
 {
 	struct lnet_msg	*msg;
+	__u64 wait;
 
 	if (list_empty(&rbp->rbp_msgs))
 		return;
@@ -1149,6 +1221,12 @@ lnet_schedule_blocked_locked(struct lnet_rtrbufpool *rbp)
 			 struct lnet_msg, msg_list);
 	list_del(&msg->msg_list);
 
+	wait = ktime_us_delta(ktime_get(), msg->msg_rtrbuf_start);
+	rbp->rbp_nblocked++;
+	rbp->rbp_wait_total += wait;
+	if (wait > rbp->rbp_wait_max)
+		rbp->rbp_wait_max = min_t(__u64, wait, U32_MAX);
+
 	(void)lnet_post_routed_recv_locked(msg, 1);
 }
 
@@ -1297,15 +1375,21 @@ lnet_select_peer_ni(struct lnet_ni *best_ni, lnet_nid_t dst_nid,
 	 * preferred peer_ni, or there are multiple preferred peer_ni,
 	 * the available transmit credits are used. If the transmit
 	 * credits are equal, we round-robin over the peer_ni.
+	 * With LNET_SEL_POLICY_LATENCY the peer_ni expected to complete
+	 * the message first is used before looking at the credits.
 	 */
 	struct lnet_peer_ni *lpni = NULL;
 	int best_lpni_credits = (best_lpni) ? best_lpni->lpni_txcredits :
 		INT_MIN;
 	int best_lpni_healthv = (best_lpni) ?
 		atomic_read(&best_lpni->lpni_healthv) : 0;
+	bool by_latency = lnet_select_policy == LNET_SEL_POLICY_LATENCY;
+	__u64 best_lpni_cost = (best_lpni && by_latency) ?
+		lnet_sel_cost(&best_lpni->lpni_sel_stats) : U64_MAX;
 	bool best_lpni_is_preferred = false;
 	bool lpni_is_preferred;
 	int lpni_healthv;
+	__u64 lpni_cost;
 	__u32 lpni_sel_prio;
 	__u32 best_sel_prio = LNET_MAX_SELECTION_PRIORITY;
 
@@ -1326,13 +1410,16 @@ lnet_select_peer_ni(struct lnet_ni *best_ni, lnet_nid_t dst_nid,
 
 		lpni_healthv = atomic_read(&lpni->lpni_healthv);
 		lpni_sel_prio = lpni->lpni_sel_priority;
+		lpni_cost = by_latency ?
+			lnet_sel_cost(&lpni->lpni_sel_stats) : U64_MAX;
 
 		if (best_lpni)
-			CDEBUG(D_NET, "n:[%s, %s] h:[%d, %d] p:[%d, %d] c:[%d, %d] s:[%d, %d]\n",
+			CDEBUG(D_NET, "n:[%s, %s] h:[%d, %d] p:[%d, %d] l:[%llu, %llu] c:[%d, %d] s:[%d, %d]\n",
 				libcfs_nid2str(lpni->lpni_nid),
 				libcfs_nid2str(best_lpni->lpni_nid),
 				lpni_healthv, best_lpni_healthv,
 				lpni_sel_prio, best_sel_prio,
+				lpni_cost, best_lpni_cost,
 				lpni->lpni_txcredits, best_lpni_credits,
 				lpni->lpni_seq, best_lpni->lpni_seq);
 		else
@@ -1366,6 +1453,12 @@ lnet_select_peer_ni(struct lnet_ni *best_ni, lnet_nid_t dst_nid,
 			continue;
 		}
 
+		/* pick the peer ni expected to complete the message first */
+		if (lpni_cost > best_lpni_cost)
+			continue;
+		else if (lpni_cost < best_lpni_cost)
+			goto select_lpni;
+
 		if (lpni->lpni_txcredits < best_lpni_credits)
 			/* We already have a peer that has more credits
 			 * available than this one. No need to consider
@@ -1387,6 +1480,7 @@ select_lpni:
 		best_sel_prio = lpni_sel_prio;
 		best_lpni = lpni;
 		best_lpni_credits = lpni->lpni_txcredits;
+		best_lpni_cost = lpni_cost;
 	}
 
 	/* if we still can't find a peer ni then we can't reach it */
@@ -1609,6 +1703,8 @@ lnet_get_best_ni(struct lnet_net *local_net, struct lnet_ni *best_ni,
 	int best_credits;
 	int best_healthv;
 	__u32 best_sel_prio;
+	bool by_latency = lnet_select_policy == LNET_SEL_POLICY_LATENCY;
+	__u64 best_cost;
 
 	/*
 	 * If there is no peer_ni that we can send to on this network,
@@ -1622,12 +1718,15 @@ lnet_get_best_ni(struct lnet_net *local_net, struct lnet_ni *best_ni,
 		shortest_distance = UINT_MAX;
 		best_credits = INT_MIN;
 		best_healthv = 0;
+		best_cost = U64_MAX;
 	} else {
 		shortest_distance = cfs_cpt_distance(lnet_cpt_table(), md_cpt,
 						     best_ni->ni_dev_cpt);
 		best_credits = atomic_read(&best_ni->ni_tx_credits);
 		best_healthv = atomic_read(&best_ni->ni_healthv);
 		best_sel_prio = best_ni->ni_sel_priority;
+		best_cost = by_latency ?
+			lnet_sel_cost(&best_ni->ni_sel_stats) : U64_MAX;
 	}
 
 	while ((ni = lnet_get_next_ni_locked(local_net, ni))) {
@@ -1636,11 +1735,14 @@ lnet_get_best_ni(struct lnet_net *local_net, struct lnet_ni *best_ni,
 		int ni_healthv;
 		int ni_fatal;
 		__u32 ni_sel_prio;
+		__u64 ni_cost;
 
 		ni_credits = atomic_read(&ni->ni_tx_credits);
 		ni_healthv = atomic_read(&ni->ni_healthv);
 		ni_fatal = atomic_read(&ni->ni_fatal_error_on);
 		ni_sel_prio = ni->ni_sel_priority;
+		ni_cost = by_latency ?
+			lnet_sel_cost(&ni->ni_sel_stats) : U64_MAX;
 
 		/*
 		 * calculate the distance from the CPT on which
@@ -1659,20 +1761,21 @@ lnet_get_best_ni(struct lnet_net *local_net, struct lnet_ni *best_ni,
 			distance = lnet_numa_range;
 
 		/*
-		 * Select on health, shorter distance, available
-		 * credits, then round-robin.
+		 * Select on health, shorter distance, expected completion
+		 * time if selecting by latency, available credits, then
+		 * round-robin.
 		 */
 		if (ni_fatal)
 			continue;
 
 		if (best_ni)
-			CDEBUG(D_NET, "compare ni %s [c:%d, d:%d, s:%d, p:%u] with best_ni %s [c:%d, d:%d, s:%d, p:%u]\n",
+			CDEBUG(D_NET, "compare ni %s [c:%d, d:%d, s:%d, p:%u, l:%llu] with best_ni %s [c:%d, d:%d, s:%d, p:%u, l:%llu]\n",
 			       libcfs_nid2str(ni->ni_nid), ni_credits, distance,
-			       ni->ni_seq, ni_sel_prio,
+			       ni->ni_seq, ni_sel_prio, ni_cost,
 			       (best_ni) ? libcfs_nid2str(best_ni->ni_nid)
 			       : "not selected", best_credits, shortest_distance,
 			       (best_ni) ? best_ni->ni_seq : 0,
-			       best_sel_prio);
+			       best_sel_prio, best_cost);
 		else
 			goto select_ni;
 
@@ -1691,6 +1794,11 @@ lnet_get_best_ni(struct lnet_net *local_net, struct lnet_ni *best_ni,
 		else if (distance < shortest_distance)
 			goto select_ni;
 
+		if (ni_cost > best_cost)
+			continue;
+		else if (ni_cost < best_cost)
+			goto select_ni;
+
 		if (ni_credits < best_credits)
 			continue;
 		else if (ni_credits > best_credits)
@@ -1705,6 +1813,7 @@ select_ni:
 		best_healthv = ni_healthv;
 		best_ni = ni;
 		best_credits = ni_credits;
+		best_cost = ni_cost;
 	}
 
 	CDEBUG(D_NET, "selected best_ni %s\n",
@@ -1864,6 +1973,7 @@ lnet_handle_send(struct lnet_send_data *sd)
 	 * time to return the credits
 	 */
 	lnet_msg_commit(msg, sd->sd_cpt);
+	lnet_sel_stats_start(msg);
 
 	/*
 	 * If we are routing the message then we keep the src_nid that was
@@ -3751,6 +3861,7 @@ lnet_monitor_thread(void *arg)
 	 *     pings them
 	 *  4. Checks if there are any NIs on the remote recovery queue
 	 *     and pings them.
+	 *  5. Resizes the router buffer pools to the demand.
 	 */
 	while (the_lnet.ln_mt_state == LNET_MT_STATE_RUNNING) {
 		now = ktime_get_real_seconds();
@@ -3758,6 +3869,9 @@ lnet_monitor_thread(void *arg)
 		if (lnet_router_checker_active())
 			lnet_check_routers();
 
+		if (the_lnet.ln_routing)
+			lnet_rtrpools_autosize();
+
 		lnet_resend_pending_msgs();
 
 		if (now >= rsp_timeout) {
@@ -183,6 +183,7 @@ lnet_msg_decommit_tx(struct lnet_msg *msg, int status)
 	struct lnet_event *ev = &msg->msg_ev;
 
 	LASSERT(msg->msg_tx_committed);
+	lnet_sel_stats_done(msg, status);
 	if (status != 0)
 		goto out;
 
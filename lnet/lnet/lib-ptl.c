@@ -353,6 +353,12 @@ lnet_mt_set_exhausted(struct lnet_match_table *mtable, int pos, int exhausted)
 		*bmap |= 1ULL << pos;
 }
 
+static inline unsigned int
+lnet_mt_uhash(struct lnet_process_id id, __u64 mbits, unsigned int bits)
+{
+	return hash_long(mbits + id.nid + id.pid, bits);
+}
+
 struct list_head *
 lnet_mt_match_head(struct lnet_match_table *mtable,
 		   struct lnet_process_id id, __u64 mbits)
@@ -362,14 +368,72 @@ lnet_mt_match_head(struct lnet_match_table *mtable,
 	if (lnet_ptl_is_wildcard(ptl)) {
 		return &mtable->mt_mhash[mbits & LNET_MT_HASH_MASK];
 	} else {
-		unsigned long hash = mbits + id.nid + id.pid;
-
 		LASSERT(lnet_ptl_is_unique(ptl));
-		hash = hash_long(hash, LNET_MT_HASH_BITS);
-		return &mtable->mt_mhash[hash & LNET_MT_HASH_MASK];
+		return &mtable->mt_uhash[lnet_mt_uhash(id, mbits,
+						       mtable->mt_uhash_bits)];
 	}
 }
 
+/**
+ * Grow the matching hash of a unique portal once it holds more than
+ * LNET_MT_UHASH_LOAD MEs per bucket, so matching bulk MEs doesn't depend
+ * on how many of them are posted.
+ *
+ * Called w/o lnet_res_lock, the new hash is allocated before taking it.
+ */
+void
+lnet_mt_uhash_grow(struct lnet_match_table *mtable)
+{
+	struct list_head *uhash;
+	struct list_head *old = NULL;
+	struct lnet_me *me;
+	struct lnet_me *tmp;
+	unsigned int bits = mtable->mt_uhash_bits; /* read w/o lock */
+	unsigned int i;
+
+	if (bits >= LNET_MT_UHASH_BITS_MAX ||
+	    mtable->mt_nmes <= (LNET_MT_UHASH_LOAD << bits))
+		return;
+
+	LIBCFS_CPT_ALLOC(uhash, lnet_cpt_table(), mtable->mt_cpt,
+			 sizeof(*uhash) << (bits + 1));
+	if (uhash == NULL) /* keep matching with the current hash */
+		return;
+
+	for (i = 0; i < (1U << (bits + 1)); i++)
+		INIT_LIST_HEAD(&uhash[i]);
+
+	lnet_res_lock(mtable->mt_cpt);
+	if (mtable->mt_uhash_bits != bits) { /* grown by somebody else */
+		lnet_res_unlock(mtable->mt_cpt);
+		LIBCFS_FREE(uhash, sizeof(*uhash) << (bits + 1));
+		return;
+	}
+
+	/* MEs with the same match criteria keep their order */
+	for (i = 0; i < (1U << bits); i++) {
+		list_for_each_entry_safe(me, tmp, &mtable->mt_uhash[i],
+					 me_list) {
+			list_move_tail(&me->me_list,
+				       &uhash[lnet_mt_uhash(me->me_match_id,
+							    me->me_match_bits,
+							    bits + 1)]);
+		}
+	}
+
+	if (mtable->mt_uhash != mtable->mt_mhash)
+		old = mtable->mt_uhash;
+	mtable->mt_uhash = uhash;
+	mtable->mt_uhash_bits = bits + 1;
+	lnet_res_unlock(mtable->mt_cpt);
+
+	if (old != NULL)
+		LIBCFS_FREE(old, sizeof(*old) << bits);
+
+	CDEBUG(D_NET, "portal %d cpt %d: ME hash grown to %u buckets\n",
+	       mtable->mt_portal, mtable->mt_cpt, 1U << (bits + 1));
+}
+
 int
 lnet_mt_match_md(struct lnet_match_table *mtable,
 		 struct lnet_match_info *info, struct lnet_msg *msg)
@@ -740,6 +804,20 @@ lnet_ptl_attach_md(struct lnet_me *me, struct lnet_libmd *md,
 	lnet_ptl_unlock(ptl);
 }
 
+static void
+lnet_mt_cleanup_mes(struct list_head *head)
+{
+	struct lnet_me *me;
+
+	while (!list_empty(head)) {
+		me = list_entry(head->next, struct lnet_me, me_list);
+		CERROR("Active ME %p on exit\n", me);
+		list_del(&me->me_list);
+		CDEBUG(D_MALLOC, "slab-freed 'me' at %p in cleanup.\n", me);
+		kmem_cache_free(lnet_mes_cachep, me);
+	}
+}
+
 static void
 lnet_ptl_cleanup(struct lnet_portal *ptl)
 {
@@ -753,26 +831,23 @@ lnet_ptl_cleanup(struct lnet_portal *ptl)
 	LASSERT(list_empty(&ptl->ptl_msg_stealing));
 	cfs_percpt_for_each(mtable, i, ptl->ptl_mtables) {
 		struct list_head *mhash;
-		struct lnet_me	 *me;
 		int		  j;
 
 		if (mtable->mt_mhash == NULL) /* uninitialized match-table */
 			continue;
 
+		if (mtable->mt_uhash != mtable->mt_mhash) {
+			mhash = mtable->mt_uhash;
+			for (j = 0; j < (1 << mtable->mt_uhash_bits); j++)
+				lnet_mt_cleanup_mes(&mhash[j]);
+			LIBCFS_FREE(mhash,
+				    sizeof(*mhash) << mtable->mt_uhash_bits);
+		}
+
 		mhash = mtable->mt_mhash;
 		/* cleanup ME */
-		for (j = 0; j < LNET_MT_HASH_SIZE + 1; j++) {
-			while (!list_empty(&mhash[j])) {
-				me = list_entry(mhash[j].next,
-						struct lnet_me, me_list);
-				CERROR("Active ME %p on exit\n", me);
-				list_del(&me->me_list);
-				CDEBUG(D_MALLOC,
-				       "slab-freed 'me' at %p in cleanup.\n",
-				       me);
-				kmem_cache_free(lnet_mes_cachep, me);
-			}
-		}
+		for (j = 0; j < LNET_MT_HASH_SIZE + 1; j++)
+			lnet_mt_cleanup_mes(&mhash[j]);
 		/* the extra entry is for MEs with ignore bits */
 		CFS_FREE_PTR_ARRAY(mhash, LNET_MT_HASH_SIZE + 1);
 	}
@@ -816,6 +891,8 @@ lnet_ptl_setup(struct lnet_portal *ptl, int index)
 		mtable->mt_mhash = mhash;
 		for (j = 0; j < LNET_MT_HASH_SIZE + 1; j++)
 			INIT_LIST_HEAD(&mhash[j]);
+		mtable->mt_uhash = mhash;
+		mtable->mt_uhash_bits = LNET_MT_HASH_BITS;
 
 		mtable->mt_portal = index;
 		mtable->mt_cpt = i;
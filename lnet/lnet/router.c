@@ -35,6 +35,10 @@
 #define LNET_NRB_LARGE_PAGES	((LNET_MTU + PAGE_SIZE - 1) >> \
 				  PAGE_SHIFT)
 
+#define LNET_RTRPOOL_HIGH_WM	90	/* % of buffers in use to grow */
+#define LNET_RTRPOOL_LOW_WM	50	/* % of buffers in use to shrink */
+#define LNET_RTRPOOL_IDLE_TICKS	10	/* periods under LOW_WM to shrink */
+
 static char *forwarding = "";
 module_param(forwarding, charp, 0444);
 MODULE_PARM_DESC(forwarding, "Explicitly enable/disable forwarding between networks");
@@ -51,6 +55,9 @@ MODULE_PARM_DESC(large_router_buffers, "# of large messages to buffer in the rou
 static int peer_buffer_credits;
 module_param(peer_buffer_credits, int, 0444);
 MODULE_PARM_DESC(peer_buffer_credits, "# router buffer credits per peer");
+static int router_buffers_max_factor;
+module_param(router_buffers_max_factor, int, 0644);
+MODULE_PARM_DESC(router_buffers_max_factor, "Grow router buffer pools by demand up to this multiple of their configured size (<= 1 to disable)");
 
 static int auto_down = 1;
 module_param(auto_down, int, 0444);
@@ -953,6 +960,32 @@ int lnet_get_rtr_pool_cfg(int cpt, struct lnet_ioctl_pool_cfg *pool_cfg)
 	return rc;
 }
 
+int lnet_get_rtr_pool_stats(struct lnet_ioctl_pool_stats *stats)
+{
+	struct lnet_rtrbufpool *rbp;
+	int cpt = stats->ps_cpt;
+	int j;
+
+	if (the_lnet.ln_rtrpools == NULL)
+		return -ENOENT;
+
+	if (cpt < 0 || cpt >= LNET_CPT_NUMBER)
+		return -ENOENT;
+
+	rbp = the_lnet.ln_rtrpools[cpt];
+	lnet_net_lock(cpt);
+	for (j = 0; j < LNET_NRBPOOLS; j++) {
+		stats->ps_pools[j].ps_nblocked = rbp[j].rbp_nblocked;
+		stats->ps_pools[j].ps_wait_avg = rbp[j].rbp_nblocked ?
+			div64_u64(rbp[j].rbp_wait_total,
+				  rbp[j].rbp_nblocked) : 0;
+		stats->ps_pools[j].ps_wait_max = rbp[j].rbp_wait_max;
+	}
+	lnet_net_unlock(cpt);
+
+	return 0;
+}
+
 int
 lnet_get_route(int idx, __u32 *net, __u32 *hops,
 	       lnet_nid_t *gateway, __u32 *flags, __u32 *priority, __u32 *sensitivity)
@@ -1335,16 +1368,34 @@ lnet_rtrpool_adjust_bufs(struct lnet_rtrbufpool *rbp, int nbufs, int cpt)
 
 	lnet_net_lock(cpt);
 	/* If we are called for less buffers than already in the pool, we
-	 * just lower the req_nbuffers number and excess buffers will be
-	 * thrown away as they are returned to the free list.  Credits
-	 * then get adjusted as well.
+	 * lower the req_nbuffers number and free the excess buffers which
+	 * are on the free list. The busy ones will be thrown away as they
+	 * are returned to the free list.  Credits then get adjusted as well.
 	 * If we already have enough buffers allocated to serve the
 	 * increase requested, then we can treat that the same way as we
 	 * do the decrease. */
 	num_rb = nbufs - rbp->rbp_nbuffers;
 	if (nbufs <= rbp->rbp_req_nbuffers || num_rb <= 0) {
 		rbp->rbp_req_nbuffers = nbufs;
+		while (rbp->rbp_nbuffers > nbufs && rbp->rbp_credits > 0) {
+			rb = list_entry(rbp->rbp_bufs.next,
+					struct lnet_rtrbuf, rb_list);
+			list_move(&rb->rb_list, &rb_list);
+			rbp->rbp_nbuffers--;
+			rbp->rbp_credits--;
+		}
+		rbp->rbp_mincredits = min(rbp->rbp_mincredits,
+					  rbp->rbp_credits);
+		rbp->rbp_tick_mincredits = min(rbp->rbp_tick_mincredits,
+					       rbp->rbp_credits);
 		lnet_net_unlock(cpt);
+
+		while (!list_empty(&rb_list)) {
+			rb = list_entry(rb_list.next, struct lnet_rtrbuf,
+					rb_list);
+			list_del(&rb->rb_list);
+			lnet_destroy_rtrbuf(rb, npages);
+		}
 		return 0;
 	}
 	/* store the older value of rbp_req_nbuffers and then set it to
@@ -1380,6 +1431,8 @@ lnet_rtrpool_adjust_bufs(struct lnet_rtrbufpool *rbp, int nbufs, int cpt)
 	rbp->rbp_nbuffers += num_buffers;
 	rbp->rbp_credits += num_buffers;
 	rbp->rbp_mincredits = rbp->rbp_credits;
+	rbp->rbp_tick_mincredits = min(rbp->rbp_tick_mincredits,
+				       rbp->rbp_credits);
 	/* We need to schedule blocked msg using the newly
 	 * added buffers. */
 	while (!list_empty(&rbp->rbp_bufs) &&
@@ -1409,6 +1462,17 @@ lnet_rtrpool_init(struct lnet_rtrbufpool *rbp, int npages)
 	rbp->rbp_npages = npages;
 	rbp->rbp_credits = 0;
 	rbp->rbp_mincredits = 0;
+	rbp->rbp_tick_mincredits = 0;
+}
+
+/* set the configured size of a pool, as opposed to its autosized one */
+static int
+lnet_rtrpool_config_bufs(struct lnet_rtrbufpool *rbp, int nbufs, int cpt)
+{
+	rbp->rbp_cfg_nbuffers = nbufs;
+	rbp->rbp_nidle = 0;
+
+	return lnet_rtrpool_adjust_bufs(rbp, nbufs, cpt);
 }
 
 void
@@ -1537,21 +1601,21 @@ lnet_rtrpools_alloc(int im_a_router)
 
 	cfs_percpt_for_each(rtrp, i, the_lnet.ln_rtrpools) {
 		lnet_rtrpool_init(&rtrp[LNET_TINY_BUF_IDX], 0);
-		rc = lnet_rtrpool_adjust_bufs(&rtrp[LNET_TINY_BUF_IDX],
+		rc = lnet_rtrpool_config_bufs(&rtrp[LNET_TINY_BUF_IDX],
 					      nrb_tiny, i);
 		if (rc != 0)
 			goto failed;
 
 		lnet_rtrpool_init(&rtrp[LNET_SMALL_BUF_IDX],
 				  LNET_NRB_SMALL_PAGES);
-		rc = lnet_rtrpool_adjust_bufs(&rtrp[LNET_SMALL_BUF_IDX],
+		rc = lnet_rtrpool_config_bufs(&rtrp[LNET_SMALL_BUF_IDX],
 					      nrb_small, i);
 		if (rc != 0)
 			goto failed;
 
 		lnet_rtrpool_init(&rtrp[LNET_LARGE_BUF_IDX],
 				  LNET_NRB_LARGE_PAGES);
-		rc = lnet_rtrpool_adjust_bufs(&rtrp[LNET_LARGE_BUF_IDX],
+		rc = lnet_rtrpool_config_bufs(&rtrp[LNET_LARGE_BUF_IDX],
 					      nrb_large, i);
 		if (rc != 0)
 			goto failed;
@@ -1582,7 +1646,7 @@ lnet_rtrpools_adjust_helper(int tiny, int small, int large)
 		tiny_router_buffers = tiny;
 		nrb = lnet_nrb_tiny_calculate();
 		cfs_percpt_for_each(rtrp, i, the_lnet.ln_rtrpools) {
-			rc = lnet_rtrpool_adjust_bufs(&rtrp[LNET_TINY_BUF_IDX],
+			rc = lnet_rtrpool_config_bufs(&rtrp[LNET_TINY_BUF_IDX],
 						      nrb, i);
 			if (rc != 0)
 				return rc;
@@ -1592,7 +1656,7 @@ lnet_rtrpools_adjust_helper(int tiny, int small, int large)
 		small_router_buffers = small;
 		nrb = lnet_nrb_small_calculate();
 		cfs_percpt_for_each(rtrp, i, the_lnet.ln_rtrpools) {
-			rc = lnet_rtrpool_adjust_bufs(&rtrp[LNET_SMALL_BUF_IDX],
+			rc = lnet_rtrpool_config_bufs(&rtrp[LNET_SMALL_BUF_IDX],
 						      nrb, i);
 			if (rc != 0)
 				return rc;
@@ -1602,7 +1666,7 @@ lnet_rtrpools_adjust_helper(int tiny, int small, int large)
 		large_router_buffers = large;
 		nrb = lnet_nrb_large_calculate();
 		cfs_percpt_for_each(rtrp, i, the_lnet.ln_rtrpools) {
-			rc = lnet_rtrpool_adjust_bufs(&rtrp[LNET_LARGE_BUF_IDX],
+			rc = lnet_rtrpool_config_bufs(&rtrp[LNET_LARGE_BUF_IDX],
 						      nrb, i);
 			if (rc != 0)
 				return rc;
@@ -1625,6 +1689,119 @@ lnet_rtrpools_adjust(int tiny, int small, int large)
 	return lnet_rtrpools_adjust_helper(tiny, small, large);
 }
 
+static void
+lnet_rtrpool_autosize(int idx, int max_factor)
+{
+	struct lnet_rtrbufpool *rtrp;
+	struct lnet_rtrbufpool *rbp;
+	long budget = 0;
+	long total = 0;
+	bool starved = false;
+	int old_nbufs;
+	int nbufs;
+	int i;
+
+	/* sample the peak use of the pool on each CPT since last time */
+	cfs_percpt_for_each(rtrp, i, the_lnet.ln_rtrpools) {
+		rbp = &rtrp[idx];
+
+		lnet_net_lock(i);
+		rbp->rbp_peak_nbuffers = rbp->rbp_nbuffers -
+					 rbp->rbp_tick_mincredits;
+		rbp->rbp_tick_mincredits = rbp->rbp_credits;
+		lnet_net_unlock(i);
+
+		/* pretend the pool of index fail_val is fully used */
+		if (CFS_FAIL_CHECK_VALUE(CFS_FAIL_LNET_RTRPOOL_BUSY, idx))
+			rbp->rbp_peak_nbuffers = rbp->rbp_req_nbuffers;
+
+		budget += (long)rbp->rbp_cfg_nbuffers * max_factor;
+		total += rbp->rbp_req_nbuffers;
+		if (rbp->rbp_peak_nbuffers > rbp->rbp_req_nbuffers)
+			starved = true;
+	}
+
+	/* when some CPT had messages blocked and the budget is used up,
+	 * take back the buffers of the underused CPTs right away */
+	starved = starved && total >= budget;
+
+	cfs_percpt_for_each(rtrp, i, the_lnet.ln_rtrpools) {
+		rbp = &rtrp[idx];
+
+		if (rbp->rbp_req_nbuffers <= rbp->rbp_cfg_nbuffers ||
+		    rbp->rbp_peak_nbuffers * 100 >=
+		    rbp->rbp_req_nbuffers * LNET_RTRPOOL_LOW_WM) {
+			rbp->rbp_nidle = 0;
+			continue;
+		}
+
+		if (++rbp->rbp_nidle < LNET_RTRPOOL_IDLE_TICKS && !starved)
+			continue;
+
+		/* leave the pool half way between the watermarks */
+		nbufs = max(rbp->rbp_cfg_nbuffers,
+			    rbp->rbp_peak_nbuffers * 200 /
+			    (LNET_RTRPOOL_HIGH_WM + LNET_RTRPOOL_LOW_WM));
+		CDEBUG(D_NET, "shrink %d page pool on CPT %d: %d -> %d\n",
+		       rbp->rbp_npages, i, rbp->rbp_req_nbuffers, nbufs);
+		total -= rbp->rbp_req_nbuffers - nbufs;
+		rbp->rbp_nidle = 0;
+		lnet_rtrpool_adjust_bufs(rbp, nbufs, i);
+	}
+
+	cfs_percpt_for_each(rtrp, i, the_lnet.ln_rtrpools) {
+		rbp = &rtrp[idx];
+		old_nbufs = rbp->rbp_req_nbuffers;
+
+		if (rbp->rbp_peak_nbuffers * 100 <
+		    old_nbufs * LNET_RTRPOOL_HIGH_WM)
+			continue;
+
+		/* grow by a quarter, or by what was missing if more */
+		nbufs = old_nbufs + max(old_nbufs / 4,
+					rbp->rbp_peak_nbuffers - old_nbufs);
+		nbufs = min_t(long, nbufs, old_nbufs + budget - total);
+		if (nbufs <= old_nbufs)
+			continue;
+
+		CDEBUG(D_NET, "grow %d page pool on CPT %d: %d -> %d\n",
+		       rbp->rbp_npages, i, old_nbufs, nbufs);
+		if (lnet_rtrpool_adjust_bufs(rbp, nbufs, i) != 0)
+			break;
+		total += nbufs - old_nbufs;
+	}
+}
+
+/*
+ * Resize the router buffer pools to the demand seen since the previous
+ * call, made by the monitor thread. A pool which had more than
+ * LNET_RTRPOOL_HIGH_WM percent of its buffers in use, or messages
+ * blocked, grows as long as the pools of that size over all CPTs stay
+ * within router_buffers_max_factor times their configured size. So a
+ * busy CPT can use the headroom left by the others. A pool which stayed
+ * under LNET_RTRPOOL_LOW_WM percent for LNET_RTRPOOL_IDLE_TICKS periods
+ * shrinks back towards its configured size, or at once if the buffers
+ * are needed by another CPT. With autosizing disabled, pools which
+ * were grown still shrink back.
+ */
+void
+lnet_rtrpools_autosize(void)
+{
+	int max_factor = max(router_buffers_max_factor, 1);
+	int idx;
+
+	/* the monitor thread must not wait on LNet configuration */
+	if (!mutex_trylock(&the_lnet.ln_api_mutex))
+		return;
+
+	if (the_lnet.ln_routing && the_lnet.ln_rtrpools != NULL) {
+		for (idx = 0; idx < LNET_NRBPOOLS; idx++)
+			lnet_rtrpool_autosize(idx, max_factor);
+	}
+
+	mutex_unlock(&the_lnet.ln_api_mutex);
+}
+
 int
 lnet_rtrpools_enable(void)
 {
@@ -1866,6 +1866,41 @@ add_msg_stats_to_yaml_blk(struct cYAML *yaml,
 	return true;
 }
 
+/*
+ * Add the selection stats of local or peer NI @nid, nothing is added if the
+ * kernel does not provide them.
+ */
+static bool
+add_sel_stats_to_yaml_blk(struct cYAML *yaml, lnet_nid_t nid, bool peer)
+{
+	struct lnet_ioctl_sel_stats stats;
+	struct cYAML *ystats;
+
+	LIBCFS_IOC_INIT_V2(stats, sel_hdr);
+	stats.sel_nid = nid;
+	stats.sel_peer = peer;
+	if (l_ioctl(LNET_DEV_ID, IOC_LIBCFS_GET_SEL_STATS, &stats) != 0)
+		return true;
+
+	ystats = cYAML_create_object(yaml, "selection stats");
+	if (!ystats)
+		return false;
+	if (cYAML_create_number(ystats, "latency",
+				stats.sel_latency)
+					== NULL)
+		return false;
+	if (cYAML_create_number(ystats, "rate",
+				stats.sel_rate)
+					== NULL)
+		return false;
+	if (cYAML_create_number(ystats, "bytes in flight",
+				stats.sel_nob)
+					== NULL)
+		return false;
+
+	return true;
+}
+
 static struct lnet_ioctl_comm_count *
 get_counts(struct lnet_ioctl_element_msg_stats *msg_stats, int idx)
 {
@@ -2251,6 +2286,10 @@ continue_without_udsp_info:
 							== NULL)
 				goto out;
 
+			if (!add_sel_stats_to_yaml_blk(item, ni_data->lic_nid,
+						       false))
+				goto out;
+
 continue_without_msg_stats:
 			tunables = cYAML_create_object(item, "tunables");
 			if (!tunables)
@@ -2524,6 +2563,36 @@ int lustre_lnet_config_response_tracking(int val, int seq_no,
 	return rc;
 }
 
+int lustre_lnet_config_select_policy(int val, int seq_no,
+				     struct cYAML **err_rc)
+{
+	int rc = LUSTRE_CFG_RC_NO_ERR;
+	char err_str[LNET_MAX_STR_LEN];
+	char val_str[LNET_MAX_STR_LEN];
+
+	if (val < 0 || val > 1) {
+		rc = LUSTRE_CFG_RC_BAD_PARAM;
+		snprintf(err_str, sizeof(err_str),
+			 "\"Valid values are: 0 or 1\"");
+	} else {
+		snprintf(err_str, sizeof(err_str), "\"success\"");
+
+		snprintf(val_str, sizeof(val_str), "%d", val);
+
+		rc = write_sysfs_file(modparam_path, "lnet_select_policy",
+				      val_str, 1, strlen(val_str) + 1);
+		if (rc)
+			snprintf(err_str, sizeof(err_str),
+				 "\"cannot configure select policy: %s\"",
+				 strerror(errno));
+	}
+
+	cYAML_build_error(rc, seq_no, ADD_CMD, "select_policy", err_str,
+			  err_rc);
+
+	return rc;
+}
+
 int lustre_lnet_config_recovery_limit(int val, int seq_no,
 				      struct cYAML **err_rc)
 {
@@ -2665,6 +2734,8 @@ int lustre_lnet_show_routing(int seq_no, struct cYAML **show_rc,
 {
 	struct lnet_ioctl_config_data *data;
 	struct lnet_ioctl_pool_cfg *pool_cfg = NULL;
+	struct lnet_ioctl_pool_stats pool_stats;
+	bool have_stats = false;
 	int rc = LUSTRE_CFG_RC_OUT_OF_MEM;
 	int l_errno = 0;
 	char *buf;
@@ -2714,6 +2785,12 @@ int lustre_lnet_show_routing(int seq_no, struct cYAML **show_rc,
 		if (backup)
 			goto calculate_buffers;
 
+		/* not provided by older kernels */
+		LIBCFS_IOC_INIT_V2(pool_stats, ps_hdr);
+		pool_stats.ps_cpt = i;
+		have_stats = l_ioctl(LNET_DEV_ID, IOC_LIBCFS_GET_BUF_STATS,
+				     &pool_stats) == 0;
+
 		snprintf(node_name, sizeof(node_name), "cpt[%d]", i);
 		item = cYAML_create_seq_item(pools_node);
 		if (item == NULL)
@@ -2754,6 +2831,21 @@ calculate_buffers:
 						pool_cfg->pl_pools[j].
 						   pl_mincredits) == NULL)
 				goto out;
+			if (!backup && have_stats &&
+			    cYAML_create_number(type_node, "blocked",
+						pool_stats.ps_pools[j].
+						   ps_nblocked) == NULL)
+				goto out;
+			if (!backup && have_stats &&
+			    cYAML_create_number(type_node, "wait_avg_us",
+						pool_stats.ps_pools[j].
+						   ps_wait_avg) == NULL)
+				goto out;
+			if (!backup && have_stats &&
+			    cYAML_create_number(type_node, "wait_max_us",
+						pool_stats.ps_pools[j].
+						   ps_wait_max) == NULL)
+				goto out;
 			/* keep track of the total count for each of the
 			 * tiny, small and large buffers */
 			buf_count[j] += pool_cfg->pl_pools[j].pl_nbuffers;
@@ -3134,6 +3226,9 @@ continue_without_udsp_info:
 						hstats->hlpni_network_timeout)
 							== NULL)
 				goto out;
+
+			if (!add_sel_stats_to_yaml_blk(peer_ni, *nidp, true))
+				goto out;
 		}
 	}
 
@@ -3666,6 +3761,29 @@ int lustre_lnet_show_response_tracking(int seq_no, struct cYAML **show_rc,
 				       show_rc, err_rc, l_errno);
 }
 
+int lustre_lnet_show_select_policy(int seq_no, struct cYAML **show_rc,
+				   struct cYAML **err_rc)
+{
+	int rc = LUSTRE_CFG_RC_OUT_OF_MEM;
+	char val[LNET_MAX_STR_LEN];
+	int select_policy = -1, l_errno = 0;
+	char err_str[LNET_MAX_STR_LEN] = "\"out of memory\"";
+
+	rc = read_sysfs_file(modparam_path, "lnet_select_policy", val,
+			     1, sizeof(val));
+	if (rc) {
+		l_errno = -errno;
+		snprintf(err_str, sizeof(err_str),
+			 "\"cannot get lnet_select_policy value: %d\"", rc);
+	} else {
+		select_policy = atoi(val);
+	}
+
+	return build_global_yaml_entry(err_str, sizeof(err_str), seq_no,
+				       "select_policy", select_policy,
+				       show_rc, err_rc, l_errno);
+}
+
 int lustre_lnet_show_recovery_limit(int seq_no, struct cYAML **show_rc,
 				    struct cYAML **err_rc)
 {
@@ -4731,7 +4849,7 @@ static int handle_yaml_config_global_settings(struct cYAML *tree,
 {
 	struct cYAML *max_intf, *numa, *discovery, *retry, *tto, *seq_no,
 		     *sen, *recov, *rsen, *drop_asym_route, *rsp_tracking,
-		     *recov_limit;
+		     *recov_limit, *select_policy;
 	int rc = 0;
 
 	seq_no = cYAML_get_object_item(tree, "seq_no");
@@ -4812,6 +4930,13 @@ static int handle_yaml_config_global_settings(struct cYAML *tree,
 							: -1,
 						       err_rc);
 
+	select_policy = cYAML_get_object_item(tree, "select_policy");
+	if (select_policy)
+		rc = lustre_lnet_config_select_policy(
+			select_policy->cy_valueint,
+			seq_no ? seq_no->cy_valueint : -1,
+			err_rc);
+
 	return rc;
 }
 
@@ -4819,7 +4944,8 @@ static int handle_yaml_del_global_settings(struct cYAML *tree,
 					   struct cYAML **show_rc,
 					   struct cYAML **err_rc)
 {
-	struct cYAML *max_intf, *numa, *discovery, *seq_no, *drop_asym_route;
+	struct cYAML *max_intf, *numa, *discovery, *seq_no, *drop_asym_route,
+		     *select_policy;
 	int rc = 0;
 
 	seq_no = cYAML_get_object_item(tree, "seq_no");
@@ -4851,6 +4977,12 @@ static int handle_yaml_del_global_settings(struct cYAML *tree,
 		rc = lustre_lnet_config_drop_asym_route(
 			0, seq_no ? seq_no->cy_valueint : -1, err_rc);
 
+	/* NIs are selected by credits by default */
+	select_policy = cYAML_get_object_item(tree, "select_policy");
+	if (select_policy)
+		rc = lustre_lnet_config_select_policy(
+			0, seq_no ? seq_no->cy_valueint : -1, err_rc);
+
 	return rc;
 }
 
@@ -4860,7 +4992,7 @@ static int handle_yaml_show_global_settings(struct cYAML *tree,
 {
 	struct cYAML *max_intf, *numa, *discovery, *retry, *tto, *seq_no,
 		     *sen, *recov, *rsen, *drop_asym_route, *rsp_tracking,
-		     *recov_limit;
+		     *recov_limit, *select_policy;
 	int rc = 0;
 
 	seq_no = cYAML_get_object_item(tree, "seq_no");
@@ -4932,6 +5064,13 @@ static int handle_yaml_show_global_settings(struct cYAML *tree,
 						     -1,
 						     show_rc, err_rc);
 
+	select_policy = cYAML_get_object_item(tree, "select_policy");
+	if (select_policy)
+		rc = lustre_lnet_show_select_policy(seq_no ?
+						    seq_no->cy_valueint :
+						    -1,
+						    show_rc, err_rc);
+
 	return rc;
 }
 
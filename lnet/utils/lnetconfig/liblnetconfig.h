@@ -473,6 +473,10 @@ int lustre_lnet_config_recovery_limit(int val, int seq_no,
 				      struct cYAML **err_rc);
 int lustre_lnet_show_recovery_limit(int seq_no, struct cYAML **show_rc,
 				    struct cYAML **err_rc);
+int lustre_lnet_config_select_policy(int val, int seq_no,
+				     struct cYAML **err_rc);
+int lustre_lnet_show_select_policy(int seq_no, struct cYAML **show_rc,
+				   struct cYAML **err_rc);
 
 /*
  * lustre_lnet_config_max_intf
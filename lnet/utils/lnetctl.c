@@ -88,6 +88,7 @@ static int jt_set_peer_ni_value(int argc, char **argv);
 static int jt_calc_service_id(int argc, char **argv);
 static int jt_set_response_tracking(int argc, char **argv);
 static int jt_set_recovery_limit(int argc, char **argv);
+static int jt_set_select_policy(int argc, char **argv);
 static int jt_udsp(int argc, char **argv);
 
 command_t cmd_list[] = {
@@ -100,7 +101,8 @@ command_t cmd_list[] = {
 			   " | discovery | drop_asym_route | retry_count"
 			   " | transaction_timeout | health_sensitivity"
 			   " | recovery_interval | router_sensitivity"
-			   " | response_tracking | recovery_limit}"},
+			   " | response_tracking | recovery_limit"
+			   " | select_policy}"},
 	{"import", jt_import, 0, "import FILE.yaml"},
 	{"export", jt_export, 0, "export FILE.yaml"},
 	{"stats", jt_stats, 0, "stats {show | help}"},
@@ -238,6 +240,11 @@ command_t set_cmds[] = {
 	 "Set how long LNet will attempt to recover unhealthy interfaces.\n"
 	 "\t0 - Recover indefinitely (default)\n"
 	 "\t>0 - Recover for the specified number of seconds.\n"},
+	{"select_policy", jt_set_select_policy, 0,
+	 "Set how NIs and peer NIs of equal health and priority are selected\n"
+	 "\t0 - by available credits (default)\n"
+	 "\t1 - by expected completion time, from the recent latency\n"
+	 "\t    and the bytes in flight\n"},
 	{ 0, 0, 0, NULL }
 };
 
@@ -400,6 +407,35 @@ static int jt_set_response_tracking(int argc, char **argv)
 	return rc;
 }
 
+static int jt_set_select_policy(int argc, char **argv)
+{
+	long int value;
+	int rc;
+	struct cYAML *err_rc = NULL;
+
+	rc = check_cmd(set_cmds, "set", "select_policy", 2, argc, argv);
+	if (rc)
+		return rc;
+
+	rc = parse_long(argv[1], &value);
+	if (rc != 0) {
+		cYAML_build_error(-1, -1, "parser", "set",
+				  "cannot parse select_policy value",
+				  &err_rc);
+		cYAML_print_tree2file(stderr, err_rc);
+		cYAML_free_tree(err_rc);
+		return -1;
+	}
+
+	rc = lustre_lnet_config_select_policy(value, -1, &err_rc);
+	if (rc != LUSTRE_CFG_RC_NO_ERR)
+		cYAML_print_tree2file(stderr, err_rc);
+
+	cYAML_free_tree(err_rc);
+
+	return rc;
+}
+
 static int jt_set_recovery_limit(int argc, char **argv)
 {
 	long int value;
@@ -1523,6 +1559,12 @@ static int jt_show_global(int argc, char **argv)
 		goto out;
 	}
 
+	rc = lustre_lnet_show_select_policy(-1, &show_rc, &err_rc);
+	if (rc != LUSTRE_CFG_RC_NO_ERR) {
+		cYAML_print_tree2file(stderr, err_rc);
+		goto out;
+	}
+
 	if (show_rc)
 		cYAML_print_tree(show_rc);
 
@@ -1877,6 +1919,13 @@ static int jt_export(int argc, char **argv)
 		err_rc = NULL;
 	}
 
+	rc = lustre_lnet_show_select_policy(-1, &show_rc, &err_rc);
+	if (rc != LUSTRE_CFG_RC_NO_ERR) {
+		cYAML_print_tree2file(stderr, err_rc);
+		cYAML_free_tree(err_rc);
+		err_rc = NULL;
+	}
+
 	rc = lustre_lnet_show_udsp(-1, -1, &show_rc, &err_rc);
 	if (rc != LUSTRE_CFG_RC_NO_ERR) {
 		cYAML_print_tree2file(stderr, err_rc);
@@ -1490,6 +1490,8 @@ struct cl_read_ahead {
 
 	/* whether lock is in contention */
 	bool		cra_contention;
+	/* bandwidth-delay product of the targets, by pages, 0 if unknown */
+	unsigned long	cra_bdp_pages;
 };
 
 static inline void cl_read_ahead_release(const struct lu_env *env,
@@ -374,6 +374,10 @@ enum {
         PTLRPC_REQACTIVE_CNTR,
         PTLRPC_TIMEOUT,
         PTLRPC_REQBUF_AVAIL_CNTR,
+	PTLRPC_THREAD_START_CNTR,
+	PTLRPC_THREAD_STOP_CNTR,
+	PTLRPC_REPQDEPTH_CNTR,
+	PTLRPC_REPBATCH_CNTR,
         PTLRPC_LAST_CNTR
 };
 
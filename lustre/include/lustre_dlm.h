@@ -43,6 +43,7 @@
 #ifndef _LUSTRE_DLM_H__
 #define _LUSTRE_DLM_H__
 
+#include <linux/rhashtable.h>
 #include <lustre_lib.h>
 #include <lustre_net.h>
 #include <lustre_import.h>
@@ -68,6 +69,11 @@ extern struct kset *ldlm_svc_kset;
 #define LDLM_DIRTY_AGE_LIMIT (10)
 #define LDLM_DEFAULT_PARALLEL_AST_LIMIT 1024
 #define LDLM_DEFAULT_LRU_SHRINK_BATCH (16)
+/* maximum extra rounds in LRU given to a lock for its refetch cost */
+#define LDLM_DEFAULT_LRU_COST_MAX	(8)
+#define LDLM_LRU_COST_MAX		(64)
+#define LDLM_LRU_FREQ_MAX		(16)
+#define LDLM_LRU_CREDIT_UNSET		(-1)
 #define LDLM_DEFAULT_SLV_RECALC_PCT (10)
 
 /**
@@ -291,6 +297,7 @@ typedef int (*ldlm_res_policy)(const struct lu_env *env,
 			       enum ldlm_mode mode, __u64 flags, void *data);
 
 typedef int (*ldlm_cancel_cbt)(struct ldlm_lock *lock);
+typedef unsigned long (*ldlm_lru_cost_cbt)(struct ldlm_lock *lock);
 
 /**
  * LVB operations.
@@ -326,12 +333,13 @@ enum ldlm_appetite {
 };
 
 /**
- * Default values for the "max_nolock_size", "contention_time" and
- * "contended_locks" namespace tunables.
+ * Default values for the "max_nolock_size", "contention_time",
+ * "contended_locks" and "expand_conflicts" namespace tunables.
  */
 #define NS_DEFAULT_MAX_NOLOCK_BYTES 0
 #define NS_DEFAULT_CONTENTION_SECONDS 2
 #define NS_DEFAULT_CONTENDED_LOCKS 32
+#define NS_DEFAULT_EXPAND_CONFLICTS 16
 
 struct ldlm_ns_bucket {
 	/** back pointer to namespace */
@@ -343,9 +351,10 @@ struct ldlm_ns_bucket {
 	 */
 	struct adaptive_timeout     nsb_at_estimate;
 	/**
-	 * Which res in the bucket should we start with the reclaim.
+	 * Serializes insertion of the resources of this bucket into the
+	 * namespace hash with dropping of their last reference.
 	 */
-	int			    nsb_reclaim_start;
+	spinlock_t		nsb_lock;
 	/* counter of entries in this bucket */
 	atomic_t		nsb_count;
 };
@@ -405,8 +414,11 @@ struct ldlm_namespace {
 	/** name of this namespace */
 	char			*ns_name;
 
-	/** Resource hash table for namespace. */
-	struct cfs_hash		*ns_rs_hash;
+	/**
+	 * Resource hash table for namespace, lookups are done under RCU
+	 * without taking any locks.
+	 */
+	struct rhashtable	ns_rs_hash;
 	struct ldlm_ns_bucket	*ns_rs_buckets;
 	unsigned int		ns_bucket_bits;
 
@@ -462,6 +474,12 @@ struct ldlm_namespace {
 	 */
 	unsigned int            ns_cancel_batch;
 
+	/**
+	 * Maximum number of extra rounds a lock chosen for cancel is kept in
+	 * LRU for the cost of what it protects, 0 disables cost-aware LRU.
+	 */
+	unsigned int		ns_lru_cost_max;
+
 	/**
 	 * How much the SLV should decrease in %% to trigger LRU cancel urgently.
 	 */
@@ -537,6 +555,14 @@ struct ldlm_namespace {
 	 */
 	timeout_t		ns_contention_time;
 
+	/**
+	 * If more than \a ns_expand_conflicts conflicts caused only by lock
+	 * expansion are found on a resource within \a ns_contention_time,
+	 * the resource is considered to have interleaved writers and extent
+	 * locks on it are granted without expansion. 0 disables this.
+	 */
+	unsigned int		ns_expand_conflicts;
+
 	/**
 	 * Limit size of contended extent locks, in bytes.
 	 * If extended lock is requested for more then this many bytes and
@@ -554,6 +580,12 @@ struct ldlm_namespace {
 	 */
 	ldlm_cancel_cbt		ns_cancel;
 
+	/**
+	 * Callback to estimate the cost of refetching the data protected by
+	 * an unused lock, in pages, used by cost-aware LRU.
+	 */
+	ldlm_lru_cost_cbt	ns_lru_cost;
+
 	/** LDLM lock stats */
 	struct lprocfs_stats	*ns_stats;
 
@@ -570,7 +602,7 @@ struct ldlm_namespace {
 				ns_rpc_recalc:1;
 
 	/**
-	 * Which bucket should we start with the lock reclaim.
+	 * Which resource should we start with the lock reclaim.
 	 */
 	int			ns_reclaim_start;
 
@@ -630,6 +662,13 @@ static inline void ns_register_cancel(struct ldlm_namespace *ns,
 	ns->ns_cancel = arg;
 }
 
+static inline void ns_register_lru_cost(struct ldlm_namespace *ns,
+					ldlm_lru_cost_cbt arg)
+{
+	LASSERT(ns != NULL);
+	ns->ns_lru_cost = arg;
+}
+
 struct ldlm_lock;
 
 /** Type for blocking callback function of a lock. */
@@ -670,11 +709,19 @@ struct ldlm_cb_set_arg {
 	ptlrpc_interpterer_t		 gl_interpret_reply;
 	void				*gl_interpret_data;
 	struct ldlm_bl_desc		*bl_desc;
+	/* blocking ASTs to the same export may be sent in one RPC */
+	bool				 bl_batch;
+	/* pending batches of blocking ASTs, struct ldlm_bl_batch */
+	struct list_head		 bl_batches;
 };
 
+struct ldlm_bl_batch;
+
 struct ldlm_cb_async_args {
 	struct ldlm_cb_set_arg	*ca_set_arg;
 	struct ldlm_lock	*ca_lock;
+	/* batched blocking AST, ca_lock is not set then */
+	struct ldlm_bl_batch	*ca_batch;
 };
 
 /** The ldlm_glimpse_work was slab allocated & must be freed accordingly.*/
@@ -704,14 +751,25 @@ struct ldlm_interval_tree {
 /**
  * Lists of waiting locks for each inodebit type.
  * A lock can be in several liq_waiting lists and it remains in lr_waiting.
+ *
+ * Granted locks are counted per inodebit and per mode, so that a new lock
+ * compatible with all the granted modes of its bits needs no scan of
+ * lr_granted.
  */
 struct ldlm_ibits_queues {
 	struct list_head	liq_waiting[MDS_INODELOCK_NUMBITS];
+	/** Number of granted locks for each inodebit and mode index. */
+	__u32			liq_granted[MDS_INODELOCK_NUMBITS][LCK_MODE_NUM];
+	/** Modes of the granted locks holding each inodebit. */
+	enum ldlm_mode		liq_granted_modes[MDS_INODELOCK_NUMBITS];
 };
 
 struct ldlm_ibits_node {
 	struct list_head	lin_link[MDS_INODELOCK_NUMBITS];
 	struct ldlm_lock	*lock;
+	/** Mode and bits accounted in ldlm_ibits_queues::liq_granted. */
+	enum ldlm_mode		lin_granted_mode;
+	__u64			lin_granted_bits;
 };
 
 /** Whether to track references to exports by LDLM locks. */
@@ -894,6 +952,17 @@ struct ldlm_lock {
 	 */
 	ktime_t			l_last_used;
 
+	/**
+	 * Number of times the lock was reused from LRU, halved each time its
+	 * LRU credit is computed. Protected by ns_lock.
+	 */
+	__u8			l_lru_freq;
+	/**
+	 * Rounds left in LRU before the lock is cancelled by cost-aware LRU,
+	 * LDLM_LRU_CREDIT_UNSET if not computed yet. Protected by ns_lock.
+	 */
+	__s8			l_lru_credit;
+
 	/** Originally requested extent for the extent lock. */
 	struct ldlm_extent	l_req_extent;
 
@@ -1056,14 +1125,12 @@ struct ldlm_resource {
 	struct ldlm_ns_bucket	*lr_ns_bucket;
 
 	/**
-	 * List item for list in namespace hash.
-	 * protected by ns_lock.
-	 * Shared with linkage for RCU-delayed free.
+	 * Linkage into namespace hash, inserted and removed under
+	 * nsb_lock of \a lr_ns_bucket.
 	 */
-	union {
-		struct hlist_node	lr_hash;
-		struct rcu_head		lr_rcu;
-	};
+	struct rhash_head	lr_hash;
+	/** Linkage for RCU-delayed free, lookups are RCU-protected. */
+	struct rcu_head		lr_rcu;
 
 	/** Reference count for this resource */
 	atomic_t		lr_refcount;
@@ -1095,11 +1162,26 @@ struct ldlm_resource {
 	};
 
 	union {
-		/**
-		 * When the resource was considered as contended,
-		 * used only on server side.
-		 */
-		time64_t	lr_contention_time;
+		/* used only on server side */
+		struct {
+			/**
+			 * When the resource was considered as contended.
+			 */
+			time64_t	lr_contention_time;
+			/**
+			 * When the resource was last found to have
+			 * interleaved writers, extent locks are not
+			 * expanded for \a ns_contention_time after that.
+			 */
+			time64_t	lr_noexpand_time;
+			/**
+			 * Start of the current window for counting
+			 * expansion conflicts.
+			 */
+			time64_t	lr_expand_start;
+			/** Expansion conflicts seen in the window. */
+			unsigned int	lr_expand_conflicts;
+		};
 		/**
 		 * Associated inode, used only on client side.
 		 */
@@ -1382,6 +1464,8 @@ int ldlm_resource_foreach(struct ldlm_resource *res, ldlm_iterator_t iter,
 			  void *closure);
 void ldlm_namespace_foreach(struct ldlm_namespace *ns, ldlm_iterator_t iter,
 			    void *closure);
+void ldlm_namespace_foreach_res(struct ldlm_namespace *ns,
+				ldlm_res_iterator_t iter, void *arg);
 int ldlm_resource_iterate(struct ldlm_namespace *, const struct ldlm_res_id *,
 			  ldlm_iterator_t iter, void *data);
 /** @} ldlm_iterator */
@@ -1433,9 +1517,9 @@ int ldlm_glimpse_locks(struct ldlm_resource *res,
  * MDT or OST to pass through LDLM requests to LDLM for handling
  * @{
  */
-int ldlm_handle_enqueue0(struct ldlm_namespace *ns, struct ptlrpc_request *req,
-			 const struct ldlm_request *dlm_req,
-			 const struct ldlm_callback_suite *cbs);
+int ldlm_handle_enqueue(struct ldlm_namespace *ns, struct req_capsule *pill,
+			const struct ldlm_request *dlm_req,
+			const struct ldlm_callback_suite *cbs);
 int ldlm_handle_convert0(struct ptlrpc_request *req,
 			 const struct ldlm_request *dlm_req);
 int ldlm_handle_cancel(struct ptlrpc_request *req);
@@ -1726,13 +1810,18 @@ int ldlm_prep_elc_req(struct obd_export *exp, struct ptlrpc_request *req,
 		      struct list_head *cancels, int count);
 
 struct ptlrpc_request *ldlm_enqueue_pack(struct obd_export *exp, int lvb_len);
-int ldlm_handle_enqueue0(struct ldlm_namespace *ns, struct ptlrpc_request *req,
-			 const struct ldlm_request *dlm_req,
-			 const struct ldlm_callback_suite *cbs);
-int ldlm_cli_enqueue_fini(struct obd_export *exp, struct ptlrpc_request *req,
+int ldlm_cli_enqueue_fini(struct obd_export *exp, struct req_capsule *pill,
 			  struct ldlm_enqueue_info *einfo, __u8 with_policy,
 			  __u64 *flags, void *lvb, __u32 lvb_len,
 			  const struct lustre_handle *lockh, int rc);
+int ldlm_cli_lock_create_pack(struct obd_export *exp,
+			      struct ldlm_request *dlmreq,
+			      struct ldlm_enqueue_info *einfo,
+			      const struct ldlm_res_id *res_id,
+			      union ldlm_policy_data const *policy,
+			      __u64 *flags, __u32 lvb_len,
+			      enum lvb_type lvb_type,
+			      struct lustre_handle *lockh);
 int ldlm_cli_enqueue_local(const struct lu_env *env,
 			   struct ldlm_namespace *ns,
 			   const struct ldlm_res_id *res_id,
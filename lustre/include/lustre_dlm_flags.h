@@ -26,7 +26,7 @@
 #ifndef LDLM_ALL_FLAGS_MASK
 
 /** l_flags bits marked as "all_flags" bits */
-#define LDLM_FL_ALL_FLAGS_MASK          0x00FFFFFFC28F932FULL
+#define LDLM_FL_ALL_FLAGS_MASK          0x00FFFFFFC28F936FULL
 
 /** extent, mode, or resource changed */
 #define LDLM_FL_LOCK_CHANGED            0x0000000000000001ULL // bit   0
@@ -73,6 +73,15 @@
 #define ldlm_set_ast_sent(_l)           LDLM_SET_FLAG((  _l), 1ULL <<  5)
 #define ldlm_clear_ast_sent(_l)         LDLM_CLEAR_FLAG((_l), 1ULL <<  5)
 
+/**
+ * Blocking AST for several locks, their client and server handles are packed
+ * in pairs into lock_handle. Only set in LDLM_BL_CALLBACK requests, never in
+ * l_flags, see ldlm_bl_batch_send(). */
+#define LDLM_FL_BL_BATCH                0x0000000000000040ULL // bit   6
+#define ldlm_is_bl_batch(_l)            LDLM_TEST_FLAG(( _l), 1ULL <<  6)
+#define ldlm_set_bl_batch(_l)           LDLM_SET_FLAG((  _l), 1ULL <<  6)
+#define ldlm_clear_bl_batch(_l)         LDLM_CLEAR_FLAG((_l), 1ULL <<  6)
+
 /**
  * Lock is being replayed.  This could probably be implied by the fact that
  * one of BLOCK_{GRANTED,CONV,WAIT} is set, but that is pretty dangerous. */
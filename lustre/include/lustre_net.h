@@ -373,6 +373,13 @@
 #define OUT_MAXREQSIZE	(1000 * 1024)
 #define OUT_MAXREPSIZE	MDS_MAXREPSIZE
 
+/**
+ * MDS_BATCH request and reply hold many sub-requests and sub-replies, each
+ * packed as a lustre_msg, and are bounded by the "regular" MDS portal.
+ */
+#define BUT_MAXREQSIZE	MDS_REG_MAXREQSIZE
+#define BUT_MAXREPSIZE	MDS_REG_MAXREPSIZE
+
 /** MDS_BUFSIZE = max_reqsize (w/o LOV EA) + max sptlrpc payload size */
 #define MDS_BUFSIZE		max(MDS_MAXREQSIZE + SPTLRPC_MAX_PAYLOAD, \
 				    8 * 1024)
@@ -1469,6 +1476,7 @@ enum {
 	SVC_STOPPING	= BIT(1),
 	SVC_STARTING	= BIT(2),
 	SVC_RUNNING	= BIT(3),
+	SVC_IDLE	= BIT(4),
 };
 
 #define PTLRPC_THR_NAME_LEN		32
@@ -1646,6 +1654,9 @@ struct ptlrpc_service {
 	int				srv_nthrs_cpt_init;
 	/** limit of threads number for each partition */
 	int				srv_nthrs_cpt_limit;
+	/** seconds a thread above srv_nthrs_cpt_init may stay idle before
+	 * it is stopped, 0 to never stop idle threads */
+	int				srv_thread_idle_timeout;
 	/** Root of debugfs dir tree for this service */
 	struct dentry		       *srv_debugfs_entry;
         /** Pointer to statistic data for this service */
@@ -0,0 +1,70 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * lustre/include/lustre_nrs_deadline.h
+ *
+ * Network Request Scheduler (NRS) deadline policy
+ *
+ */
+
+#ifndef _LUSTRE_NRS_DEADLINE_H
+#define _LUSTRE_NRS_DEADLINE_H
+
+/* \name deadline
+ *
+ * Deadline policy
+ *
+ * This policy handles RPCs in the order of their adaptive timeout deadlines,
+ * so that the requests closest to expiry are served first.
+ * @{
+ */
+
+/**
+ * Private data structure for the deadline policy
+ */
+struct nrs_deadline_head {
+	/**
+	 * Resource object for policy instance.
+	 */
+	struct ptlrpc_nrs_resource	dh_res;
+	/**
+	 * Queued requests, ordered by their deadline.
+	 */
+	struct binheap		       *dh_binheap;
+	/**
+	 * Arrival order, used to keep requests with the same deadline in
+	 * FIFO order.
+	 */
+	__u64				dh_sequence;
+};
+
+struct nrs_deadline_req {
+	/**
+	 * Deadline of the request at enqueue time. ptlrpc_request::rq_deadline
+	 * can be extended by early replies while the request is queued, so
+	 * the binheap key is kept separately.
+	 */
+	time64_t		dr_deadline;
+	__u64			dr_sequence;
+};
+
+/** @} deadline */
+#endif
@@ -126,6 +126,24 @@ struct nrs_tbf_client {
 	bool				 tc_in_heap;
 	/** Sequence of the newest rule. */
 	__u32				 tc_rule_sequence;
+	/** Guaranteed minimum RPC rate, 0 if none. */
+	u32				 tc_min_rate;
+	/** Time to wait for next guaranteed token. */
+	__u64				 tc_min_nsecs;
+	/** Guaranteed token number. */
+	__u64				 tc_min_ntoken;
+	/** Time check-point of the guaranteed bucket. */
+	__u64				 tc_min_check_time;
+	/** Deadline of the next guaranteed token. */
+	__u64				 tc_min_deadline;
+	/** Node in the binary heap of classes with a minimum rate. */
+	struct binheap_node		 tc_min_node;
+	/** Whether the client is in the minimum rate heap. */
+	bool				 tc_in_min_heap;
+	/** RPCs of the class in the current autotuning window. */
+	__u64				 tc_auto_nrpcs;
+	/** Start of the current autotuning window. */
+	__u64				 tc_auto_start;
 	/**
 	 * Linkage into LRU list. Protected bucket lock of
 	 * nrs_tbf_head::th_cli_hash.
@@ -139,6 +157,8 @@ enum nrs_rule_flags {
 	NTRS_STOPPING	= 0x00000001,
 	NTRS_DEFAULT	= 0x00000002,
 	NTRS_REALTIME	= 0x00000004,
+	/** Rule started by the autotuner, see nrs_tbf_auto_check(). */
+	NTRS_AUTO	= 0x00000008,
 };
 
 struct nrs_tbf_rule {
@@ -184,6 +204,21 @@ struct nrs_tbf_rule {
 	atomic_t			 tr_ref;
 	/** Generation of the rule. */
 	__u64				 tr_generation;
+	/** Guaranteed minimum RPC/s of each class of the rule, 0 if none. */
+	u32				 tr_min_rate;
+	/** Time to wait for next guaranteed token. */
+	u64				 tr_min_nsecs_per_rpc;
+	/**
+	 * Parent rule. Classes of this rule also take tokens from the parent
+	 * rule bucket, and can borrow them when out of their own tokens.
+	 */
+	struct nrs_tbf_rule		*tr_parent;
+	/** Token number of the bucket shared by the children of the rule. */
+	__u64				 tr_ntoken;
+	/** Time check-point of the bucket shared by the children. */
+	__u64				 tr_check_time;
+	/** Last time the job limited by an automatic rule was seen hot. */
+	__u64				 tr_auto_hot_time;
 };
 
 struct nrs_tbf_ops {
@@ -226,6 +261,61 @@ struct nrs_tbf_bucket {
 	struct list_head	ntb_lru;
 };
 
+enum nrs_tbf_auto_action {
+	NRS_TBF_AUTO_START,
+	NRS_TBF_AUTO_CHANGE,
+	NRS_TBF_AUTO_STOP,
+};
+
+/**
+ * Entry of the audit log of the rules started, changed and stopped by the
+ * autotuner.
+ */
+struct nrs_tbf_auto_event {
+	time64_t			 tae_time;
+	enum nrs_tbf_auto_action	 tae_action;
+	char				 tae_rule[MAX_TBF_NAME];
+	char				 tae_jobid[LUSTRE_JOBID_SIZE];
+	/** RPC/s of the job measured in the last window. */
+	__u32				 tae_rate;
+	/** RPC/s limit of the rule. */
+	__u32				 tae_limit;
+};
+
+#define NRS_TBF_AUTO_LOG_SIZE		32
+#define NRS_TBF_AUTO_INTERVAL		10
+#define NRS_TBF_AUTO_EXPIRE		60
+
+/**
+ * State of the autotuner, which starts a jobid rule for each job using more
+ * than a share of the capacity of the partition, and stops it once the job
+ * has cooled down.
+ */
+struct nrs_tbf_auto {
+	/** Share of the capacity a single job may use in percent, 0 is off. */
+	__u32				 ta_share;
+	/** RPC/s capacity of the partition, 0 to use the measured one. */
+	__u32				 ta_capacity;
+	/** Length of a sampling window, in seconds. */
+	__u32				 ta_interval;
+	/** How long a rule remains after its job has cooled down, in seconds. */
+	__u32				 ta_expire;
+	/** Estimated RPC/s capacity, decaying peak of the handled RPC/s. */
+	__u32				 ta_measured;
+	/** Sequence used to name the rules. */
+	__u32				 ta_sequence;
+	/** Start of the current sampling window. */
+	__u64				 ta_start;
+	/** Number of handled requests. */
+	__u64				 ta_ndone;
+	/** Number of handled requests at the start of the window. */
+	__u64				 ta_ndone_start;
+	/** Number of audit log entries ever recorded. */
+	__u64				 ta_nevents;
+	/** Audit log, the oldest entries are overwritten. */
+	struct nrs_tbf_auto_event	 ta_log[NRS_TBF_AUTO_LOG_SIZE];
+};
+
 /**
  * Private data structure for the TBF policy
  */
@@ -266,6 +356,12 @@ struct nrs_tbf_head {
 	 * Heap of queues.
 	 */
 	struct binheap		*th_binheap;
+	/**
+	 * Heap of queues with a guaranteed minimum rate, ordered by the
+	 * deadline of their next guaranteed token. These are served before
+	 * the queues in th_binheap.
+	 */
+	struct binheap		*th_min_binheap;
 	/**
 	 * Hash of clients.
 	 */
@@ -286,6 +382,10 @@ struct nrs_tbf_head {
 	 * Index of bucket on hash table while purging.
 	 */
 	int				 th_purge_start;
+	/**
+	 * Automatic rules.
+	 */
+	struct nrs_tbf_auto		 th_auto;
 };
 
 enum nrs_tbf_cmd_type {
@@ -312,14 +412,32 @@ struct nrs_tbf_cmd {
 			__u32			 ts_valid_type;
 			enum nrs_rule_flags	 ts_rule_flags;
 			char			*ts_next_name;
+			__u64			 ts_min_rate;
+			char			*ts_parent_name;
 		} tc_start;
 		struct nrs_tbf_cmd_change {
 			__u64			 tc_rpc_rate;
 			char			*tc_next_name;
+			__u64			 tc_min_rate;
+			bool			 tc_min_rate_set;
 		} tc_change;
 	} u;
 };
 
+#define NRS_TBF_AUTO_SHARE	0x00000001
+#define NRS_TBF_AUTO_CAPACITY	0x00000002
+#define NRS_TBF_AUTO_INTERVAL	0x00000004
+#define NRS_TBF_AUTO_EXPIRE	0x00000008
+
+/** Settings of the autotuner, only those in \a tac_valid are changed. */
+struct nrs_tbf_auto_cmd {
+	__u32	tac_valid;
+	__u32	tac_share;
+	__u32	tac_capacity;
+	__u32	tac_interval;
+	__u32	tac_expire;
+};
+
 enum nrs_tbf_field {
 	NRS_TBF_FIELD_NID,
 	NRS_TBF_FIELD_JOBID,
@@ -374,6 +492,14 @@ enum nrs_ctl_tbf {
 	 * Read the TBF policy type preset by proc entry "nrs_policies".
 	 */
 	NRS_CTL_TBF_RD_TYPE_FLAG,
+	/**
+	 * Read the settings and the audit log of the autotuner.
+	 */
+	NRS_CTL_TBF_RD_AUTO,
+	/**
+	 * Write the settings of the autotuner.
+	 */
+	NRS_CTL_TBF_WR_AUTO,
 };
 
 /** @} tbf */
@@ -108,6 +108,8 @@ struct osc_device {
 		uint64_t	os_lockless_writes;    /* by bytes */
 		uint64_t	os_lockless_reads;     /* by bytes */
 		uint64_t	os_lockless_truncates; /* by times */
+		uint64_t	os_compr_writes;       /* by bytes */
+		uint64_t	os_compr_wire_writes;  /* by bytes on wire */
 	} od_stats;
 
 	/* configuration item(s) */
@@ -137,6 +139,12 @@ struct osc_io {
 	/** active extents, we know how many bytes is going to be written,
 	 * so having an active extent will prevent it from being fragmented */
 	struct osc_extent *oi_active;
+	/** pages queued for oi_active but not yet attached to it, see
+	 * osc_io_pending_flush() */
+	struct list_head   oi_pending_pages;
+	unsigned int	   oi_pending_nr;
+	/** srvlock of the pages in oi_pending_pages */
+	bool		   oi_pending_srvlock;
 	/** partially truncated extent, we need to hold this extent to prevent
 	 * page writeback from happening. */
 	struct osc_extent *oi_trunc;
@@ -533,6 +541,10 @@ struct osc_page {
 	 * lru page list. See osc_lru_{del|use}() in osc_page.c for usage.
 	 */
 	struct list_head	ops_lru;
+	/**
+	 * CPT of the client_obd LRU partition holding ops_lru.
+	 */
+	int			ops_lru_cpt;
 	/**
 	 * Submit time - the time when the page is starting RPC. For debugging.
 	 */
@@ -581,6 +593,7 @@ int osc_set_async_flags(struct osc_object *obj, struct osc_page *opg,
 			u32 async_flags);
 int osc_prep_async_page(struct osc_object *osc, struct osc_page *ops,
 			struct page *page, loff_t offset);
+void osc_io_pending_flush(struct osc_io *oio);
 int osc_queue_async_io(const struct lu_env *env, struct cl_io *io,
 		       struct osc_page *ops, cl_commit_cbt cb);
 int osc_page_cache_add(const struct lu_env *env, struct osc_page *opg,
@@ -664,8 +677,7 @@ int osc_cleanup_common(struct obd_device *obd);
 int osc_set_info_async(const struct lu_env *env, struct obd_export *exp,
 		       u32 keylen, void *key, u32 vallen, void *val,
 		       struct ptlrpc_request_set *set);
-int osc_ldlm_resource_invalidate(struct cfs_hash *hs, struct cfs_hash_bd *bd,
-				 struct hlist_node *hnode, void *arg);
+int osc_ldlm_resource_invalidate(struct ldlm_resource *res, void *arg);
 int osc_reconnect(const struct lu_env *env, struct obd_export *exp,
 		  struct obd_device *obd, struct obd_uuid *cluuid,
 		  struct obd_connect_data *data, void *localdata);
@@ -723,6 +735,7 @@ void osc_lock_cancel(const struct lu_env *env,
 void osc_lock_fini(const struct lu_env *env, struct cl_lock_slice *slice);
 int osc_ldlm_glimpse_ast(struct ldlm_lock *dlmlock, void *data);
 unsigned long osc_ldlm_weigh_ast(struct ldlm_lock *dlmlock);
+unsigned long osc_ldlm_lru_cost(struct ldlm_lock *dlmlock);
 
 /*****************************************************************************
  *
@@ -62,14 +62,42 @@ enum req_location {
 
 struct req_capsule {
         struct ptlrpc_request   *rc_req;
+	/** Sub-request message in a batch RPC, NULL for a regular request */
+	struct lustre_msg	*rc_reqmsg;
+	/** Sub-reply message in a batch RPC */
+	struct lustre_msg	*rc_repmsg;
+	/** Space available for the sub-reply message at \a rc_repmsg */
+	__u32			 rc_replen;
+	/** Swab state of the sub-request/reply buffers, see rq_req_swab_mask */
+	__u32			 rc_req_swab_mask;
+	__u32			 rc_rep_swab_mask;
         const struct req_format *rc_fmt;
         enum req_location        rc_loc;
         __u32                    rc_area[RCL_NR][REQ_MAX_FIELD_NR];
 };
 
+/**
+ * A capsule describes a sub-request of a batch RPC (see MDS_BATCH) when its
+ * messages are not the ones of the embedding ptlrpc_request.
+ */
+static inline bool req_capsule_subreq(const struct req_capsule *pill)
+{
+	return pill->rc_reqmsg != NULL;
+}
+
 void req_capsule_init(struct req_capsule *pill, struct ptlrpc_request *req,
                       enum req_location location);
 void req_capsule_fini(struct req_capsule *pill);
+void req_capsule_subreq_init(struct req_capsule *pill,
+			     const struct req_format *fmt,
+			     struct ptlrpc_request *req,
+			     struct lustre_msg *reqmsg,
+			     struct lustre_msg *repmsg,
+			     enum req_location loc);
+int req_capsule_subreq_unpack(struct req_capsule *pill, enum req_location loc,
+			      __u32 len);
+int req_capsule_client_pack(struct req_capsule *pill, __u32 len);
+bool req_capsule_server_packed(struct req_capsule *pill);
 
 void req_capsule_set(struct req_capsule *pill, const struct req_format *fmt);
 void req_capsule_client_dump(struct req_capsule *pill);
@@ -187,6 +215,8 @@ extern struct req_format RQF_MDS_SWAP_LAYOUTS;
 extern struct req_format RQF_MDS_REINT_MIGRATE;
 extern struct req_format RQF_MDS_REINT_RESYNC;
 extern struct req_format RQF_MDS_RMFID;
+extern struct req_format RQF_MDS_BATCH;
+extern struct req_format RQF_BUT_GETATTR;
 /* MDS hsm formats */
 extern struct req_format RQF_MDS_HSM_STATE_GET;
 extern struct req_format RQF_MDS_HSM_STATE_SET;
@@ -234,6 +264,7 @@ extern struct req_format RQF_LDLM_CANCEL;
 extern struct req_format RQF_LDLM_CALLBACK;
 extern struct req_format RQF_LDLM_CP_CALLBACK;
 extern struct req_format RQF_LDLM_BL_CALLBACK;
+extern struct req_format RQF_LDLM_BL_CALLBACK_BATCH;
 extern struct req_format RQF_LDLM_GL_CALLBACK;
 extern struct req_format RQF_LDLM_GL_CALLBACK_DESC;
 /* LOG req_format */
@@ -333,6 +364,7 @@ extern struct req_msg_field RMF_FIEMAP_KEY;
 extern struct req_msg_field RMF_FIEMAP_VAL;
 extern struct req_msg_field RMF_OST_ID;
 extern struct req_msg_field RMF_SHORT_IO;
+extern struct req_msg_field RMF_OST_COMPR;
 
 /* MGS config read message format */
 extern struct req_msg_field RMF_MGS_CONFIG_BODY;
@@ -347,6 +379,10 @@ extern struct req_msg_field RMF_OUT_UPDATE_REPLY;
 extern struct req_msg_field RMF_OUT_UPDATE_HEADER;
 extern struct req_msg_field RMF_OUT_UPDATE_BUF;
 
+/* Batch RPC format */
+extern struct req_msg_field RMF_BUT_REQUEST;
+extern struct req_msg_field RMF_BUT_REPLY;
+
 /* LFSCK format */
 extern struct req_msg_field RMF_LFSCK_REQUEST;
 extern struct req_msg_field RMF_LFSCK_REPLY;
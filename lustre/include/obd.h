@@ -177,6 +177,19 @@ enum obd_cl_sem_lock_class {
 
 struct mdc_rpc_lock;
 struct obd_import;
+/**
+ * Per-CPT partition of the LRU pages of a client_obd, so that LRU
+ * maintenance done on different CPTs does not serialize on one lock.
+ */
+struct cl_lru_part {
+	/** Lock for clp_list */
+	spinlock_t		clp_lock;
+	/** List of LRU pages added on this CPT */
+	struct list_head	clp_list;
+	/** # of LRU pages in clp_list */
+	atomic_long_t		clp_in_list;
+};
+
 struct client_obd {
 	struct rw_semaphore	 cl_sem;
 	struct obd_uuid		 cl_target_uuid;
@@ -284,6 +297,14 @@ struct client_obd {
 	struct obd_histogram	cl_write_page_hist;
 	struct obd_histogram	cl_read_offset_hist;
 	struct obd_histogram	cl_write_offset_hist;
+	/* bandwidth-delay estimate of read RPCs, used to size readahead,
+	 * protected by cl_loi_list_lock */
+	ktime_t			cl_read_sample_start;
+	ktime_t			cl_read_sample_last;
+	__u64			cl_read_sample_bytes;
+	__u64			cl_read_bw;		/* bytes per second */
+	__u64			cl_read_rtt_min;	/* usec */
+	time64_t		cl_read_rtt_stamp;
 
 	/** LRU for osc caching pages */
 	struct cl_client_cache  *cl_cache;
@@ -297,8 +318,6 @@ struct client_obd {
 	 * queue, or in transfer. Busy pages can't be discarded so they are not
 	 * in LRU cache. */
 	atomic_long_t            cl_lru_busy;
-	/** # of LRU pages in the cache for this client_obd */
-	atomic_long_t            cl_lru_in_list;
 	/** # of threads are shrinking LRU cache. To avoid contention, it's not
 	 * allowed to have multiple threads shrinking LRU cache. */
 	atomic_t                 cl_lru_shrinkers;
@@ -308,11 +327,9 @@ struct client_obd {
 	 * reclaim and shrink - shrink is async, voluntarily rebalancing;
 	 * reclaim is sync, initiated by IO thread when the LRU slots are
 	 * in shortage. */
-	__u64                    cl_lru_reclaim;
-	/** List of LRU pages for this client_obd */
-	struct list_head         cl_lru_list;
-	/** Lock for LRU page list */
-	spinlock_t		 cl_lru_list_lock;
+	atomic_long_t		 cl_lru_reclaim;
+	/** Per-CPT lists of LRU pages for this client_obd */
+	struct cl_lru_part	**cl_lru_parts;
 	/** # of unstable pages in this client_obd.
 	 * An unstable page is a page state that WRITE RPC has finished but
 	 * the transaction has NOT yet committed. */
@@ -333,6 +350,8 @@ struct client_obd {
 	wait_queue_head_t	 cl_mod_rpcs_waitq;
 	unsigned long		*cl_mod_tag_bitmap;
 	struct obd_histogram	 cl_mod_rpcs_hist;
+	/* number of sub-requests packed into each batch RPC */
+	struct obd_histogram	 cl_batch_rpc_hist;
 
         /* mgc datastruct */
 	struct mutex		  cl_mgc_mutex;
@@ -350,6 +369,8 @@ struct client_obd {
 	enum cksum_types	 cl_cksum_type;
 	/* preferred checksum algorithm to be used */
 	enum cksum_types	 cl_preferred_cksum_type;
+	/* compression algorithm of bulk writes */
+	enum ll_compr_type	 cl_compr_type;
 
         /* also protected by the poorly named _loi_list_lock lock above */
         struct osc_async_rc      cl_ar;
@@ -423,6 +444,9 @@ struct lov_obd {
 	struct lov_md_tgt_desc	*lov_mdc_tgts;
 
 	struct kobject		*lov_tgts_kobj;
+
+	/* submit direct IO pages of different stripes in parallel */
+	bool			lov_parallel_dio;
 };
 
 #define lmv_tgt_desc lu_tgt_desc
@@ -951,9 +975,9 @@ struct md_callback {
 
 struct md_enqueue_info;
 /* metadata stat-ahead */
-typedef int (* md_enqueue_cb_t)(struct ptlrpc_request *req,
-                                struct md_enqueue_info *minfo,
-                                int rc);
+typedef int (* md_enqueue_cb_t)(struct req_capsule *pill,
+				struct md_enqueue_info *minfo,
+				int rc);
 
 struct md_enqueue_info {
 	struct md_op_data		mi_data;
@@ -963,6 +987,19 @@ struct md_enqueue_info {
 	struct ldlm_enqueue_info	mi_einfo;
 	md_enqueue_cb_t			mi_cb;
 	void			       *mi_cbdata;
+	/* capsule of the sub-request when sent in a batch RPC */
+	struct req_capsule		mi_pill;
+};
+
+/*
+ * Batch of metadata requests packed into MDS_BATCH RPCs, the result of each
+ * request is returned through the callback of its md_enqueue_info.
+ */
+struct lu_batch {
+	/* first error met when sending the batch RPCs */
+	int				lbt_result;
+	/* max number of requests packed into one RPC */
+	__u32				lbt_max_count;
 };
 
 struct obd_ops {
@@ -1212,6 +1249,14 @@ struct md_ops {
 			  const union lmv_mds_md *lmv, size_t lmv_size);
 	int (*m_rmfid)(struct obd_export *exp, struct fid_array *fa, int *rcs,
 		       struct ptlrpc_request_set *set);
+
+	struct lu_batch *(*m_batch_create)(struct obd_export *exp,
+					   __u32 max_count);
+	int (*m_batch_stop)(struct obd_export *exp, struct lu_batch *bh);
+	int (*m_batch_flush)(struct obd_export *exp, struct lu_batch *bh,
+			     bool wait);
+	int (*m_batch_add)(struct obd_export *exp, struct lu_batch *bh,
+			   struct md_enqueue_info *minfo);
 };
 
 static inline struct md_open_data *obd_mod_alloc(void)
@@ -1306,6 +1351,22 @@ static inline int cli_brw_size(struct obd_device *obd)
 	return obd->u.cli.cl_max_pages_per_rpc << PAGE_SHIFT;
 }
 
+/* # of LRU pages in the cache for this client_obd */
+static inline long cli_lru_in_list(struct client_obd *cli)
+{
+	struct cl_lru_part *part;
+	long pages = 0;
+	int i;
+
+	if (cli->cl_lru_parts == NULL)
+		return 0;
+
+	cfs_percpt_for_each(part, i, cli->cl_lru_parts)
+		pages += atomic_long_read(&part->clp_in_list);
+
+	return pages;
+}
+
 /*
  * When RPC size or the max RPCs in flight is increased, the max dirty pages
  * of the client should be increased accordingly to avoid sending fragmented
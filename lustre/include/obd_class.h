@@ -1327,6 +1327,10 @@ enum mps_stat_idx {
 	LPROC_MD_GETXATTR,
 	LPROC_MD_INTENT_GETATTR_ASYNC,
 	LPROC_MD_REVALIDATE_LOCK,
+	LPROC_MD_BATCH_CREATE,
+	LPROC_MD_BATCH_STOP,
+	LPROC_MD_BATCH_FLUSH,
+	LPROC_MD_BATCH_ADD,
 	LPROC_MD_LAST_OPC,
 };
 
@@ -1570,7 +1574,7 @@ static inline int md_unlink(struct obd_export *exp, struct md_op_data *op_data,
 }
 
 static inline int md_get_lustre_md(struct obd_export *exp,
-                                   struct ptlrpc_request *req,
+				   struct req_capsule *pill,
                                    struct obd_export *dt_exp,
                                    struct obd_export *md_exp,
                                    struct lustre_md *md)
@@ -1581,7 +1585,7 @@ static inline int md_get_lustre_md(struct obd_export *exp,
 	if (rc)
 		return rc;
 
-	return MDP(exp->exp_obd, get_lustre_md)(exp, req, dt_exp, md_exp, md);
+	return MDP(exp->exp_obd, get_lustre_md)(exp, pill, dt_exp, md_exp, md);
 }
 
 static inline int md_free_lustre_md(struct obd_export *exp,
@@ -1806,6 +1810,82 @@ static inline int md_rmfid(struct obd_export *exp, struct fid_array *fa,
 	return MDP(exp->exp_obd, rmfid)(exp, fa, rcs, set);
 }
 
+/**
+ * Create a batch of metadata requests, \a max_count being the max number of
+ * requests packed into one RPC.
+ */
+static inline struct lu_batch *md_batch_create(struct obd_export *exp,
+					       __u32 max_count)
+{
+	int rc;
+
+	rc = exp_check_ops(exp);
+	if (rc)
+		return ERR_PTR(rc);
+
+	lprocfs_counter_incr(exp->exp_obd->obd_md_stats,
+			     LPROC_MD_BATCH_CREATE);
+
+	return MDP(exp->exp_obd, batch_create)(exp, max_count);
+}
+
+/**
+ * Send the pending requests of a batch and release it. Returns the first
+ * error met when sending the batch RPCs.
+ */
+static inline int md_batch_stop(struct obd_export *exp, struct lu_batch *bh)
+{
+	int rc;
+
+	rc = exp_check_ops(exp);
+	if (rc)
+		return rc;
+
+	lprocfs_counter_incr(exp->exp_obd->obd_md_stats,
+			     LPROC_MD_BATCH_STOP);
+
+	return MDP(exp->exp_obd, batch_stop)(exp, bh);
+}
+
+/**
+ * Send the pending requests of a batch, and wait for their replies if
+ * \a wait is set.
+ */
+static inline int md_batch_flush(struct obd_export *exp, struct lu_batch *bh,
+				 bool wait)
+{
+	int rc;
+
+	rc = exp_check_ops(exp);
+	if (rc)
+		return rc;
+
+	lprocfs_counter_incr(exp->exp_obd->obd_md_stats,
+			     LPROC_MD_BATCH_FLUSH);
+
+	return MDP(exp->exp_obd, batch_flush)(exp, bh, wait);
+}
+
+/**
+ * Add an intent getattr/lookup request into a batch. The request is sent
+ * alone, like md_intent_getattr_async() does, when the MDT doesn't support
+ * MDS_BATCH RPC.
+ */
+static inline int md_batch_add(struct obd_export *exp, struct lu_batch *bh,
+			       struct md_enqueue_info *minfo)
+{
+	int rc;
+
+	rc = exp_check_ops(exp);
+	if (rc)
+		return rc;
+
+	lprocfs_counter_incr(exp->exp_obd->obd_md_stats,
+			     LPROC_MD_BATCH_ADD);
+
+	return MDP(exp->exp_obd, batch_add)(exp, bh, minfo);
+}
+
 /* OBD Metadata Support */
 
 extern int obd_init_caches(void);
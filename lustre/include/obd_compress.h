@@ -0,0 +1,61 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ *
+ * Bulk data compression helpers
+ */
+
+#ifndef __OBD_COMPRESS_H
+#define __OBD_COMPRESS_H
+
+#include <linux/crypto.h>
+#include <libcfs/libcfs.h>
+#include <uapi/linux/lustre/lustre_idl.h>
+
+/* log2 of the size of the chunks compressed independently */
+#define OBD_COMPR_CHUNK_BITS_DEF	max_t(unsigned int, 16, PAGE_SHIFT)
+#define OBD_COMPR_CHUNK_BITS_MAX	20
+
+const char *obd_compr_type2name(enum ll_compr_type type);
+int obd_compr_name2type(const char *name);
+__u16 obd_compr_types_supported(void);
+struct crypto_comp *obd_compr_alloc(enum ll_compr_type type);
+
+static inline void obd_compr_free(struct crypto_comp *cc)
+{
+	crypto_free_comp(cc);
+}
+
+/*
+ * Length of the piece of [@offset, @offset + @len) compressed on its own,
+ * i.e. up to the next chunk-aligned offset, see struct brw_compr_desc.
+ */
+static inline __u32 obd_compr_piece_len(__u64 offset, __u32 len,
+					unsigned int chunk_bits)
+{
+	__u64 chunk_end = (offset | ((1ULL << chunk_bits) - 1)) + 1;
+
+	return min_t(__u64, len, chunk_end - offset);
+}
+
+#endif /* __OBD_COMPRESS_H */
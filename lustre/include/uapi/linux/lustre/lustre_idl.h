@@ -616,8 +616,8 @@ struct lustre_msg_v2 {
 	__u32 lm_repsize;	/* size of preallocated reply buffer */
 	__u32 lm_cksum;		/* CRC32 of ptlrpc_body early reply messages */
 	__u32 lm_flags;		/* enum lustre_msghdr MSGHDR_* flags */
-	__u32 lm_padding_2;	/* unused */
-	__u32 lm_padding_3;	/* unused */
+	__u32 lm_opc;		/* sub-request opcode in a batch RPC */
+	__u32 lm_result;	/* sub-request result in a batch RPC */
 	__u32 lm_buflens[0];	/* length of additional buffers in bytes,
 				 * padded to a multiple of 8 bytes. */
 	/*
@@ -850,6 +850,9 @@ struct ptlrpc_body_v2 {
 #define OBD_CONNECT2_GETATTR_PFID      0x20000ULL /* pack parent FID in getattr */
 #define OBD_CONNECT2_LSEEK	       0x40000ULL /* SEEK_HOLE/DATA RPC */
 #define OBD_CONNECT2_DOM_LVB	       0x80000ULL /* pack DOM glimpse data in LVB */
+#define OBD_CONNECT2_BATCH_RPC	      0x100000ULL /* Multi-op batched RPCs */
+#define OBD_CONNECT2_COMPRESS	      0x200000ULL /* compressed bulk writes */
+#define OBD_CONNECT2_BATCH_BL_AST     0x400000ULL /* batched blocking ASTs */
 /* XXX README XXX:
  * Please DO NOT add flag values here before first ensuring that this same
  * flag value is not in use on some other branch.  Please clear any such
@@ -909,7 +912,9 @@ struct ptlrpc_body_v2 {
 				OBD_CONNECT2_CRUSH | \
 				OBD_CONNECT2_ENCRYPT | \
 				OBD_CONNECT2_GETATTR_PFID |\
-				OBD_CONNECT2_LSEEK | OBD_CONNECT2_DOM_LVB)
+				OBD_CONNECT2_LSEEK | OBD_CONNECT2_DOM_LVB |\
+				OBD_CONNECT2_BATCH_RPC | \
+				OBD_CONNECT2_BATCH_BL_AST)
 
 #define OST_CONNECT_SUPPORTED  (OBD_CONNECT_SRVLOCK | OBD_CONNECT_GRANT | \
 				OBD_CONNECT_REQPORTAL | OBD_CONNECT_VERSION | \
@@ -931,7 +936,9 @@ struct ptlrpc_body_v2 {
 				OBD_CONNECT_SHORTIO | OBD_CONNECT_FLAGS2)
 
 #define OST_CONNECT_SUPPORTED2 (OBD_CONNECT2_LOCKAHEAD | OBD_CONNECT2_INC_XID |\
-				OBD_CONNECT2_ENCRYPT | OBD_CONNECT2_LSEEK)
+				OBD_CONNECT2_ENCRYPT | OBD_CONNECT2_LSEEK | \
+				OBD_CONNECT2_COMPRESS | \
+				OBD_CONNECT2_BATCH_BL_AST)
 
 #define ECHO_CONNECT_SUPPORTED (OBD_CONNECT_FID)
 #define ECHO_CONNECT_SUPPORTED2 0
@@ -974,7 +981,7 @@ struct obd_connect_data {
          * any field after ocd_maxbytes on the receiver without a valid flag
          * may result in out-of-bound memory access and kernel oops. */
 	__u16 ocd_maxmodrpcs;    /* Maximum modify RPCs in parallel */
-	__u16 padding0;          /* added 2.1.0. also fix lustre_swab_connect */
+	__u16 ocd_compr_types;   /* supported compression algorithms */
 	__u32 padding1;          /* added 2.1.0. also fix lustre_swab_connect */
 	__u64 ocd_connect_flags2;
         __u64 padding3;          /* added 2.1.0. also fix lustre_swab_connect */
@@ -1023,6 +1030,20 @@ enum cksum_types {
 #define OBD_CKSUM_ALL (OBD_CKSUM_CRC32 | OBD_CKSUM_ADLER | OBD_CKSUM_CRC32C | \
 		       OBD_CKSUM_T10_ALL)
 
+/*
+ * Supported compression algorithms for bulk writes, BIT(type) of every
+ * algorithm is stored in obd_connect_data::ocd_compr_types.
+ * Please update obd_compr_names[] in obd_compress.c when adding a new one.
+ */
+enum ll_compr_type {
+	LL_COMPR_TYPE_NONE	= 0,
+	LL_COMPR_TYPE_LZ4	= 1,
+	LL_COMPR_TYPE_LZ4HC	= 2,
+	LL_COMPR_TYPE_DEFLATE	= 3,
+	LL_COMPR_TYPE_ZSTD	= 4,
+	LL_COMPR_TYPE_MAX,
+};
+
 /*
  * The default checksum algorithm used on top of T10PI GRD tags for RPC.
  * Considering that the checksum-of-checksums is only computing CRC32 on a
@@ -1431,6 +1452,22 @@ struct niobuf_remote {
 	__u32	rnb_flags;
 };
 
+/*
+ * Compressed bulk write descriptor, sent in RMF_OST_COMPR with OST_WRITE.
+ *
+ * The data of every niobuf is split at each file offset aligned to the
+ * chunk size, every such piece is compressed on its own, and its size on
+ * the wire is stored in bcd_sizes[] in niobuf order. The bulk carries the
+ * pieces back to back. A piece whose wire size is equal to its length is
+ * sent uncompressed.
+ */
+struct brw_compr_desc {
+	__u32	bcd_type;	/* enum ll_compr_type */
+	__u32	bcd_chunk_bits;	/* log2 of the chunk size */
+	__u32	bcd_count;	/* number of pieces */
+	__u32	bcd_sizes[0];	/* wire size of each piece */
+};
+
 /* lock value block communicated between the filter and llite */
 
 /* OST_LVB_ERR_INIT is needed because the return code in rc is
@@ -1673,6 +1710,7 @@ enum mds_cmd {
 	MDS_HSM_CT_UNREGISTER	= 60,
 	MDS_SWAP_LAYOUTS	= 61,
 	MDS_RMFID		= 62,
+	MDS_BATCH		= 63,
 	MDS_LAST_OPC
 };
 
@@ -3474,6 +3512,63 @@ struct out_read_reply {
 	char	orr_data[0];
 };
 
+/**
+ * MDS_BATCH RPC Format
+ *
+ * A batch RPC packs several independent metadata sub-requests, each one
+ * being a complete lustre_msg_v2 without ptlrpc_body, so that the MDT can
+ * handle them with the regular request handlers in a single service thread
+ * wakeup.  The opcode of each sub-request is stored in lm_opc, and the
+ * result of each sub-request is returned in lm_result of its reply.
+ *
+ * Request Format
+ *
+ *   batch_update_request
+ *   lustre_msg (1st)
+ *   lustre_msg (2nd)
+ *   ...
+ *   lustre_msg (burq_count-th)
+ *
+ * Reply Format
+ *
+ *   batch_update_reply
+ *   lustre_msg (1st)
+ *   lustre_msg (2nd)
+ *   ...
+ *   lustre_msg (burp_count-th)
+ *
+ * burp_count may be less than burq_count if the MDT stopped processing
+ * sub-requests early, e.g. because the reply buffer was exhausted.
+ */
+
+/* opcodes for batched sub-requests */
+enum batch_update_cmd {
+	BUT_GETATTR		= 1,
+	BUT_LAST_OPC
+};
+
+#define BUT_FIRST_OPC		BUT_GETATTR
+
+#define BUT_REQUEST_MAGIC	0xBADE0001
+/* Hold batched sub-requests sending to the MDT in single RPC */
+struct batch_update_request {
+	__u32			burq_magic;
+	__u16			burq_count;	/* number of burq_reqmsg[] */
+	__u16			burq_padding;
+	__u32			burq_reply_size;/* reply buffer for all subs */
+	__u32			burq_padding2;
+	struct lustre_msg	burq_reqmsg[0];
+};
+
+#define BUT_REPLY_MAGIC		0x00AD0001
+/* Hold batched sub-replies being replied from the MDT. */
+struct batch_update_reply {
+	__u32			burp_magic;
+	__u16			burp_count;	/* number of burp_repmsg[] */
+	__u16			burp_padding;
+	struct lustre_msg	burp_repmsg[0];
+};
+
 /** layout swap request structure
  * fid1 and fid2 are in mdt_body
  */
@@ -2450,6 +2450,7 @@ enum lu_ladvise_type {
 	LU_LADVISE_DONTNEED	= 2,
 	LU_LADVISE_LOCKNOEXPAND = 3,
 	LU_LADVISE_LOCKAHEAD	= 4,
+	LU_LADVISE_PREFETCH	= 5,
 	LU_LADVISE_MAX
 };
 
@@ -2458,6 +2459,7 @@ enum lu_ladvise_type {
 	[LU_LADVISE_DONTNEED]		= "dontneed",			\
 	[LU_LADVISE_LOCKNOEXPAND]	= "locknoexpand",		\
 	[LU_LADVISE_LOCKAHEAD]		= "lockahead",			\
+	[LU_LADVISE_PREFETCH]		= "prefetch",			\
 }
 
 /* This is the userspace argument for ladvise.  It is currently the same as
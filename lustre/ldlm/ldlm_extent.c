@@ -263,12 +263,56 @@ ldlm_extent_internal_policy_waiting(struct ldlm_lock *req,
 }
 
 
+/**
+ * Account conflicts caused only by lock expansion on \a res.
+ *
+ * Writers interleaving small stripes of a shared file (N-to-1 I/O) never
+ * request overlapping extents, but each lock granted to one of them is
+ * expanded over the neighbouring stripes of the others, so every enqueue
+ * revokes the locks of other clients. Once more than ns_expand_conflicts
+ * such conflicts are seen during ns_contention_time, stop expanding locks
+ * on the resource for ns_contention_time and consider it contended, so
+ * that clients allowing it switch to lockless I/O.
+ *
+ * \retval true if locks on \a res should not be expanded
+ */
+static bool ldlm_extent_check_interleave(struct ldlm_resource *res,
+					 int expand_conflicts)
+{
+	struct ldlm_namespace *ns = ldlm_res_to_ns(res);
+	time64_t now = ktime_get_seconds();
+
+	if (ns->ns_expand_conflicts == 0)
+		return false;
+
+	if (expand_conflicts > 0) {
+		if (now >= res->lr_expand_start + ns->ns_contention_time) {
+			res->lr_expand_start = now;
+			res->lr_expand_conflicts = 0;
+		}
+		res->lr_expand_conflicts += expand_conflicts;
+		if (res->lr_expand_conflicts > ns->ns_expand_conflicts) {
+			if (now >= res->lr_noexpand_time +
+				   ns->ns_contention_time)
+				CDEBUG(D_DLMTRACE, "res "DLDLMRES": %u expansion conflicts in %llds, stop expanding locks\n",
+				       PLDLMRES(res),
+				       res->lr_expand_conflicts,
+				       (s64)(now - res->lr_expand_start));
+			res->lr_noexpand_time = now;
+			res->lr_contention_time = now;
+		}
+	}
+
+	return now < res->lr_noexpand_time + ns->ns_contention_time;
+}
+
 /* In order to determine the largest possible extent we can grant, we need
  * to scan all of the queues. */
 static void ldlm_extent_policy(struct ldlm_resource *res,
 			       struct ldlm_lock *lock, __u64 *flags)
 {
 	struct ldlm_extent new_ex = { .start = 0, .end = OBD_OBJECT_EOF };
+	bool noexpand;
 
 	if (lock->l_export == NULL)
 		/*
@@ -288,11 +332,15 @@ static void ldlm_extent_policy(struct ldlm_resource *res,
 	/* Because reprocess_queue zeroes flags and uses it to return
 	 * LDLM_FL_LOCK_CHANGED, we must check for the NO_EXPANSION flag
 	 * in the lock flags rather than the 'flags' argument */
-	if (likely(!(lock->l_flags & LDLM_FL_NO_EXPANSION))) {
+	noexpand = ldlm_extent_check_interleave(res, 0);
+	if (likely(!(lock->l_flags & LDLM_FL_NO_EXPANSION) && !noexpand)) {
 		ldlm_extent_internal_policy_granted(lock, &new_ex);
 		ldlm_extent_internal_policy_waiting(lock, &new_ex);
 	} else {
-		LDLM_DEBUG(lock, "Not expanding manually requested lock.\n");
+		if (noexpand)
+			LDLM_DEBUG(lock, "Not expanding lock on resource with interleaved writers.\n");
+		else
+			LDLM_DEBUG(lock, "Not expanding manually requested lock.\n");
 		new_ex.start = lock->l_policy_data.l_extent.start;
 		new_ex.end = lock->l_policy_data.l_extent.end;
 		/* In case the request is not on correct boundaries, we call
@@ -329,6 +377,7 @@ struct ldlm_extent_compat_args {
 	enum ldlm_mode mode;
 	int *locks;
 	int *compat;
+	int *expand;
 };
 
 static enum interval_iter ldlm_extent_compat_cb(struct interval_node *n,
@@ -352,6 +401,10 @@ static enum interval_iter ldlm_extent_compat_cb(struct interval_node *n,
                          ldlm_lockname[mode],
                          ldlm_lockname[lock->l_granted_mode]);
                 count++;
+		/* the conflict exists only because the lock was expanded */
+		if (lock->l_req_extent.end < enq->l_req_extent.start ||
+		    lock->l_req_extent.start > enq->l_req_extent.end)
+			(*priv->expand)++;
 		if (lock->l_blocking_ast &&
 		    lock->l_granted_mode != LCK_GROUP)
                         ldlm_add_ast_work_item(lock, enq, work_list);
@@ -374,6 +427,8 @@ static enum interval_iter ldlm_extent_compat_cb(struct interval_node *n,
  *
  * If \a work_list is provided, conflicting locks are linked there.
  * If \a work_list is not provided, we exit this function on first conflict.
+ * Conflicts with locks whose requested extent doesn't overlap the requested
+ * extent of \a req are counted in \a expand_conflicts.
  *
  * \retval 0 if the lock is not compatible
  * \retval 1 if the lock is compatible
@@ -384,7 +439,7 @@ static enum interval_iter ldlm_extent_compat_cb(struct interval_node *n,
 static int
 ldlm_extent_compat_queue(struct list_head *queue, struct ldlm_lock *req,
 			 __u64 *flags, struct list_head *work_list,
-			 int *contended_locks)
+			 int *contended_locks, int *expand_conflicts)
 {
 	struct ldlm_resource *res = req->l_resource;
 	enum ldlm_mode req_mode = req->l_req_mode;
@@ -403,7 +458,8 @@ ldlm_extent_compat_queue(struct list_head *queue, struct ldlm_lock *req,
                 struct ldlm_extent_compat_args data = {.work_list = work_list,
                                                .lock = req,
                                                .locks = contended_locks,
-                                               .compat = &compat };
+                                               .compat = &compat,
+                                               .expand = expand_conflicts };
                 struct interval_node_extent ex = { .start = req_start,
                                                    .end = req_end };
                 int idx, rc;
@@ -587,6 +643,7 @@ ldlm_extent_compat_queue(struct list_head *queue, struct ldlm_lock *req,
                                    lock->l_req_extent.start > req_end) {
                                 /* false contention, the requests doesn't really overlap */
                                 check_contention = 0;
+                                (*expand_conflicts)++;
                         }
 
                         if (!work_list)
@@ -746,6 +803,7 @@ int ldlm_process_extent_lock(struct ldlm_lock *lock, __u64 *flags,
 	struct ldlm_resource *res = lock->l_resource;
 	int rc, rc2 = 0;
 	int contended_locks = 0;
+	int expand_conflicts = 0;
 	struct list_head *grant_work = intention == LDLM_PROCESS_ENQUEUE ?
 							NULL : work_list;
 	ENTRY;
@@ -764,11 +822,13 @@ int ldlm_process_extent_lock(struct ldlm_lock *lock, __u64 *flags,
 		 * ever stops being true, we want to find out. */
                 LASSERT(*flags == 0);
                 rc = ldlm_extent_compat_queue(&res->lr_granted, lock, flags,
-					      NULL, &contended_locks);
+					      NULL, &contended_locks,
+					      &expand_conflicts);
                 if (rc == 1) {
                         rc = ldlm_extent_compat_queue(&res->lr_waiting, lock,
 						      flags, NULL,
-                                                      &contended_locks);
+						      &contended_locks,
+						      &expand_conflicts);
                 }
                 if (rc == 0)
                         RETURN(LDLM_ITER_STOP);
@@ -783,14 +843,16 @@ int ldlm_process_extent_lock(struct ldlm_lock *lock, __u64 *flags,
 
         contended_locks = 0;
 	rc = ldlm_extent_compat_queue(&res->lr_granted, lock, flags,
-				      work_list, &contended_locks);
+				      work_list, &contended_locks,
+				      &expand_conflicts);
 	if (rc < 0)
 		GOTO(out, *err = rc);
 
 	if (rc != 2) {
 		rc2 = ldlm_extent_compat_queue(&res->lr_waiting, lock,
 					       flags, work_list,
-					       &contended_locks);
+					       &contended_locks,
+					       &expand_conflicts);
 		if (rc2 < 0)
 			GOTO(out, *err = rc = rc2);
 	}
@@ -800,6 +862,9 @@ int ldlm_process_extent_lock(struct ldlm_lock *lock, __u64 *flags,
 		ldlm_resource_unlink_lock(lock);
 		ldlm_grant_lock(lock, grant_work);
 	} else {
+		/* conflicts are resolved by blocking ASTs, remember the
+		 * ones caused by expansion for the locks granted later */
+		ldlm_extent_check_interleave(res, expand_conflicts);
 		/* Adding LDLM_FL_NO_TIMEOUT flag to granted lock to
 		 * force client to wait for the lock endlessly once
 		 * the lock is enqueued -bzzz */
@@ -139,6 +139,33 @@ restart:
 	RETURN(rc);
 }
 
+/**
+ * Check the modes of the granted locks holding any of the bits or try_bits
+ * of \a req, without scanning lr_granted.
+ *
+ * \retval true if all these modes are compatible with the mode of \a req
+ */
+static bool ldlm_inodebits_granted_compat(struct ldlm_resource *res,
+					  struct ldlm_lock *req)
+{
+	struct ldlm_ibits_queues *queues = res->lr_ibits_queues;
+	__u64 bits = req->l_policy_data.l_inodebits.bits |
+		     req->l_policy_data.l_inodebits.try_bits;
+	enum ldlm_mode modes = 0;
+	int i;
+
+	for (i = 0; i < MDS_INODELOCK_NUMBITS; i++)
+		if (bits & BIT(i))
+			modes |= queues->liq_granted_modes[i];
+
+	for (i = 0; i < LCK_MODE_NUM; i++)
+		if ((modes & BIT(i)) && !lockmode_compat(BIT(i),
+							 req->l_req_mode))
+			return false;
+
+	return true;
+}
+
 /**
  * Determine if the lock is compatible with all locks on the queue.
  *
@@ -182,6 +209,12 @@ ldlm_inodebits_compat_queue(struct list_head *queue, struct ldlm_lock *req,
 		     (req_bits | *try_bits) != MDS_INODELOCK_DOM))
 		RETURN(-EPROTO);
 
+	/* No granted lock holding our bits has a conflicting mode, so the
+	 * walk below would neither find a conflict nor filter try_bits. */
+	if (queue == &req->l_resource->lr_granted && req_mode != LCK_GROUP &&
+	    ldlm_inodebits_granted_compat(req->l_resource, req))
+		RETURN(1);
+
 	list_for_each(tmp, queue) {
 		struct list_head *mode_tail;
 
@@ -601,6 +634,8 @@ int ldlm_inodebits_alloc_lock(struct ldlm_lock *lock)
 		for (i = 0; i < MDS_INODELOCK_NUMBITS; i++)
 			INIT_LIST_HEAD(&lock->l_ibits_node->lin_link[i]);
 		lock->l_ibits_node->lock = lock;
+		lock->l_ibits_node->lin_granted_mode = LCK_MINMODE;
+		lock->l_ibits_node->lin_granted_bits = 0;
 	} else {
 		lock->l_ibits_node = NULL;
 	}
@@ -650,8 +685,47 @@ void ldlm_inodebits_add_lock(struct ldlm_resource *res, struct list_head *head,
 	}
 }
 
+static void ldlm_inodebits_granted_count(struct ldlm_ibits_queues *queues,
+					 __u64 bits, enum ldlm_mode mode,
+					 int delta)
+{
+	int idx = ffs(mode) - 1;
+	int i;
+
+	for (i = 0; i < MDS_INODELOCK_NUMBITS; i++) {
+		if (!(bits & BIT(i)))
+			continue;
+
+		queues->liq_granted[i][idx] += delta;
+		if (queues->liq_granted[i][idx] == 0)
+			queues->liq_granted_modes[i] &= ~mode;
+		else
+			queues->liq_granted_modes[i] |= mode;
+	}
+}
+
+/**
+ * Account a lock just added to lr_granted of \a res.
+ */
+void ldlm_inodebits_add_granted(struct ldlm_resource *res,
+				struct ldlm_lock *lock)
+{
+	struct ldlm_ibits_node *node = lock->l_ibits_node;
+
+	if (!ldlm_is_ns_srv(lock) || node == NULL)
+		return;
+
+	LASSERT(node->lin_granted_mode == LCK_MINMODE);
+	node->lin_granted_mode = lock->l_req_mode;
+	node->lin_granted_bits = lock->l_policy_data.l_inodebits.bits;
+	ldlm_inodebits_granted_count(res->lr_ibits_queues,
+				     node->lin_granted_bits,
+				     node->lin_granted_mode, 1);
+}
+
 void ldlm_inodebits_unlink_lock(struct ldlm_lock *lock)
 {
+	struct ldlm_ibits_node *node = lock->l_ibits_node;
 	int i;
 
 	ldlm_unlink_lock_skiplist(lock);
@@ -659,5 +733,14 @@ void ldlm_inodebits_unlink_lock(struct ldlm_lock *lock)
 		return;
 
 	for (i = 0; i < MDS_INODELOCK_NUMBITS; i++)
-		list_del_init(&lock->l_ibits_node->lin_link[i]);
+		list_del_init(&node->lin_link[i]);
+
+	if (node->lin_granted_mode != LCK_MINMODE) {
+		LASSERT(!list_empty(&lock->l_res_link));
+		ldlm_inodebits_granted_count(lock->l_resource->lr_ibits_queues,
+					     node->lin_granted_bits,
+					     node->lin_granted_mode, -1);
+		node->lin_granted_mode = LCK_MINMODE;
+		node->lin_granted_bits = 0;
+	}
 }
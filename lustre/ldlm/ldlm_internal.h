@@ -100,6 +100,7 @@ int ldlm_cancel_lru_local(struct ldlm_namespace *ns,
 			  struct list_head *cancels, int min, int max,
 			  enum ldlm_cancel_flags cancel_flags,
 			  enum ldlm_lru_flags lru_flags);
+int ldlm_request_bufsize(int count, int type);
 extern unsigned int ldlm_enqueue_min;
 /* ldlm_resource.c */
 extern struct kmem_cache *ldlm_resource_slab;
@@ -180,6 +181,26 @@ void ldlm_handle_bl_callback(struct ldlm_namespace *ns,
                              struct ldlm_lock_desc *ld, struct ldlm_lock *lock);
 void ldlm_bl_desc2lock(const struct ldlm_lock_desc *ld, struct ldlm_lock *lock);
 
+#ifdef HAVE_SERVER_SUPPORT
+/** Maximum number of locks in a batched blocking AST RPC */
+#define LDLM_BL_BATCH_MAX	128
+
+/**
+ * Blocking ASTs for locks of the same export, sharing the blocking lock
+ * description and AST flags, to be sent in one LDLM_BL_CALLBACK RPC.
+ */
+struct ldlm_bl_batch {
+	struct list_head	 lbb_list;
+	struct obd_export	*lbb_export;
+	struct ldlm_lock_desc	 lbb_desc;
+	__u64			 lbb_flags;
+	int			 lbb_count;
+	struct ldlm_lock	*lbb_locks[LDLM_BL_BATCH_MAX];
+};
+
+int ldlm_bl_batch_flush(struct ldlm_cb_set_arg *arg);
+#endif
+
 #ifdef HAVE_SERVER_SUPPORT
 /* ldlm_plain.c */
 int ldlm_process_plain_lock(struct ldlm_lock *lock, __u64 *flags,
@@ -209,6 +230,8 @@ int ldlm_inodebits_alloc_lock(struct ldlm_lock *lock);
 void ldlm_inodebits_add_lock(struct ldlm_resource *res, struct list_head *head,
 			     struct ldlm_lock *lock, bool tail);
 void ldlm_inodebits_unlink_lock(struct ldlm_lock *lock);
+void ldlm_inodebits_add_granted(struct ldlm_resource *res,
+				struct ldlm_lock *lock);
 
 /* ldlm_flock.c */
 int ldlm_process_flock_lock(struct ldlm_lock *req, __u64 *flags,
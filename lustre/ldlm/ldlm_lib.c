@@ -326,7 +326,9 @@ int client_obd_setup(struct obd_device *obd, struct lustre_cfg *lcfg)
 	char *cli_name = lustre_cfg_buf(lcfg, 0);
 	struct ptlrpc_connection fake_conn = { .c_self = 0,
 					       .c_remote_uuid.uuid[0] = 0 };
+	struct cl_lru_part *part;
 	int rc;
+	int i;
 
 	ENTRY;
 
@@ -444,9 +446,16 @@ int client_obd_setup(struct obd_device *obd, struct lustre_cfg *lcfg)
 	INIT_LIST_HEAD(&cli->cl_lru_osc);
 	atomic_set(&cli->cl_lru_shrinkers, 0);
 	atomic_long_set(&cli->cl_lru_busy, 0);
-	atomic_long_set(&cli->cl_lru_in_list, 0);
-	INIT_LIST_HEAD(&cli->cl_lru_list);
-	spin_lock_init(&cli->cl_lru_list_lock);
+	atomic_long_set(&cli->cl_lru_reclaim, 0);
+	cli->cl_lru_parts = cfs_percpt_alloc(cfs_cpt_tab,
+					     sizeof(struct cl_lru_part));
+	if (cli->cl_lru_parts == NULL)
+		RETURN(-ENOMEM);
+	cfs_percpt_for_each(part, i, cli->cl_lru_parts) {
+		spin_lock_init(&part->clp_lock);
+		INIT_LIST_HEAD(&part->clp_list);
+		atomic_long_set(&part->clp_in_list, 0);
+	}
 	atomic_long_set(&cli->cl_unstable_count, 0);
 	INIT_LIST_HEAD(&cli->cl_shrink_list);
 	INIT_LIST_HEAD(&cli->cl_grant_chain);
@@ -503,6 +512,7 @@ int client_obd_setup(struct obd_device *obd, struct lustre_cfg *lcfg)
 
 	spin_lock_init(&cli->cl_mod_rpcs_lock);
 	spin_lock_init(&cli->cl_mod_rpcs_hist.oh_lock);
+	spin_lock_init(&cli->cl_batch_rpc_hist.oh_lock);
 	cli->cl_max_mod_rpcs_in_flight = 0;
 	cli->cl_mod_rpcs_in_flight = 0;
 	cli->cl_close_rpcs_in_flight = 0;
@@ -596,6 +606,8 @@ err:
 		OBD_FREE(cli->cl_mod_tag_bitmap,
 			 BITS_TO_LONGS(OBD_MAX_RIF_MAX) * sizeof(long));
 	cli->cl_mod_tag_bitmap = NULL;
+	cfs_percpt_free(cli->cl_lru_parts);
+	cli->cl_lru_parts = NULL;
 
 	RETURN(rc);
 }
@@ -620,6 +632,11 @@ int client_obd_cleanup(struct obd_device *obd)
 			 BITS_TO_LONGS(OBD_MAX_RIF_MAX) * sizeof(long));
 	cli->cl_mod_tag_bitmap = NULL;
 
+	if (cli->cl_lru_parts != NULL) {
+		cfs_percpt_free(cli->cl_lru_parts);
+		cli->cl_lru_parts = NULL;
+	}
+
 	RETURN(0);
 }
 EXPORT_SYMBOL(client_obd_cleanup);
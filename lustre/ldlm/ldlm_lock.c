@@ -308,6 +308,7 @@ void ldlm_lock_add_to_lru_nolock(struct ldlm_lock *lock)
 	struct ldlm_namespace *ns = ldlm_lock_to_ns(lock);
 
 	lock->l_last_used = ktime_get();
+	lock->l_lru_credit = LDLM_LRU_CREDIT_UNSET;
 	LASSERT(list_empty(&lock->l_lru));
 	LASSERT(lock->l_resource->lr_type != LDLM_FLOCK);
 	list_add_tail(&lock->l_lru, &ns->ns_unused_list);
@@ -349,11 +350,33 @@ void ldlm_lock_touch_in_lru(struct ldlm_lock *lock)
 	if (!list_empty(&lock->l_lru)) {
 		ldlm_lock_remove_from_lru_nolock(lock);
 		ldlm_lock_add_to_lru_nolock(lock);
+		if (lock->l_lru_freq < LDLM_LRU_FREQ_MAX)
+			lock->l_lru_freq++;
 	}
 	spin_unlock(&ns->ns_lock);
 	EXIT;
 }
 
+/**
+ * Removes LDLM lock \a lock from LRU because it is being reused, and accounts
+ * the reuse in the lock frequency used by cost-aware LRU.
+ */
+static void ldlm_lock_reuse_from_lru(struct ldlm_lock *lock)
+{
+	struct ldlm_namespace *ns = ldlm_lock_to_ns(lock);
+
+	if (ldlm_is_ns_srv(lock)) {
+		LASSERT(list_empty(&lock->l_lru));
+		return;
+	}
+
+	spin_lock(&ns->ns_lock);
+	if (ldlm_lock_remove_from_lru_nolock(lock) &&
+	    lock->l_lru_freq < LDLM_LRU_FREQ_MAX)
+		lock->l_lru_freq++;
+	spin_unlock(&ns->ns_lock);
+}
+
 /**
  * Helper to destroy a locked lock.
  *
@@ -752,7 +775,7 @@ EXPORT_SYMBOL(ldlm_lock_addref);
 void ldlm_lock_addref_internal_nolock(struct ldlm_lock *lock,
 				      enum ldlm_mode mode)
 {
-        ldlm_lock_remove_from_lru(lock);
+	ldlm_lock_reuse_from_lru(lock);
         if (mode & (LCK_NL | LCK_CR | LCK_PR)) {
                 lock->l_readers++;
                 lu_ref_add_atomic(&lock->l_reference, "reader", lock);
@@ -1083,6 +1106,9 @@ static void ldlm_granted_list_add_lock(struct ldlm_lock *lock,
 	if (&lock->l_sl_policy != prev->policy_link)
 		list_add(&lock->l_sl_policy, prev->policy_link);
 
+	if (res->lr_type == LDLM_IBITS)
+		ldlm_inodebits_add_granted(res, lock);
+
         EXIT;
 }
 
@@ -2104,8 +2130,12 @@ ldlm_work_bl_ast_lock(struct ptlrpc_request_set *rqset, void *opaq)
 
 	ENTRY;
 
-	if (list_empty(arg->list))
+	if (list_empty(arg->list)) {
+		/* send blocking ASTs batched for the same client */
+		if (!list_empty(&arg->bl_batches))
+			RETURN(ldlm_bl_batch_flush(arg));
 		RETURN(-ENOENT);
+	}
 
 	lock = list_entry(arg->list->next, struct ldlm_lock, l_bl_ast);
 
@@ -2126,6 +2156,8 @@ ldlm_work_bl_ast_lock(struct ptlrpc_request_set *rqset, void *opaq)
 	}
 
 	LASSERT(lock->l_blocking_lock);
+	/* cleared for batched ASTs to be matched by the descriptor */
+	memset(&d, 0, sizeof(d));
 	ldlm_lock2desc(lock->l_blocking_lock, &d);
 	/* copy blocking lock ibits in cancel_bits as well,
 	 * new client may use them for lock convert and it is
@@ -2296,6 +2328,7 @@ int ldlm_run_ast_work(struct ldlm_namespace *ns, struct list_head *rpc_list,
 
 	atomic_set(&arg->restart, 0);
 	arg->list = rpc_list;
+	INIT_LIST_HEAD(&arg->bl_batches);
 
 	switch (ast_type) {
 	case LDLM_WORK_CP_AST:
@@ -2305,6 +2338,7 @@ int ldlm_run_ast_work(struct ldlm_namespace *ns, struct list_head *rpc_list,
 #ifdef HAVE_SERVER_SUPPORT
 	case LDLM_WORK_BL_AST:
 		arg->type = LDLM_BL_CALLBACK;
+		arg->bl_batch = true;
 		work_ast_lock = ldlm_work_bl_ast_lock;
 		break;
 	case LDLM_WORK_REVOKE_AST:
@@ -2402,11 +2436,8 @@ void ldlm_reprocess_all(struct ldlm_resource *res, struct ldlm_lock *hint)
 }
 EXPORT_SYMBOL(ldlm_reprocess_all);
 
-static int ldlm_reprocess_res(struct cfs_hash *hs, struct cfs_hash_bd *bd,
-			      struct hlist_node *hnode, void *arg)
+static int ldlm_reprocess_res(struct ldlm_resource *res, void *arg)
 {
-	struct ldlm_resource *res = cfs_hash_object(hs, hnode);
-
 	/* This is only called once after recovery done. LU-8306. */
 	__ldlm_reprocess_all(res, LDLM_PROCESS_RECOVERY, NULL);
 	return 0;
@@ -2420,10 +2451,8 @@ void ldlm_reprocess_recovery_done(struct ldlm_namespace *ns)
 {
 	ENTRY;
 
-	if (ns != NULL) {
-		cfs_hash_for_each_nolock(ns->ns_rs_hash,
-					 ldlm_reprocess_res, NULL, 0);
-	}
+	if (ns != NULL)
+		ldlm_namespace_foreach_res(ns, ldlm_reprocess_res, NULL);
 	EXIT;
 }
 
@@ -746,6 +746,47 @@ static int ldlm_handle_ast_error(struct ldlm_lock *lock,
 	return rc;
 }
 
+/**
+ * Handle the reply to a batched blocking AST, every lock has its own status
+ * in the reply unless the whole RPC failed.
+ */
+static int ldlm_cb_batch_interpret(struct ptlrpc_request *req,
+				   struct ldlm_cb_async_args *ca, int rc)
+{
+	struct ldlm_bl_batch *batch = ca->ca_batch;
+	__u32 *rcs = NULL;
+	int i;
+
+	ENTRY;
+
+	if (rc == 0) {
+		rcs = req_capsule_server_sized_get(&req->rq_pill, &RMF_RCS,
+						   batch->lbb_count *
+						   sizeof(*rcs));
+		if (rcs == NULL)
+			rc = -EPROTO;
+	}
+
+	for (i = 0; i < batch->lbb_count; i++) {
+		struct ldlm_lock *lock = batch->lbb_locks[i];
+		int lock_rc = rcs != NULL ? (__s32)rcs[i] : rc;
+
+		if (lock_rc != 0)
+			lock_rc = ldlm_handle_ast_error(lock, req, lock_rc,
+							"blocking");
+		if (lock_rc == -ERESTART)
+			atomic_inc(&ca->ca_set_arg->restart);
+
+		/* release extra reference taken in ldlm_bl_batch_add() */
+		LDLM_LOCK_RELEASE(lock);
+	}
+
+	class_export_put(batch->lbb_export);
+	OBD_FREE_PTR(batch);
+
+	RETURN(0);
+}
+
 static int ldlm_cb_interpret(const struct lu_env *env,
 			     struct ptlrpc_request *req, void *args, int rc)
 {
@@ -755,6 +796,9 @@ static int ldlm_cb_interpret(const struct lu_env *env,
 
 	ENTRY;
 
+	if (ca->ca_batch != NULL)
+		RETURN(ldlm_cb_batch_interpret(req, ca, rc));
+
 	LASSERT(lock != NULL);
 
 	switch (arg->type) {
@@ -808,8 +852,17 @@ static void ldlm_update_resend(struct ptlrpc_request *req, void *data)
 {
 	struct ldlm_cb_async_args *ca = data;
 	struct ldlm_lock *lock = ca->ca_lock;
+	int i;
 
-	ldlm_refresh_waiting_lock(lock, ldlm_bl_timeout(lock));
+	if (ca->ca_batch == NULL) {
+		ldlm_refresh_waiting_lock(lock, ldlm_bl_timeout(lock));
+		return;
+	}
+
+	for (i = 0; i < ca->ca_batch->lbb_count; i++) {
+		lock = ca->ca_batch->lbb_locks[i];
+		ldlm_refresh_waiting_lock(lock, ldlm_bl_timeout(lock));
+	}
 }
 
 static inline int ldlm_ast_fini(struct ptlrpc_request *req,
@@ -869,18 +922,13 @@ static void ldlm_lock_reorder_req(struct ldlm_lock *lock)
 }
 
 /**
- * ->l_blocking_ast() method for server-side locks. This is invoked when newly
- * enqueued server lock conflicts with given one.
- *
- * Sends blocking AST RPC to the client owning that lock; arms timeout timer
- * to wait for client response.
+ * Send the blocking AST of \a lock alone in a LDLM_BL_CALLBACK RPC.
  */
-int ldlm_server_blocking_ast(struct ldlm_lock *lock,
-			     struct ldlm_lock_desc *desc,
-			     void *data, int flag)
+static int ldlm_bl_ast_send(struct ldlm_cb_set_arg *arg,
+			    struct ldlm_lock *lock,
+			    struct ldlm_lock_desc *desc)
 {
 	struct ldlm_cb_async_args *ca;
-	struct ldlm_cb_set_arg *arg = data;
 	struct ldlm_request *body;
 	struct ptlrpc_request  *req;
 	int instant_cancel = 0;
@@ -888,22 +936,6 @@ int ldlm_server_blocking_ast(struct ldlm_lock *lock,
 
 	ENTRY;
 
-	if (flag == LDLM_CB_CANCELING)
-		/* Don't need to do anything here. */
-		RETURN(0);
-
-	if (OBD_FAIL_PRECHECK(OBD_FAIL_LDLM_SRV_BL_AST)) {
-		LDLM_DEBUG(lock, "dropping BL AST");
-		RETURN(0);
-	}
-
-	LASSERT(lock);
-	LASSERT(data != NULL);
-	if (lock->l_export->exp_obd->obd_recovering != 0)
-		LDLM_ERROR(lock, "BUG 6063: lock collide during recovery");
-
-	ldlm_lock_reorder_req(lock);
-
 	req = ptlrpc_request_alloc_pack(lock->l_export->exp_imp_reverse,
 					&RQF_LDLM_BL_CALLBACK,
 					LUSTRE_DLM_VERSION, LDLM_BL_CALLBACK);
@@ -913,6 +945,7 @@ int ldlm_server_blocking_ast(struct ldlm_lock *lock,
 	ca = ptlrpc_req_async_args(ca, req);
 	ca->ca_set_arg = arg;
 	ca->ca_lock = lock;
+	ca->ca_batch = NULL;
 
 	req->rq_interpret_reply = ldlm_cb_interpret;
 
@@ -981,6 +1014,237 @@ int ldlm_server_blocking_ast(struct ldlm_lock *lock,
 	RETURN(rc);
 }
 
+/**
+ * Send the blocking ASTs of \a batch in one LDLM_BL_CALLBACK RPC.
+ *
+ * The request is marked with LDLM_FL_BL_BATCH, the client and server handles
+ * of each lock are packed in pairs into the lock_handle array. The client
+ * replies with a status for each lock in RMF_RCS.
+ *
+ * A batch of a single lock is sent as a regular blocking AST, and so are the
+ * ASTs of a batch that cannot be sent for lack of memory, the locks are
+ * already in the waiting list and their client would be evicted otherwise.
+ */
+static int ldlm_bl_batch_send(struct ldlm_cb_set_arg *arg,
+			      struct ldlm_bl_batch *batch)
+{
+	struct obd_export *exp = batch->lbb_export;
+	struct ldlm_cb_async_args *ca;
+	struct ldlm_request *body;
+	struct ptlrpc_request *req;
+	int i;
+	int rc;
+
+	ENTRY;
+
+	list_del_init(&batch->lbb_list);
+	if (batch->lbb_count == 0)
+		GOTO(out, rc = 0);
+
+	if (batch->lbb_count == 1)
+		GOTO(out_single, rc = 0);
+
+	req = ptlrpc_request_alloc(exp->exp_imp_reverse,
+				   &RQF_LDLM_BL_CALLBACK_BATCH);
+	if (req == NULL)
+		GOTO(out_single, rc = -ENOMEM);
+
+	req_capsule_set_size(&req->rq_pill, &RMF_DLM_REQ, RCL_CLIENT,
+			     ldlm_request_bufsize(batch->lbb_count * 2,
+						  LDLM_BL_CALLBACK));
+	rc = ptlrpc_request_pack(req, LUSTRE_DLM_VERSION, LDLM_BL_CALLBACK);
+	if (rc) {
+		ptlrpc_request_free(req);
+		GOTO(out_single, rc);
+	}
+
+	body = req_capsule_client_get(&req->rq_pill, &RMF_DLM_REQ);
+	body->lock_desc = batch->lbb_desc;
+	body->lock_flags = batch->lbb_flags |
+			   ldlm_flags_to_wire(LDLM_FL_BL_BATCH);
+	body->lock_count = batch->lbb_count * 2;
+	for (i = 0; i < batch->lbb_count; i++) {
+		struct ldlm_lock *lock = batch->lbb_locks[i];
+
+		body->lock_handle[2 * i] = lock->l_remote_handle;
+		body->lock_handle[2 * i + 1].cookie = lock->l_handle.h_cookie;
+	}
+
+	req_capsule_set_size(&req->rq_pill, &RMF_RCS, RCL_SERVER,
+			     batch->lbb_count * sizeof(__u32));
+	ptlrpc_request_set_replen(req);
+
+	ca = ptlrpc_req_async_args(ca, req);
+	ca->ca_set_arg = arg;
+	ca->ca_lock = NULL;
+	ca->ca_batch = batch;
+
+	req->rq_interpret_reply = ldlm_cb_interpret;
+	/* Do not resend after lock callback timeout */
+	req->rq_delay_limit = ldlm_bl_timeout(batch->lbb_locks[0]);
+	req->rq_resend_cb = ldlm_update_resend;
+	req->rq_send_state = LUSTRE_IMP_FULL;
+	/* ptlrpc_request_pack already set timeout */
+	if (AT_OFF)
+		req->rq_timeout = ldlm_get_rq_timeout();
+
+	CDEBUG(D_DLMTRACE, "%s: sending %d blocking ASTs to %s in one RPC\n",
+	       exp->exp_obd->obd_name, batch->lbb_count,
+	       obd_export_nid2str(exp));
+
+	if (exp->exp_nid_stats && exp->exp_nid_stats->nid_ldlm_stats)
+		lprocfs_counter_incr(exp->exp_nid_stats->nid_ldlm_stats,
+				     LDLM_BL_CALLBACK - LDLM_FIRST_OPC);
+
+	ptlrpc_set_add_req(arg->set, req);
+
+	RETURN(0);
+out_single:
+	if (rc != 0)
+		CDEBUG(D_DLMTRACE,
+		       "%s: cannot batch %d blocking ASTs to %s: rc = %d\n",
+		       exp->exp_obd->obd_name, batch->lbb_count,
+		       obd_export_nid2str(exp), rc);
+
+	rc = 0;
+	for (i = 0; i < batch->lbb_count; i++) {
+		int rc2;
+
+		rc2 = ldlm_bl_ast_send(arg, batch->lbb_locks[i],
+				       &batch->lbb_desc);
+		if (rc == 0)
+			rc = rc2;
+	}
+out:
+	for (i = 0; i < batch->lbb_count; i++)
+		LDLM_LOCK_RELEASE(batch->lbb_locks[i]);
+	class_export_put(exp);
+	OBD_FREE_PTR(batch);
+
+	RETURN(rc);
+}
+
+/**
+ * Send the next pending batch of blocking ASTs, called by the AST producer
+ * once all locks are processed.
+ */
+int ldlm_bl_batch_flush(struct ldlm_cb_set_arg *arg)
+{
+	struct ldlm_bl_batch *batch;
+
+	batch = list_first_entry(&arg->bl_batches, struct ldlm_bl_batch,
+				 lbb_list);
+
+	return ldlm_bl_batch_send(arg, batch);
+}
+
+/**
+ * Add a blocking AST for \a lock to the batch of its export.
+ *
+ * Locks are batched together if they are blocked by the same lock, i.e. have
+ * the same blocking lock description and AST flags.
+ *
+ * \retval -EAGAIN the AST cannot be batched and has to be sent alone
+ */
+static int ldlm_bl_batch_add(struct ldlm_cb_set_arg *arg,
+			     struct ldlm_lock *lock,
+			     struct ldlm_lock_desc *desc)
+{
+	struct ldlm_bl_batch *batch;
+	__u64 flags = ldlm_flags_to_wire(lock->l_flags & LDLM_FL_AST_MASK);
+	bool found = false;
+
+	ENTRY;
+
+	list_for_each_entry(batch, &arg->bl_batches, lbb_list) {
+		if (batch->lbb_export == lock->l_export &&
+		    batch->lbb_flags == flags &&
+		    memcmp(&batch->lbb_desc, desc, sizeof(*desc)) == 0) {
+			found = true;
+			break;
+		}
+	}
+
+	if (!found) {
+		OBD_ALLOC_PTR(batch);
+		if (batch == NULL)
+			RETURN(-EAGAIN);
+
+		batch->lbb_export = class_export_get(lock->l_export);
+		batch->lbb_desc = *desc;
+		batch->lbb_flags = flags;
+		list_add_tail(&batch->lbb_list, &arg->bl_batches);
+	}
+
+	lock_res_and_lock(lock);
+	/*
+	 * Leave destroyed, not granted and cancel-on-block locks to the
+	 * regular path.
+	 */
+	if (ldlm_is_destroyed(lock) || !ldlm_is_granted(lock) ||
+	    ldlm_is_cancel_on_block(lock) ||
+	    ldlm_flags_to_wire(lock->l_flags & LDLM_FL_AST_MASK) != flags) {
+		unlock_res_and_lock(lock);
+		RETURN(-EAGAIN);
+	}
+
+	LDLM_DEBUG(lock, "server preparing batched blocking AST");
+
+	ldlm_set_cbpending(lock);
+	ldlm_add_waiting_lock(lock, ldlm_bl_timeout(lock));
+	LDLM_LOCK_GET(lock);
+	batch->lbb_locks[batch->lbb_count++] = lock;
+	unlock_res_and_lock(lock);
+
+	if (batch->lbb_count == LDLM_BL_BATCH_MAX)
+		RETURN(ldlm_bl_batch_send(arg, batch));
+
+	RETURN(0);
+}
+
+/**
+ * ->l_blocking_ast() method for server-side locks. This is invoked when newly
+ * enqueued server lock conflicts with given one.
+ *
+ * Sends blocking AST RPC to the client owning that lock; arms timeout timer
+ * to wait for client response.
+ */
+int ldlm_server_blocking_ast(struct ldlm_lock *lock,
+			     struct ldlm_lock_desc *desc,
+			     void *data, int flag)
+{
+	struct ldlm_cb_set_arg *arg = data;
+	int rc;
+
+	ENTRY;
+
+	if (flag == LDLM_CB_CANCELING)
+		/* Don't need to do anything here. */
+		RETURN(0);
+
+	if (OBD_FAIL_PRECHECK(OBD_FAIL_LDLM_SRV_BL_AST)) {
+		LDLM_DEBUG(lock, "dropping BL AST");
+		RETURN(0);
+	}
+
+	LASSERT(lock);
+	LASSERT(data != NULL);
+	if (lock->l_export->exp_obd->obd_recovering != 0)
+		LDLM_ERROR(lock, "BUG 6063: lock collide during recovery");
+
+	ldlm_lock_reorder_req(lock);
+
+	if (arg->bl_batch && exp_connect_batch_bl_ast(lock->l_export)) {
+		rc = ldlm_bl_batch_add(arg, lock, desc);
+		if (rc != -EAGAIN)
+			RETURN(rc);
+	}
+
+	rc = ldlm_bl_ast_send(arg, lock, desc);
+
+	RETURN(rc);
+}
+
 /**
  * ->l_completion_ast callback for a remote lock in server namespace.
  *
@@ -1034,6 +1298,7 @@ int ldlm_server_completion_ast(struct ldlm_lock *lock, __u64 flags, void *data)
 	ca = ptlrpc_req_async_args(ca, req);
 	ca->ca_set_arg = arg;
 	ca->ca_lock = lock;
+	ca->ca_batch = NULL;
 
 	req->rq_interpret_reply = ldlm_cb_interpret;
 	body = req_capsule_client_get(&req->rq_pill, &RMF_DLM_REQ);
@@ -1163,6 +1428,7 @@ int ldlm_server_glimpse_ast(struct ldlm_lock *lock, void *data)
 	ca = ptlrpc_req_async_args(ca, req);
 	ca->ca_set_arg = arg;
 	ca->ca_lock = lock;
+	ca->ca_batch = NULL;
 
 	/* server namespace, doesn't need lock */
 	req_capsule_set_size(&req->rq_pill, &RMF_DLM_LVB, RCL_SERVER,
@@ -1226,11 +1492,12 @@ EXPORT_SYMBOL(ldlm_request_lock);
  * Main server-side entry point into LDLM for enqueue. This is called by ptlrpc
  * service threads to carry out client lock enqueueing requests.
  */
-int ldlm_handle_enqueue0(struct ldlm_namespace *ns,
-			 struct ptlrpc_request *req,
-			 const struct ldlm_request *dlm_req,
-			 const struct ldlm_callback_suite *cbs)
+int ldlm_handle_enqueue(struct ldlm_namespace *ns,
+			struct req_capsule *pill,
+			const struct ldlm_request *dlm_req,
+			const struct ldlm_callback_suite *cbs)
 {
+	struct ptlrpc_request *req = pill->rc_req;
 	struct ldlm_reply *dlm_rep;
 	__u64 flags;
 	enum ldlm_error err = ELDLM_OK;
@@ -1372,16 +1639,19 @@ int ldlm_handle_enqueue0(struct ldlm_namespace *ns,
 existing_lock:
 	cookie = req;
 	if (!(flags & LDLM_FL_HAS_INTENT)) {
+		/* only intent enqueue can be batched */
+		if (unlikely(req_capsule_subreq(pill)))
+			GOTO(out, rc = -EPROTO);
 		/* based on the assumption that lvb size never changes during
 		 * resource life time otherwise it need resource->lr_lock's
 		 * protection */
-		req_capsule_set_size(&req->rq_pill, &RMF_DLM_LVB,
+		req_capsule_set_size(pill, &RMF_DLM_LVB,
 				     RCL_SERVER, ldlm_lvbo_size(lock));
 
 		if (OBD_FAIL_CHECK(OBD_FAIL_LDLM_ENQUEUE_EXTENT_ERR))
 			GOTO(out, rc = -ENOMEM);
 
-		rc = req_capsule_server_pack(&req->rq_pill);
+		rc = req_capsule_server_pack(pill);
 		if (rc)
 			GOTO(out, rc);
 	}
@@ -1393,7 +1663,7 @@ existing_lock:
 		GOTO(out, err);
 	}
 
-	dlm_rep = req_capsule_server_get(&req->rq_pill, &RMF_DLM_REP);
+	dlm_rep = req_capsule_server_get(pill, &RMF_DLM_REP);
 
 	ldlm_lock2desc(lock, &dlm_rep->lock_desc);
 	ldlm_lock2handle(lock, &dlm_rep->lock_handle);
@@ -1464,11 +1734,26 @@ existing_lock:
 
 	EXIT;
 out:
-	req->rq_status = rc ?: err; /* return either error - b=11190 */
-	if (!req->rq_packed_final) {
-		int rc1 = lustre_pack_reply(req, 1, NULL, NULL);
-		if (rc == 0)
-			rc = rc1;
+	if (req_capsule_subreq(pill)) {
+		/*
+		 * Sub-request status is returned in its own reply message,
+		 * the batch handler makes sure there is room for the header.
+		 */
+		if (!req_capsule_server_packed(pill)) {
+			int rc1 = req_capsule_server_pack(pill);
+
+			if (rc == 0)
+				rc = rc1;
+		}
+		pill->rc_repmsg->lm_result = ptlrpc_status_hton(rc ?: err);
+	} else {
+		req->rq_status = rc ?: err; /* return either error - b=11190 */
+		if (!req->rq_packed_final) {
+			int rc1 = lustre_pack_reply(req, 1, NULL, NULL);
+
+			if (rc == 0)
+				rc = rc1;
+		}
 	}
 
 	/*
@@ -1481,17 +1766,17 @@ out:
 			   err, rc);
 
 		if (rc == 0 &&
-		    req_capsule_has_field(&req->rq_pill, &RMF_DLM_LVB,
+		    req_capsule_has_field(pill, &RMF_DLM_LVB,
 					  RCL_SERVER) &&
 		    ldlm_lvbo_size(lock) > 0) {
 			void *buf;
 			int buflen;
 
 retry:
-			buf = req_capsule_server_get(&req->rq_pill,
+			buf = req_capsule_server_get(pill,
 						     &RMF_DLM_LVB);
 			LASSERTF(buf != NULL, "req %p, lock %p\n", req, lock);
-			buflen = req_capsule_get_size(&req->rq_pill,
+			buflen = req_capsule_get_size(pill,
 					&RMF_DLM_LVB, RCL_SERVER);
 			/*
 			 * non-replayed lock, delayed lvb init may
@@ -1502,12 +1787,12 @@ retry:
 
 				rc2 = ldlm_lvbo_fill(lock, buf, &buflen);
 				if (rc2 >= 0) {
-					req_capsule_shrink(&req->rq_pill,
+					req_capsule_shrink(pill,
 							   &RMF_DLM_LVB,
 							   rc2, RCL_SERVER);
 				} else if (rc2 == -ERANGE) {
 					rc2 = req_capsule_server_grow(
-							&req->rq_pill,
+							pill,
 							&RMF_DLM_LVB, buflen);
 					if (!rc2) {
 						goto retry;
@@ -1518,7 +1803,7 @@ retry:
 						 * to client.
 						 */
 						req_capsule_shrink(
-							&req->rq_pill,
+							pill,
 							&RMF_DLM_LVB, 0,
 							RCL_SERVER);
 					}
@@ -1528,7 +1813,7 @@ retry:
 			} else if (flags & LDLM_FL_REPLAY) {
 				/* no LVB resend upon replay */
 				if (buflen > 0)
-					req_capsule_shrink(&req->rq_pill,
+					req_capsule_shrink(pill,
 							   &RMF_DLM_LVB,
 							   0, RCL_SERVER);
 				else
@@ -2288,6 +2573,105 @@ static inline void ldlm_callback_errmsg(struct ptlrpc_request *req,
 		CWARN("Send reply failed, maybe cause b=21636.\n");
 }
 
+/**
+ * Callback handler for batched blocking ASTs.
+ *
+ * The request is marked with LDLM_FL_BL_BATCH and carries the client and
+ * server handles of each lock in pairs. Every lock gets its own status in the
+ * reply, -EINVAL if it is not known anymore. The blocking callbacks are
+ * handled after the reply is sent.
+ */
+static void ldlm_handle_bl_callback_batch(struct ptlrpc_request *req,
+					  struct ldlm_namespace *ns,
+					  struct ldlm_request *dlm_req)
+{
+	struct ldlm_lock **locks;
+	__u32 *rcs;
+	int count = dlm_req->lock_count / 2;
+	int rc;
+	int i;
+
+	ENTRY;
+
+	if (count == 0 || dlm_req->lock_count % 2 != 0 ||
+	    req_capsule_get_size(&req->rq_pill, &RMF_DLM_REQ, RCL_CLIENT) <
+	    ldlm_request_bufsize(dlm_req->lock_count, LDLM_BL_CALLBACK)) {
+		rc = ldlm_callback_reply(req, -EPROTO);
+		ldlm_callback_errmsg(req, "Operate with invalid parameter", rc,
+				     NULL);
+		RETURN_EXIT;
+	}
+
+	OBD_ALLOC_PTR_ARRAY(locks, count);
+	if (locks == NULL) {
+		rc = ldlm_callback_reply(req, -ENOMEM);
+		ldlm_callback_errmsg(req, "Operate without memory", rc, NULL);
+		RETURN_EXIT;
+	}
+
+	req_capsule_extend(&req->rq_pill, &RQF_LDLM_BL_CALLBACK_BATCH);
+	req_capsule_set_size(&req->rq_pill, &RMF_RCS, RCL_SERVER,
+			     count * sizeof(*rcs));
+	rc = req_capsule_server_pack(&req->rq_pill);
+	if (rc) {
+		rc = ldlm_callback_reply(req, rc);
+		ldlm_callback_errmsg(req, "Operate without reply", rc, NULL);
+		GOTO(out, rc);
+	}
+	rcs = req_capsule_server_get(&req->rq_pill, &RMF_RCS);
+
+	for (i = 0; i < count; i++) {
+		struct lustre_handle *lockh = &dlm_req->lock_handle[2 * i];
+		struct ldlm_lock *lock;
+
+		rcs[i] = 0;
+		lock = ldlm_handle2lock_long(lockh, 0);
+		if (!lock) {
+			CDEBUG(D_DLMTRACE,
+			       "callback on lock %#llx - lock disappeared\n",
+			       lockh->cookie);
+			rcs[i] = -EINVAL;
+			continue;
+		}
+
+		/* see ldlm_callback_handler() for the single lock case */
+		lock_res_and_lock(lock);
+		lock->l_flags |= ldlm_flags_from_wire(dlm_req->lock_flags &
+						      LDLM_FL_AST_MASK);
+		if ((ldlm_is_canceling(lock) && ldlm_is_bl_done(lock)) ||
+		     ldlm_is_failed(lock)) {
+			LDLM_DEBUG(lock,
+				   "callback on lock %llx - lock disappeared",
+				   lockh->cookie);
+			unlock_res_and_lock(lock);
+			LDLM_LOCK_RELEASE(lock);
+			rcs[i] = -EINVAL;
+			continue;
+		}
+		ldlm_lock_remove_from_lru(lock);
+		ldlm_set_bl_ast(lock);
+		if (lock->l_remote_handle.cookie == 0)
+			lock->l_remote_handle = dlm_req->lock_handle[2 * i + 1];
+		unlock_res_and_lock(lock);
+		locks[i] = lock;
+	}
+
+	rc = ldlm_callback_reply(req, 0);
+	if (req->rq_no_reply || rc)
+		ldlm_callback_errmsg(req, "Normal process", rc, NULL);
+
+	for (i = 0; i < count; i++) {
+		if (locks[i] == NULL)
+			continue;
+		if (ldlm_bl_to_thread_lock(ns, &dlm_req->lock_desc, locks[i]))
+			ldlm_handle_bl_callback(ns, &dlm_req->lock_desc,
+						locks[i]);
+	}
+	EXIT;
+out:
+	OBD_FREE_PTR_ARRAY(locks, count);
+}
+
 /* TODO: handle requests in a similar way as MDT: see mdt_handle_common() */
 static int ldlm_callback_handler(struct ptlrpc_request *req)
 {
@@ -2361,6 +2745,13 @@ static int ldlm_callback_handler(struct ptlrpc_request *req)
 		RETURN(0);
 	}
 
+	if (lustre_msg_get_opc(req->rq_reqmsg) == LDLM_BL_CALLBACK &&
+	    (ldlm_flags_from_wire(dlm_req->lock_flags) & LDLM_FL_BL_BATCH)) {
+		CDEBUG(D_INODE, "batched blocking ast\n");
+		ldlm_handle_bl_callback_batch(req, ns, dlm_req);
+		RETURN(0);
+	}
+
 	/*
 	 * Force a known safe race, send a cancel to the server for a lock
 	 * which the server has already started a blocking callback on.
@@ -602,15 +602,17 @@ static bool ldlm_request_slot_needed(struct ldlm_enqueue_info *einfo)
 /**
  * Finishing portion of client lock enqueue code.
  *
- * Called after receiving reply from server.
+ * Called after receiving reply from server. The \a pill is either the one
+ * of the enqueue request or the one of a sub-request in a batch RPC.
  */
-int ldlm_cli_enqueue_fini(struct obd_export *exp, struct ptlrpc_request *req,
+int ldlm_cli_enqueue_fini(struct obd_export *exp, struct req_capsule *pill,
 			  struct ldlm_enqueue_info *einfo,
 			  __u8 with_policy, __u64 *ldlm_flags, void *lvb,
 			  __u32 lvb_len, const struct lustre_handle *lockh,
 			  int rc)
 {
 	struct ldlm_namespace *ns = exp->exp_obd->obd_namespace;
+	struct ptlrpc_request *req = pill->rc_req;
 	const struct lu_env *env = NULL;
 	int is_replay = *ldlm_flags & LDLM_FL_REPLAY;
 	struct ldlm_lock *lock;
@@ -619,10 +621,13 @@ int ldlm_cli_enqueue_fini(struct obd_export *exp, struct ptlrpc_request *req,
 
 	ENTRY;
 
-	if (ldlm_request_slot_needed(einfo))
-		obd_put_request_slot(&req->rq_import->imp_obd->u.cli);
+	/* the batch RPC holds the slots for all its sub-requests */
+	if (!req_capsule_subreq(pill)) {
+		if (ldlm_request_slot_needed(einfo))
+			obd_put_request_slot(&req->rq_import->imp_obd->u.cli);
 
-	ptlrpc_put_mod_rpc_slot(req);
+		ptlrpc_put_mod_rpc_slot(req);
+	}
 
 	if (req && req->rq_svc_thread)
 		env = req->rq_svc_thread->t_env;
@@ -647,14 +652,14 @@ int ldlm_cli_enqueue_fini(struct obd_export *exp, struct ptlrpc_request *req,
 	}
 
 	/* Before we return, swab the reply */
-	reply = req_capsule_server_get(&req->rq_pill, &RMF_DLM_REP);
+	reply = req_capsule_server_get(pill, &RMF_DLM_REP);
 	if (reply == NULL)
 		GOTO(cleanup, rc = -EPROTO);
 
 	if (lvb_len > 0) {
 		int size = 0;
 
-		size = req_capsule_get_size(&req->rq_pill, &RMF_DLM_LVB,
+		size = req_capsule_get_size(pill, &RMF_DLM_LVB,
 					    RCL_SERVER);
 		if (size < 0) {
 			LDLM_ERROR(lock, "Fail to get lvb_len, rc = %d", size);
@@ -670,7 +675,7 @@ int ldlm_cli_enqueue_fini(struct obd_export *exp, struct ptlrpc_request *req,
 
 	if (rc == ELDLM_LOCK_ABORTED) {
 		if (lvb_len > 0 && lvb != NULL)
-			rc = ldlm_fill_lvb(lock, &req->rq_pill, RCL_SERVER,
+			rc = ldlm_fill_lvb(lock, pill, RCL_SERVER,
 					   lvb, lvb_len);
 		GOTO(cleanup, rc = rc ? : ELDLM_LOCK_ABORTED);
 	}
@@ -765,7 +770,7 @@ int ldlm_cli_enqueue_fini(struct obd_export *exp, struct ptlrpc_request *req,
 		 */
 		lock_res_and_lock(lock);
 		if (!ldlm_is_granted(lock))
-			rc = ldlm_fill_lvb(lock, &req->rq_pill, RCL_SERVER,
+			rc = ldlm_fill_lvb(lock, pill, RCL_SERVER,
 					   lock->l_lvb_data, lvb_len);
 		unlock_res_and_lock(lock);
 		if (rc < 0) {
@@ -955,6 +960,108 @@ struct ptlrpc_request *ldlm_enqueue_pack(struct obd_export *exp, int lvb_len)
 }
 EXPORT_SYMBOL(ldlm_enqueue_pack);
 
+static struct ldlm_lock *
+ldlm_cli_lock_create(struct obd_export *exp, struct ldlm_enqueue_info *einfo,
+		     const struct ldlm_res_id *res_id,
+		     union ldlm_policy_data const *policy, __u32 lvb_len,
+		     enum lvb_type lvb_type, struct lustre_handle *lockh)
+{
+	const struct ldlm_callback_suite cbs = {
+		.lcs_completion = einfo->ei_cb_cp,
+		.lcs_blocking	= einfo->ei_cb_bl,
+		.lcs_glimpse	= einfo->ei_cb_gl
+	};
+	struct ldlm_lock *lock;
+
+	lock = ldlm_lock_create(exp->exp_obd->obd_namespace, res_id,
+				einfo->ei_type, einfo->ei_mode, &cbs,
+				einfo->ei_cbdata, lvb_len, lvb_type);
+	if (IS_ERR(lock))
+		return lock;
+
+	if (einfo->ei_cb_created)
+		einfo->ei_cb_created(lock);
+
+	/* for the local lock, add the reference */
+	ldlm_lock_addref_internal(lock, einfo->ei_mode);
+	ldlm_lock2handle(lock, lockh);
+	if (policy != NULL)
+		lock->l_policy_data = *policy;
+
+	if (einfo->ei_type == LDLM_EXTENT) {
+		/* extent lock without policy is a bug */
+		if (policy == NULL)
+			LBUG();
+
+		lock->l_req_extent = policy->l_extent;
+	}
+
+	return lock;
+}
+
+static void ldlm_cli_lock_setup(struct ldlm_lock *lock,
+				struct obd_export *exp,
+				struct ldlm_enqueue_info *einfo, __u64 flags)
+{
+	lock->l_conn_export = exp;
+	lock->l_export = NULL;
+	lock->l_blocking_ast = einfo->ei_cb_bl;
+	lock->l_flags |= (flags & (LDLM_FL_NO_LRU | LDLM_FL_EXCL |
+				   LDLM_FL_ATOMIC_CB));
+	lock->l_activity = ktime_get_real_seconds();
+}
+
+static void ldlm_cli_lock_pack(struct ldlm_lock *lock,
+			       struct ldlm_request *body, __u64 flags,
+			       const struct lustre_handle *lockh)
+{
+	ldlm_lock2desc(lock, &body->lock_desc);
+	body->lock_flags = ldlm_flags_to_wire(flags);
+	body->lock_handle[0] = *lockh;
+}
+
+/**
+ * Create a client-side lock and pack its description into \a dlmreq.
+ *
+ * This is used for enqueue requests not sent by ldlm_cli_enqueue(), like the
+ * sub-requests of a batch RPC. The caller sends the request itself and then
+ * calls ldlm_cli_enqueue_fini() with the reply, as ldlm_cli_enqueue() does.
+ */
+int ldlm_cli_lock_create_pack(struct obd_export *exp,
+			      struct ldlm_request *dlmreq,
+			      struct ldlm_enqueue_info *einfo,
+			      const struct ldlm_res_id *res_id,
+			      union ldlm_policy_data const *policy,
+			      __u64 *flags, __u32 lvb_len,
+			      enum lvb_type lvb_type,
+			      struct lustre_handle *lockh)
+{
+	struct ldlm_lock *lock;
+
+	ENTRY;
+
+	/* replay is not supported for batched locks */
+	LASSERT(!(*flags & LDLM_FL_REPLAY));
+
+	lock = ldlm_cli_lock_create(exp, einfo, res_id, policy, lvb_len,
+				    lvb_type, lockh);
+	if (IS_ERR(lock))
+		RETURN(PTR_ERR(lock));
+
+	LDLM_DEBUG(lock, "client-side enqueue START (batch), flags %#llx",
+		   *flags);
+
+	ldlm_cli_lock_setup(lock, exp, einfo, *flags);
+	ldlm_cli_lock_pack(lock, dlmreq, *flags, lockh);
+
+	if (exp->exp_obd->obd_svc_stats != NULL)
+		ldlm_svc_get_eopc(dlmreq, exp->exp_obd->obd_svc_stats);
+
+	LDLM_DEBUG(lock, "sending request (batch)");
+	RETURN(0);
+}
+EXPORT_SYMBOL(ldlm_cli_lock_create_pack);
+
 /**
  * Client-side lock enqueue.
  *
@@ -996,43 +1103,16 @@ int ldlm_cli_enqueue(struct obd_export *exp, struct ptlrpc_request **reqp,
 		LDLM_DEBUG(lock, "client-side enqueue START");
 		LASSERT(exp == lock->l_conn_export);
 	} else {
-		const struct ldlm_callback_suite cbs = {
-			.lcs_completion = einfo->ei_cb_cp,
-			.lcs_blocking	= einfo->ei_cb_bl,
-			.lcs_glimpse	= einfo->ei_cb_gl
-		};
-		lock = ldlm_lock_create(ns, res_id, einfo->ei_type,
-					einfo->ei_mode, &cbs, einfo->ei_cbdata,
-					lvb_len, lvb_type);
+		lock = ldlm_cli_lock_create(exp, einfo, res_id, policy, lvb_len,
+					    lvb_type, lockh);
 		if (IS_ERR(lock))
 			RETURN(PTR_ERR(lock));
 
-		if (einfo->ei_cb_created)
-			einfo->ei_cb_created(lock);
-
-		/* for the local lock, add the reference */
-		ldlm_lock_addref_internal(lock, einfo->ei_mode);
-		ldlm_lock2handle(lock, lockh);
-		if (policy != NULL)
-			lock->l_policy_data = *policy;
-
-		if (einfo->ei_type == LDLM_EXTENT) {
-			/* extent lock without policy is a bug */
-			if (policy == NULL)
-				LBUG();
-
-			lock->l_req_extent = policy->l_extent;
-		}
 		LDLM_DEBUG(lock, "client-side enqueue START, flags %#llx",
 			   *flags);
 	}
 
-	lock->l_conn_export = exp;
-	lock->l_export = NULL;
-	lock->l_blocking_ast = einfo->ei_cb_bl;
-	lock->l_flags |= (*flags & (LDLM_FL_NO_LRU | LDLM_FL_EXCL |
-				    LDLM_FL_ATOMIC_CB));
-	lock->l_activity = ktime_get_real_seconds();
+	ldlm_cli_lock_setup(lock, exp, einfo, *flags);
 
 	/* lock not sent to server yet */
 	if (reqp == NULL || *reqp == NULL) {
@@ -1068,9 +1148,7 @@ int ldlm_cli_enqueue(struct obd_export *exp, struct ptlrpc_request **reqp,
 
 	/* Dump lock data into the request buffer */
 	body = req_capsule_client_get(&req->rq_pill, &RMF_DLM_REQ);
-	ldlm_lock2desc(lock, &body->lock_desc);
-	body->lock_flags = ldlm_flags_to_wire(*flags);
-	body->lock_handle[0] = *lockh;
+	ldlm_cli_lock_pack(lock, body, *flags, lockh);
 
 	/* extended LDLM opcodes in client stats */
 	if (exp->exp_obd->obd_svc_stats != NULL) {
@@ -1114,8 +1192,8 @@ int ldlm_cli_enqueue(struct obd_export *exp, struct ptlrpc_request **reqp,
 
 	rc = ptlrpc_queue_wait(req);
 
-	err = ldlm_cli_enqueue_fini(exp, req, einfo, policy ? 1 : 0, flags,
-				    lvb, lvb_len, lockh, rc);
+	err = ldlm_cli_enqueue_fini(exp, &req->rq_pill, einfo, policy ? 1 : 0,
+				    flags, lvb, lvb_len, lockh, rc);
 
 	/*
 	 * If ldlm_cli_enqueue_fini did not find the lock, we need to free
@@ -1786,6 +1864,60 @@ ldlm_cancel_lru_policy(struct ldlm_namespace *ns, enum ldlm_lru_flags lru_flags)
 	}
 }
 
+/**
+ * Cost-aware LRU: give a lock chosen for cancel by the LRU policy another
+ * round in LRU if it is expensive to lose.
+ *
+ * The first time a lock is picked since it was put into LRU it gets a credit
+ * of rounds made of its reuse frequency and of log2 of the number of cached
+ * pages it protects (the cost of refetching them), limited by
+ * ns_lru_cost_max. The frequency is halved then, so that locks which are not
+ * reused anymore age out. While it has credit left the lock is moved to the
+ * LRU tail instead of being cancelled, so cheap and rarely used locks are
+ * cancelled first.
+ *
+ * \retval true the lock was moved to the LRU tail and has to be kept
+ * \retval false the lock can be cancelled
+ */
+static bool ldlm_lru_cost_keep(struct ldlm_namespace *ns,
+			       struct ldlm_lock *lock, ktime_t last_use)
+{
+	unsigned long pages = 0;
+	bool keep = false;
+
+	if (lock->l_lru_credit == LDLM_LRU_CREDIT_UNSET)
+		pages = ns->ns_lru_cost(lock);
+
+	spin_lock(&ns->ns_lock);
+	if (list_empty(&lock->l_lru) ||
+	    ktime_compare(last_use, lock->l_last_used))
+		goto out;
+
+	if (lock->l_lru_credit == LDLM_LRU_CREDIT_UNSET) {
+		unsigned int credit = lock->l_lru_freq;
+
+		if (pages)
+			credit += ilog2(pages) + 1;
+		lock->l_lru_credit = min(credit, ns->ns_lru_cost_max);
+		lock->l_lru_freq >>= 1;
+	}
+
+	if (lock->l_lru_credit > 0) {
+		lock->l_lru_credit--;
+		if (ns->ns_last_pos == &lock->l_lru)
+			ns->ns_last_pos = lock->l_lru.prev;
+		list_move_tail(&lock->l_lru, &ns->ns_unused_list);
+		keep = true;
+	}
+out:
+	spin_unlock(&ns->ns_lock);
+
+	if (keep)
+		LDLM_DEBUG(lock, "keep lock in lru, %d rounds left",
+			   lock->l_lru_credit);
+	return keep;
+}
+
 /**
  * - Free space in LRU for \a min new locks,
  *   redundant unused locks are canceled locally;
@@ -1822,7 +1954,9 @@ static int ldlm_prepare_lru_list(struct ldlm_namespace *ns,
 {
 	ldlm_cancel_lru_policy_t pf;
 	int added = 0;
+	int kept = 0;
 	int no_wait = lru_flags & LDLM_LRU_FLAG_NO_WAIT;
+	bool cost_aware;
 	ENTRY;
 
 	/*
@@ -1849,6 +1983,9 @@ static int ldlm_prepare_lru_list(struct ldlm_namespace *ns,
 	pf = ldlm_cancel_lru_policy(ns, lru_flags);
 	LASSERT(pf != NULL);
 
+	cost_aware = !no_wait && !(lru_flags & LDLM_LRU_FLAG_CLEANUP) &&
+		     ns->ns_lru_cost != NULL && ns->ns_lru_cost_max > 0;
+
 	/* For any flags, stop scanning if @max is reached. */
 	while (!list_empty(&ns->ns_unused_list) && (max == 0 || added < max)) {
 		struct ldlm_lock *lock;
@@ -1922,6 +2059,22 @@ static int ldlm_prepare_lru_list(struct ldlm_namespace *ns,
 			continue;
 		}
 
+		/*
+		 * Expensive locks are moved to the LRU tail while they have
+		 * credit left, at most ns_nr_unused times per scan so that
+		 * it ends even if locks are reused and put back meanwhile.
+		 * Locks older than ns_max_age are cancelled regardless.
+		 */
+		if (cost_aware && kept < ns->ns_nr_unused &&
+		    ktime_before(ktime_get(),
+				 ktime_add(last_use, ns->ns_max_age)) &&
+		    ldlm_lru_cost_keep(ns, lock, last_use)) {
+			kept++;
+			lu_ref_del(&lock->l_reference, __func__, current);
+			LDLM_LOCK_RELEASE(lock);
+			continue;
+		}
+
 		lock_res_and_lock(lock);
 		/* Check flags again under the lock. */
 		if (ldlm_is_canceling(lock) ||
@@ -2210,10 +2363,8 @@ struct ldlm_cli_cancel_arg {
 };
 
 static int
-ldlm_cli_hash_cancel_unused(struct cfs_hash *hs, struct cfs_hash_bd *bd,
-			    struct hlist_node *hnode, void *arg)
+ldlm_cli_hash_cancel_unused(struct ldlm_resource *res, void *arg)
 {
-	struct ldlm_resource           *res = cfs_hash_object(hs, hnode);
 	struct ldlm_cli_cancel_arg     *lc = arg;
 
 	ldlm_cli_cancel_unused_resource(ldlm_res_to_ns(res), &res->lr_name,
@@ -2249,8 +2400,8 @@ int ldlm_cli_cancel_unused(struct ldlm_namespace *ns,
 						       LCK_MINMODE, flags,
 						       opaque));
 	} else {
-		cfs_hash_for_each_nolock(ns->ns_rs_hash,
-					 ldlm_cli_hash_cancel_unused, &arg, 0);
+		ldlm_namespace_foreach_res(ns, ldlm_cli_hash_cancel_unused,
+					   &arg);
 		RETURN(ELDLM_OK);
 	}
 }
@@ -2300,12 +2451,8 @@ static int ldlm_iter_helper(struct ldlm_lock *lock, void *closure)
 	return helper->iter(lock, helper->closure);
 }
 
-static int ldlm_res_iter_helper(struct cfs_hash *hs, struct cfs_hash_bd *bd,
-				struct hlist_node *hnode, void *arg)
-
+static int ldlm_res_iter_helper(struct ldlm_resource *res, void *arg)
 {
-	struct ldlm_resource *res = cfs_hash_object(hs, hnode);
-
 	return ldlm_resource_foreach(res, ldlm_iter_helper, arg) ==
 				     LDLM_ITER_STOP;
 }
@@ -2316,8 +2463,7 @@ void ldlm_namespace_foreach(struct ldlm_namespace *ns,
 {
 	struct iter_helper_data helper = { .iter = iter, .closure = closure };
 
-	cfs_hash_for_each_nolock(ns->ns_rs_hash,
-				 ldlm_res_iter_helper, &helper, 0);
+	ldlm_namespace_foreach_res(ns, ldlm_res_iter_helper, &helper);
 
 }
 
@@ -35,6 +35,7 @@
  */
 
 #define DEBUG_SUBSYSTEM S_LDLM
+#include <linux/delay.h>
 #include <lustre_dlm.h>
 #include <lustre_fid.h>
 #include <obd_class.h>
@@ -398,6 +399,34 @@ static ssize_t lru_cancel_batch_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(lru_cancel_batch);
 
+static ssize_t lru_cost_max_show(struct kobject *kobj, struct attribute *attr,
+				 char *buf)
+{
+	struct ldlm_namespace *ns = container_of(kobj, struct ldlm_namespace,
+						 ns_kobj);
+
+	return sprintf(buf, "%u\n", ns->ns_lru_cost_max);
+}
+
+static ssize_t lru_cost_max_store(struct kobject *kobj, struct attribute *attr,
+				  const char *buffer, size_t count)
+{
+	struct ldlm_namespace *ns = container_of(kobj, struct ldlm_namespace,
+						 ns_kobj);
+	unsigned int tmp;
+
+	if (kstrtouint(buffer, 10, &tmp))
+		return -EINVAL;
+
+	if (tmp > LDLM_LRU_COST_MAX)
+		return -ERANGE;
+
+	ns->ns_lru_cost_max = tmp;
+
+	return count;
+}
+LUSTRE_RW_ATTR(lru_cost_max);
+
 static ssize_t ns_recalc_pct_show(struct kobject *kobj,
 				  struct attribute *attr, char *buf)
 {
@@ -643,6 +672,32 @@ static ssize_t contended_locks_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(contended_locks);
 
+static ssize_t expand_conflicts_show(struct kobject *kobj,
+				     struct attribute *attr, char *buf)
+{
+	struct ldlm_namespace *ns = container_of(kobj, struct ldlm_namespace,
+						 ns_kobj);
+
+	return sprintf(buf, "%u\n", ns->ns_expand_conflicts);
+}
+
+static ssize_t expand_conflicts_store(struct kobject *kobj,
+				      struct attribute *attr,
+				      const char *buffer, size_t count)
+{
+	struct ldlm_namespace *ns = container_of(kobj, struct ldlm_namespace,
+						 ns_kobj);
+	unsigned int tmp;
+
+	if (kstrtouint(buffer, 10, &tmp))
+		return -EINVAL;
+
+	ns->ns_expand_conflicts = tmp;
+
+	return count;
+}
+LUSTRE_RW_ATTR(expand_conflicts);
+
 static ssize_t max_parallel_ast_show(struct kobject *kobj,
 				     struct attribute *attr, char *buf)
 {
@@ -681,6 +736,7 @@ static struct attribute *ldlm_ns_attrs[] = {
 	&lustre_attr_ns_recalc_pct.attr,
 	&lustre_attr_lru_size.attr,
 	&lustre_attr_lru_cancel_batch.attr,
+	&lustre_attr_lru_cost_max.attr,
 	&lustre_attr_lru_max_age.attr,
 	&lustre_attr_early_lock_cancel.attr,
 	&lustre_attr_dirty_age_limit.attr,
@@ -690,6 +746,7 @@ static struct attribute *ldlm_ns_attrs[] = {
 	&lustre_attr_max_nolock_bytes.attr,
 	&lustre_attr_contention_seconds.attr,
 	&lustre_attr_contended_locks.attr,
+	&lustre_attr_expand_conflicts.attr,
 	&lustre_attr_max_parallel_ast.attr,
 #endif
 	NULL,
@@ -765,18 +822,6 @@ static int ldlm_namespace_debugfs_register(struct ldlm_namespace *ns)
 }
 #undef MAX_STRING_SIZE
 
-static unsigned ldlm_res_hop_hash(struct cfs_hash *hs,
-				  const void *key, unsigned int mask)
-{
-	const struct ldlm_res_id *id = key;
-	unsigned int val = 0;
-	unsigned int i;
-
-	for (i = 0; i < RES_NAME_SIZE; i++)
-		val += id->name[i];
-	return val & mask;
-}
-
 static unsigned int ldlm_res_hop_fid_hash(const struct ldlm_res_id *id, unsigned int bits)
 {
 	struct lu_fid       fid;
@@ -798,84 +843,34 @@ static unsigned int ldlm_res_hop_fid_hash(const struct ldlm_res_id *id, unsigned
 	return cfs_hash_32(hash, bits);
 }
 
-static void *ldlm_res_hop_key(struct hlist_node *hnode)
-{
-	struct ldlm_resource   *res;
-
-	res = hlist_entry(hnode, struct ldlm_resource, lr_hash);
-	return &res->lr_name;
-}
-
-static int ldlm_res_hop_keycmp(const void *key, struct hlist_node *hnode)
-{
-	struct ldlm_resource   *res;
-
-	res = hlist_entry(hnode, struct ldlm_resource, lr_hash);
-	return ldlm_res_eq((const struct ldlm_res_id *)key,
-			   (const struct ldlm_res_id *)&res->lr_name);
-}
-
-static void *ldlm_res_hop_object(struct hlist_node *hnode)
-{
-	return hlist_entry(hnode, struct ldlm_resource, lr_hash);
-}
-
-static void
-ldlm_res_hop_get_locked(struct cfs_hash *hs, struct hlist_node *hnode)
-{
-	struct ldlm_resource *res;
-
-	res = hlist_entry(hnode, struct ldlm_resource, lr_hash);
-	ldlm_resource_getref(res);
-}
-
-static void ldlm_res_hop_put(struct cfs_hash *hs, struct hlist_node *hnode)
-{
-	struct ldlm_resource *res;
-
-	res = hlist_entry(hnode, struct ldlm_resource, lr_hash);
-	ldlm_resource_putref(res);
-}
-
-static struct cfs_hash_ops ldlm_ns_hash_ops = {
-	.hs_hash        = ldlm_res_hop_hash,
-	.hs_key         = ldlm_res_hop_key,
-	.hs_keycmp      = ldlm_res_hop_keycmp,
-	.hs_keycpy      = NULL,
-	.hs_object      = ldlm_res_hop_object,
-	.hs_get         = ldlm_res_hop_get_locked,
-	.hs_put         = ldlm_res_hop_put
+static const struct rhashtable_params ldlm_res_hash_params = {
+	.key_len	= sizeof(struct ldlm_res_id),
+	.key_offset	= offsetof(struct ldlm_resource, lr_name),
+	.head_offset	= offsetof(struct ldlm_resource, lr_hash),
+	.automatic_shrinking = true,
 };
 
 static struct {
-	/** hash bucket bits */
-	unsigned		nsd_bkt_bits;
-	/** hash bits */
-	unsigned		nsd_all_bits;
+	/** bits of the number of ns_rs_buckets */
+	unsigned		nsd_bucket_bits;
 } ldlm_ns_hash_defs[] = {
 	[LDLM_NS_TYPE_MDC] = {
-		.nsd_bkt_bits   = 11,
-		.nsd_all_bits   = 16,
+		.nsd_bucket_bits = 5,
 	},
 	[LDLM_NS_TYPE_MDT] = {
-		.nsd_bkt_bits   = 14,
-		.nsd_all_bits   = 21,
+		.nsd_bucket_bits = 7,
 	},
 	[LDLM_NS_TYPE_OSC] = {
-		.nsd_bkt_bits   = 8,
-		.nsd_all_bits   = 12,
+		.nsd_bucket_bits = 4,
 	},
 	[LDLM_NS_TYPE_OST] = {
-		.nsd_bkt_bits   = 11,
-		.nsd_all_bits   = 17,
+		.nsd_bucket_bits = 6,
 	},
 	[LDLM_NS_TYPE_MGC] = {
-		.nsd_bkt_bits   = 3,
-		.nsd_all_bits   = 4,
+		.nsd_bucket_bits = 1,
 	},
 	[LDLM_NS_TYPE_MGT] = {
-		.nsd_bkt_bits   = 3,
-		.nsd_all_bits   = 4,
+		.nsd_bucket_bits = 1,
 	},
 };
 
@@ -901,7 +896,7 @@ struct ldlm_namespace *ldlm_namespace_new(struct obd_device *obd, char *name,
 	}
 
 	if (ns_type >= ARRAY_SIZE(ldlm_ns_hash_defs) ||
-	    ldlm_ns_hash_defs[ns_type].nsd_bkt_bits == 0) {
+	    ldlm_ns_hash_defs[ns_type].nsd_bucket_bits == 0) {
 		rc = -EINVAL;
 		CERROR("%s: unknown namespace type %d: rc = %d\n",
 		       name, ns_type, rc);
@@ -912,23 +907,11 @@ struct ldlm_namespace *ldlm_namespace_new(struct obd_device *obd, char *name,
 	if (!ns)
 		GOTO(out_ref, rc = -ENOMEM);
 
-	ns->ns_rs_hash = cfs_hash_create(name,
-					 ldlm_ns_hash_defs[ns_type].nsd_all_bits,
-					 ldlm_ns_hash_defs[ns_type].nsd_all_bits,
-					 ldlm_ns_hash_defs[ns_type].nsd_bkt_bits,
-					 0,
-					 CFS_HASH_MIN_THETA,
-					 CFS_HASH_MAX_THETA,
-					 &ldlm_ns_hash_ops,
-					 CFS_HASH_DEPTH |
-					 CFS_HASH_BIGNAME |
-					 CFS_HASH_SPIN_BKTLOCK |
-					 CFS_HASH_NO_ITEMREF);
-	if (!ns->ns_rs_hash)
-		GOTO(out_ns, rc = -ENOMEM);
-
-	ns->ns_bucket_bits = ldlm_ns_hash_defs[ns_type].nsd_all_bits -
-			     ldlm_ns_hash_defs[ns_type].nsd_bkt_bits;
+	rc = rhashtable_init(&ns->ns_rs_hash, &ldlm_res_hash_params);
+	if (rc)
+		GOTO(out_ns, rc);
+
+	ns->ns_bucket_bits = ldlm_ns_hash_defs[ns_type].nsd_bucket_bits;
 
 	OBD_ALLOC_PTR_ARRAY_LARGE(ns->ns_rs_buckets, 1 << ns->ns_bucket_bits);
 	if (!ns->ns_rs_buckets)
@@ -939,7 +922,7 @@ struct ldlm_namespace *ldlm_namespace_new(struct obd_device *obd, char *name,
 
 		at_init(&nsb->nsb_at_estimate, ldlm_enqueue_min, 0);
 		nsb->nsb_namespace = ns;
-		nsb->nsb_reclaim_start = 0;
+		spin_lock_init(&nsb->nsb_lock);
 		atomic_set(&nsb->nsb_count, 0);
 	}
 
@@ -959,11 +942,13 @@ struct ldlm_namespace *ldlm_namespace_new(struct obd_device *obd, char *name,
 	ns->ns_max_nolock_size    = NS_DEFAULT_MAX_NOLOCK_BYTES;
 	ns->ns_contention_time    = NS_DEFAULT_CONTENTION_SECONDS;
 	ns->ns_contended_locks    = NS_DEFAULT_CONTENDED_LOCKS;
+	ns->ns_expand_conflicts   = NS_DEFAULT_EXPAND_CONFLICTS;
 
 	ns->ns_max_parallel_ast   = LDLM_DEFAULT_PARALLEL_AST_LIMIT;
 	ns->ns_nr_unused          = 0;
 	ns->ns_max_unused         = LDLM_DEFAULT_LRU_SIZE;
 	ns->ns_cancel_batch       = LDLM_DEFAULT_LRU_SHRINK_BATCH;
+	ns->ns_lru_cost_max       = LDLM_DEFAULT_LRU_COST_MAX;
 	ns->ns_recalc_pct         = LDLM_DEFAULT_SLV_RECALC_PCT;
 	ns->ns_max_age            = ktime_set(LDLM_DEFAULT_MAX_ALIVE, 0);
 	ns->ns_ctime_age_limit    = LDLM_CTIME_AGE_LIMIT;
@@ -1005,7 +990,7 @@ out_sysfs:
 out_hash:
 	OBD_FREE_PTR_ARRAY_LARGE(ns->ns_rs_buckets, 1 << ns->ns_bucket_bits);
 	kfree(ns->ns_name);
-	cfs_hash_putref(ns->ns_rs_hash);
+	rhashtable_destroy(&ns->ns_rs_hash);
 out_ns:
         OBD_FREE_PTR(ns);
 out_ref:
@@ -1100,10 +1085,8 @@ static void cleanup_resource(struct ldlm_resource *res, struct list_head *q,
 	} while (1);
 }
 
-static int ldlm_resource_clean(struct cfs_hash *hs, struct cfs_hash_bd *bd,
-			       struct hlist_node *hnode, void *arg)
+static int ldlm_resource_clean(struct ldlm_resource *res, void *arg)
 {
-	struct ldlm_resource *res = cfs_hash_object(hs, hnode);
 	__u64 flags = *(__u64 *)arg;
 
 	cleanup_resource(res, &res->lr_granted, flags);
@@ -1112,11 +1095,8 @@ static int ldlm_resource_clean(struct cfs_hash *hs, struct cfs_hash_bd *bd,
 	return 0;
 }
 
-static int ldlm_resource_complain(struct cfs_hash *hs, struct cfs_hash_bd *bd,
-				  struct hlist_node *hnode, void *arg)
+static int ldlm_resource_complain(struct ldlm_resource *res, void *arg)
 {
-	struct ldlm_resource  *res = cfs_hash_object(hs, hnode);
-
 	lock_res(res);
 	CERROR("%s: namespace resource "DLDLMRES" (%p) refcount nonzero "
 	       "(%d) after lock cleanup; forcing cleanup.\n",
@@ -1143,10 +1123,8 @@ int ldlm_namespace_cleanup(struct ldlm_namespace *ns, __u64 flags)
 		return ELDLM_OK;
 	}
 
-	cfs_hash_for_each_nolock(ns->ns_rs_hash, ldlm_resource_clean,
-				 &flags, 0);
-	cfs_hash_for_each_nolock(ns->ns_rs_hash, ldlm_resource_complain,
-				 NULL, 0);
+	ldlm_namespace_foreach_res(ns, ldlm_resource_clean, &flags);
+	ldlm_namespace_foreach_res(ns, ldlm_resource_complain, NULL);
 	return ELDLM_OK;
 }
 EXPORT_SYMBOL(ldlm_namespace_cleanup);
@@ -1271,7 +1249,7 @@ void ldlm_namespace_free_post(struct ldlm_namespace *ns)
 
 	ldlm_namespace_debugfs_unregister(ns);
 	ldlm_namespace_sysfs_unregister(ns);
-	cfs_hash_putref(ns->ns_rs_hash);
+	rhashtable_destroy(&ns->ns_rs_hash);
 	OBD_FREE_PTR_ARRAY_LARGE(ns->ns_rs_buckets, 1 << ns->ns_bucket_bits);
 	kfree(ns->ns_name);
 	/* Namespace \a ns should be not on list at this time, otherwise
@@ -1474,38 +1452,51 @@ static void ldlm_resource_free(struct ldlm_resource *res)
 	call_rcu(&res->lr_rcu, __ldlm_resource_free);
 }
 
+/**
+ * Look up the resource with given name in the namespace hash without taking
+ * any locks.
+ *
+ * A resource with zero refcount is being freed, it is not returned, the
+ * caller is then serialized with its removal from the hash by nsb_lock.
+ */
+static struct ldlm_resource *
+ldlm_resource_lookup(struct ldlm_namespace *ns, const struct ldlm_res_id *name)
+{
+	struct ldlm_resource *res;
+
+	rcu_read_lock();
+	res = rhashtable_lookup(&ns->ns_rs_hash, name, ldlm_res_hash_params);
+	if (res != NULL && !atomic_inc_not_zero(&res->lr_refcount))
+		res = NULL;
+	rcu_read_unlock();
+
+	return res;
+}
+
 /**
  * Return a reference to resource with given name, creating it if necessary.
  * Args: namespace with ns_lock unlocked
- * Locks: takes and releases NS hash-lock and res->lr_lock
- * Returns: referenced, unlocked ldlm_resource or NULL
+ * Locks: takes and releases nsb_lock if the resource is not found
+ * Returns: referenced, unlocked ldlm_resource or ERR_PTR
  */
 struct ldlm_resource *
 ldlm_resource_get(struct ldlm_namespace *ns, struct ldlm_resource *parent,
 		  const struct ldlm_res_id *name, enum ldlm_type type,
 		  int create)
 {
-	struct hlist_node	*hnode;
-	struct ldlm_resource	*res = NULL;
-	struct cfs_hash_bd		bd;
-	__u64			version;
+	struct ldlm_resource	*res;
+	struct ldlm_resource	*old;
+	struct ldlm_ns_bucket	*nsb;
 	int			ns_refcount = 0;
 	int hash;
 
 	LASSERT(ns != NULL);
 	LASSERT(parent == NULL);
-	LASSERT(ns->ns_rs_hash != NULL);
 	LASSERT(name->name[0] != 0);
 
-	cfs_hash_bd_get_and_lock(ns->ns_rs_hash, (void *)name, &bd, 0);
-	hnode = cfs_hash_bd_lookup_locked(ns->ns_rs_hash, &bd, (void *)name);
-	if (hnode != NULL) {
-		cfs_hash_bd_unlock(ns->ns_rs_hash, &bd, 0);
-		GOTO(found, res);
-	}
-
-	version = cfs_hash_bd_version_get(&bd);
-	cfs_hash_bd_unlock(ns->ns_rs_hash, &bd, 0);
+	res = ldlm_resource_lookup(ns, name);
+	if (res != NULL)
+		return res;
 
 	if (create == 0)
 		return ERR_PTR(-ENOENT);
@@ -1517,30 +1508,40 @@ ldlm_resource_get(struct ldlm_namespace *ns, struct ldlm_resource *parent,
 		return ERR_PTR(-ENOMEM);
 
 	hash = ldlm_res_hop_fid_hash(name, ns->ns_bucket_bits);
-	res->lr_ns_bucket = &ns->ns_rs_buckets[hash];
+	nsb = &ns->ns_rs_buckets[hash];
+	res->lr_ns_bucket = nsb;
 	res->lr_name = *name;
 	res->lr_type = type;
 
-	cfs_hash_bd_lock(ns->ns_rs_hash, &bd, 1);
-	hnode = (version == cfs_hash_bd_version_get(&bd)) ? NULL :
-		cfs_hash_bd_lookup_locked(ns->ns_rs_hash, &bd, (void *)name);
+try_again:
+	spin_lock(&nsb->nsb_lock);
+	old = rhashtable_lookup_get_insert_fast(&ns->ns_rs_hash, &res->lr_hash,
+						ldlm_res_hash_params);
+	if (IS_ERR(old)) {
+		spin_unlock(&nsb->nsb_lock);
+		/* hash table could be resizing. */
+		if (PTR_ERR(old) == -ENOMEM || PTR_ERR(old) == -EBUSY) {
+			msleep(5);
+			goto try_again;
+		}
+	} else if (old != NULL) {
+		/* Someone won the race and already added the resource, its
+		 * refcount can drop to zero only under nsb_lock. */
+		atomic_inc(&old->lr_refcount);
+		spin_unlock(&nsb->nsb_lock);
+	}
 
-	if (hnode != NULL) {
-		/* Someone won the race and already added the resource. */
-		cfs_hash_bd_unlock(ns->ns_rs_hash, &bd, 1);
+	if (old != NULL) {
 		/* Clean lu_ref for failed resource. */
 		lu_ref_fini(&res->lr_reference);
 		ldlm_resource_free(res);
-found:
-		res = hlist_entry(hnode, struct ldlm_resource, lr_hash);
-		return res;
+		return old;
 	}
-	/* We won! Let's add the resource. */
-	cfs_hash_bd_add_locked(ns->ns_rs_hash, &bd, &res->lr_hash);
-	if (atomic_inc_return(&res->lr_ns_bucket->nsb_count) == 1)
+	/* We won! The resource is added. */
+	if (atomic_inc_return(&nsb->nsb_count) == 1)
 		ns_refcount = ldlm_namespace_get_return(ns);
 
-	cfs_hash_bd_unlock(ns->ns_rs_hash, &bd, 1);
+	spin_unlock(&nsb->nsb_lock);
 
 	OBD_FAIL_TIMEOUT(OBD_FAIL_LDLM_CREATE_RESOURCE, 2);
 
@@ -1568,8 +1569,7 @@ struct ldlm_resource *ldlm_resource_getref(struct ldlm_resource *res)
 	return res;
 }
 
-static void __ldlm_resource_putref_final(struct cfs_hash_bd *bd,
-                                         struct ldlm_resource *res)
+static void __ldlm_resource_putref_final(struct ldlm_resource *res)
 {
 	struct ldlm_ns_bucket *nsb = res->lr_ns_bucket;
 
@@ -1583,8 +1583,8 @@ static void __ldlm_resource_putref_final(struct cfs_hash_bd *bd,
 		LBUG();
 	}
 
-	cfs_hash_bd_del_locked(nsb->nsb_namespace->ns_rs_hash,
-			       bd, &res->lr_hash);
+	rhashtable_remove_fast(&nsb->nsb_namespace->ns_rs_hash, &res->lr_hash,
+			       ldlm_res_hash_params);
 	lu_ref_fini(&res->lr_reference);
 	if (atomic_dec_and_test(&nsb->nsb_count))
 		ldlm_namespace_put(nsb->nsb_namespace);
@@ -1594,16 +1594,15 @@ static void __ldlm_resource_putref_final(struct cfs_hash_bd *bd,
 int ldlm_resource_putref(struct ldlm_resource *res)
 {
 	struct ldlm_namespace *ns = ldlm_res_to_ns(res);
-	struct cfs_hash_bd   bd;
+	struct ldlm_ns_bucket *nsb = res->lr_ns_bucket;
 
 	LASSERT_ATOMIC_GT_LT(&res->lr_refcount, 0, LI_POISON);
 	CDEBUG(D_INFO, "putref res: %p count: %d\n",
 	       res, atomic_read(&res->lr_refcount) - 1);
 
-	cfs_hash_bd_get(ns->ns_rs_hash, &res->lr_name, &bd);
-	if (cfs_hash_bd_dec_and_lock(ns->ns_rs_hash, &bd, &res->lr_refcount)) {
-		__ldlm_resource_putref_final(&bd, res);
-		cfs_hash_bd_unlock(ns->ns_rs_hash, &bd, 1);
+	if (atomic_dec_and_lock(&res->lr_refcount, &nsb->nsb_lock)) {
+		__ldlm_resource_putref_final(res);
+		spin_unlock(&nsb->nsb_lock);
 		if (ns->ns_lvbo && ns->ns_lvbo->lvbo_free)
 			ns->ns_lvbo->lvbo_free(res);
 		ldlm_resource_free(res);
@@ -1613,6 +1612,40 @@ int ldlm_resource_putref(struct ldlm_resource *res)
 }
 EXPORT_SYMBOL(ldlm_resource_putref);
 
+/**
+ * Call \a iter for each resource in the namespace.
+ *
+ * \a iter is called with a reference on the resource and without any locks
+ * held, so it may block. Resources added or removed concurrently may be
+ * missed or visited twice. The iteration stops when \a iter returns
+ * non-zero.
+ */
+void ldlm_namespace_foreach_res(struct ldlm_namespace *ns,
+				ldlm_res_iterator_t iter, void *arg)
+{
+	struct rhashtable_iter hiter;
+	struct ldlm_resource *res;
+	int rc = 0;
+
+	rhashtable_walk_enter(&ns->ns_rs_hash, &hiter);
+	rhashtable_walk_start(&hiter);
+	while (rc == 0 && (res = rhashtable_walk_next(&hiter)) != NULL) {
+		/* the table is being resized, the walk continues */
+		if (IS_ERR(res))
+			continue;
+		if (!atomic_inc_not_zero(&res->lr_refcount))
+			continue;
+
+		rhashtable_walk_stop(&hiter);
+		rc = iter(res, arg);
+		ldlm_resource_putref(res);
+		rhashtable_walk_start(&hiter);
+	}
+	rhashtable_walk_stop(&hiter);
+	rhashtable_walk_exit(&hiter);
+}
+EXPORT_SYMBOL(ldlm_namespace_foreach_res);
+
 static void __ldlm_resource_add_lock(struct ldlm_resource *res,
 				     struct list_head *head,
 				     struct ldlm_lock *lock,
@@ -1730,10 +1763,8 @@ void ldlm_dump_all_namespaces(enum ldlm_side client, int level)
 	mutex_unlock(ldlm_namespace_lock(client));
 }
 
-static int ldlm_res_hash_dump(struct cfs_hash *hs, struct cfs_hash_bd *bd,
-			      struct hlist_node *hnode, void *arg)
+static int ldlm_res_hash_dump(struct ldlm_resource *res, void *arg)
 {
-	struct ldlm_resource *res = cfs_hash_object(hs, hnode);
 	int    level = (int)(unsigned long)arg;
 
 	lock_res(res);
@@ -1759,9 +1790,8 @@ void ldlm_namespace_dump(int level, struct ldlm_namespace *ns)
 	if (ktime_get_seconds() < ns->ns_next_dump)
 		return;
 
-	cfs_hash_for_each_nolock(ns->ns_rs_hash,
-				 ldlm_res_hash_dump,
-				 (void *)(unsigned long)level, 0);
+	ldlm_namespace_foreach_res(ns, ldlm_res_hash_dump,
+				   (void *)(unsigned long)level);
 	spin_lock(&ns->ns_lock);
 	ns->ns_next_dump = ktime_get_seconds() + 10;
 	spin_unlock(&ns->ns_lock);
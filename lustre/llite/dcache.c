@@ -250,7 +250,7 @@ int ll_revalidate_it_finish(struct ptlrpc_request *request,
         if (it_disposition(it, DISP_LOOKUP_NEG))
                 RETURN(-ENOENT);
 
-        rc = ll_prep_inode(&de->d_inode, request, NULL, it);
+        rc = ll_prep_inode(&de->d_inode, &request->rq_pill, NULL, it);
 
         RETURN(rc);
 }
@@ -657,7 +657,7 @@ retry:
 		GOTO(out, rc);
 	}
 
-	rc = ll_prep_inode(&de->d_inode, req, NULL, itp);
+	rc = ll_prep_inode(&de->d_inode, &req->rq_pill, NULL, itp);
 
 	if (!rc && itp->it_lock_mode) {
 		__u64 bits = 0;
@@ -1478,6 +1478,8 @@ void ll_io_init(struct cl_io *io, struct file *file, enum cl_io_type iot,
 		io->u.ci_wr.wr_sync   = !!(file->f_flags & O_SYNC ||
 					   file->f_flags & O_DIRECT ||
 					   IS_SYNC(inode));
+		io->u.ci_wr.wr_sync  |= !!(args &&
+					   ll_iocb_is_direct(args->u.normal.via_iocb));
 #ifdef HAVE_GENERIC_WRITE_SYNC_2ARGS
 		io->u.ci_wr.wr_sync  |= !!(args &&
 					   (args->u.normal.via_iocb->ki_flags &
@@ -1534,6 +1536,44 @@ static void ll_heat_add(struct inode *inode, enum cl_io_type iot,
 	spin_unlock(&lli->lli_heat_lock);
 }
 
+/*
+ * Hybrid IO: buffered IO large enough to not benefit from the page cache is
+ * done as direct IO. The kernel flushes and invalidates the cached pages of
+ * the range around the direct IO, so it stays coherent with the page cache.
+ */
+static bool ll_hybrid_io_direct(struct file *file, struct vvp_io_args *args,
+				enum cl_io_type iot, size_t count)
+{
+#ifdef IOCB_DIRECT
+	struct inode *inode = file_inode(file);
+	struct ll_sb_info *sbi = ll_i2sbi(inode);
+	struct kiocb *iocb = args->u.normal.via_iocb;
+	__u64 threshold;
+
+	if (!sbi->ll_hybrid_io || iocb->ki_flags & IOCB_DIRECT ||
+	    !is_sync_kiocb(iocb) || !iter_is_iovec(args->u.normal.via_iter))
+		return false;
+
+	threshold = iot == CIT_READ ? sbi->ll_hybrid_io_read_threshold_bytes :
+				      sbi->ll_hybrid_io_write_threshold_bytes;
+	if (count < threshold)
+		return false;
+
+	/* pages of a mapped file cannot be invalidated, and encrypted files
+	 * need whole pages for direct IO
+	 */
+	if (mapping_mapped(file->f_mapping) || IS_ENCRYPTED(inode))
+		return false;
+
+	if (iot == CIT_WRITE && file->f_flags & O_APPEND)
+		return false;
+
+	return true;
+#else
+	return false;
+#endif
+}
+
 static ssize_t
 ll_file_io_generic(const struct lu_env *env, struct vvp_io_args *args,
 		   struct file *file, enum cl_io_type iot,
@@ -1553,6 +1593,10 @@ ll_file_io_generic(const struct lu_env *env, struct vvp_io_args *args,
 	struct cl_dio_aio *ci_aio = NULL;
 	size_t per_bytes;
 	bool partial_io = false;
+#ifdef IOCB_DIRECT
+	bool hybrid_io = false;
+#endif
+	bool dio;
 	size_t max_io_pages, max_cached_pages;
 
 	ENTRY;
@@ -1566,8 +1610,19 @@ ll_file_io_generic(const struct lu_env *env, struct vvp_io_args *args,
 	if (max_io_pages > (max_cached_pages >> 2))
 		max_io_pages = max_cached_pages >> 2;
 
+#ifdef IOCB_DIRECT
+	if (ll_hybrid_io_direct(file, args, iot, count)) {
+		CDEBUG(D_VFSTRACE, "%s: hybrid IO, %s %zu bytes as direct IO\n",
+		       file_dentry(file)->d_name.name,
+		       iot == CIT_READ ? "read" : "write", count);
+		args->u.normal.via_iocb->ki_flags |= IOCB_DIRECT;
+		hybrid_io = true;
+	}
+#endif
+	dio = ll_iocb_is_direct(args->u.normal.via_iocb);
+
 	io = vvp_env_thread_io(env);
-	if (file->f_flags & O_DIRECT) {
+	if (dio) {
 		if (!is_sync_kiocb(args->u.normal.via_iocb))
 			is_aio = true;
 		ci_aio = cl_aio_alloc(args->u.normal.via_iocb);
@@ -1581,7 +1636,7 @@ restart:
 	 * if we have small max_cached_mb but large block IO issued, io
 	 * could not be finished and blocked whole client.
 	 */
-	if (file->f_flags & O_DIRECT)
+	if (dio)
 		per_bytes = count;
 	else
 		per_bytes = min(max_io_pages << PAGE_SHIFT, count);
@@ -1608,7 +1663,7 @@ restart:
 		 * See LU-6227 for details.
 		 */
 		if (((iot == CIT_WRITE) ||
-		    (iot == CIT_READ && (file->f_flags & O_DIRECT))) &&
+		    (iot == CIT_READ && dio)) &&
 		    !(vio->vui_fd->fd_flags & LL_FILE_GROUP_LOCKED)) {
 			CDEBUG(D_VFSTRACE, "Range lock "RL_FMT"\n",
 			       RL_PARA(&range));
@@ -1703,6 +1758,11 @@ out:
 		}
 	}
 
+#ifdef IOCB_DIRECT
+	if (hybrid_io)
+		args->u.normal.via_iocb->ki_flags &= ~IOCB_DIRECT;
+#endif
+
 	if (iot == CIT_READ) {
 		if (result > 0)
 			ll_stats_ops_tally(ll_i2sbi(inode),
@@ -3162,6 +3222,47 @@ int ll_file_lock_ahead(struct file *file, struct llapi_lu_ladvise *ladvise)
 out:
 	RETURN(result);
 }
+
+/*
+ * Prefetch the extent described by \a ladvise into the client page cache.
+ *
+ * A read lock on the extent is taken first, since readahead only reads
+ * pages covered by a cached lock, then the extent is queued to the async
+ * readahead workers. A conflicting lock held by another client makes the
+ * hint a no-op rather than cancelling that lock.
+ */
+static int ll_file_prefetch(struct file *file,
+			    struct llapi_lu_ladvise *ladvise)
+{
+	struct inode *inode = file_inode(file);
+	struct llapi_lu_ladvise lock_advise = *ladvise;
+	__u64 end;
+	int rc;
+
+	ENTRY;
+
+	rc = cl_glimpse_size(inode);
+	if (rc)
+		RETURN(rc);
+
+	end = min_t(__u64, ladvise->lla_end, i_size_read(inode));
+	if (ladvise->lla_start >= end)
+		RETURN(0);
+
+	lock_advise.lla_lockahead_mode = MODE_READ_USER;
+	lock_advise.lla_peradvice_flags = 0;
+	lock_advise.lla_end = end - 1;
+	rc = ll_file_lock_ahead(file, &lock_advise);
+	if (rc == -EWOULDBLOCK || rc == -EAGAIN)
+		RETURN(0);
+	if (rc < 0)
+		RETURN(rc);
+
+	rc = ll_readahead_prefetch(file, ladvise->lla_start >> PAGE_SHIFT,
+				   (end - 1) >> PAGE_SHIFT);
+	RETURN(rc);
+}
+
 static const char *const ladvise_names[] = LU_LADVISE_NAMES;
 
 static int ll_ladvise_sanity(struct inode *inode,
@@ -3209,6 +3310,7 @@ static int ll_ladvise_sanity(struct inode *inode,
 		/* fallthrough */
 	case LU_LADVISE_WILLREAD:
 	case LU_LADVISE_DONTNEED:
+	case LU_LADVISE_PREFETCH:
 	default:
 		/* Note fall through above - These checks apply to all advices
 		 * except LOCKNOEXPAND */
@@ -4013,6 +4115,11 @@ out:
 					     &u_ladvise->lla_lockahead_result))
 					GOTO(out_ladvise, rc = -EFAULT);
 				break;
+			case LU_LADVISE_PREFETCH:
+				rc = ll_file_prefetch(file, k_ladvise);
+				if (rc)
+					GOTO(out_ladvise, rc);
+				break;
 			default:
 				rc = ll_ladvise(inode, file,
 						k_ladvise_hdr->lah_flags,
@@ -4574,7 +4681,7 @@ int ll_get_fid_by_name(struct inode *parent, const char *name,
 		*fid = body->mbo_fid1;
 
 	if (inode != NULL)
-		rc = ll_prep_inode(inode, req, parent->i_sb, NULL);
+		rc = ll_prep_inode(inode, &req->rq_pill, parent->i_sb, NULL);
 out_req:
 	ptlrpc_req_finished(req);
 	RETURN(rc);
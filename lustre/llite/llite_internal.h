@@ -520,6 +520,9 @@ enum ra_stat {
 	RA_STAT_ASYNC,
 	RA_STAT_FAILED_FAST_READ,
 	RA_STAT_MMAP_RANGE_READ,
+	RA_STAT_PREFETCH,
+	RA_STAT_BDP_LIMITED,
+	RA_STAT_BDP_EXTENDED,
 	_NR_RA_STAT,
 };
 
@@ -539,6 +542,8 @@ struct ll_ra_info {
 	atomic_t ra_async_inflight;
 	/* Threshold to control when to trigger async readahead */
 	unsigned long ra_async_pages_per_file_threshold;
+	/* size the per-file window from the bandwidth-delay product */
+	unsigned int ra_adaptive:1;
 };
 
 /* ra_io_arg will be filled in the beginning of ll_readahead with
@@ -698,7 +703,8 @@ struct ll_sb_info {
 	unsigned int		  ll_xattr_cache_enabled:1,
 				  ll_xattr_cache_set:1, /* already set to 0/1 */
 				  ll_client_common_fill_super_succeeded:1,
-				  ll_checksum_set:1;
+				  ll_checksum_set:1,
+				  ll_hybrid_io:1; /* large buffered IO as DIO */
 
 	struct lustre_client_ocd  ll_lco;
 
@@ -733,6 +739,8 @@ struct ll_sb_info {
 	unsigned int		  ll_sa_running_max;/* max concurrent
 						     * statahead instances */
 	unsigned int		  ll_sa_max;     /* max statahead RPCs */
+	unsigned int		  ll_sa_batch_max;/* max getattr sub-requests
+						   * per statahead batch RPC */
 	atomic_t		  ll_sa_total;   /* statahead thread started
 						  * count */
 	atomic_t		  ll_sa_wrong;   /* statahead thread stopped for
@@ -750,6 +758,10 @@ struct ll_sb_info {
 	/* st_blksize returned by stat(2), when non-zero */
 	unsigned int		  ll_stat_blksize;
 
+	/* buffered IO at least this large is done as direct IO */
+	__u64			  ll_hybrid_io_write_threshold_bytes;
+	__u64			  ll_hybrid_io_read_threshold_bytes;
+
 	/* maximum relative age of cached statfs results */
 	unsigned int		  ll_statfs_max_age;
 
@@ -782,6 +794,9 @@ struct ll_sb_info {
 
 #define SBI_DEFAULT_HEAT_DECAY_WEIGHT	((80 * 256 + 50) / 100)
 #define SBI_DEFAULT_HEAT_PERIOD_SECOND	(60)
+
+#define SBI_DEFAULT_HYBRID_IO_WRITE_THRESHOLD	(2 << 20)
+#define SBI_DEFAULT_HYBRID_IO_READ_THRESHOLD	(8 << 20)
 /*
  * per file-descriptor read-ahead data.
  */
@@ -830,6 +845,11 @@ struct ll_readahead_state {
 	 * It decides how many pages will be sent for each read-ahead.
 	 */
 	unsigned long	ras_rpc_pages;
+	/*
+	 * Bandwidth-delay product of the targets being read, in pages,
+	 * used to size the window if read_ahead_adaptive is set.
+	 */
+	unsigned long	ras_bdp_pages;
         /*
          * Where next read-ahead should start at. This lies within read-ahead
          * window. Read-ahead window is read in pieces rather than at once
@@ -1058,6 +1078,8 @@ int ll_readpage(struct file *file, struct page *page);
 int ll_io_read_page(const struct lu_env *env, struct cl_io *io,
 			   struct cl_page *page, struct file *file);
 void ll_readahead_init(struct inode *inode, struct ll_readahead_state *ras);
+int ll_readahead_prefetch(struct file *file, pgoff_t start_idx,
+			  pgoff_t end_idx);
 int vvp_io_write_commit(const struct lu_env *env, struct cl_io *io);
 
 enum lcc_type;
@@ -1186,7 +1208,7 @@ void ll_umount_begin(struct super_block *sb);
 int ll_remount_fs(struct super_block *sb, int *flags, char *data);
 int ll_show_options(struct seq_file *seq, struct dentry *dentry);
 void ll_dirty_page_discard_warn(struct page *page, int ioret);
-int ll_prep_inode(struct inode **inode, struct ptlrpc_request *req,
+int ll_prep_inode(struct inode **inode, struct req_capsule *pill,
 		  struct super_block *, struct lookup_intent *);
 int ll_obd_statfs(struct inode *inode, void __user *arg);
 int ll_get_max_mdsize(struct ll_sb_info *sbi, int *max_mdsize);
@@ -1409,6 +1431,10 @@ void ll_ra_stats_inc(struct inode *inode, enum ra_stat which);
 #define LL_SA_RUNNING_MAX	256
 #define LL_SA_RUNNING_DEF	16
 
+/* statahead getattr requests packed into one MDS_BATCH RPC, 0 disables it */
+#define LL_SA_BATCH_MAX		1024
+#define LL_SA_BATCH_DEF		64
+
 #define LL_SA_CACHE_BIT         5
 #define LL_SA_CACHE_SIZE        (1 << LL_SA_CACHE_BIT)
 #define LL_SA_CACHE_MASK        (LL_SA_CACHE_SIZE - 1)
@@ -1445,6 +1471,8 @@ struct ll_statahead_info {
 	wait_queue_head_t	sai_waitq;	/* stat-ahead wait queue */
 	struct task_struct	*sai_task;	/* stat-ahead thread */
 	struct task_struct	*sai_agl_task;	/* AGL thread */
+	struct lu_batch		*sai_bh;	/* batch for statahead getattr
+						 * RPCs, NULL if not batched */
 	struct list_head	sai_interim_entries; /* entries which got async
 						      * stat reply, but not
 						      * instantiated */
@@ -1546,6 +1574,16 @@ dentry_may_statahead(struct inode *dir, struct dentry *dentry)
 int cl_sync_file_range(struct inode *inode, loff_t start, loff_t end,
 		       enum cl_fsync_mode mode, int ignore_layout);
 
+/* whether the IO is done as direct IO, by O_DIRECT or by hybrid IO */
+static inline bool ll_iocb_is_direct(struct kiocb *iocb)
+{
+#ifdef IOCB_DIRECT
+	return iocb->ki_flags & IOCB_DIRECT;
+#else
+	return iocb->ki_filp->f_flags & O_DIRECT;
+#endif
+}
+
 static inline int ll_file_nolock(const struct file *file)
 {
 	struct ll_file_data *fd = file->private_data;
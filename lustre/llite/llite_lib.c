@@ -66,6 +66,7 @@
 #include <lustre_log.h>
 #include <cl_object.h>
 #include <obd_cksum.h>
+#include <obd_compress.h>
 #include "llite_internal.h"
 
 struct kmem_cache *ll_file_data_slab;
@@ -181,6 +182,7 @@ static struct ll_sb_info *ll_init_sbi(void)
 	/* metadata statahead is enabled by default */
 	sbi->ll_sa_running_max = LL_SA_RUNNING_DEF;
 	sbi->ll_sa_max = LL_SA_RPC_DEF;
+	sbi->ll_sa_batch_max = LL_SA_BATCH_DEF;
 	atomic_set(&sbi->ll_sa_total, 0);
 	atomic_set(&sbi->ll_sa_wrong, 0);
 	atomic_set(&sbi->ll_sa_running, 0);
@@ -190,6 +192,12 @@ static struct ll_sb_info *ll_init_sbi(void)
 	sbi->ll_flags |= LL_SBI_TINY_WRITE;
 	ll_sbi_set_encrypt(sbi, true);
 
+	/* hybrid IO is disabled by default */
+	sbi->ll_hybrid_io_write_threshold_bytes =
+		SBI_DEFAULT_HYBRID_IO_WRITE_THRESHOLD;
+	sbi->ll_hybrid_io_read_threshold_bytes =
+		SBI_DEFAULT_HYBRID_IO_READ_THRESHOLD;
+
 	/* root squash */
 	sbi->ll_squash.rsi_uid = 0;
 	sbi->ll_squash.rsi_gid = 0;
@@ -331,7 +339,9 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt)
 				   OBD_CONNECT2_PCC |
 				   OBD_CONNECT2_CRUSH | OBD_CONNECT2_LSEEK |
 				   OBD_CONNECT2_GETATTR_PFID |
-				   OBD_CONNECT2_DOM_LVB;
+				   OBD_CONNECT2_DOM_LVB |
+				   OBD_CONNECT2_BATCH_RPC |
+				   OBD_CONNECT2_BATCH_BL_AST;
 
 #ifdef HAVE_LRU_RESIZE_SUPPORT
         if (sbi->ll_flags & LL_SBI_LRU_RESIZE)
@@ -523,7 +533,8 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt)
 				  OBD_CONNECT_BULK_MBITS | OBD_CONNECT_SHORTIO |
 				  OBD_CONNECT_FLAGS2 | OBD_CONNECT_GRANT_SHRINK;
 	data->ocd_connect_flags2 = OBD_CONNECT2_LOCKAHEAD |
-				   OBD_CONNECT2_INC_XID | OBD_CONNECT2_LSEEK;
+				   OBD_CONNECT2_INC_XID | OBD_CONNECT2_LSEEK |
+				   OBD_CONNECT2_BATCH_BL_AST;
 
 	if (!OBD_FAIL_CHECK(OBD_FAIL_OSC_CONNECT_GRANT_PARAM))
 		data->ocd_connect_flags |= OBD_CONNECT_GRANT_PARAM;
@@ -540,6 +551,10 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt)
 	else
 		data->ocd_cksum_types = obd_cksum_types_supported_client();
 
+	data->ocd_compr_types = obd_compr_types_supported();
+	if (data->ocd_compr_types)
+		data->ocd_connect_flags2 |= OBD_CONNECT2_COMPRESS;
+
 #ifdef HAVE_LRU_RESIZE_SUPPORT
 	data->ocd_connect_flags |= OBD_CONNECT_LRU_RESIZE;
 #endif
@@ -657,7 +672,8 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt)
 		GOTO(out_lock_cn_cb, err);
 	}
 
-	err = md_get_lustre_md(sbi->ll_md_exp, request, sbi->ll_dt_exp,
+	err = md_get_lustre_md(sbi->ll_md_exp, &request->rq_pill,
+			       sbi->ll_dt_exp,
 			       sbi->ll_md_exp, &lmd);
 	if (err) {
 		CERROR("failed to understand root inode md: rc = %d\n", err);
@@ -1809,7 +1825,8 @@ static int ll_md_setattr(struct dentry *dentry, struct md_op_data *op_data)
 		RETURN(rc);
 	}
 
-        rc = md_get_lustre_md(sbi->ll_md_exp, request, sbi->ll_dt_exp,
+        rc = md_get_lustre_md(sbi->ll_md_exp, &request->rq_pill,
+			      sbi->ll_dt_exp,
                               sbi->ll_md_exp, &md);
         if (rc) {
                 ptlrpc_req_finished(request);
@@ -2878,7 +2895,7 @@ void ll_open_cleanup(struct super_block *sb, struct ptlrpc_request *open_req)
 	EXIT;
 }
 
-int ll_prep_inode(struct inode **inode, struct ptlrpc_request *req,
+int ll_prep_inode(struct inode **inode, struct req_capsule *pill,
 		  struct super_block *sb, struct lookup_intent *it)
 {
 	struct ll_sb_info *sbi = NULL;
@@ -2890,7 +2907,7 @@ int ll_prep_inode(struct inode **inode, struct ptlrpc_request *req,
 
 	LASSERT(*inode || sb);
 	sbi = sb ? ll_s2sbi(sb) : ll_i2sbi(*inode);
-	rc = md_get_lustre_md(sbi->ll_md_exp, req, sbi->ll_dt_exp,
+	rc = md_get_lustre_md(sbi->ll_md_exp, pill, sbi->ll_dt_exp,
 			      sbi->ll_md_exp, &md);
 	if (rc != 0)
 		GOTO(out, rc);
@@ -103,7 +103,7 @@ struct inode *search_inode_for_lustre(struct super_block *sb,
 				PFID(fid), rc);
 		RETURN(ERR_PTR(rc));
 	}
-	rc = ll_prep_inode(&inode, req, sb, NULL);
+	rc = ll_prep_inode(&inode, &req->rq_pill, sb, NULL);
 	ptlrpc_req_finished(req);
 	if (rc)
 		RETURN(ERR_PTR(rc));
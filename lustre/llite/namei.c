@@ -662,7 +662,7 @@ static int ll_lookup_it_finish(struct ptlrpc_request *request,
 		struct mdt_body *body = req_capsule_server_get(pill,
 							       &RMF_MDT_BODY);
 
-		rc = ll_prep_inode(&inode, request, (*de)->d_sb, it);
+		rc = ll_prep_inode(&inode, &request->rq_pill, (*de)->d_sb, it);
 		if (rc)
 			RETURN(rc);
 
@@ -1262,7 +1262,7 @@ static struct inode *ll_create_node(struct inode *dir, struct lookup_intent *it)
 	LASSERT(it_disposition(it, DISP_ENQ_CREATE_REF));
 	request = it->it_request;
         it_clear_disposition(it, DISP_ENQ_CREATE_REF);
-        rc = ll_prep_inode(&inode, request, dir->i_sb, it);
+        rc = ll_prep_inode(&inode, &request->rq_pill, dir->i_sb, it);
         if (rc)
                 GOTO(out, inode = ERR_PTR(rc));
 
@@ -1493,7 +1493,7 @@ again:
 
 	CFS_FAIL_TIMEOUT(OBD_FAIL_LLITE_NEWNODE_PAUSE, cfs_fail_val);
 
-	err = ll_prep_inode(&inode, request, dchild->d_sb, NULL);
+	err = ll_prep_inode(&inode, &request->rq_pill, dchild->d_sb, NULL);
 	if (err)
 		GOTO(err_exit, err);
 
@@ -452,6 +452,8 @@ ll_read_ahead_pages(const struct lu_env *env, struct cl_io *io,
 				if (ras->ras_rpc_pages != ra.cra_rpc_pages &&
 				    ra.cra_rpc_pages > 0)
 					ras->ras_rpc_pages = ra.cra_rpc_pages;
+				if (ra.cra_bdp_pages > 0)
+					ras->ras_bdp_pages = ra.cra_bdp_pages;
 				if (!skip_index) {
 					/* trim it to align with optimal RPC size */
 					end_idx = ras_align(ras, ria->ria_end_idx + 1);
@@ -685,6 +687,77 @@ out_free_work:
 	ll_readahead_work_free(work);
 }
 
+/**
+ * Queue async readahead of pages [start_idx, end_idx] of \a file.
+ *
+ * This is used for LU_LADVISE_PREFETCH, where the application tells in
+ * advance which extents it is going to access, e.g. shuffled reads over a
+ * known index or page faults on a mmapped file, for which the readahead
+ * state machine cannot detect any pattern. The extent is split into works
+ * of at most ra_max_pages_per_file pages, the caller does not wait for the
+ * data. The works are subject to the same limits as the async readahead of
+ * kickoff_async_readahead(): the hint is trimmed to the readahead pages left
+ * in ra_max_pages and to ra_async_max_active works in flight.
+ *
+ * \retval 0		success, the hint may have been trimmed
+ * \retval negative	negative errno on error
+ */
+int ll_readahead_prefetch(struct file *file, pgoff_t start_idx,
+			  pgoff_t end_idx)
+{
+	struct inode *inode = file_inode(file);
+	struct ll_sb_info *sbi = ll_i2sbi(inode);
+	struct ll_ra_info *ra = &sbi->ll_ra_info;
+	struct ll_readahead_work *lrw;
+	unsigned long budget;
+	unsigned long pages;
+	int cur_pages;
+
+	ENTRY;
+
+	if (ra->ra_max_pages_per_file == 0 || ra->ra_max_pages == 0)
+		RETURN(0);
+
+	/* the queued works reserve their pages only when they run */
+	cur_pages = atomic_read(&ra->ra_cur_pages);
+	if (cur_pages >= sbi->ll_cache->ccc_lru_max ||
+	    cur_pages >= ra->ra_max_pages)
+		budget = 0;
+	else
+		budget = ra->ra_max_pages - cur_pages;
+
+	while (start_idx <= end_idx && budget > 0) {
+		if (atomic_read(&ra->ra_async_inflight) >
+		    ra->ra_async_max_active)
+			break;
+
+		pages = min3(end_idx - start_idx + 1, budget,
+			     ra->ra_max_pages_per_file);
+
+		/* ll_readahead_work_free() free it */
+		OBD_ALLOC_PTR(lrw);
+		if (lrw == NULL)
+			RETURN(-ENOMEM);
+
+		atomic_inc(&ra->ra_async_inflight);
+		lrw->lrw_file = get_file(file);
+		lrw->lrw_start_idx = start_idx;
+		lrw->lrw_end_idx = start_idx + pages - 1;
+		memcpy(lrw->lrw_jobid, ll_i2info(inode)->lli_jobid,
+		       sizeof(lrw->lrw_jobid));
+		ll_readahead_work_add(inode, lrw);
+		ll_ra_stats_inc(inode, RA_STAT_PREFETCH);
+
+		start_idx += pages;
+		budget -= pages;
+	}
+
+	if (start_idx <= end_idx)
+		ll_ra_stats_inc(inode, RA_STAT_MAX_IN_FLIGHT);
+
+	RETURN(0);
+}
+
 static int ll_readahead(const struct lu_env *env, struct cl_io *io,
 			struct cl_page_list *queue,
 			struct ll_readahead_state *ras, bool hit,
@@ -919,6 +992,7 @@ void ll_readahead_init(struct inode *inode, struct ll_readahead_state *ras)
 {
 	spin_lock_init(&ras->ras_lock);
 	ras->ras_rpc_pages = PTLRPC_MAX_BRW_PAGES;
+	ras->ras_bdp_pages = 0;
 	ras_reset(ras, 0);
 	ras->ras_last_read_end_bytes = 0;
 	ras->ras_requests = 0;
@@ -986,6 +1060,24 @@ stride_page_count(struct ll_readahead_state *ras, loff_t len)
 	return (bytes_count + PAGE_SIZE - 1) >> PAGE_SHIFT;
 }
 
+/*
+ * Maximum readahead window of a file.
+ *
+ * With read_ahead_adaptive, the window may grow to twice the
+ * bandwidth-delay product of the targets: deep enough to keep a
+ * high-latency path busy, shallow for a congested target, and with enough
+ * headroom to keep growing while the window itself limits the throughput.
+ */
+static unsigned long ras_window_max(struct ll_readahead_state *ras,
+				    struct ll_ra_info *ra)
+{
+	if (!ra->ra_adaptive || ras->ras_bdp_pages == 0)
+		return ra->ra_max_pages_per_file;
+
+	return min(max(ras->ras_bdp_pages * 2, ras->ras_rpc_pages),
+		   ra->ra_max_pages);
+}
+
 /* Stride Read-ahead window will be increased inc_len according to
  * stride I/O pattern */
 static void ras_stride_increase_window(struct ll_readahead_state *ras,
@@ -1034,7 +1126,7 @@ static void ras_stride_increase_window(struct ll_readahead_state *ras,
 
 out:
 	if (stride_page_count(ras, window_bytes) <=
-	    ra->ra_max_pages_per_file || ras->ras_window_pages == 0)
+	    ras_window_max(ras, ra) || ras->ras_window_pages == 0)
 		ras->ras_window_pages = (window_bytes >> PAGE_SHIFT);
 
 	LASSERT(ras->ras_window_pages > 0);
@@ -1057,12 +1149,20 @@ static void ras_increase_window(struct inode *inode,
 		pgoff_t window_pages;
 
 		window_pages = min(ras->ras_window_pages + ras->ras_rpc_pages,
-				   ra->ra_max_pages_per_file);
+				   ras_window_max(ras, ra));
 		if (window_pages < ras->ras_rpc_pages)
 			ras->ras_window_pages = window_pages;
 		else
 			ras->ras_window_pages = ras_align(ras, window_pages);
 	}
+
+	if (ra->ra_adaptive && ras->ras_bdp_pages > 0) {
+		if (ras->ras_window_pages > ra->ra_max_pages_per_file)
+			ll_ra_stats_inc(inode, RA_STAT_BDP_EXTENDED);
+		else if (ras->ras_window_pages >= ras_window_max(ras, ra) &&
+			 ras_window_max(ras, ra) < ra->ra_max_pages_per_file)
+			ll_ra_stats_inc(inode, RA_STAT_BDP_LIMITED);
+	}
 }
 
 /**
@@ -1883,8 +1983,8 @@ int ll_readpage(struct file *file, struct page *vmpage)
 	 * with lockless i/o, and buffered requires LDLM locking, so in
 	 * this case we must restart without lockless.
 	 */
-	if (file->f_flags & O_DIRECT &&
-	    lcc && lcc->lcc_type == LCC_RW &&
+	if (lcc && lcc->lcc_type == LCC_RW &&
+	    ll_iocb_is_direct(vvp_env_io(env)->vui_iocb) &&
 	    !io->ci_dio_lock) {
 		unlock_page(vmpage);
 		io->ci_dio_lock = 1;
@@ -247,6 +247,101 @@ static ssize_t ll_get_user_pages(int rw, struct iov_iter *iter,
 #endif
 }
 
+#if defined(HAVE_DIO_ITER)
+/*
+ * ll_free_bounce_pages - release the bounce pages of an unaligned direct IO
+ * @pages: array of bounce pages
+ *
+ * The pages stay alive as long as the cl_pages of the transfer hold them.
+ */
+static void ll_free_bounce_pages(struct page **pages, size_t npages)
+{
+	size_t i;
+
+	for (i = 0; i < npages; i++) {
+		if (!pages[i])
+			break;
+		put_page(pages[i]);
+	}
+
+	OBD_FREE_PTR_ARRAY_LARGE(pages, npages);
+}
+
+/*
+ * Direct IO which is not page aligned, either in the file or in the user
+ * buffer, is done through bounce pages. The data is placed in the bounce
+ * pages at the same offset in page as in the file, so that only the
+ * requested range is transferred. For a write the user data is copied to
+ * the bounce pages here, @iter is not advanced.
+ */
+static ssize_t ll_get_bounce_pages(int rw, struct iov_iter *iter,
+				   struct page ***pages, size_t *npages,
+				   loff_t file_offset, size_t maxsize)
+{
+	size_t poff = file_offset & ~PAGE_MASK;
+	size_t count = min_t(size_t, maxsize, iov_iter_count(iter));
+	size_t page_count;
+	size_t i;
+
+	if (!count)
+		return 0;
+
+	page_count = DIV_ROUND_UP(poff + count, PAGE_SIZE);
+	OBD_ALLOC_PTR_ARRAY_LARGE(*pages, page_count);
+	if (*pages == NULL)
+		return -ENOMEM;
+
+	for (i = 0; i < page_count; i++) {
+		(*pages)[i] = alloc_page(GFP_NOFS);
+		if ((*pages)[i] == NULL) {
+			ll_free_bounce_pages(*pages, page_count);
+			return -ENOMEM;
+		}
+	}
+
+	if (rw == WRITE) {
+		struct iov_iter tmp = *iter;
+		size_t left = count;
+
+		for (i = 0; i < page_count; i++) {
+			size_t bytes = min_t(size_t, left, PAGE_SIZE - poff);
+
+			if (copy_page_from_iter((*pages)[i], poff, bytes,
+						&tmp) != bytes) {
+				ll_free_bounce_pages(*pages, page_count);
+				return -EFAULT;
+			}
+			left -= bytes;
+			poff = 0;
+		}
+	}
+	*npages = page_count;
+
+	return count;
+}
+
+/* copy the data read into the bounce pages to the user buffer */
+static int ll_bounce_pages_to_iter(struct page **pages, size_t npages,
+				   loff_t file_offset, size_t count,
+				   struct iov_iter *iter)
+{
+	struct iov_iter tmp = *iter;
+	size_t poff = file_offset & ~PAGE_MASK;
+	size_t i;
+
+	for (i = 0; i < npages && count > 0; i++) {
+		size_t bytes = min_t(size_t, count, PAGE_SIZE - poff);
+
+		if (copy_page_to_iter(pages[i], poff, bytes, &tmp) != bytes)
+			return -EFAULT;
+		count -= bytes;
+		poff = 0;
+	}
+
+	return 0;
+}
+#endif
+
 /* iov_iter_alignment() is introduced in 3.16 similar to HAVE_DIO_ITER */
 #if defined(HAVE_DIO_ITER)
 static unsigned long iov_iter_alignment_vfs(const struct iov_iter *i)
@@ -320,8 +415,10 @@ struct ll_dio_pages {
 	struct page		**ldp_pages;
 	/** # of pages in the array. */
 	size_t			ldp_count;
-	/* the file offset of the first page. */
+	/* the file offset of the first byte, only it may be unaligned */
 	loff_t			ldp_file_offset;
+	/* anchor to account the pages to, the aio one if NULL */
+	struct cl_sync_io	*ldp_sync;
 };
 
 static int
@@ -331,7 +428,7 @@ ll_direct_rw_pages(const struct lu_env *env, struct cl_io *io, size_t size,
 	struct cl_page    *page;
 	struct cl_2queue  *queue = &io->ci_queue;
 	struct cl_object  *obj = io->ci_obj;
-	struct cl_sync_io *anchor = &pv->ldp_aio->cda_sync;
+	struct cl_sync_io *anchor = pv->ldp_sync ?: &pv->ldp_aio->cda_sync;
 	loff_t offset   = pv->ldp_file_offset;
 	int io_pages    = 0;
 	size_t page_size = cl_page_size(obj);
@@ -342,7 +439,9 @@ ll_direct_rw_pages(const struct lu_env *env, struct cl_io *io, size_t size,
 
 	cl_2queue_init(queue);
 	for (i = 0; i < pv->ldp_count; i++) {
-		LASSERT(!(offset & (PAGE_SIZE - 1)));
+		size_t from = offset & (page_size - 1);
+		size_t to = min(from + size, page_size);
+
 		page = cl_page_find(env, obj, cl_index(obj, offset),
 				    pv->ldp_pages[i], CPT_TRANSIENT);
 		if (IS_ERR(page)) {
@@ -372,13 +471,13 @@ ll_direct_rw_pages(const struct lu_env *env, struct cl_io *io, size_t size,
 		 * Set page clip to tell transfer formation engine
 		 * that page has to be sent even if it is beyond KMS.
 		 */
-		cl_page_clip(env, page, 0, min(size, page_size));
+		cl_page_clip(env, page, from, to);
 		++io_pages;
 
 		/* drop the reference count for cl_page_find */
 		cl_page_put(env, page);
-		offset += page_size;
-		size -= page_size;
+		offset += to - from;
+		size -= to - from;
 	}
 	if (rc == 0 && io_pages > 0) {
 		int iot = rw == READ ? CRT_READ : CRT_WRITE;
@@ -429,6 +528,65 @@ ll_direct_rw_pages(const struct lu_env *env, struct cl_io *io, size_t size,
 #define MAX_DIO_SIZE ((MAX_MALLOC / sizeof(struct brw_page) * PAGE_SIZE) & \
 		      ~((size_t)DT_MAX_BRW_SIZE - 1))
 
+#if defined(HAVE_DIO_ITER)
+/*
+ * Unaligned direct IO of up to @size bytes through bounce pages.
+ *
+ * Writes stay asynchronous, the bounce pages are released with the pages of
+ * the aio. Reads are waited for, so the data can be copied to the user buffer
+ * from the context of the caller, the RPCs of the chunk are still sent in
+ * parallel. Returns the number of bytes done.
+ */
+static ssize_t
+ll_direct_rw_bounce(const struct lu_env *env, struct cl_io *io, size_t size,
+		    int rw, struct inode *inode, struct iov_iter *iter,
+		    struct ll_dio_pages *pv)
+{
+	struct cl_sync_io anchor;
+	struct page **pages;
+	ssize_t count;
+	int rc;
+
+	count = ll_get_bounce_pages(rw, iter, &pages, &pv->ldp_count,
+				    pv->ldp_file_offset, size);
+	if (count <= 0)
+		return count;
+
+	pv->ldp_pages = pages;
+	if (rw == READ) {
+		cl_sync_io_init(&anchor, 1);
+		pv->ldp_sync = &anchor;
+	}
+
+	rc = ll_direct_rw_pages(env, io, count, rw, inode, pv);
+
+	if (rw == READ) {
+		int rc2;
+
+		/* drop the initial reference and wait for the pages */
+		cl_sync_io_note(env, &anchor, rc);
+		rc2 = cl_sync_io_wait(env, &anchor, 0);
+		if (rc == 0)
+			rc = rc2;
+		if (rc == 0)
+			rc = ll_bounce_pages_to_iter(pages, pv->ldp_count,
+						     pv->ldp_file_offset,
+						     count, iter);
+	}
+	ll_free_bounce_pages(pages, pv->ldp_count);
+
+	return rc < 0 ? rc : count;
+}
+#else
+static ssize_t
+ll_direct_rw_bounce(const struct lu_env *env, struct cl_io *io, size_t size,
+		    int rw, struct inode *inode, struct iov_iter *iter,
+		    struct ll_dio_pages *pv)
+{
+	return -EINVAL;
+}
+#endif
+
 static ssize_t
 ll_direct_IO_impl(struct kiocb *iocb, struct iov_iter *iter, int rw)
 {
@@ -442,24 +600,31 @@ ll_direct_IO_impl(struct kiocb *iocb, struct iov_iter *iter, int rw)
 	ssize_t tot_bytes = 0, result = 0;
 	loff_t file_offset = iocb->ki_pos;
 	struct vvp_io *vio;
+	bool unaligned;
 
 	/* Check EOF by ourselves */
 	if (rw == READ && file_offset >= i_size_read(inode))
 		return 0;
 
-	/* FIXME: io smaller than PAGE_SIZE is broken on ia64 ??? */
-	if (file_offset & ~PAGE_MASK)
+	/*
+	 * Unaligned IO goes through bounce pages, except for encrypted files
+	 * which need whole pages to be encrypted.
+	 */
+	unaligned = (file_offset & ~PAGE_MASK) ||
+		    (ll_iov_iter_alignment(iter) & ~PAGE_MASK);
+#if defined(HAVE_DIO_ITER)
+	if (unaligned && (file_offset & ~PAGE_MASK) && IS_ENCRYPTED(inode))
 		RETURN(-EINVAL);
+#else
+	if (unaligned)
+		RETURN(-EINVAL);
+#endif
 
 	CDEBUG(D_VFSTRACE, "VFS Op:inode="DFID"(%p), size=%zd (max %lu), "
-	       "offset=%lld=%llx, pages %zd (max %lu)\n",
+	       "offset=%lld=%llx, pages %zd (max %lu)%s\n",
 	       PFID(ll_inode2fid(inode)), inode, count, MAX_DIO_SIZE,
 	       file_offset, file_offset, count >> PAGE_SHIFT,
-	       MAX_DIO_SIZE >> PAGE_SHIFT);
-
-	/* Check that all user buffers are aligned as well */
-	if (ll_iov_iter_alignment(iter) & ~PAGE_MASK)
-		RETURN(-EINVAL);
+	       MAX_DIO_SIZE >> PAGE_SHIFT, unaligned ? ", unaligned" : "");
 
 	lcc = ll_cl_find(file);
 	if (lcc == NULL)
@@ -488,21 +653,31 @@ ll_direct_IO_impl(struct kiocb *iocb, struct iov_iter *iter, int rw)
 				count = i_size_read(inode) - file_offset;
 		}
 
-		result = ll_get_user_pages(rw, iter, &pages,
-					   &pvec.ldp_count, count);
-		if (unlikely(result <= 0))
-			GOTO(out, result);
-
-		count = result;
 		pvec.ldp_file_offset = file_offset;
-		pvec.ldp_pages = pages;
+		if (unaligned) {
+			result = ll_direct_rw_bounce(env, io, count, rw, inode,
+						     iter, &pvec);
+			if (unlikely(result <= 0))
+				GOTO(out, result);
+
+			count = result;
+			result = 0;
+		} else {
+			result = ll_get_user_pages(rw, iter, &pages,
+						   &pvec.ldp_count, count);
+			if (unlikely(result <= 0))
+				GOTO(out, result);
 
-		result = ll_direct_rw_pages(env, io, count,
-					    rw, inode, &pvec);
-		ll_free_user_pages(pages, pvec.ldp_count);
+			count = result;
+			pvec.ldp_pages = pages;
 
-		if (unlikely(result < 0))
-			GOTO(out, result);
+			result = ll_direct_rw_pages(env, io, count,
+						    rw, inode, &pvec);
+			ll_free_user_pages(pages, pvec.ldp_count);
+
+			if (unlikely(result < 0))
+				GOTO(out, result);
+		}
 
 		iov_iter_advance(iter, count);
 		tot_bytes += count;
@@ -685,7 +860,7 @@ static int ll_write_begin(struct file *file, struct address_space *mapping,
 	env = lcc->lcc_env;
 	io  = lcc->lcc_io;
 
-	if (file->f_flags & O_DIRECT) {
+	if (ll_iocb_is_direct(vvp_env_io(env)->vui_iocb)) {
 		/* direct IO failed because it couldn't clean up cached pages,
 		 * this causes a problem for mirror write because the cached
 		 * page may belong to another mirror, which will result in
@@ -76,6 +76,8 @@ struct sa_entry {
 	struct md_enqueue_info *se_minfo;
 	/* pointer to the async getattr request */
 	struct ptlrpc_request  *se_req;
+	/* capsule of the async getattr request, or of its batch sub-request */
+	struct req_capsule     *se_pill;
 	/* pointer to the target inode */
 	struct inode	       *se_inode;
 	/* entry name */
@@ -348,7 +350,7 @@ static void sa_fini_data(struct md_enqueue_info *minfo)
 	OBD_FREE_PTR(minfo);
 }
 
-static int ll_statahead_interpret(struct ptlrpc_request *req,
+static int ll_statahead_interpret(struct req_capsule *pill,
 				  struct md_enqueue_info *minfo, int rc);
 
 /*
@@ -413,6 +415,7 @@ sa_make_ready(struct ll_statahead_info *sai, struct sa_entry *entry, int ret)
 
 	if (req) {
 		entry->se_req = NULL;
+		entry->se_pill = NULL;
 		ptlrpc_req_finished(req);
 	}
 
@@ -641,7 +644,7 @@ static void sa_instantiate(struct ll_statahead_info *sai,
 	struct inode *child;
 	struct md_enqueue_info *minfo;
 	struct lookup_intent *it;
-	struct ptlrpc_request *req;
+	struct req_capsule *pill;
 	struct mdt_body *body;
 	int rc = 0;
 
@@ -651,8 +654,8 @@ static void sa_instantiate(struct ll_statahead_info *sai,
 
 	minfo = entry->se_minfo;
 	it = &minfo->mi_it;
-	req = entry->se_req;
-	body = req_capsule_server_get(&req->rq_pill, &RMF_MDT_BODY);
+	pill = entry->se_pill;
+	body = req_capsule_server_get(pill, &RMF_MDT_BODY);
 	if (!body)
 		GOTO(out, rc = -EFAULT);
 
@@ -672,7 +675,7 @@ static void sa_instantiate(struct ll_statahead_info *sai,
 	if (rc != 1)
 		GOTO(out, rc = -EAGAIN);
 
-	rc = ll_prep_inode(&child, req, dir->i_sb, it);
+	rc = ll_prep_inode(&child, pill, dir->i_sb, it);
 	if (rc)
 		GOTO(out, rc);
 
@@ -724,7 +727,7 @@ static void sa_handle_callback(struct ll_statahead_info *sai)
  * only put sa_entry in sai_interim_entries, and wake up statahead thread to
  * really prepare inode and instantiate sa_entry later.
  */
-static int ll_statahead_interpret(struct ptlrpc_request *req,
+static int ll_statahead_interpret(struct req_capsule *pill,
 				  struct md_enqueue_info *minfo, int rc)
 {
 	struct lookup_intent *it = &minfo->mi_it;
@@ -772,7 +775,8 @@ static int ll_statahead_interpret(struct ptlrpc_request *req,
 		int first = 0;
 
 		entry->se_minfo = minfo;
-		entry->se_req = ptlrpc_request_addref(req);
+		entry->se_req = ptlrpc_request_addref(pill->rc_req);
+		entry->se_pill = pill;
 		/*
 		 * Release the async ibits lock ASAP to avoid deadlock
 		 * when statahead thread tries to enqueue lock on parent
@@ -794,6 +798,27 @@ static int ll_statahead_interpret(struct ptlrpc_request *req,
 	RETURN(rc);
 }
 
+/*
+ * send async stat RPC, or pack it into the statahead batch which is sent
+ * once full or when the statahead thread is about to wait.
+ */
+static int sa_getattr(struct inode *dir, struct md_enqueue_info *minfo)
+{
+	struct ll_statahead_info *sai = ll_i2info(dir)->lli_sai;
+
+	if (sai->sai_bh)
+		return md_batch_add(ll_i2mdexp(dir), sai->sai_bh, minfo);
+
+	return md_intent_getattr_async(ll_i2mdexp(dir), minfo);
+}
+
+/* send the statahead getattr requests batched so far */
+static inline void sa_flush(struct inode *dir, struct ll_statahead_info *sai)
+{
+	if (sai->sai_bh)
+		md_batch_flush(ll_i2mdexp(dir), sai->sai_bh, false);
+}
+
 /* async stat for file not found in dcache */
 static int sa_lookup(struct inode *dir, struct sa_entry *entry)
 {
@@ -806,7 +831,7 @@ static int sa_lookup(struct inode *dir, struct sa_entry *entry)
 	if (IS_ERR(minfo))
 		RETURN(PTR_ERR(minfo));
 
-	rc = md_intent_getattr_async(ll_i2mdexp(dir), minfo);
+	rc = sa_getattr(dir, minfo);
 	if (rc < 0)
 		sa_fini_data(minfo);
 
@@ -851,7 +876,7 @@ static int sa_revalidate(struct inode *dir, struct sa_entry *entry,
 		RETURN(1);
 	}
 
-	rc = md_intent_getattr_async(ll_i2mdexp(dir), minfo);
+	rc = sa_getattr(dir, minfo);
 	if (rc < 0) {
 		entry->se_inode = NULL;
 		iput(inode);
@@ -1022,6 +1047,18 @@ static int ll_statahead_thread(void *arg)
 	if (!op_data)
 		GOTO(out, rc = -ENOMEM);
 
+	if (sbi->ll_sa_batch_max > 0) {
+		struct lu_batch *bh;
+
+		bh = md_batch_create(ll_i2mdexp(dir), sbi->ll_sa_batch_max);
+		if (IS_ERR(bh))
+			CDEBUG(D_READA,
+			       "%s: cannot create statahead batch, use async getattr: rc = %ld\n",
+			       sbi->ll_fsname, PTR_ERR(bh));
+		else
+			sai->sai_bh = bh;
+	}
+
 	while (pos != MDS_DIR_END_OFF && sai->sai_task) {
 		struct lu_dirpage *dp;
 		struct lu_dirent  *ent;
@@ -1125,13 +1162,21 @@ static int ll_statahead_thread(void *arg)
 
 				if (!sa_sent_full(sai))
 					break;
-				schedule();
+
+				__set_current_state(TASK_RUNNING);
+				sa_flush(dir, sai);
+				set_current_state(TASK_IDLE);
+				if (sa_sent_full(sai) && !sa_has_callback(sai))
+					schedule();
 			}
 			__set_current_state(TASK_RUNNING);
 
 			sa_statahead(parent, name, namelen, &fid);
 		}
 
+		/* don't keep the requests of this page waiting for the next */
+		sa_flush(dir, sai);
+
 		pos = le64_to_cpu(dp->ldp_hash_end);
 		ll_release_page(dir, page,
 				le32_to_cpu(dp->ldp_flags) & LDF_COLLIDE);
@@ -1149,6 +1194,11 @@ static int ll_statahead_thread(void *arg)
 	}
 	ll_finish_md_op_data(op_data);
 
+	if (sai->sai_bh) {
+		md_batch_stop(ll_i2mdexp(dir), sai->sai_bh);
+		sai->sai_bh = NULL;
+	}
+
 	if (rc < 0) {
 		spin_lock(&lli->lli_sa_lock);
 		sai->sai_task = NULL;
@@ -3368,7 +3368,7 @@ lmv_lock_match(struct obd_export *exp, __u64 flags,
 }
 
 static int
-lmv_get_lustre_md(struct obd_export *exp, struct ptlrpc_request *req,
+lmv_get_lustre_md(struct obd_export *exp, struct req_capsule *pill,
 		  struct obd_export *dt_exp, struct obd_export *md_exp,
 		  struct lustre_md *md)
 {
@@ -3378,7 +3378,7 @@ lmv_get_lustre_md(struct obd_export *exp, struct ptlrpc_request *req,
 	if (!tgt || !tgt->ltd_exp)
 		return -EINVAL;
 
-	return md_get_lustre_md(tgt->ltd_exp, req, dt_exp, md_exp, md);
+	return md_get_lustre_md(tgt->ltd_exp, pill, dt_exp, md_exp, md);
 }
 
 static int lmv_free_lustre_md(struct obd_export *exp, struct lustre_md *md)
@@ -3435,37 +3435,170 @@ static int lmv_clear_open_replay_data(struct obd_export *exp,
 	RETURN(md_clear_open_replay_data(tgt->ltd_exp, och));
 }
 
-static int lmv_intent_getattr_async(struct obd_export *exp,
-				    struct md_enqueue_info *minfo)
+static struct lmv_tgt_desc *
+lmv_intent_getattr_async_tgt(struct lmv_obd *lmv,
+			     struct md_enqueue_info *minfo)
 {
 	struct md_op_data *op_data = &minfo->mi_data;
-	struct obd_device *obd = exp->exp_obd;
-	struct lmv_obd *lmv = &obd->u.lmv;
 	struct lmv_tgt_desc *ptgt;
 	struct lmv_tgt_desc *ctgt;
-	int rc;
-
-	ENTRY;
 
 	if (!fid_is_sane(&op_data->op_fid2))
-		RETURN(-EINVAL);
+		return ERR_PTR(-EINVAL);
 
 	ptgt = lmv_locate_tgt(lmv, op_data);
 	if (IS_ERR(ptgt))
-		RETURN(PTR_ERR(ptgt));
+		return ptgt;
 
 	ctgt = lmv_fid2tgt(lmv, &op_data->op_fid2);
 	if (IS_ERR(ctgt))
-		RETURN(PTR_ERR(ctgt));
+		return ctgt;
 
 	/*
 	 * remote object needs two RPCs to lookup and getattr, considering the
 	 * complexity don't support statahead for now.
 	 */
 	if (ctgt != ptgt)
-		RETURN(-EREMOTE);
+		return ERR_PTR(-EREMOTE);
+
+	return ptgt;
+}
+
+static int lmv_intent_getattr_async(struct obd_export *exp,
+				    struct md_enqueue_info *minfo)
+{
+	struct lmv_tgt_desc *tgt;
+	int rc;
+
+	ENTRY;
+
+	tgt = lmv_intent_getattr_async_tgt(&exp->exp_obd->u.lmv, minfo);
+	if (IS_ERR(tgt))
+		RETURN(PTR_ERR(tgt));
+
+	rc = md_intent_getattr_async(tgt->ltd_exp, minfo);
+
+	RETURN(rc);
+}
+
+/* batch of requests sent to one MDT */
+struct lmv_sub_batch {
+	struct list_head	 sbh_sub_item;
+	struct lmv_tgt_desc	*sbh_tgt;
+	struct lu_batch		*sbh_sub;
+};
+
+struct lmv_batch {
+	struct lu_batch		 lbh_super;
+	struct list_head	 lbh_sub_batch_list;
+};
+
+static struct lu_batch *lmv_batch_create(struct obd_export *exp,
+					 __u32 max_count)
+{
+	struct lmv_batch *lbh;
+
+	ENTRY;
+
+	OBD_ALLOC_PTR(lbh);
+	if (lbh == NULL)
+		RETURN(ERR_PTR(-ENOMEM));
+
+	lbh->lbh_super.lbt_max_count = max_count;
+	INIT_LIST_HEAD(&lbh->lbh_sub_batch_list);
+
+	RETURN(&lbh->lbh_super);
+}
+
+static int lmv_batch_stop(struct obd_export *exp, struct lu_batch *bh)
+{
+	struct lmv_batch *lbh = container_of(bh, struct lmv_batch, lbh_super);
+	struct lmv_sub_batch *sub;
+	struct lmv_sub_batch *tmp;
+	int rc = 0;
+	int rc1;
+
+	ENTRY;
+
+	list_for_each_entry_safe(sub, tmp, &lbh->lbh_sub_batch_list,
+				 sbh_sub_item) {
+		list_del(&sub->sbh_sub_item);
+		rc1 = md_batch_stop(sub->sbh_tgt->ltd_exp, sub->sbh_sub);
+		if (rc == 0)
+			rc = rc1;
+		OBD_FREE_PTR(sub);
+	}
+
+	OBD_FREE_PTR(lbh);
+	RETURN(rc);
+}
+
+static int lmv_batch_flush(struct obd_export *exp, struct lu_batch *bh,
+			   bool wait)
+{
+	struct lmv_batch *lbh = container_of(bh, struct lmv_batch, lbh_super);
+	struct lmv_sub_batch *sub;
+	int rc = 0;
+	int rc1;
+
+	ENTRY;
+
+	list_for_each_entry(sub, &lbh->lbh_sub_batch_list, sbh_sub_item) {
+		rc1 = md_batch_flush(sub->sbh_tgt->ltd_exp, sub->sbh_sub, wait);
+		if (rc == 0)
+			rc = rc1;
+	}
+
+	RETURN(rc);
+}
+
+static struct lu_batch *lmv_batch_lookup_sub(struct lmv_batch *lbh,
+					     struct lmv_tgt_desc *tgt)
+{
+	struct lmv_sub_batch *sub;
+	struct lu_batch *bh;
+
+	list_for_each_entry(sub, &lbh->lbh_sub_batch_list, sbh_sub_item) {
+		if (sub->sbh_tgt == tgt)
+			return sub->sbh_sub;
+	}
+
+	OBD_ALLOC_PTR(sub);
+	if (sub == NULL)
+		return ERR_PTR(-ENOMEM);
+
+	bh = md_batch_create(tgt->ltd_exp, lbh->lbh_super.lbt_max_count);
+	if (IS_ERR(bh)) {
+		OBD_FREE_PTR(sub);
+		return bh;
+	}
+
+	sub->sbh_tgt = tgt;
+	sub->sbh_sub = bh;
+	list_add_tail(&sub->sbh_sub_item, &lbh->lbh_sub_batch_list);
+
+	return bh;
+}
+
+static int lmv_batch_add(struct obd_export *exp, struct lu_batch *bh,
+			 struct md_enqueue_info *minfo)
+{
+	struct lmv_batch *lbh = container_of(bh, struct lmv_batch, lbh_super);
+	struct lmv_tgt_desc *tgt;
+	struct lu_batch *sub;
+	int rc;
+
+	ENTRY;
+
+	tgt = lmv_intent_getattr_async_tgt(&exp->exp_obd->u.lmv, minfo);
+	if (IS_ERR(tgt))
+		RETURN(PTR_ERR(tgt));
+
+	sub = lmv_batch_lookup_sub(lbh, tgt);
+	if (IS_ERR(sub))
+		RETURN(PTR_ERR(sub));
 
-	rc = md_intent_getattr_async(ptgt->ltd_exp, minfo);
+	rc = md_batch_add(tgt->ltd_exp, sub, minfo);
 
 	RETURN(rc);
 }
@@ -3655,6 +3788,10 @@ static const struct md_ops lmv_md_ops = {
 	.m_get_fid_from_lsm	= lmv_get_fid_from_lsm,
 	.m_unpackmd		= lmv_unpackmd,
 	.m_rmfid		= lmv_rmfid,
+	.m_batch_create		= lmv_batch_create,
+	.m_batch_stop		= lmv_batch_stop,
+	.m_batch_flush		= lmv_batch_flush,
+	.m_batch_add		= lmv_batch_add,
 };
 
 static int __init lmv_init(void)
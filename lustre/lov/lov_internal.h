@@ -253,6 +253,7 @@ struct lov_request_set {
 };
 
 extern struct kmem_cache *lov_oinfo_slab;
+extern struct workqueue_struct *lov_dio_wq;
 
 extern struct lu_kmem_descr lov_caches[];
 
@@ -1192,6 +1192,9 @@ static int lov_io_read_ahead(const struct lu_env *env,
 	if (r0->lo_nr == 1) /* single stripe file */
 		RETURN(0);
 
+	/* the readahead window spans all stripes, read in parallel */
+	ra->cra_bdp_pages *= r0->lo_nr;
+
 	pps = lov_lse(loo, index)->lsme_stripe_size >> PAGE_SHIFT;
 
 	CDEBUG(D_READA, DFID " max_index = %lu, pps = %u, index = %d, "
@@ -1259,6 +1262,123 @@ int lov_io_lru_reserve(const struct lu_env *env,
 	RETURN(0);
 }
 
+/* submission of the direct IO pages of one stripe */
+struct lov_io_submit_work {
+	struct list_head	 lsw_linkage;
+	struct work_struct	 lsw_work;
+	struct completion	 lsw_done;
+	struct lov_io_sub	*lsw_sub;
+	enum cl_req_type	 lsw_crt;
+	struct cl_2queue	 lsw_queue;
+	int			 lsw_rc;
+};
+
+static void lov_io_submit_work_handler(struct work_struct *work)
+{
+	struct lov_io_submit_work *lsw;
+
+	lsw = container_of(work, struct lov_io_submit_work, lsw_work);
+	lsw->lsw_rc = cl_io_submit_rw(lsw->lsw_sub->sub_env,
+				      &lsw->lsw_sub->sub_io, lsw->lsw_crt,
+				      &lsw->lsw_queue);
+	complete(&lsw->lsw_done);
+}
+
+/*
+ * Direct IO pages spanning several stripes are submitted in parallel, so a
+ * single thread can keep all OSTs busy: the page preparation and queueing of
+ * each stripe but the first run from lov_dio_wq, the sub-io of each stripe
+ * having its own environment.
+ */
+static bool lov_io_submit_parallel(struct lov_io *lio,
+				   struct cl_page_list *qin)
+{
+	struct lov_device *ld = lu2lov_dev(lio->lis_object->lo_cl.co_lu.lo_dev);
+	struct cl_page *first = cl_page_list_first(qin);
+	struct cl_page *page;
+	bool multi = false;
+
+	if (!ld->ld_lov->lov_parallel_dio || first->cp_type != CPT_TRANSIENT)
+		return false;
+
+	cl_page_list_for_each(page, qin) {
+		if (lov_page_is_empty(page))
+			return false;
+		if (page->cp_lov_index != first->cp_lov_index)
+			multi = true;
+	}
+
+	return multi;
+}
+
+static int lov_io_submit_dio(const struct lu_env *env, struct lov_io *lio,
+			     enum cl_req_type crt, struct cl_2queue *queue)
+{
+	struct cl_page_list *qin = &queue->c2_qin;
+	struct lov_io_submit_work *lsw;
+	struct lov_io_submit_work *first = NULL;
+	struct lov_io_submit_work *tmp;
+	struct cl_page *page;
+	struct cl_page *pg_tmp;
+	LIST_HEAD(works);
+	int rc = 0;
+
+	ENTRY;
+
+	while (qin->pl_nr > 0) {
+		struct lov_io_sub *sub;
+		int index;
+
+		index = cl_page_list_first(qin)->cp_lov_index;
+		sub = lov_sub_get(env, lio, index);
+		if (IS_ERR(sub)) {
+			rc = PTR_ERR(sub);
+			break;
+		}
+
+		OBD_ALLOC_PTR(lsw);
+		if (lsw == NULL) {
+			rc = -ENOMEM;
+			break;
+		}
+
+		INIT_WORK(&lsw->lsw_work, lov_io_submit_work_handler);
+		init_completion(&lsw->lsw_done);
+		lsw->lsw_sub = sub;
+		lsw->lsw_crt = crt;
+		cl_2queue_init(&lsw->lsw_queue);
+		cl_page_list_for_each_safe(page, pg_tmp, qin) {
+			if (page->cp_lov_index == index)
+				cl_page_list_move(&lsw->lsw_queue.c2_qin, qin,
+						  page);
+		}
+		list_add_tail(&lsw->lsw_linkage, &works);
+	}
+
+	list_for_each_entry(lsw, &works, lsw_linkage) {
+		if (first == NULL)
+			first = lsw;
+		else
+			queue_work(lov_dio_wq, &lsw->lsw_work);
+	}
+	if (first != NULL)
+		lov_io_submit_work_handler(&first->lsw_work);
+
+	list_for_each_entry_safe(lsw, tmp, &works, lsw_linkage) {
+		wait_for_completion(&lsw->lsw_done);
+		if (rc == 0)
+			rc = lsw->lsw_rc;
+
+		cl_page_list_splice(&lsw->lsw_queue.c2_qin, qin);
+		cl_page_list_splice(&lsw->lsw_queue.c2_qout, &queue->c2_qout);
+		cl_2queue_fini(env, &lsw->lsw_queue);
+		list_del(&lsw->lsw_linkage);
+		OBD_FREE_PTR(lsw);
+	}
+
+	RETURN(rc);
+}
+
 /**
  * lov implementation of cl_operations::cio_submit() method. It takes a list
  * of pages in \a queue, splits it into per-stripe sub-lists, invokes
@@ -1288,6 +1408,9 @@ static int lov_io_submit(const struct lu_env *env,
 	int rc = 0;
 	ENTRY;
 
+	if (qin->pl_nr > 1 && lov_io_submit_parallel(lio, qin))
+		RETURN(lov_io_submit_dio(env, lio, crt, queue));
+
 	cl_page_list_init(plist);
 	while (qin->pl_nr > 0) {
 		struct cl_2queue  *cl2q = &lov_env_info(env)->lti_cl2q;
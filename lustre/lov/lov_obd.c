@@ -746,6 +746,7 @@ int lov_setup(struct obd_device *obd, struct lustre_cfg *lcfg)
 	mutex_init(&lov->lov_lock);
 	atomic_set(&lov->lov_refcount, 0);
 	lov->lov_sp_me = LUSTRE_SP_CLI;
+	lov->lov_parallel_dio = true;
 
 	init_rwsem(&lov->lov_notify_lock);
 
@@ -1301,6 +1302,7 @@ static const struct obd_ops lov_obd_ops = {
 };
 
 struct kmem_cache *lov_oinfo_slab;
+struct workqueue_struct *lov_dio_wq;
 
 static int __init lov_init(void)
 {
@@ -1324,9 +1326,17 @@ static int __init lov_init(void)
                 return -ENOMEM;
         }
 
+	lov_dio_wq = alloc_workqueue("lov_dio", WQ_UNBOUND | WQ_HIGHPRI, 0);
+	if (lov_dio_wq == NULL) {
+		kmem_cache_destroy(lov_oinfo_slab);
+		lu_kmem_fini(lov_caches);
+		return -ENOMEM;
+	}
+
 	rc = class_register_type(&lov_obd_ops, NULL, true,
 				 LUSTRE_LOV_NAME, &lov_device_type);
         if (rc) {
+		destroy_workqueue(lov_dio_wq);
 		kmem_cache_destroy(lov_oinfo_slab);
                 lu_kmem_fini(lov_caches);
         }
@@ -1337,6 +1347,7 @@ static int __init lov_init(void)
 static void __exit lov_exit(void)
 {
 	class_unregister_type(LUSTRE_LOV_NAME);
+	destroy_workqueue(lov_dio_wq);
 	kmem_cache_destroy(lov_oinfo_slab);
 	lu_kmem_fini(lov_caches);
 }
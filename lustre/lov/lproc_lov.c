@@ -265,6 +265,33 @@ static const struct proc_ops lov_proc_target_fops = {
 };
 #endif /* CONFIG_PROC_FS */
 
+static ssize_t parallel_dio_show(struct kobject *kobj, struct attribute *attr,
+				 char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+
+	return sprintf(buf, "%u\n", obd->u.lov.lov_parallel_dio);
+}
+
+static ssize_t parallel_dio_store(struct kobject *kobj, struct attribute *attr,
+				  const char *buffer, size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	bool val;
+	int rc;
+
+	rc = kstrtobool(buffer, &val);
+	if (rc)
+		return rc;
+
+	obd->u.lov.lov_parallel_dio = val;
+
+	return count;
+}
+LUSTRE_RW_ATTR(parallel_dio);
+
 static struct attribute *lov_attrs[] = {
 	&lustre_attr_activeobd.attr,
 	&lustre_attr_numobd.attr,
@@ -273,6 +300,7 @@ static struct attribute *lov_attrs[] = {
 	&lustre_attr_stripeoffset.attr,
 	&lustre_attr_stripetype.attr,
 	&lustre_attr_stripecount.attr,
+	&lustre_attr_parallel_dio.attr,
 	NULL,
 };
 
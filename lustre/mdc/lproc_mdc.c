@@ -363,11 +363,11 @@ static int mdc_cached_mb_seq_show(struct seq_file *m, void *v)
 
 	seq_printf(m, "used_mb: %ld\n"
 		   "busy_cnt: %ld\n"
-		   "reclaim: %llu\n",
-		   (atomic_long_read(&cli->cl_lru_in_list) +
+		   "reclaim: %ld\n",
+		   (cli_lru_in_list(cli) +
 		    atomic_long_read(&cli->cl_lru_busy)) >> shift,
 		    atomic_long_read(&cli->cl_lru_busy),
-		   cli->cl_lru_reclaim);
+		   atomic_long_read(&cli->cl_lru_reclaim));
 
 	return 0;
 }
@@ -399,7 +399,7 @@ mdc_cached_mb_seq_write(struct file *file, const char __user *buffer,
 
 	pages_number >>= PAGE_SHIFT;
 
-	rc = atomic_long_read(&cli->cl_lru_in_list) - pages_number;
+	rc = cli_lru_in_list(cli) - pages_number;
 	if (rc > 0) {
 		struct lu_env *env;
 		__u16 refcheck;
@@ -440,6 +440,7 @@ static ssize_t mdc_rpc_stats_seq_write(struct file *file,
 	struct client_obd *cli = &obd->u.cli;
 
 	lprocfs_oh_clear(&cli->cl_mod_rpcs_hist);
+	lprocfs_oh_clear(&cli->cl_batch_rpc_hist);
 
 	lprocfs_oh_clear(&cli->cl_read_rpc_hist);
 	lprocfs_oh_clear(&cli->cl_write_rpc_hist);
@@ -539,6 +540,23 @@ static int mdc_rpc_stats_seq_show(struct seq_file *seq, void *v)
 		if (read_cum == read_tot && write_cum == write_tot)
 			break;
 	}
+
+	seq_printf(seq, "\n\t\t\tbatch\n");
+	seq_printf(seq, "sub-reqs per rpc      rpcs   %% cum %%\n");
+
+	read_tot = lprocfs_oh_sum(&cli->cl_batch_rpc_hist);
+
+	read_cum = 0;
+	for (i = 0; i < OBD_HIST_MAX; i++) {
+		unsigned long r = cli->cl_batch_rpc_hist.oh_buckets[i];
+
+		read_cum += r;
+		seq_printf(seq, "%d:\t\t%10lu %3u %3u\n",
+			   1 << i, r, pct(r, read_tot),
+			   pct(read_cum, read_tot));
+		if (read_cum == read_tot)
+			break;
+	}
 	spin_unlock(&cli->cl_loi_list_lock);
 
 	return 0;
@@ -0,0 +1,399 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ *
+ * lustre/mdc/mdc_batch.c
+ *
+ * Batch metadata RPC (MDS_BATCH) client
+ */
+
+#define DEBUG_SUBSYSTEM S_MDC
+
+#include <lustre_acl.h>
+
+#include "mdc_internal.h"
+
+struct mdc_batch {
+	struct lu_batch			  mbh_super;
+	/* batch RPC being filled */
+	struct ptlrpc_request		 *mbh_req;
+	/* requests packed into mbh_req */
+	struct md_enqueue_info		**mbh_items;
+	/* space for the sub-requests in the batch request buffer */
+	__u32				  mbh_reqlen;
+	/* offset of the next sub-request in the batch request buffer */
+	__u32				  mbh_reqoff;
+	/* size of the reply buffer needed by all the sub-requests */
+	__u32				  mbh_repsize;
+};
+
+struct mdc_batch_args {
+	struct obd_export		 *ba_exp;
+	struct md_enqueue_info		**ba_items;
+	__u32				  ba_count;
+	__u32				  ba_max_count;
+};
+
+static inline struct batch_update_request *
+mdc_batch_burq(struct ptlrpc_request *req)
+{
+	return req_capsule_client_get(&req->rq_pill, &RMF_BUT_REQUEST);
+}
+
+static inline struct lustre_msg *
+mdc_batch_msg(struct lustre_msg *first, __u32 offset)
+{
+	return (struct lustre_msg *)((char *)first + offset);
+}
+
+static int mdc_batch_prep(struct obd_export *exp, struct mdc_batch *mbh)
+{
+	struct ptlrpc_request *req;
+	struct batch_update_request *burq;
+	__u32 hdrlen;
+	int rc;
+
+	ENTRY;
+
+	req = ptlrpc_request_alloc(class_exp2cliimp(exp), &RQF_MDS_BATCH);
+	if (req == NULL)
+		RETURN(-ENOMEM);
+
+	req_capsule_set_size(&req->rq_pill, &RMF_BUT_REQUEST, RCL_CLIENT, 0);
+	hdrlen = req_capsule_msg_size(&req->rq_pill, RCL_CLIENT);
+	req_capsule_set_size(&req->rq_pill, &RMF_BUT_REQUEST, RCL_CLIENT,
+			     BUT_MAXREQSIZE - hdrlen);
+
+	rc = ptlrpc_request_pack(req, LUSTRE_MDS_VERSION, MDS_BATCH);
+	if (rc) {
+		ptlrpc_request_free(req);
+		RETURN(rc);
+	}
+
+	OBD_ALLOC_PTR_ARRAY(mbh->mbh_items, mbh->mbh_super.lbt_max_count);
+	if (mbh->mbh_items == NULL) {
+		ptlrpc_req_finished(req);
+		RETURN(-ENOMEM);
+	}
+
+	burq = mdc_batch_burq(req);
+	burq->burq_magic = BUT_REQUEST_MAGIC;
+	burq->burq_count = 0;
+	burq->burq_reply_size = 0;
+
+	mbh->mbh_req = req;
+	mbh->mbh_reqlen = BUT_MAXREQSIZE - hdrlen - sizeof(*burq);
+	mbh->mbh_reqoff = 0;
+	mbh->mbh_repsize = 0;
+
+	RETURN(0);
+}
+
+static int mdc_batch_interpret(const struct lu_env *env,
+			       struct ptlrpc_request *req,
+			       void *args, int rc)
+{
+	struct mdc_batch_args *aa = args;
+	struct batch_update_request *burq = mdc_batch_burq(req);
+	struct batch_update_reply *burp = NULL;
+	__u32 replen = 0;
+	__u32 reqoff = 0;
+	__u32 repoff = 0;
+	int i;
+
+	ENTRY;
+
+	obd_put_request_slot(&aa->ba_exp->exp_obd->u.cli);
+
+	if (rc == 0) {
+		burp = req_capsule_server_get(&req->rq_pill, &RMF_BUT_REPLY);
+		if (burp == NULL || burp->burp_magic != BUT_REPLY_MAGIC)
+			rc = -EPROTO;
+		else
+			replen = req_capsule_get_size(&req->rq_pill,
+						      &RMF_BUT_REPLY,
+						      RCL_SERVER) -
+				 sizeof(*burp);
+	}
+
+	for (i = 0; i < aa->ba_count; i++) {
+		struct md_enqueue_info *minfo = aa->ba_items[i];
+		struct req_capsule *pill = &minfo->mi_pill;
+		struct lustre_msg *reqmsg;
+		struct lustre_msg *repmsg = NULL;
+		int subrc = rc;
+
+		reqmsg = mdc_batch_msg(burq->burq_reqmsg, reqoff);
+		reqoff += lustre_packed_msg_size(reqmsg);
+
+		/* not executed, the reply buffer was exhausted */
+		if (subrc == 0 && i >= burp->burp_count)
+			subrc = -EAGAIN;
+
+		if (subrc == 0)
+			repmsg = mdc_batch_msg(burp->burp_repmsg, repoff);
+
+		req_capsule_subreq_init(pill, &RQF_BUT_GETATTR, req, reqmsg,
+					repmsg, RCL_CLIENT);
+		if (subrc == 0) {
+			subrc = req_capsule_subreq_unpack(pill, RCL_SERVER,
+							  replen - repoff);
+			if (subrc < 0) {
+				CERROR("%s: cannot unpack batch sub-reply %d: rc = %d\n",
+				       aa->ba_exp->exp_obd->obd_name, i, subrc);
+				/* the following sub-replies can't be found */
+				rc = subrc;
+			} else {
+				repoff += subrc;
+				subrc = ptlrpc_status_ntoh(repmsg->lm_result);
+			}
+		}
+
+		mdc_intent_getattr_async_fini(aa->ba_exp, pill, minfo, subrc);
+	}
+
+	OBD_FREE_PTR_ARRAY(aa->ba_items, aa->ba_max_count);
+	RETURN(0);
+}
+
+static void mdc_batch_fail(struct obd_export *exp, struct ptlrpc_request *req,
+			   struct md_enqueue_info **items, __u32 count, int rc)
+{
+	struct batch_update_request *burq = mdc_batch_burq(req);
+	__u32 reqoff = 0;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		struct md_enqueue_info *minfo = items[i];
+		struct lustre_msg *reqmsg;
+
+		reqmsg = mdc_batch_msg(burq->burq_reqmsg, reqoff);
+		reqoff += lustre_packed_msg_size(reqmsg);
+
+		req_capsule_subreq_init(&minfo->mi_pill, &RQF_BUT_GETATTR, req,
+					reqmsg, NULL, RCL_CLIENT);
+		mdc_intent_getattr_async_fini(exp, &minfo->mi_pill, minfo, rc);
+	}
+}
+
+int mdc_batch_flush(struct obd_export *exp, struct lu_batch *bh, bool wait)
+{
+	struct mdc_batch *mbh = container_of(bh, struct mdc_batch, mbh_super);
+	struct ptlrpc_request *req = mbh->mbh_req;
+	struct batch_update_request *burq;
+	struct mdc_batch_args *aa;
+	__u32 repsize;
+	int rc;
+
+	ENTRY;
+
+	if (req == NULL)
+		RETURN(0);
+
+	mbh->mbh_req = NULL;
+	burq = mdc_batch_burq(req);
+	if (burq->burq_count == 0) {
+		OBD_FREE_PTR_ARRAY(mbh->mbh_items, bh->lbt_max_count);
+		ptlrpc_req_finished(req);
+		RETURN(0);
+	}
+
+	burq->burq_reply_size = mbh->mbh_repsize;
+	req_capsule_shrink(&req->rq_pill, &RMF_BUT_REQUEST,
+			   sizeof(*burq) + mbh->mbh_reqoff, RCL_CLIENT);
+
+	repsize = min_t(__u32, sizeof(struct batch_update_reply) +
+			       mbh->mbh_repsize, BUT_MAXREPSIZE);
+	req_capsule_set_size(&req->rq_pill, &RMF_BUT_REPLY, RCL_SERVER,
+			     repsize);
+	ptlrpc_request_set_replen(req);
+
+	/* the batch takes a single RPC slot for all its sub-requests */
+	rc = obd_get_request_slot(&exp->exp_obd->u.cli);
+	if (rc) {
+		mdc_batch_fail(exp, req, mbh->mbh_items, burq->burq_count, rc);
+		OBD_FREE_PTR_ARRAY(mbh->mbh_items, bh->lbt_max_count);
+		ptlrpc_req_finished(req);
+		if (bh->lbt_result == 0)
+			bh->lbt_result = rc;
+		RETURN(rc);
+	}
+
+	lprocfs_oh_tally_log2(&exp->exp_obd->u.cli.cl_batch_rpc_hist,
+			      burq->burq_count);
+
+	aa = ptlrpc_req_async_args(aa, req);
+	aa->ba_exp = exp;
+	aa->ba_items = mbh->mbh_items;
+	aa->ba_count = burq->burq_count;
+	aa->ba_max_count = bh->lbt_max_count;
+	mbh->mbh_items = NULL;
+
+	req->rq_interpret_reply = mdc_batch_interpret;
+	if (wait) {
+		rc = ptlrpc_queue_wait(req);
+		ptlrpc_req_finished(req);
+		if (rc && bh->lbt_result == 0)
+			bh->lbt_result = rc;
+	} else {
+		ptlrpcd_add_req(req);
+	}
+
+	RETURN(rc);
+}
+
+int mdc_batch_add(struct obd_export *exp, struct lu_batch *bh,
+		  struct md_enqueue_info *minfo)
+{
+	struct mdc_batch *mbh = container_of(bh, struct mdc_batch, mbh_super);
+	struct md_op_data *op_data = &minfo->mi_data;
+	struct lookup_intent *it = &minfo->mi_it;
+	struct req_capsule *pill = &minfo->mi_pill;
+	struct batch_update_request *burq;
+	struct ldlm_request *dlmreq;
+	struct lustre_msg *reqmsg;
+	struct ldlm_res_id res_id;
+	union ldlm_policy_data policy = {
+		.l_inodebits = { MDS_INODELOCK_LOOKUP | MDS_INODELOCK_UPDATE }
+	};
+	__u64 flags = LDLM_FL_HAS_INTENT;
+	__u32 reqsize;
+	__u32 repsize;
+	bool have_secctx;
+	int rc;
+
+	ENTRY;
+
+	if (!(it->it_op & (IT_GETATTR | IT_LOOKUP)))
+		RETURN(-EOPNOTSUPP);
+
+	if (!exp_connect_batch_rpc(exp))
+		RETURN(mdc_intent_getattr_async(exp, minfo));
+
+	CDEBUG(D_DLMTRACE,
+	       "name: %.*s in inode "DFID", intent: %s flags %#llo\n",
+	       (int)op_data->op_namelen, op_data->op_name,
+	       PFID(&op_data->op_fid1), ldlm_it2str(it->it_op), it->it_flags);
+
+again:
+	if (mbh->mbh_req == NULL) {
+		rc = mdc_batch_prep(exp, mbh);
+		if (rc)
+			RETURN(rc);
+	}
+
+	burq = mdc_batch_burq(mbh->mbh_req);
+	reqmsg = mdc_batch_msg(burq->burq_reqmsg, mbh->mbh_reqoff);
+	req_capsule_subreq_init(pill, &RQF_BUT_GETATTR, mbh->mbh_req, reqmsg,
+				NULL, RCL_CLIENT);
+	have_secctx = mdc_intent_getattr_size_set(exp, pill, it, op_data);
+
+	rc = req_capsule_client_pack(pill, mbh->mbh_reqlen - mbh->mbh_reqoff);
+	if (rc < 0)
+		GOTO(flush, rc);
+	reqsize = rc;
+
+	reqmsg->lm_opc = BUT_GETATTR;
+	/* If the MDT return -ERANGE because of large ACL, then the sponsor
+	 * of the async getattr RPC will handle that by itself.
+	 */
+	mdc_intent_getattr_fill(exp, pill, it, op_data,
+				LUSTRE_POSIX_ACL_MAX_SIZE_OLD, have_secctx);
+
+	repsize = req_capsule_msg_size(pill, RCL_SERVER);
+	if (sizeof(struct batch_update_reply) + mbh->mbh_repsize + repsize >
+	    BUT_MAXREPSIZE)
+		GOTO(flush, rc = -EOVERFLOW);
+
+	/* With Data-on-MDT the glimpse callback is needed too, see
+	 * mdc_intent_getattr_async().
+	 */
+	if (minfo->mi_einfo.ei_cb_gl == NULL)
+		minfo->mi_einfo.ei_cb_gl = mdc_ldlm_glimpse_ast;
+
+	fid_build_reg_res_name(&op_data->op_fid1, &res_id);
+	dlmreq = req_capsule_client_get(pill, &RMF_DLM_REQ);
+	rc = ldlm_cli_lock_create_pack(exp, dlmreq, &minfo->mi_einfo, &res_id,
+				       &policy, &flags, 0, LVB_T_NONE,
+				       &minfo->mi_lockh);
+	if (rc) {
+		req_capsule_fini(pill);
+		RETURN(rc);
+	}
+
+	mbh->mbh_items[burq->burq_count++] = minfo;
+	mbh->mbh_reqoff += reqsize;
+	mbh->mbh_repsize += repsize;
+
+	/* @minfo is owned by the batch from now on, a failure to send it is
+	 * reported through its callback and bh->lbt_result.
+	 */
+	if (burq->burq_count >= bh->lbt_max_count)
+		mdc_batch_flush(exp, bh, false);
+
+	RETURN(0);
+
+flush:
+	req_capsule_fini(pill);
+	/* a single request too big for the batch RPC */
+	if (burq->burq_count == 0)
+		RETURN(rc);
+
+	rc = mdc_batch_flush(exp, bh, false);
+	if (rc)
+		RETURN(rc);
+	goto again;
+}
+
+struct lu_batch *mdc_batch_create(struct obd_export *exp, __u32 max_count)
+{
+	struct mdc_batch *mbh;
+
+	ENTRY;
+
+	if (max_count == 0)
+		RETURN(ERR_PTR(-EINVAL));
+
+	OBD_ALLOC_PTR(mbh);
+	if (mbh == NULL)
+		RETURN(ERR_PTR(-ENOMEM));
+
+	mbh->mbh_super.lbt_max_count = min_t(__u32, max_count, U16_MAX);
+
+	RETURN(&mbh->mbh_super);
+}
+
+int mdc_batch_stop(struct obd_export *exp, struct lu_batch *bh)
+{
+	struct mdc_batch *mbh = container_of(bh, struct mdc_batch, mbh_super);
+	int rc;
+
+	ENTRY;
+
+	rc = mdc_batch_flush(exp, bh, false);
+	if (rc == 0)
+		rc = bh->lbt_result;
+
+	OBD_FREE_PTR(mbh);
+	RETURN(rc);
+}
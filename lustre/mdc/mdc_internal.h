@@ -42,7 +42,7 @@ void mdc_swap_layouts_pack(struct ptlrpc_request *req,
 			   struct md_op_data *op_data);
 void mdc_readdir_pack(struct ptlrpc_request *req, __u64 pgoff, size_t size,
 		      const struct lu_fid *fid);
-void mdc_getattr_pack(struct ptlrpc_request *req, __u64 valid, __u32 flags,
+void mdc_getattr_pack(struct req_capsule *pill, __u64 valid, __u32 flags,
 		      struct md_op_data *data, size_t ea_size);
 void mdc_setattr_pack(struct ptlrpc_request *req, struct md_op_data *op_data,
 		      void *ea, size_t ealen);
@@ -131,6 +131,24 @@ int mdc_revalidate_lock(struct obd_export *exp, struct lookup_intent *it,
 
 int mdc_intent_getattr_async(struct obd_export *exp,
 			     struct md_enqueue_info *minfo);
+bool mdc_intent_getattr_size_set(struct obd_export *exp,
+				 struct req_capsule *pill,
+				 struct lookup_intent *it,
+				 struct md_op_data *op_data);
+void mdc_intent_getattr_fill(struct obd_export *exp, struct req_capsule *pill,
+			     struct lookup_intent *it,
+			     struct md_op_data *op_data, __u32 acl_bufsize,
+			     bool have_secctx);
+void mdc_intent_getattr_async_fini(struct obd_export *exp,
+				   struct req_capsule *pill,
+				   struct md_enqueue_info *minfo, int rc);
+
+/* mdc_batch.c */
+struct lu_batch *mdc_batch_create(struct obd_export *exp, __u32 max_count);
+int mdc_batch_stop(struct obd_export *exp, struct lu_batch *bh);
+int mdc_batch_flush(struct obd_export *exp, struct lu_batch *bh, bool wait);
+int mdc_batch_add(struct obd_export *exp, struct lu_batch *bh,
+		  struct md_enqueue_info *minfo);
 
 enum ldlm_mode mdc_lock_match(struct obd_export *exp, __u64 flags,
 			      const struct lu_fid *fid, enum ldlm_type type,
@@ -157,10 +175,10 @@ static inline int mdc_prep_elc_req(struct obd_export *exp,
 }
 
 #ifdef CONFIG_LUSTRE_FS_POSIX_ACL
-int mdc_unpack_acl(struct ptlrpc_request *req, struct lustre_md *md);
+int mdc_unpack_acl(struct req_capsule *pill, struct lustre_md *md);
 #else
 static inline
-int mdc_unpack_acl(struct ptlrpc_request *req, struct lustre_md *md)
+int mdc_unpack_acl(struct req_capsule *pill, struct lustre_md *md)
 {
 	return 0;
 }
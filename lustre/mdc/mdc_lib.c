@@ -98,7 +98,7 @@ void mdc_pack_body(struct ptlrpc_request *req, const struct lu_fid *fid,
  * \a name must be '\0' terminated of length \a name_len and represent
  * a single path component (not contain '/').
  */
-static void mdc_pack_name(struct ptlrpc_request *req,
+static void mdc_pack_name(struct req_capsule *pill,
 			  const struct req_msg_field *field,
 			  const char *name, size_t name_len)
 {
@@ -106,8 +106,8 @@ static void mdc_pack_name(struct ptlrpc_request *req,
 	size_t buf_size;
 	size_t cpy_len;
 
-	buf = req_capsule_client_get(&req->rq_pill, field);
-	buf_size = req_capsule_get_size(&req->rq_pill, field, RCL_CLIENT);
+	buf = req_capsule_client_get(pill, field);
+	buf_size = req_capsule_get_size(pill, field, RCL_CLIENT);
 
 	LASSERT(name != NULL && name_len != 0 &&
 		buf != NULL && buf_size == name_len + 1);
@@ -117,8 +117,8 @@ static void mdc_pack_name(struct ptlrpc_request *req,
 	LASSERT(lu_name_is_valid_2(buf, cpy_len));
 	if (cpy_len != name_len)
 		CDEBUG(D_DENTRY, "%s: %s len %zd != %zd, concurrent rename?\n",
-		       req->rq_export->exp_obd->obd_name, buf, name_len,
-		       cpy_len);
+		       pill->rc_req->rq_export->exp_obd->obd_name, buf,
+		       name_len, cpy_len);
 }
 
 void mdc_file_secctx_pack(struct ptlrpc_request *req, const char *secctx_name,
@@ -227,7 +227,8 @@ void mdc_create_pack(struct ptlrpc_request *req, struct md_op_data *op_data,
 	rec->cr_bias     = op_data->op_bias;
 	rec->cr_umask    = current_umask();
 
-	mdc_pack_name(req, &RMF_NAME, op_data->op_name, op_data->op_namelen);
+	mdc_pack_name(&req->rq_pill, &RMF_NAME, op_data->op_name,
+		      op_data->op_namelen);
 	if (data) {
 		tmp = req_capsule_client_get(&req->rq_pill, &RMF_EADATA);
 		memcpy(tmp, data, datalen);
@@ -309,8 +310,8 @@ void mdc_open_pack(struct ptlrpc_request *req, struct md_op_data *op_data,
 		rec->cr_open_handle_old = op_data->op_open_handle;
 
 		if (op_data->op_name) {
-			mdc_pack_name(req, &RMF_NAME, op_data->op_name,
-				      op_data->op_namelen);
+			mdc_pack_name(&req->rq_pill, &RMF_NAME,
+				      op_data->op_name, op_data->op_namelen);
 
 			if (op_data->op_bias & MDS_CREATE_VOLATILE)
 				cr_flags |= MDS_OPEN_VOLATILE;
@@ -478,7 +479,8 @@ void mdc_unlink_pack(struct ptlrpc_request *req, struct md_op_data *op_data)
 	rec->ul_time = op_data->op_mod_time;
 	rec->ul_bias = op_data->op_bias;
 
-	mdc_pack_name(req, &RMF_NAME, op_data->op_name, op_data->op_namelen);
+	mdc_pack_name(&req->rq_pill, &RMF_NAME, op_data->op_name,
+		      op_data->op_namelen);
 
 	/* pack SELinux policy info if any */
 	mdc_file_sepol_pack(req);
@@ -504,7 +506,8 @@ void mdc_link_pack(struct ptlrpc_request *req, struct md_op_data *op_data)
 	rec->lk_time     = op_data->op_mod_time;
 	rec->lk_bias     = op_data->op_bias;
 
-	mdc_pack_name(req, &RMF_NAME, op_data->op_name, op_data->op_namelen);
+	mdc_pack_name(&req->rq_pill, &RMF_NAME, op_data->op_name,
+		      op_data->op_namelen);
 
 	/* pack SELinux policy info if any */
 	mdc_file_sepol_pack(req);
@@ -578,10 +581,10 @@ void mdc_rename_pack(struct ptlrpc_request *req, struct md_op_data *op_data,
 	rec->rn_mode     = op_data->op_mode;
 	rec->rn_bias     = op_data->op_bias;
 
-	mdc_pack_name(req, &RMF_NAME, old, oldlen);
+	mdc_pack_name(&req->rq_pill, &RMF_NAME, old, oldlen);
 
 	if (new != NULL)
-		mdc_pack_name(req, &RMF_SYMTGT, new, newlen);
+		mdc_pack_name(&req->rq_pill, &RMF_SYMTGT, new, newlen);
 
 	/* pack SELinux policy info if any */
 	mdc_file_sepol_pack(req);
@@ -609,7 +612,7 @@ void mdc_migrate_pack(struct ptlrpc_request *req, struct md_op_data *op_data,
 	rec->rn_mode     = op_data->op_mode;
 	rec->rn_bias     = op_data->op_bias;
 
-	mdc_pack_name(req, &RMF_NAME, name, namelen);
+	mdc_pack_name(&req->rq_pill, &RMF_NAME, name, namelen);
 
 	if (op_data->op_bias & MDS_CLOSE_MIGRATE) {
 		struct mdt_ioepoch *epoch;
@@ -623,11 +626,10 @@ void mdc_migrate_pack(struct ptlrpc_request *req, struct md_op_data *op_data,
 	memcpy(ea, op_data->op_data, op_data->op_data_size);
 }
 
-void mdc_getattr_pack(struct ptlrpc_request *req, __u64 valid, __u32 flags,
+void mdc_getattr_pack(struct req_capsule *pill, __u64 valid, __u32 flags,
 		      struct md_op_data *op_data, size_t ea_size)
 {
-	struct mdt_body *b = req_capsule_client_get(&req->rq_pill,
-						    &RMF_MDT_BODY);
+	struct mdt_body *b = req_capsule_client_get(pill, &RMF_MDT_BODY);
 
 	b->mbo_valid = valid;
 	if (op_data->op_bias & MDS_CROSS_REF)
@@ -641,7 +643,7 @@ void mdc_getattr_pack(struct ptlrpc_request *req, __u64 valid, __u32 flags,
 	b->mbo_valid |= OBD_MD_FLID;
 
 	if (op_data->op_name != NULL)
-		mdc_pack_name(req, &RMF_NAME, op_data->op_name,
+		mdc_pack_name(pill, &RMF_NAME, op_data->op_name,
 			      op_data->op_namelen);
 }
 
@@ -514,49 +514,53 @@ mdc_intent_getxattr_pack(struct obd_export *exp, struct lookup_intent *it,
 	RETURN(req);
 }
 
-static struct ptlrpc_request *
-mdc_intent_getattr_pack(struct obd_export *exp, struct lookup_intent *it,
-			struct md_op_data *op_data, __u32 acl_bufsize)
+/**
+ * Set the client buffer sizes of an intent getattr request in \a pill.
+ *
+ * \retval true if the name of the security xattr will be packed
+ */
+bool mdc_intent_getattr_size_set(struct obd_export *exp,
+				 struct req_capsule *pill,
+				 struct lookup_intent *it,
+				 struct md_op_data *op_data)
 {
-	struct ptlrpc_request *req;
-	struct obd_device *obd = class_exp2obd(exp);
-	u64 valid = OBD_MD_FLGETATTR | OBD_MD_FLEASIZE | OBD_MD_FLMODEASIZE |
-		    OBD_MD_FLDIREA | OBD_MD_MEA | OBD_MD_FLACL |
-		    OBD_MD_DEFAULT_MEA;
-	struct ldlm_intent *lit;
-	__u32 easize;
 	bool have_secctx = false;
-	int rc;
-
-	ENTRY;
-	req = ptlrpc_request_alloc(class_exp2cliimp(exp),
-				   &RQF_LDLM_INTENT_GETATTR);
-	if (req == NULL)
-		RETURN(ERR_PTR(-ENOMEM));
 
 	/* send name of security xattr to get upon intent */
 	if (it->it_op & (IT_LOOKUP | IT_GETATTR) &&
-	    req_capsule_has_field(&req->rq_pill, &RMF_FILE_SECCTX_NAME,
-				  RCL_CLIENT) &&
+	    req_capsule_has_field(pill, &RMF_FILE_SECCTX_NAME, RCL_CLIENT) &&
 	    op_data->op_file_secctx_name_size > 0 &&
 	    op_data->op_file_secctx_name != NULL) {
 		have_secctx = true;
-		req_capsule_set_size(&req->rq_pill, &RMF_FILE_SECCTX_NAME,
-				     RCL_CLIENT,
+		req_capsule_set_size(pill, &RMF_FILE_SECCTX_NAME, RCL_CLIENT,
 				     op_data->op_file_secctx_name_size);
 	}
 
-	req_capsule_set_size(&req->rq_pill, &RMF_NAME, RCL_CLIENT,
+	req_capsule_set_size(pill, &RMF_NAME, RCL_CLIENT,
 			     op_data->op_namelen + 1);
 
-	rc = ldlm_prep_enqueue_req(exp, req, NULL, 0);
-	if (rc) {
-		ptlrpc_request_free(req);
-		RETURN(ERR_PTR(rc));
-	}
+	return have_secctx;
+}
+
+/**
+ * Pack the intent and the getattr body of an intent getattr request, and
+ * set the reply buffer sizes in \a pill. The request buffers must have been
+ * sized by mdc_intent_getattr_size_set() and packed already.
+ */
+void mdc_intent_getattr_fill(struct obd_export *exp, struct req_capsule *pill,
+			     struct lookup_intent *it,
+			     struct md_op_data *op_data, __u32 acl_bufsize,
+			     bool have_secctx)
+{
+	struct obd_device *obd = class_exp2obd(exp);
+	u64 valid = OBD_MD_FLGETATTR | OBD_MD_FLEASIZE | OBD_MD_FLMODEASIZE |
+		    OBD_MD_FLDIREA | OBD_MD_MEA | OBD_MD_FLACL |
+		    OBD_MD_DEFAULT_MEA;
+	struct ldlm_intent *lit;
+	__u32 easize;
 
 	/* pack the intent */
-	lit = req_capsule_client_get(&req->rq_pill, &RMF_LDLM_INTENT);
+	lit = req_capsule_client_get(pill, &RMF_LDLM_INTENT);
 	lit->opc = (__u64)it->it_op;
 
 	if (obd->u.cli.cl_default_mds_easize > 0)
@@ -565,38 +569,63 @@ mdc_intent_getattr_pack(struct obd_export *exp, struct lookup_intent *it,
 		easize = obd->u.cli.cl_max_mds_easize;
 
 	/* pack the intended request */
-	mdc_getattr_pack(req, valid, it->it_flags, op_data, easize);
+	mdc_getattr_pack(pill, valid, it->it_flags, op_data, easize);
 
-	req_capsule_set_size(&req->rq_pill, &RMF_MDT_MD, RCL_SERVER, easize);
-	req_capsule_set_size(&req->rq_pill, &RMF_ACL, RCL_SERVER, acl_bufsize);
-	req_capsule_set_size(&req->rq_pill, &RMF_DEFAULT_MDT_MD, RCL_SERVER,
+	req_capsule_set_size(pill, &RMF_MDT_MD, RCL_SERVER, easize);
+	req_capsule_set_size(pill, &RMF_ACL, RCL_SERVER, acl_bufsize);
+	req_capsule_set_size(pill, &RMF_DEFAULT_MDT_MD, RCL_SERVER,
 			     sizeof(struct lmv_user_md));
 
 	if (have_secctx) {
 		char *secctx_name;
 
-		secctx_name = req_capsule_client_get(&req->rq_pill,
+		secctx_name = req_capsule_client_get(pill,
 						     &RMF_FILE_SECCTX_NAME);
 		memcpy(secctx_name, op_data->op_file_secctx_name,
 		       op_data->op_file_secctx_name_size);
 
-		req_capsule_set_size(&req->rq_pill, &RMF_FILE_SECCTX,
-				     RCL_SERVER, easize);
+		req_capsule_set_size(pill, &RMF_FILE_SECCTX, RCL_SERVER,
+				     easize);
 
 		CDEBUG(D_SEC, "packed '%.*s' as security xattr name\n",
 		       op_data->op_file_secctx_name_size,
 		       op_data->op_file_secctx_name);
 	} else {
-		req_capsule_set_size(&req->rq_pill, &RMF_FILE_SECCTX,
-				     RCL_SERVER, 0);
+		req_capsule_set_size(pill, &RMF_FILE_SECCTX, RCL_SERVER, 0);
 	}
 
 	if (exp_connect_encrypt(exp) && it->it_op & (IT_LOOKUP | IT_GETATTR))
-		req_capsule_set_size(&req->rq_pill, &RMF_FILE_ENCCTX,
-				     RCL_SERVER, easize);
+		req_capsule_set_size(pill, &RMF_FILE_ENCCTX, RCL_SERVER,
+				     easize);
 	else
-		req_capsule_set_size(&req->rq_pill, &RMF_FILE_ENCCTX,
-				     RCL_SERVER, 0);
+		req_capsule_set_size(pill, &RMF_FILE_ENCCTX, RCL_SERVER, 0);
+}
+
+static struct ptlrpc_request *
+mdc_intent_getattr_pack(struct obd_export *exp, struct lookup_intent *it,
+			struct md_op_data *op_data, __u32 acl_bufsize)
+{
+	struct ptlrpc_request *req;
+	bool have_secctx;
+	int rc;
+
+	ENTRY;
+	req = ptlrpc_request_alloc(class_exp2cliimp(exp),
+				   &RQF_LDLM_INTENT_GETATTR);
+	if (req == NULL)
+		RETURN(ERR_PTR(-ENOMEM));
+
+	have_secctx = mdc_intent_getattr_size_set(exp, &req->rq_pill, it,
+						  op_data);
+
+	rc = ldlm_prep_enqueue_req(exp, req, NULL, 0);
+	if (rc) {
+		ptlrpc_request_free(req);
+		RETURN(ERR_PTR(rc));
+	}
+
+	mdc_intent_getattr_fill(exp, &req->rq_pill, it, op_data, acl_bufsize,
+				have_secctx);
 
 	ptlrpc_request_set_replen(req);
 	RETURN(req);
@@ -672,12 +701,12 @@ static struct ptlrpc_request *mdc_enqueue_pack(struct obd_export *exp,
 }
 
 static int mdc_finish_enqueue(struct obd_export *exp,
-			      struct ptlrpc_request *req,
+			      struct req_capsule *pill,
 			      struct ldlm_enqueue_info *einfo,
 			      struct lookup_intent *it,
 			      struct lustre_handle *lockh, int rc)
 {
-	struct req_capsule *pill = &req->rq_pill;
+	struct ptlrpc_request *req = pill->rc_req;
 	struct ldlm_request *lockreq;
 	struct ldlm_reply *lockrep;
 	struct ldlm_lock *lock;
@@ -1071,7 +1100,7 @@ resend:
 		goto resend;
 	}
 
-	rc = mdc_finish_enqueue(exp, req, einfo, it, lockh, rc);
+	rc = mdc_finish_enqueue(exp, &req->rq_pill, einfo, it, lockh, rc);
 	if (rc < 0) {
 		if (lustre_handle_is_used(lockh)) {
 			ldlm_lock_decref(lockh, einfo->ei_mode);
@@ -1097,11 +1126,12 @@ int mdc_enqueue(struct obd_export *exp, struct ldlm_enqueue_info *einfo,
 }
 
 static int mdc_finish_intent_lock(struct obd_export *exp,
-				  struct ptlrpc_request *request,
+				  struct req_capsule *pill,
 				  struct md_op_data *op_data,
 				  struct lookup_intent *it,
 				  struct lustre_handle *lockh)
 {
+	struct ptlrpc_request *request = pill->rc_req;
 	struct lustre_handle old_lock;
 	struct ldlm_lock *lock;
 	int rc = 0;
@@ -1180,8 +1210,7 @@ static int mdc_finish_intent_lock(struct obd_export *exp,
 		if (it_has_reply_body(it)) {
 			struct mdt_body *body;
 
-			body = req_capsule_server_get(&request->rq_pill,
-						      &RMF_MDT_BODY);
+			body = req_capsule_server_get(pill, &RMF_MDT_BODY);
 			/* mdc_enqueue checked */
 			LASSERT(body != NULL);
 			LASSERTF(fid_res_name_eq(&body->mbo_fid1,
@@ -1358,17 +1387,20 @@ int mdc_intent_lock(struct obd_export *exp, struct md_op_data *op_data,
 		RETURN(rc);
 
 	*reqp = it->it_request;
-	rc = mdc_finish_intent_lock(exp, *reqp, op_data, it, &lockh);
+	rc = mdc_finish_intent_lock(exp, &(*reqp)->rq_pill, op_data, it,
+				    &lockh);
 	RETURN(rc);
 }
 
-static int mdc_intent_getattr_async_interpret(const struct lu_env *env,
-					      struct ptlrpc_request *req,
-					      void *args, int rc)
+/**
+ * Finish an async intent getattr once its reply, or the reply of the batch
+ * RPC it was sent in, has arrived, then call the md_enqueue_info callback.
+ */
+void mdc_intent_getattr_async_fini(struct obd_export *exp,
+				   struct req_capsule *pill,
+				   struct md_enqueue_info *minfo, int rc)
 {
-	struct mdc_getattr_args *ga = args;
-	struct obd_export *exp = ga->ga_exp;
-	struct md_enqueue_info *minfo = ga->ga_minfo;
+	struct ptlrpc_request *req = pill->rc_req;
 	struct ldlm_enqueue_info *einfo = &minfo->mi_einfo;
 	struct lookup_intent *it = &minfo->mi_it;
 	struct lustre_handle *lockh = &minfo->mi_lockh;
@@ -1379,7 +1411,7 @@ static int mdc_intent_getattr_async_interpret(const struct lu_env *env,
 	if (OBD_FAIL_CHECK(OBD_FAIL_MDC_GETATTR_ENQUEUE))
 		rc = -ETIMEDOUT;
 
-	rc = ldlm_cli_enqueue_fini(exp, req, einfo, 1, &flags, NULL, 0,
+	rc = ldlm_cli_enqueue_fini(exp, pill, einfo, 1, &flags, NULL, 0,
 				   lockh, rc);
 	if (rc < 0) {
 		CERROR("%s: ldlm_cli_enqueue_fini() failed: rc = %d\n",
@@ -1388,21 +1420,31 @@ static int mdc_intent_getattr_async_interpret(const struct lu_env *env,
 		GOTO(out, rc);
 	}
 
-	lockrep = req_capsule_server_get(&req->rq_pill, &RMF_DLM_REP);
+	lockrep = req_capsule_server_get(pill, &RMF_DLM_REP);
 	LASSERT(lockrep != NULL);
 
 	lockrep->lock_policy_res2 =
 		ptlrpc_status_ntoh(lockrep->lock_policy_res2);
 
-	rc = mdc_finish_enqueue(exp, req, einfo, it, lockh, rc);
+	rc = mdc_finish_enqueue(exp, pill, einfo, it, lockh, rc);
 	if (rc)
 		GOTO(out, rc);
 
-	rc = mdc_finish_intent_lock(exp, req, &minfo->mi_data, it, lockh);
+	rc = mdc_finish_intent_lock(exp, pill, &minfo->mi_data, it, lockh);
 	EXIT;
 
 out:
-	minfo->mi_cb(req, minfo, rc);
+	minfo->mi_cb(pill, minfo, rc);
+}
+
+static int mdc_intent_getattr_async_interpret(const struct lu_env *env,
+					      struct ptlrpc_request *req,
+					      void *args, int rc)
+{
+	struct mdc_getattr_args *ga = args;
+
+	mdc_intent_getattr_async_fini(ga->ga_exp, &req->rq_pill, ga->ga_minfo,
+				      rc);
 	return 0;
 }
 
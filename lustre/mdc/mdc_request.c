@@ -506,12 +506,12 @@ out:
 	return rc;
 }
 
-static int mdc_get_lustre_md(struct obd_export *exp, struct ptlrpc_request *req,
+static int mdc_get_lustre_md(struct obd_export *exp,
+			     struct req_capsule *pill,
 			     struct obd_export *dt_exp,
 			     struct obd_export *md_exp,
 			     struct lustre_md *md)
 {
-        struct req_capsule *pill = &req->rq_pill;
         int rc;
         ENTRY;
 
@@ -611,7 +611,7 @@ static int mdc_get_lustre_md(struct obd_export *exp, struct ptlrpc_request *req,
 		 * only when aclsize != 0 there's an actual segment for ACL
 		 * in reply buffer.
 		 */
-		rc = mdc_unpack_acl(req, md);
+		rc = mdc_unpack_acl(pill, md);
 		if (rc)
 			GOTO(out, rc);
 	}
@@ -2669,9 +2669,9 @@ static int mdc_import_event(struct obd_device *obd, struct obd_import *imp,
 			 */
 			osc_io_unplug(env, cli, NULL);
 
-			cfs_hash_for_each_nolock(ns->ns_rs_hash,
-						 osc_ldlm_resource_invalidate,
-						 env, 0);
+			ldlm_namespace_foreach_res(ns,
+						   osc_ldlm_resource_invalidate,
+						   env);
 			cl_env_put(env, &refcheck);
 			ldlm_namespace_cleanup(ns, LDLM_FL_LOCAL_ONLY);
 		} else {
@@ -2813,6 +2813,7 @@ int mdc_setup(struct obd_device *obd, struct lustre_cfg *cfg)
 	obd->u.cli.cl_dom_min_inline_repsize = MDC_DOM_DEF_INLINE_REPSIZE;
 
 	ns_register_cancel(obd->obd_namespace, mdc_cancel_weight);
+	ns_register_lru_cost(obd->obd_namespace, osc_ldlm_lru_cost);
 
 	obd->obd_namespace->ns_lvbo = &inode_lvbo;
 
@@ -2937,6 +2938,10 @@ static const struct md_ops mdc_md_ops = {
 	.m_intent_getattr_async = mdc_intent_getattr_async,
 	.m_revalidate_lock      = mdc_revalidate_lock,
 	.m_rmfid		= mdc_rmfid,
+	.m_batch_create		= mdc_batch_create,
+	.m_batch_stop		= mdc_batch_stop,
+	.m_batch_flush		= mdc_batch_flush,
+	.m_batch_add		= mdc_batch_add,
 };
 
 dev_t mdc_changelog_dev;
@@ -0,0 +1,190 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ *
+ * lustre/mdt/mdt_batch.c
+ *
+ * Batch metadata RPC (MDS_BATCH) handler
+ */
+
+#define DEBUG_SUBSYSTEM S_MDS
+
+#include "mdt_internal.h"
+
+/*
+ * Batched intent getattr/lookup: run the sub-request through the regular
+ * LDLM enqueue path, with the session pointing to the sub-request capsule.
+ */
+static int mdt_batch_getattr(struct tgt_session_info *tsi,
+			     struct req_capsule *pill)
+{
+	struct req_capsule *batch_pill = tsi->tsi_pill;
+	struct ldlm_request *batch_dlm_req = tsi->tsi_dlm_req;
+	struct ldlm_request *dlm_req;
+	struct ldlm_intent *it;
+	union ldlm_wire_policy_data *policy;
+	int rc;
+
+	ENTRY;
+
+	dlm_req = req_capsule_client_get(pill, &RMF_DLM_REQ);
+	if (dlm_req == NULL)
+		RETURN(-EFAULT);
+
+	policy = &dlm_req->lock_desc.l_policy_data;
+	if (dlm_req->lock_desc.l_resource.lr_type != LDLM_IBITS ||
+	    (policy->l_inodebits.bits | policy->l_inodebits.try_bits) == 0 ||
+	    !(ldlm_flags_from_wire(dlm_req->lock_flags) & LDLM_FL_HAS_INTENT))
+		RETURN(-EPROTO);
+
+	it = req_capsule_client_get(pill, &RMF_LDLM_INTENT);
+	if (it == NULL || !(it->opc & (IT_GETATTR | IT_LOOKUP)))
+		RETURN(-EPROTO);
+
+	tsi->tsi_pill = pill;
+	tsi->tsi_dlm_req = dlm_req;
+	rc = tgt_enqueue(tsi);
+	tsi->tsi_pill = batch_pill;
+	tsi->tsi_dlm_req = batch_dlm_req;
+
+	RETURN(clear_serious(rc));
+}
+
+/**
+ * Handler of MDS_BATCH RPC.
+ *
+ * Sub-requests are executed one after another, each of them replying in its
+ * own lustre_msg packed in place in the batch reply buffer. The processing
+ * stops early when the reply buffer is exhausted, the client then learns
+ * from burp_count which sub-requests were not executed.
+ */
+int mdt_batch(struct tgt_session_info *tsi)
+{
+	struct mdt_thread_info *info = mdt_th_info(tsi->tsi_env);
+	struct req_capsule *pill = &info->mti_sub_pill;
+	struct ptlrpc_request *req = tgt_ses_req(tsi);
+	struct batch_update_request *burq;
+	struct batch_update_reply *burp;
+	struct lustre_msg *reqmsg;
+	struct lustre_msg *repmsg;
+	__u32 reqlen, replen;
+	__u32 reqoff = 0;
+	__u32 repoff = 0;
+	__u32 minlen;
+	__u32 size = 0;
+	int i;
+	int rc;
+
+	ENTRY;
+
+	burq = req_capsule_client_get(tsi->tsi_pill, &RMF_BUT_REQUEST);
+	if (burq == NULL)
+		RETURN(err_serious(-EPROTO));
+
+	if (burq->burq_magic != BUT_REQUEST_MAGIC) {
+		rc = -EPROTO;
+		CERROR("%s: invalid batch request magic %#x: rc = %d\n",
+		       tgt_name(tsi->tsi_tgt), burq->burq_magic, rc);
+		RETURN(err_serious(rc));
+	}
+
+	reqlen = req_capsule_get_size(tsi->tsi_pill, &RMF_BUT_REQUEST,
+				      RCL_CLIENT);
+	if (reqlen < sizeof(*burq))
+		RETURN(err_serious(-EPROTO));
+	reqlen -= sizeof(*burq);
+
+	replen = min_t(__u32, sizeof(*burp) + burq->burq_reply_size,
+		       BUT_MAXREPSIZE);
+	req_capsule_set_size(tsi->tsi_pill, &RMF_BUT_REPLY, RCL_SERVER,
+			     replen);
+	rc = req_capsule_server_pack(tsi->tsi_pill);
+	if (rc)
+		RETURN(err_serious(rc));
+
+	burp = req_capsule_server_get(tsi->tsi_pill, &RMF_BUT_REPLY);
+	burp->burp_magic = BUT_REPLY_MAGIC;
+	burp->burp_count = 0;
+	replen -= sizeof(*burp);
+
+	/* every sub-reply carries at least its status */
+	minlen = lustre_msg_size_v2(1, &size);
+
+	for (i = 0; i < burq->burq_count; i++) {
+		__u32 sublen;
+
+		if (replen - repoff < minlen)
+			break;
+
+		reqmsg = (struct lustre_msg *)((char *)burq->burq_reqmsg +
+					       reqoff);
+		repmsg = (struct lustre_msg *)((char *)burp->burp_repmsg +
+					       repoff);
+		repmsg->lm_bufcount = 0;
+
+		req_capsule_subreq_init(pill, &RQF_BUT_GETATTR, req, reqmsg,
+					repmsg, RCL_SERVER);
+		pill->rc_replen = replen - repoff;
+
+		rc = req_capsule_subreq_unpack(pill, RCL_CLIENT,
+					       reqlen - reqoff);
+		if (rc < 0) {
+			CERROR("%s: cannot unpack batch sub-request %d: rc = %d\n",
+			       tgt_name(tsi->tsi_tgt), i, rc);
+			req_capsule_fini(pill);
+			break;
+		}
+		sublen = rc;
+
+		switch (reqmsg->lm_opc) {
+		case BUT_GETATTR:
+			rc = mdt_batch_getattr(tsi, pill);
+			break;
+		default:
+			rc = -EOPNOTSUPP;
+			break;
+		}
+
+		if (!req_capsule_server_packed(pill)) {
+			/* let the client retry what didn't fit in the reply */
+			if (rc == -EOVERFLOW && i > 0) {
+				req_capsule_fini(pill);
+				break;
+			}
+			lustre_init_msg_v2(repmsg, 1, &size, NULL);
+			repmsg->lm_result = ptlrpc_status_hton(rc);
+		}
+		req_capsule_fini(pill);
+
+		reqoff += sublen;
+		repoff += lustre_packed_msg_size(repmsg);
+		burp->burp_count++;
+	}
+
+	CDEBUG(D_INFO, "%s: handled %u/%u batched sub-requests\n",
+	       tgt_name(tsi->tsi_tgt), burp->burp_count, burq->burq_count);
+
+	req_capsule_shrink(tsi->tsi_pill, &RMF_BUT_REPLY,
+			   sizeof(*burp) + repoff, RCL_SERVER);
+	RETURN(0);
+}
@@ -714,8 +714,13 @@ again:
 			goto map;
 
 		/* If LOV/LMA EA is small, we can reuse part of their buffer */
-		client = ptlrpc_req_get_repsize(pill->rc_req);
-		server = lustre_packed_msg_size(pill->rc_req->rq_repmsg);
+		if (req_capsule_subreq(pill)) {
+			client = pill->rc_replen;
+			server = lustre_packed_msg_size(pill->rc_repmsg);
+		} else {
+			client = ptlrpc_req_get_repsize(pill->rc_req);
+			server = lustre_packed_msg_size(pill->rc_req->rq_repmsg);
+		}
 		if (req_capsule_has_field(pill, &RMF_MDT_MD, RCL_SERVER)) {
 			lmm_buflen = req_capsule_get_size(pill, &RMF_MDT_MD,
 							  RCL_SERVER);
@@ -1358,7 +1363,7 @@ static int mdt_getattr_internal(struct mdt_thread_info *info,
 	if (S_ISDIR(lu_object_attr(&next->mo_lu)) &&
 	    ((reqbody->mbo_valid & (OBD_MD_MEA | OBD_MD_DEFAULT_MEA)) ==
 		    (OBD_MD_MEA | OBD_MD_DEFAULT_MEA)) &&
-	    req_capsule_has_field(&req->rq_pill, &RMF_DEFAULT_MDT_MD,
+	    req_capsule_has_field(pill, &RMF_DEFAULT_MDT_MD,
 				  RCL_SERVER)) {
 		ma->ma_lmv = buffer->lb_buf;
 		ma->ma_lmv_size = buffer->lb_len;
@@ -3375,7 +3380,7 @@ int mdt_check_resent_lock(struct mdt_thread_info *info,
 		lock = ldlm_handle2lock(&lhc->mlh_reg_lh);
 		LASSERT(lustre_msg_get_flags(req->rq_reqmsg) & MSG_RESENT);
 		if (lock == NULL) {
-			/* Lock is pinned by ldlm_handle_enqueue0() as it is
+			/* Lock is pinned by ldlm_handle_enqueue() as it is
 			 * a resend case, however, it could be already destroyed
 			 * due to client eviction or a raced cancel RPC. */
 			LDLM_DEBUG_NOLOCK("Invalid lock handle %#llx",
@@ -4016,6 +4021,8 @@ struct mdt_thread_info *tsi2mdt_info(struct tgt_session_info *tsi)
 	LASSERT(mti != NULL);
 
 	mdt_thread_info_init(tgt_ses_req(tsi), mti);
+	/* sub-request of a batch RPC has its own capsule */
+	mti->mti_pill = tsi->tsi_pill;
 	if (tsi->tsi_corpus != NULL) {
 		mti->mti_object = mdt_obj(tsi->tsi_corpus);
 		lu_object_get(tsi->tsi_corpus);
@@ -4069,7 +4076,7 @@ int mdt_intent_lock_replace(struct mdt_thread_info *info,
         }
 
 	if (new_lock == NULL && (flags & LDLM_FL_RESENT)) {
-		/* Lock is pinned by ldlm_handle_enqueue0() as it is
+		/* Lock is pinned by ldlm_handle_enqueue() as it is
 		 * a resend case, however, it could be already destroyed
 		 * due to client eviction or a raced cancel RPC. */
 		LDLM_DEBUG_NOLOCK("Invalid lock handle %#llx\n",
@@ -4184,7 +4191,9 @@ void mdt_intent_fixup_resent(struct mdt_thread_info *info,
          * this request.  Clear MSG_RESENT, because it can be handled like any
          * normal request now.
          */
-        lustre_msg_clear_flags(req->rq_reqmsg, MSG_RESENT);
+	/* other sub-requests of a batch RPC may still be resent ones */
+	if (!req_capsule_subreq(info->mti_pill))
+		lustre_msg_clear_flags(req->rq_reqmsg, MSG_RESENT);
 
 	DEBUG_REQ(D_DLMTRACE, req, "no existing lock with rhandle %#llx",
 		  dlmreq->lock_handle[0].cookie);
@@ -4386,7 +4395,7 @@ static int mdt_intent_layout(enum ldlm_intent_flags it_opc,
 	}
 
 	/*
-	 * set reply buffer size, so that ldlm_handle_enqueue0()->
+	 * set reply buffer size, so that ldlm_handle_enqueue()->
 	 * ldlm_lvbo_fill() will fill the reply buffer with lovea.
 	 */
 	req_capsule_set_size(info->mti_pill, &RMF_DLM_LVB, RCL_SERVER,
@@ -4610,7 +4619,13 @@ static int mdt_intent_opc(enum ldlm_intent_flags it_opc,
 		RETURN(-EPROTO);
 	}
 
-	req_capsule_extend(pill, it_format);
+	if (req_capsule_subreq(pill)) {
+		/* only getattr/lookup intents are batched, see mdt_batch() */
+		if (it_format != &RQF_LDLM_INTENT_GETATTR)
+			RETURN(-EPROTO);
+	} else {
+		req_capsule_extend(pill, it_format);
+	}
 
 	rc = mdt_unpack_req_pack_rep(info, it_handler_flags);
 	if (rc < 0)
@@ -4628,7 +4643,7 @@ static int mdt_intent_opc(enum ldlm_intent_flags it_opc,
 	rc = (*it_handler)(it_opc, info, lockp, flags);
 
 	/* Check whether the reply has been packed successfully. */
-	if (req->rq_repmsg != NULL) {
+	if (req_capsule_server_packed(pill)) {
 		rep = req_capsule_server_get(info->mti_pill, &RMF_DLM_REP);
 		rep->lock_policy_res2 =
 			ptlrpc_status_hton(rep->lock_policy_res2);
@@ -4676,8 +4691,11 @@ static int mdt_intent_policy(const struct lu_env *env,
 	LASSERT(pill->rc_req == req);
 	ldesc = &info->mti_dlm_req->lock_desc;
 
-	if (req->rq_reqmsg->lm_bufcount > DLM_INTENT_IT_OFF) {
-		req_capsule_extend(pill, &RQF_LDLM_INTENT_BASIC);
+	if (req_capsule_subreq(pill) ||
+	    req->rq_reqmsg->lm_bufcount > DLM_INTENT_IT_OFF) {
+		/* sub-request format has the intent already */
+		if (!req_capsule_subreq(pill))
+			req_capsule_extend(pill, &RQF_LDLM_INTENT_BASIC);
 		it = req_capsule_client_get(pill, &RMF_LDLM_INTENT);
 		if (it != NULL) {
 			mdt_ptlrpc_stats_update(req, it->opc);
@@ -5454,6 +5472,7 @@ TGT_MDT_HDL(HAS_KEY | HAS_BODY | HAS_REPLY | IS_MUTABLE,
 	    MDS_SWAP_LAYOUTS,
 	    mdt_swap_layouts),
 TGT_MDT_HDL(IS_MUTABLE,		MDS_RMFID,	mdt_rmfid),
+TGT_MDT_HDL(0,				MDS_BATCH,	mdt_batch),
 };
 
 static struct tgt_handler mdt_io_ops[] = {
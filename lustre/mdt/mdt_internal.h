@@ -563,6 +563,9 @@ struct mdt_thread_info {
 	struct md_layout_change	   mti_mlc;
 
 	struct lu_seq_range	   mti_range;
+
+	/* capsule of the sub-request being handled by mdt_batch() */
+	struct req_capsule	   mti_sub_pill;
 };
 
 extern struct lu_context_key mdt_thread_key;
@@ -892,6 +895,7 @@ int mdt_revoke_remote_lookup_lock(struct mdt_thread_info *info,
 				  struct mdt_object *obj);
 
 int mdt_get_info(struct tgt_session_info *tsi);
+int mdt_batch(struct tgt_session_info *tsi);
 int mdt_attr_get_complex(struct mdt_thread_info *info,
 			 struct mdt_object *o, struct md_attr *ma);
 int mdt_big_xattr_get(struct mdt_thread_info *info, struct mdt_object *o,
@@ -641,6 +641,9 @@ static const char *const obd_connect_names[] = {
 	"getattr_pfid",		/* 0x20000 */
 	"lseek",		/* 0x40000 */
 	"dom_lvb",		/* 0x80000 */
+	"batch_rpc",		/* 0x100000 */
+	"compress",		/* 0x200000 */
+	"batch_bl_ast",		/* 0x400000 */
 	NULL
 };
 
@@ -772,6 +775,10 @@ obd_connect_data_seqprint(struct seq_file *m, struct obd_connect_data *ocd)
 	if (flags & OBD_CONNECT_MULTIMODRPCS)
 		seq_printf(m, "       max_mod_rpcs: %hu\n",
 			   ocd->ocd_maxmodrpcs);
+	if (flags & OBD_CONNECT_FLAGS2 &&
+	    ocd->ocd_connect_flags2 & OBD_CONNECT2_COMPRESS)
+		seq_printf(m, "       compr_types: %#x\n",
+			   ocd->ocd_compr_types);
 }
 
 static void lprocfs_import_seq_show_locked(struct seq_file *m,
@@ -1493,6 +1500,10 @@ static const char * const mps_stats[] = {
 	[LPROC_MD_GETXATTR]		= "getxattr",
 	[LPROC_MD_INTENT_GETATTR_ASYNC]	= "intent_getattr_async",
 	[LPROC_MD_REVALIDATE_LOCK]	= "revalidate_lock",
+	[LPROC_MD_BATCH_CREATE]		= "batch_create",
+	[LPROC_MD_BATCH_STOP]		= "batch_stop",
+	[LPROC_MD_BATCH_FLUSH]		= "batch_flush",
+	[LPROC_MD_BATCH_ADD]		= "batch_add",
 };
 
 int lprocfs_alloc_md_stats(struct obd_device *obd,
@@ -0,0 +1,87 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ *
+ * Bulk data compression functions, the algorithms are provided by the
+ * kernel crypto compression API.
+ */
+
+#define DEBUG_SUBSYSTEM S_CLASS
+
+#include <obd_class.h>
+#include <obd_compress.h>
+
+/* crypto API names of the compression algorithms */
+static const char *const obd_compr_names[LL_COMPR_TYPE_MAX] = {
+	[LL_COMPR_TYPE_NONE]	= "none",
+	[LL_COMPR_TYPE_LZ4]	= "lz4",
+	[LL_COMPR_TYPE_LZ4HC]	= "lz4hc",
+	[LL_COMPR_TYPE_DEFLATE]	= "deflate",
+	[LL_COMPR_TYPE_ZSTD]	= "zstd",
+};
+
+const char *obd_compr_type2name(enum ll_compr_type type)
+{
+	if (type >= LL_COMPR_TYPE_MAX)
+		return "unknown";
+
+	return obd_compr_names[type];
+}
+EXPORT_SYMBOL(obd_compr_type2name);
+
+int obd_compr_name2type(const char *name)
+{
+	int i;
+
+	for (i = 0; i < LL_COMPR_TYPE_MAX; i++) {
+		if (strcmp(name, obd_compr_names[i]) == 0)
+			return i;
+	}
+
+	return -EINVAL;
+}
+EXPORT_SYMBOL(obd_compr_name2type);
+
+/* mask of the algorithms available in the running kernel */
+__u16 obd_compr_types_supported(void)
+{
+	__u16 types = 0;
+	int i;
+
+	for (i = LL_COMPR_TYPE_NONE + 1; i < LL_COMPR_TYPE_MAX; i++) {
+		if (crypto_has_comp(obd_compr_names[i], 0, 0))
+			types |= BIT(i);
+	}
+
+	return types;
+}
+EXPORT_SYMBOL(obd_compr_types_supported);
+
+struct crypto_comp *obd_compr_alloc(enum ll_compr_type type)
+{
+	if (type == LL_COMPR_TYPE_NONE || type >= LL_COMPR_TYPE_MAX)
+		return ERR_PTR(-EINVAL);
+
+	return crypto_alloc_comp(obd_compr_names[type], 0, 0);
+}
+EXPORT_SYMBOL(obd_compr_alloc);
@@ -44,6 +44,7 @@
 
 #include "ofd_internal.h"
 #include <obd_cksum.h>
+#include <obd_compress.h>
 #include <uapi/linux/lustre/lustre_ioctl.h>
 #include <lustre_quota.h>
 #include <lustre_lfsck.h>
@@ -275,6 +276,13 @@ static int ofd_parse_connect_data(const struct lu_env *env,
 	if (!ofd->ofd_lut.lut_dt_conf.ddp_has_lseek_data_hole)
 		data->ocd_connect_flags2 &= ~OBD_CONNECT2_LSEEK;
 
+	if (OCD_HAS_FLAG(data, FLAGS2) &&
+	    data->ocd_connect_flags2 & OBD_CONNECT2_COMPRESS) {
+		data->ocd_compr_types &= obd_compr_types_supported();
+		if (data->ocd_compr_types == 0)
+			data->ocd_connect_flags2 &= ~OBD_CONNECT2_COMPRESS;
+	}
+
 	RETURN(0);
 }
 
@@ -33,6 +33,7 @@
 #include <linux/version.h>
 #include <asm/statfs.h>
 #include <obd_cksum.h>
+#include <obd_compress.h>
 #include <obd_class.h>
 #include <lprocfs_status.h>
 #include <linux/seq_file.h>
@@ -187,15 +188,22 @@ static int osc_cached_mb_seq_show(struct seq_file *m, void *v)
 {
 	struct obd_device *obd = m->private;
 	struct client_obd *cli = &obd->u.cli;
+	struct cl_lru_part *part;
 	int shift = 20 - PAGE_SHIFT;
+	int i;
 
 	seq_printf(m, "used_mb: %ld\n"
 		   "busy_cnt: %ld\n"
-		   "reclaim: %llu\n",
-		   (atomic_long_read(&cli->cl_lru_in_list) +
+		   "reclaim: %ld\n",
+		   (cli_lru_in_list(cli) +
 		    atomic_long_read(&cli->cl_lru_busy)) >> shift,
 		    atomic_long_read(&cli->cl_lru_busy),
-		   cli->cl_lru_reclaim);
+		   atomic_long_read(&cli->cl_lru_reclaim));
+
+	seq_puts(m, "cpt_lru_cnt:");
+	cfs_percpt_for_each(part, i, cli->cl_lru_parts)
+		seq_printf(m, " %ld", atomic_long_read(&part->clp_in_list));
+	seq_putc(m, '\n');
 
 	return 0;
 }
@@ -227,7 +235,7 @@ static ssize_t osc_cached_mb_seq_write(struct file *file,
 
 	pages_number >>= PAGE_SHIFT;
 
-	rc = atomic_long_read(&cli->cl_lru_in_list) - pages_number;
+	rc = cli_lru_in_list(cli) - pages_number;
 	if (rc > 0) {
 		struct lu_env *env;
 		__u16 refcheck;
@@ -455,6 +463,58 @@ static ssize_t osc_checksum_type_seq_write(struct file *file,
 }
 LPROC_SEQ_FOPS(osc_checksum_type);
 
+static int osc_compress_type_seq_show(struct seq_file *m, void *v)
+{
+	struct obd_device *obd = m->private;
+	__u16 types = obd_compr_types_supported() | BIT(LL_COMPR_TYPE_NONE);
+	int i;
+
+	for (i = 0; i < LL_COMPR_TYPE_MAX; i++) {
+		if ((BIT(i) & types) == 0)
+			continue;
+		if (obd->u.cli.cl_compr_type == i)
+			seq_printf(m, "[%s] ", obd_compr_type2name(i));
+		else
+			seq_printf(m, "%s ", obd_compr_type2name(i));
+	}
+	seq_puts(m, "\n");
+
+	return 0;
+}
+
+static ssize_t osc_compress_type_seq_write(struct file *file,
+					   const char __user *buffer,
+					   size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct obd_device *obd = m->private;
+	char kernbuf[10];
+	int type;
+
+	if (count > sizeof(kernbuf) - 1)
+		return -EINVAL;
+	if (copy_from_user(kernbuf, buffer, count))
+		return -EFAULT;
+
+	if (count > 0 && kernbuf[count - 1] == '\n')
+		kernbuf[count - 1] = '\0';
+	else
+		kernbuf[count] = '\0';
+
+	type = obd_compr_name2type(kernbuf);
+	if (type < 0)
+		return type;
+	if (type != LL_COMPR_TYPE_NONE &&
+	    !(obd_compr_types_supported() & BIT(type)))
+		return -ENOTSUPP;
+
+	/* the type is only used if the OST supports it too */
+	obd->u.cli.cl_compr_type = type;
+
+	return count;
+}
+LPROC_SEQ_FOPS(osc_compress_type);
+
 static ssize_t resend_count_show(struct kobject *kobj,
 				 struct attribute *attr,
 				 char *buf)
@@ -613,6 +673,26 @@ static int osc_unstable_stats_seq_show(struct seq_file *m, void *v)
 }
 LPROC_SEQ_FOPS_RO(osc_unstable_stats);
 
+static int osc_read_bdp_seq_show(struct seq_file *m, void *v)
+{
+	struct obd_device *obd = m->private;
+	struct client_obd *cli = &obd->u.cli;
+	__u64 rtt_min;
+	__u64 bw;
+
+	spin_lock(&cli->cl_loi_list_lock);
+	rtt_min = cli->cl_read_rtt_min;
+	bw = cli->cl_read_bw;
+	spin_unlock(&cli->cl_loi_list_lock);
+
+	seq_printf(m, "rtt_min_us: %llu\n"
+		   "bandwidth_bytes: %llu\n"
+		   "bdp_pages: %lu\n",
+		   rtt_min, bw, osc_read_bdp_pages(cli));
+	return 0;
+}
+LPROC_SEQ_FOPS_RO(osc_read_bdp);
+
 static ssize_t idle_timeout_show(struct kobject *kobj, struct attribute *attr,
 				 char *buf)
 {
@@ -753,6 +833,8 @@ struct lprocfs_vars lprocfs_osc_obd_vars[] = {
 	  .fops	=	&osc_cached_mb_fops		},
 	{ .name =	"cur_grant_bytes",
 	  .fops =	&osc_cur_grant_bytes_fops	},
+	{ .name	=	"compress_type",
+	  .fops	=	&osc_compress_type_fops		},
 	{ .name	=	"checksum_type",
 	  .fops	=	&osc_checksum_type_fops		},
 	{ .name	=	"timeouts",
@@ -765,6 +847,8 @@ struct lprocfs_vars lprocfs_osc_obd_vars[] = {
 	  .fops	=	&osc_pinger_recov_fops		},
 	{ .name	=	"unstable_stats",
 	  .fops	=	&osc_unstable_stats_fops	},
+	{ .name	=	"read_bdp",
+	  .fops	=	&osc_read_bdp_fops		},
 	{ NULL }
 };
 
@@ -900,6 +984,10 @@ static int osc_stats_seq_show(struct seq_file *seq, void *v)
 		   stats->os_lockless_reads);
 	seq_printf(seq, "lockless_truncate\t\t%llu\n",
 		   stats->os_lockless_truncates);
+	seq_printf(seq, "compressed_write_bytes\t\t%llu\n",
+		   stats->os_compr_writes);
+	seq_printf(seq, "compressed_wire_bytes\t\t%llu\n",
+		   stats->os_compr_wire_writes);
 	return 0;
 }
 
@@ -1355,7 +1355,7 @@ static int osc_completion(const struct lu_env *env, struct osc_async_page *oap,
 	       __tmp->cl_lost_grant, __tmp->cl_avail_grant,		\
 	       __tmp->cl_dirty_grant,					\
 	       __tmp->cl_reserved_grant, __tmp->cl_w_in_flight,		\
-	       atomic_long_read(&__tmp->cl_lru_in_list),		\
+	       cli_lru_in_list(__tmp),					\
 	       atomic_long_read(&__tmp->cl_lru_busy),			\
 	       atomic_read(&__tmp->cl_lru_shrinkers), ##args);		\
 } while (0)
@@ -2265,6 +2265,39 @@ int osc_prep_async_page(struct osc_object *osc, struct osc_page *ops,
 }
 EXPORT_SYMBOL(osc_prep_async_page);
 
+/**
+ * Attach the pages collected by osc_queue_async_io() to the active extent.
+ *
+ * The pages are still locked by the writer, and an active extent is not
+ * touched by writeback or truncate, so they can be gathered without the
+ * object lock. This way the object lock is taken once per pagevec instead
+ * of once per page, which matters when many threads write to the same
+ * object. This must be called before the pages are unlocked and before the
+ * active extent is released.
+ */
+void osc_io_pending_flush(struct osc_io *oio)
+{
+	struct osc_extent *ext = oio->oi_active;
+	struct osc_object *osc;
+
+	if (oio->oi_pending_nr == 0)
+		return;
+
+	LASSERT(ext != NULL);
+	osc = ext->oe_obj;
+
+	osc_object_lock(osc);
+	if (ext->oe_nr_pages == 0)
+		ext->oe_srvlock = oio->oi_pending_srvlock;
+	else
+		LASSERT(ext->oe_srvlock == oio->oi_pending_srvlock);
+	ext->oe_nr_pages += oio->oi_pending_nr;
+	list_splice_tail_init(&oio->oi_pending_pages, &ext->oe_pages);
+	osc_object_unlock(osc);
+
+	oio->oi_pending_nr = 0;
+}
+
 int osc_queue_async_io(const struct lu_env *env, struct cl_io *io,
 		       struct osc_page *ops, cl_commit_cbt cb)
 {
@@ -2376,6 +2409,7 @@ int osc_queue_async_io(const struct lu_env *env, struct cl_io *io,
 		need_release = 1;
 	}
 	if (need_release) {
+		osc_io_pending_flush(oio);
 		osc_extent_release(env, ext);
 		oio->oi_active = NULL;
 		ext = NULL;
@@ -2397,6 +2431,7 @@ int osc_queue_async_io(const struct lu_env *env, struct cl_io *io,
 			 * so we must mark dirty & unlock any pages in the
 			 * write commit pagevec. */
 			if (pagevec_count(pvec)) {
+				osc_io_pending_flush(oio);
 				cb(env, io, pvec);
 				pagevec_reinit(pvec);
 			}
@@ -2427,14 +2462,13 @@ int osc_queue_async_io(const struct lu_env *env, struct cl_io *io,
 			 ext, "index = %lu.\n", index);
 		LASSERT((oap->oap_brw_flags & OBD_BRW_FROM_GRANT) != 0);
 
-		osc_object_lock(osc);
-		if (ext->oe_nr_pages == 0)
-			ext->oe_srvlock = ops->ops_srvlock;
+		/* the page is attached to the extent by osc_io_pending_flush() */
+		if (oio->oi_pending_nr == 0)
+			oio->oi_pending_srvlock = ops->ops_srvlock;
 		else
-			LASSERT(ext->oe_srvlock == ops->ops_srvlock);
-		++ext->oe_nr_pages;
-		list_add_tail(&oap->oap_pending_item, &ext->oe_pages);
-		osc_object_unlock(osc);
+			LASSERT(oio->oi_pending_srvlock == ops->ops_srvlock);
+		++oio->oi_pending_nr;
+		list_add_tail(&oap->oap_pending_item, &oio->oi_pending_pages);
 
 		if (!ext->oe_layout_version)
 			ext->oe_layout_version = io->ci_layout_version;
@@ -86,6 +86,7 @@ int osc_process_config_base(struct obd_device *obd, struct lustre_cfg *cfg);
 int osc_build_rpc(const struct lu_env *env, struct client_obd *cli,
 		  struct list_head *ext_list, int cmd);
 unsigned long osc_lru_reserve(struct client_obd *cli, unsigned long npages);
+unsigned long osc_read_bdp_pages(struct client_obd *cli);
 void osc_lru_unreserve(struct client_obd *cli, unsigned long npages);
 
 extern struct lu_kmem_descr osc_caches[];
@@ -93,6 +93,7 @@ static int osc_io_read_ahead(const struct lu_env *env,
 		}
 
 		ra->cra_rpc_pages = osc_cli(osc)->cl_max_pages_per_rpc;
+		ra->cra_bdp_pages = osc_read_bdp_pages(osc_cli(osc));
 		ra->cra_end_idx = cl_index(osc2cl(osc),
 					   dlmlock->l_policy_data.l_extent.end);
 		ra->cra_release = osc_read_ahead_release;
@@ -321,6 +322,8 @@ int osc_io_commit_async(const struct lu_env *env,
 	}
 
 	ll_pagevec_init(pvec, 0);
+	INIT_LIST_HEAD(&oio->oi_pending_pages);
+	oio->oi_pending_nr = 0;
 
 	while (qin->pl_nr > 0) {
 		struct osc_async_page *oap;
@@ -353,11 +356,15 @@ int osc_io_commit_async(const struct lu_env *env,
 
 		/* if there are no more slots, do the callback & reinit */
 		if (pagevec_add(pvec, page->cp_vmpage) == 0) {
+			osc_io_pending_flush(oio);
 			(*cb)(env, io, pvec);
 			pagevec_reinit(pvec);
 		}
 	}
 
+	/* Pages must be in the extent before they are unlocked */
+	osc_io_pending_flush(oio);
+
 	/* Clean up any partially full pagevecs */
 	if (pagevec_count(pvec) != 0)
 		(*cb)(env, io, pvec);
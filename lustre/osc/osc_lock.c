@@ -660,38 +660,51 @@ static bool weigh_cb(const struct lu_env *env, struct cl_io *io,
 	return true;
 }
 
+/* the most pages counted under a lock for its LRU cost */
+#define OSC_LRU_COST_PAGES	(1UL << 15)
+
+static bool cost_cb(const struct lu_env *env, struct cl_io *io,
+		    struct osc_page *ops, void *cbdata)
+{
+	return ++(*(unsigned long *)cbdata) < OSC_LRU_COST_PAGES;
+}
+
+/**
+ * Returns 1 if there are pages under [\a start, \a end] which cannot be
+ * discarded right away, 0 otherwise. If \a count is set, returns the number
+ * of cached pages under the extent instead, up to OSC_LRU_COST_PAGES.
+ */
 static unsigned long osc_lock_weight(const struct lu_env *env,
 				     struct osc_object *oscobj,
-				     loff_t start, loff_t end)
+				     loff_t start, loff_t end, bool count)
 {
 	struct cl_io *io = osc_env_thread_io(env);
 	struct cl_object *obj = cl_object_top(&oscobj->oo_cl);
-	pgoff_t page_index;
-	int result;
+	pgoff_t page_index = cl_index(obj, start);
+	unsigned long result = 0;
+	int rc;
 
 	ENTRY;
 
 	io->ci_obj = obj;
 	io->ci_ignore_layout = 1;
-	result = cl_io_init(env, io, CIT_MISC, io->ci_obj);
-	if (result != 0)
-		RETURN(1);
+	rc = cl_io_init(env, io, CIT_MISC, io->ci_obj);
+	if (rc != 0)
+		RETURN(count ? OSC_LRU_COST_PAGES : 1);
 
-	page_index = cl_index(obj, start);
-
-	if (!osc_page_gang_lookup(env, io, oscobj,
-				  page_index, cl_index(obj, end),
-				  weigh_cb, (void *)&page_index))
-		result = 1;
+	if (count)
+		osc_page_gang_lookup(env, io, oscobj, page_index,
+				     cl_index(obj, end), cost_cb, &result);
+	else
+		result = !osc_page_gang_lookup(env, io, oscobj, page_index,
+					       cl_index(obj, end), weigh_cb,
+					       (void *)&page_index);
 	cl_io_fini(env, io);
 
-	return result;
+	RETURN(result);
 }
 
-/**
- * Get the weight of dlm lock for early cancellation.
- */
-unsigned long osc_ldlm_weigh_ast(struct ldlm_lock *dlmlock)
+static unsigned long osc_ldlm_weigh(struct ldlm_lock *dlmlock, bool count)
 {
 	struct lu_env *env;
 	struct osc_object *obj;
@@ -739,15 +752,16 @@ unsigned long osc_ldlm_weigh_ast(struct ldlm_lock *dlmlock)
 		/*
 		 * If the lock is being used by an IO, definitely not cancel it.
 		 */
-		GOTO(out, weight = 1);
+		GOTO(out, weight = count ? OSC_LRU_COST_PAGES : 1);
 	}
 
 	if (dlmlock->l_resource->lr_type == LDLM_EXTENT)
 		weight = osc_lock_weight(env, obj,
 					 dlmlock->l_policy_data.l_extent.start,
-					 dlmlock->l_policy_data.l_extent.end);
+					 dlmlock->l_policy_data.l_extent.end,
+					 count);
 	else if (ldlm_has_dom(dlmlock))
-		weight = osc_lock_weight(env, obj, 0, OBD_OBJECT_EOF);
+		weight = osc_lock_weight(env, obj, 0, OBD_OBJECT_EOF, count);
 	/* The DOM bit can be cancelled at any time; in that case, we know
 	 * there are no pages, so just return weight of 0
 	 */
@@ -763,8 +777,30 @@ out:
 	cl_env_put(env, &refcheck);
 	return weight;
 }
+
+/**
+ * Get the weight of dlm lock for early cancellation.
+ */
+unsigned long osc_ldlm_weigh_ast(struct ldlm_lock *dlmlock)
+{
+	return osc_ldlm_weigh(dlmlock, false);
+}
 EXPORT_SYMBOL(osc_ldlm_weigh_ast);
 
+/**
+ * Get the cost of cancelling an unused dlm lock for cost-aware LRU, that is
+ * the number of cached pages which would be discarded with the lock.
+ */
+unsigned long osc_ldlm_lru_cost(struct ldlm_lock *dlmlock)
+{
+	if (dlmlock->l_resource->lr_type != LDLM_EXTENT &&
+	    !ldlm_has_dom(dlmlock))
+		return 0;
+
+	return osc_ldlm_weigh(dlmlock, true);
+}
+EXPORT_SYMBOL(osc_ldlm_lru_cost);
+
 static void osc_lock_build_einfo(const struct lu_env *env,
 				 const struct cl_lock *lock,
 				 struct osc_object *osc,
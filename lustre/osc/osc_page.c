@@ -364,7 +364,7 @@ static inline int lru_shrink_max(struct client_obd *cli)
 static int osc_cache_too_much(struct client_obd *cli)
 {
 	struct cl_client_cache *cache = cli->cl_cache;
-	long pages = atomic_long_read(&cli->cl_lru_in_list);
+	long pages = cli_lru_in_list(cli);
 	unsigned long budget;
 
 	LASSERT(cache != NULL);
@@ -416,12 +416,20 @@ int lru_queue_work(const struct lu_env *env, void *data)
 	RETURN(0);
 }
 
+/**
+ * Pages are added to the LRU partition of the current CPT, the one of the
+ * ptlrpcd thread completing the transfer, which usually runs on the CPT of
+ * the thread that dirtied the pages.
+ */
 void osc_lru_add_batch(struct client_obd *cli, struct list_head *plist)
 {
 	LIST_HEAD(lru);
+	struct cl_lru_part *part;
 	struct osc_async_page *oap;
 	long npages = 0;
+	int cpt;
 
+	cpt = cfs_cpt_current(cfs_cpt_tab, 1);
 	list_for_each_entry(oap, plist, oap_pending_item) {
 		struct osc_page *opg = oap2osc_page(oap);
 
@@ -430,27 +438,35 @@ void osc_lru_add_batch(struct client_obd *cli, struct list_head *plist)
 
 		++npages;
 		LASSERT(list_empty(&opg->ops_lru));
+		opg->ops_lru_cpt = cpt;
 		list_add(&opg->ops_lru, &lru);
 	}
 
 	if (npages > 0) {
-		spin_lock(&cli->cl_lru_list_lock);
-		list_splice_tail(&lru, &cli->cl_lru_list);
+		part = cli->cl_lru_parts[cpt];
+		spin_lock(&part->clp_lock);
+		list_splice_tail(&lru, &part->clp_list);
+		atomic_long_add(npages, &part->clp_in_list);
+		spin_unlock(&part->clp_lock);
 		atomic_long_sub(npages, &cli->cl_lru_busy);
-		atomic_long_add(npages, &cli->cl_lru_in_list);
 		cli->cl_lru_last_used = ktime_get_real_seconds();
-		spin_unlock(&cli->cl_lru_list_lock);
 
 		if (waitqueue_active(&osc_lru_waitq))
 			(void)ptlrpcd_queue_work(cli->cl_lru_work);
 	}
 }
 
-static void __osc_lru_del(struct client_obd *cli, struct osc_page *opg)
+static inline struct cl_lru_part *osc_lru_part(struct client_obd *cli,
+					       struct osc_page *opg)
+{
+	return cli->cl_lru_parts[opg->ops_lru_cpt];
+}
+
+static void __osc_lru_del(struct cl_lru_part *part, struct osc_page *opg)
 {
-	LASSERT(atomic_long_read(&cli->cl_lru_in_list) > 0);
+	LASSERT(atomic_long_read(&part->clp_in_list) > 0);
 	list_del_init(&opg->ops_lru);
-	atomic_long_dec(&cli->cl_lru_in_list);
+	atomic_long_dec(&part->clp_in_list);
 }
 
 /**
@@ -460,14 +476,16 @@ static void __osc_lru_del(struct client_obd *cli, struct osc_page *opg)
 static void osc_lru_del(struct client_obd *cli, struct osc_page *opg)
 {
 	if (opg->ops_in_lru) {
-		spin_lock(&cli->cl_lru_list_lock);
+		struct cl_lru_part *part = osc_lru_part(cli, opg);
+
+		spin_lock(&part->clp_lock);
 		if (!list_empty(&opg->ops_lru)) {
-			__osc_lru_del(cli, opg);
+			__osc_lru_del(part, opg);
 		} else {
 			LASSERT(atomic_long_read(&cli->cl_lru_busy) > 0);
 			atomic_long_dec(&cli->cl_lru_busy);
 		}
-		spin_unlock(&cli->cl_lru_list_lock);
+		spin_unlock(&part->clp_lock);
 
 		atomic_long_inc(cli->cl_lru_left);
 		/* this is a great place to release more LRU pages if
@@ -491,14 +509,17 @@ static void osc_lru_use(struct client_obd *cli, struct osc_page *opg)
 	/* If page is being transferred for the first time,
 	 * ops_lru should be empty */
 	if (opg->ops_in_lru) {
+		struct cl_lru_part *part;
+
 		if (list_empty(&opg->ops_lru))
 			return;
-		spin_lock(&cli->cl_lru_list_lock);
+		part = osc_lru_part(cli, opg);
+		spin_lock(&part->clp_lock);
 		if (!list_empty(&opg->ops_lru)) {
-			__osc_lru_del(cli, opg);
+			__osc_lru_del(part, opg);
 			atomic_long_inc(&cli->cl_lru_busy);
 		}
-		spin_unlock(&cli->cl_lru_list_lock);
+		spin_unlock(&part->clp_lock);
 	}
 }
 
@@ -546,10 +567,12 @@ static inline bool lru_page_busy(struct client_obd *cli, struct cl_page *page)
 }
 
 /**
- * Drop @target of pages from LRU at most.
+ * Drop @target of pages from the LRU partition @part at most.
  */
-long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
-		   long target, bool force)
+static long osc_lru_shrink_part(const struct lu_env *env,
+				struct client_obd *cli,
+				struct cl_lru_part *part, long target,
+				bool force)
 {
 	struct cl_io *io;
 	struct cl_object *clobj = NULL;
@@ -561,32 +584,12 @@ long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 	int rc = 0;
 	ENTRY;
 
-	LASSERT(atomic_long_read(&cli->cl_lru_in_list) >= 0);
-	if (atomic_long_read(&cli->cl_lru_in_list) == 0 || target <= 0)
-		RETURN(0);
-
-	CDEBUG(D_CACHE, "%s: shrinkers: %d, force: %d\n",
-	       cli_name(cli), atomic_read(&cli->cl_lru_shrinkers), force);
-	if (!force) {
-		if (atomic_read(&cli->cl_lru_shrinkers) > 0)
-			RETURN(-EBUSY);
-
-		if (atomic_inc_return(&cli->cl_lru_shrinkers) > 1) {
-			atomic_dec(&cli->cl_lru_shrinkers);
-			RETURN(-EBUSY);
-		}
-	} else {
-		atomic_inc(&cli->cl_lru_shrinkers);
-	}
-
 	pvec = (struct cl_page **)osc_env_info(env)->oti_pvec;
 	io = osc_env_thread_io(env);
 
-	spin_lock(&cli->cl_lru_list_lock);
-	if (force)
-		cli->cl_lru_reclaim++;
-	maxscan = min(target << 1, atomic_long_read(&cli->cl_lru_in_list));
-	while (!list_empty(&cli->cl_lru_list)) {
+	spin_lock(&part->clp_lock);
+	maxscan = min(target << 1, atomic_long_read(&part->clp_in_list));
+	while (!list_empty(&part->clp_list)) {
 		struct cl_page *page;
 		bool will_free = false;
 
@@ -596,11 +599,11 @@ long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 		if (--maxscan < 0)
 			break;
 
-		opg = list_entry(cli->cl_lru_list.next, struct osc_page,
+		opg = list_entry(part->clp_list.next, struct osc_page,
 				 ops_lru);
 		page = opg->ops_cl.cpl_page;
 		if (lru_page_busy(cli, page)) {
-			list_move_tail(&opg->ops_lru, &cli->cl_lru_list);
+			list_move_tail(&opg->ops_lru, &part->clp_list);
 			continue;
 		}
 
@@ -609,7 +612,7 @@ long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 			struct cl_object *tmp = page->cp_obj;
 
 			cl_object_get(tmp);
-			spin_unlock(&cli->cl_lru_list_lock);
+			spin_unlock(&part->clp_lock);
 
 			if (clobj != NULL) {
 				discard_pagevec(env, io, pvec, index);
@@ -625,7 +628,7 @@ long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 			io->ci_ignore_layout = 1;
 			rc = cl_io_init(env, io, CIT_MISC, clobj);
 
-			spin_lock(&cli->cl_lru_list_lock);
+			spin_lock(&part->clp_lock);
 
 			if (rc != 0)
 				break;
@@ -638,7 +641,7 @@ long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 			if (!lru_page_busy(cli, page)) {
 				/* remove it from lru list earlier to avoid
 				 * lock contention */
-				__osc_lru_del(cli, opg);
+				__osc_lru_del(part, opg);
 				opg->ops_in_lru = 0; /* will be discarded */
 
 				cl_page_get(page);
@@ -649,24 +652,24 @@ long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 		}
 
 		if (!will_free) {
-			list_move_tail(&opg->ops_lru, &cli->cl_lru_list);
+			list_move_tail(&opg->ops_lru, &part->clp_list);
 			continue;
 		}
 
-		/* Don't discard and free the page with cl_lru_list held */
+		/* Don't discard and free the page with clp_lock held */
 		pvec[index++] = page;
 		if (unlikely(index == OTI_PVEC_SIZE)) {
-			spin_unlock(&cli->cl_lru_list_lock);
+			spin_unlock(&part->clp_lock);
 			discard_pagevec(env, io, pvec, index);
 			index = 0;
 
-			spin_lock(&cli->cl_lru_list_lock);
+			spin_lock(&part->clp_lock);
 		}
 
 		if (++count >= target)
 			break;
 	}
-	spin_unlock(&cli->cl_lru_list_lock);
+	spin_unlock(&part->clp_lock);
 
 	if (clobj != NULL) {
 		discard_pagevec(env, io, pvec, index);
@@ -675,6 +678,79 @@ long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 		cl_object_put(env, clobj);
 	}
 
+	RETURN(count > 0 ? count : rc);
+}
+
+/**
+ * Drop @target of pages from LRU at most.
+ *
+ * The share of a LRU partition is an equal part of the pages of the
+ * client_obd. Partitions above their share are shrunk first, which
+ * rebalances the LRU between CPTs, then the partition of the current CPT
+ * and the following ones.
+ */
+long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
+		   long target, bool force)
+{
+	struct cl_lru_part *part;
+	long in_list = cli_lru_in_list(cli);
+	long count = 0;
+	long share;
+	long rc = 0;
+	int ncpt;
+	int cpt;
+	int i;
+	ENTRY;
+
+	LASSERT(in_list >= 0);
+	if (in_list == 0 || target <= 0)
+		RETURN(0);
+
+	CDEBUG(D_CACHE, "%s: shrinkers: %d, force: %d\n",
+	       cli_name(cli), atomic_read(&cli->cl_lru_shrinkers), force);
+	if (!force) {
+		if (atomic_read(&cli->cl_lru_shrinkers) > 0)
+			RETURN(-EBUSY);
+
+		if (atomic_inc_return(&cli->cl_lru_shrinkers) > 1) {
+			atomic_dec(&cli->cl_lru_shrinkers);
+			RETURN(-EBUSY);
+		}
+	} else {
+		atomic_inc(&cli->cl_lru_shrinkers);
+		atomic_long_inc(&cli->cl_lru_reclaim);
+	}
+
+	ncpt = cfs_percpt_number(cli->cl_lru_parts);
+	share = in_list / ncpt;
+	cfs_percpt_for_each(part, i, cli->cl_lru_parts) {
+		long over = atomic_long_read(&part->clp_in_list) - share;
+
+		if (count >= target)
+			break;
+		if (ncpt == 1 || over <= 0)
+			continue;
+
+		rc = osc_lru_shrink_part(env, cli, part,
+					 min(over, target - count), force);
+		if (rc < 0)
+			GOTO(out, rc);
+		count += rc;
+	}
+
+	cpt = cfs_cpt_current(cfs_cpt_tab, 1);
+	for (i = 0; i < ncpt && count < target; i++) {
+		part = cli->cl_lru_parts[(cpt + i) % ncpt];
+		if (atomic_long_read(&part->clp_in_list) == 0)
+			continue;
+
+		rc = osc_lru_shrink_part(env, cli, part, target - count,
+					 force);
+		if (rc < 0)
+			GOTO(out, rc);
+		count += rc;
+	}
+out:
 	atomic_dec(&cli->cl_lru_shrinkers);
 	if (count > 0) {
 		atomic_long_add(count, cli->cl_lru_left);
@@ -720,7 +796,7 @@ static long osc_lru_reclaim(struct client_obd *cli, unsigned long npages)
 	}
 
 	CDEBUG(D_CACHE, "%s: cli %p no free slots, pages: %ld/%ld, want: %ld\n",
-		cli_name(cli), cli, atomic_long_read(&cli->cl_lru_in_list),
+		cli_name(cli), cli, cli_lru_in_list(cli),
 		atomic_long_read(&cli->cl_lru_busy), npages);
 
 	/* Reclaim LRU slots from other client_obd as it can't free enough
@@ -738,7 +814,7 @@ static long osc_lru_reclaim(struct client_obd *cli, unsigned long npages)
 
 		CDEBUG(D_CACHE, "%s: cli %p LRU pages: %ld, busy: %ld.\n",
 			cli_name(cli), cli,
-			atomic_long_read(&cli->cl_lru_in_list),
+			cli_lru_in_list(cli),
 			atomic_long_read(&cli->cl_lru_busy));
 
 		list_move_tail(&cli->cl_lru_osc, &cache->ccc_lru);
@@ -1081,7 +1157,7 @@ unsigned long osc_cache_shrink_count(struct shrinker *sk,
 
 	spin_lock(&osc_shrink_lock);
 	list_for_each_entry(cli, &osc_shrink_list, cl_shrink_list)
-		cached += atomic_long_read(&cli->cl_lru_in_list);
+		cached += cli_lru_in_list(cli);
 	spin_unlock(&osc_shrink_lock);
 
 	return (cached  * sysctl_vfs_cache_pressure) / 100;
@@ -43,6 +43,7 @@
 #include <lustre_obdo.h>
 #include <obd.h>
 #include <obd_cksum.h>
+#include <obd_compress.h>
 #include <obd_class.h>
 #include <lustre_osc.h>
 #include <linux/falloc.h>
@@ -1372,6 +1373,181 @@ static inline void osc_release_bounce_pages(struct brw_page **pga,
 #endif
 }
 
+/* compressed bulk of a write RPC, see struct brw_compr_desc */
+struct osc_brw_compr {
+	struct brw_compr_desc	 *obc_desc;
+	u32			  obc_desc_size;
+	struct page		**obc_pages;
+	u32			  obc_page_count;
+	u32			  obc_max_pages;
+	/* bytes of compressed bulk */
+	u32			  obc_nob;
+};
+
+static void osc_brw_compr_fini(struct osc_brw_compr *obc)
+{
+	int i;
+
+	for (i = 0; i < obc->obc_page_count; i++)
+		__free_page(obc->obc_pages[i]);
+	if (obc->obc_pages)
+		OBD_FREE_PTR_ARRAY_LARGE(obc->obc_pages, obc->obc_max_pages);
+	if (obc->obc_desc)
+		OBD_FREE_LARGE(obc->obc_desc, obc->obc_desc_size);
+	memset(obc, 0, sizeof(*obc));
+}
+
+/* append @len bytes of @buf to the compressed bulk */
+static int osc_brw_compr_append(struct osc_brw_compr *obc, const char *buf,
+				u32 len)
+{
+	while (len > 0) {
+		unsigned int poff = obc->obc_nob & ~PAGE_MASK;
+		unsigned int count = min_t(unsigned int, len, PAGE_SIZE - poff);
+		char *ptr;
+
+		if (poff == 0) {
+			struct page *page;
+
+			/* it doesn't save any page of bulk */
+			if (obc->obc_page_count == obc->obc_max_pages)
+				return -EOVERFLOW;
+
+			page = alloc_page(GFP_NOFS);
+			if (page == NULL)
+				return -ENOMEM;
+			obc->obc_pages[obc->obc_page_count++] = page;
+		}
+
+		ptr = kmap_atomic(obc->obc_pages[obc->obc_page_count - 1]);
+		memcpy(ptr + poff, buf, count);
+		kunmap_atomic(ptr);
+
+		buf += count;
+		len -= count;
+		obc->obc_nob += count;
+	}
+
+	return 0;
+}
+
+/* compress @slen bytes of @src, or send them as is if that saves nothing */
+static int osc_brw_compr_piece(struct crypto_comp *cc,
+			       struct osc_brw_compr *obc, const char *src,
+			       u32 slen, char *dst, u32 *wire_size)
+{
+	unsigned int dlen = slen;
+	int rc;
+
+	rc = crypto_comp_compress(cc, src, slen, dst, &dlen);
+	if (rc == 0 && dlen < slen) {
+		*wire_size = dlen;
+		return osc_brw_compr_append(obc, dst, dlen);
+	}
+
+	*wire_size = slen;
+	return osc_brw_compr_append(obc, src, slen);
+}
+
+/* Does the page start a new piece, see struct brw_compr_desc */
+static inline bool osc_brw_compr_new_piece(struct brw_page **pga, int i,
+					   unsigned int chunk_bits)
+{
+	return i == 0 || !can_merge_pages(pga[i - 1], pga[i]) ||
+	       (pga[i]->off & ((1ULL << chunk_bits) - 1)) == 0;
+}
+
+/*
+ * Compress the pages of a write RPC with @niocount niobufs chunk by chunk
+ * into newly allocated pages.
+ *
+ * \retval 0		@obc holds the compressed bulk
+ * \retval negative	the data can't or shouldn't be compressed
+ */
+static int osc_brw_compress(enum ll_compr_type type, struct brw_page **pga,
+			    u32 page_count, int niocount,
+			    struct osc_brw_compr *obc)
+{
+	unsigned int chunk_bits = OBD_COMPR_CHUNK_BITS_DEF;
+	u32 chunk_size = 1U << chunk_bits;
+	struct crypto_comp *cc;
+	char *src = NULL;
+	char *dst = NULL;
+	u32 count = 0;
+	u32 slen = 0;
+	int i;
+	int rc;
+
+	ENTRY;
+
+	for (i = 0; i < page_count; i++) {
+		if (osc_brw_compr_new_piece(pga, i, chunk_bits))
+			count++;
+	}
+
+	memset(obc, 0, sizeof(*obc));
+	obc->obc_desc_size = offsetof(struct brw_compr_desc, bcd_sizes[count]);
+	/* the descriptor must fit in the room left by niobufs in request */
+	if (obc->obc_desc_size > (DT_MAX_BRW_PAGES - niocount) *
+				 sizeof(struct niobuf_remote))
+		RETURN(-E2BIG);
+
+	cc = obd_compr_alloc(type);
+	if (IS_ERR(cc))
+		RETURN(PTR_ERR(cc));
+
+	OBD_ALLOC_LARGE(obc->obc_desc, obc->obc_desc_size);
+	obc->obc_max_pages = page_count;
+	OBD_ALLOC_PTR_ARRAY_LARGE(obc->obc_pages, obc->obc_max_pages);
+	OBD_ALLOC_LARGE(src, chunk_size);
+	OBD_ALLOC_LARGE(dst, chunk_size);
+	if (!obc->obc_desc || !obc->obc_pages || !src || !dst)
+		GOTO(out, rc = -ENOMEM);
+
+	count = 0;
+	for (i = 0; i < page_count; i++) {
+		struct brw_page *pg = pga[i];
+		char *ptr;
+
+		if (i > 0 && osc_brw_compr_new_piece(pga, i, chunk_bits)) {
+			rc = osc_brw_compr_piece(cc, obc, src, slen, dst,
+					&obc->obc_desc->bcd_sizes[count++]);
+			if (rc)
+				GOTO(out, rc);
+			slen = 0;
+		}
+
+		LASSERT(slen + pg->count <= chunk_size);
+		ptr = kmap_atomic(pg->pg);
+		memcpy(src + slen, ptr + (pg->off & ~PAGE_MASK), pg->count);
+		kunmap_atomic(ptr);
+		slen += pg->count;
+	}
+	rc = osc_brw_compr_piece(cc, obc, src, slen, dst,
+				 &obc->obc_desc->bcd_sizes[count++]);
+	if (rc)
+		GOTO(out, rc);
+
+	/* not worth it unless at least one page of bulk is saved */
+	if (obc->obc_page_count == page_count)
+		GOTO(out, rc = -EOVERFLOW);
+
+	obc->obc_desc->bcd_type = type;
+	obc->obc_desc->bcd_chunk_bits = chunk_bits;
+	obc->obc_desc->bcd_count = count;
+	EXIT;
+out:
+	if (dst)
+		OBD_FREE_LARGE(dst, chunk_size);
+	if (src)
+		OBD_FREE_LARGE(src, chunk_size);
+	obd_compr_free(cc);
+	if (rc)
+		osc_brw_compr_fini(obc);
+
+	return rc;
+}
+
 static int
 osc_brw_prep_request(int cmd, struct client_obd *cli, struct obdo *oa,
 		     u32 page_count, struct brw_page **pga,
@@ -1388,6 +1564,8 @@ osc_brw_prep_request(int cmd, struct client_obd *cli, struct obdo *oa,
 	struct brw_page *pg_prev;
 	void *short_io_buf;
 	const char *obd_name = cli->cl_import->imp_obd->obd_name;
+	struct osc_brw_compr obc = { NULL };
+	enum ll_compr_type compr_type = cli->cl_compr_type;
 	struct inode *inode;
 	bool directio = false;
 
@@ -1542,8 +1720,27 @@ retry_encrypt:
 		req_capsule_set_size(pill, &RMF_SHORT_IO, RCL_SERVER,
 				     short_io_size);
 
+	/* Encrypted data doesn't compress, and don't allocate more memory for
+	 * writes which are run to free some.
+	 */
+	if (opc == OST_WRITE && short_io_size == 0 &&
+	    compr_type != LL_COMPR_TYPE_NONE &&
+	    imp_connect_compress(cli->cl_import, compr_type) &&
+	    !(inode && IS_ENCRYPTED(inode)) &&
+	    !(pga[0]->flag & OBD_BRW_MEMALLOC)) {
+		rc = osc_brw_compress(compr_type, pga, page_count, niocount,
+				      &obc);
+		if (rc == 0)
+			req_capsule_set_size(pill, &RMF_OST_COMPR, RCL_CLIENT,
+					     obc.obc_desc_size);
+		else
+			CDEBUG(D_CACHE, "%s: write sent uncompressed: rc = %d\n",
+			       obd_name, rc);
+	}
+
         rc = ptlrpc_request_pack(req, LUSTRE_OST_VERSION, opc);
         if (rc) {
+		osc_brw_compr_fini(&obc);
                 ptlrpc_request_free(req);
                 RETURN(rc);
         }
@@ -1560,7 +1757,8 @@ retry_encrypt:
 		goto no_bulk;
 	}
 
-	desc = ptlrpc_prep_bulk_imp(req, page_count,
+	desc = ptlrpc_prep_bulk_imp(req,
+		obc.obc_desc ? obc.obc_page_count : page_count,
 		cli->cl_import->imp_connect_data.ocd_brw_size >> LNET_MTU_BITS,
 		(opc == OST_WRITE ? PTLRPC_BULK_GET_SOURCE :
 			PTLRPC_BULK_PUT_SINK),
@@ -1646,7 +1844,7 @@ no_bulk:
 			       ptr + poff,
 			       pg->count);
 			kunmap_atomic(ptr);
-		} else if (short_io_size == 0) {
+		} else if (short_io_size == 0 && !obc.obc_desc) {
 			desc->bd_frag_ops->add_kiov_frag(desc, pg->pg, poff,
 							 pg->count);
 		}
@@ -1668,6 +1866,28 @@ no_bulk:
                 "want %p - real %p\n", req_capsule_client_get(&req->rq_pill,
                 &RMF_NIOBUF_REMOTE), (void *)(niobuf - niocount));
 
+	if (obc.obc_desc) {
+		struct osc_stats *stats;
+
+		/* the bulk descriptor keeps its own reference on the pages */
+		for (i = 0; i < obc.obc_page_count; i++) {
+			desc->bd_frag_ops->add_kiov_frag(desc,
+				obc.obc_pages[i], 0,
+				min_t(u32, PAGE_SIZE,
+				      obc.obc_nob - i * PAGE_SIZE));
+		}
+		memcpy(req_capsule_client_get(pill, &RMF_OST_COMPR),
+		       obc.obc_desc, obc.obc_desc_size);
+
+		stats = &obd2osc_dev(cli->cl_import->imp_obd)->od_stats;
+		stats->os_compr_writes += requested_nob;
+		stats->os_compr_wire_writes += obc.obc_nob;
+		CDEBUG(D_CACHE, "%s: compressed write %d -> %u bytes with %s\n",
+		       obd_name, requested_nob, obc.obc_nob,
+		       obd_compr_type2name(compr_type));
+		osc_brw_compr_fini(&obc);
+	}
+
         osc_announce_cached(cli, &body->oa, opc == OST_WRITE ? requested_nob:0);
         if (resend) {
                 if ((body->oa.o_valid & OBD_MD_FLFLAGS) == 0) {
@@ -1755,6 +1975,7 @@ no_bulk:
         RETURN(0);
 
  out:
+	osc_brw_compr_fini(&obc);
         ptlrpc_req_finished(req);
         RETURN(rc);
 }
@@ -2296,6 +2517,78 @@ static void osc_release_ppga(struct brw_page **ppga, size_t count)
 	OBD_FREE_PTR_ARRAY_LARGE(ppga, count);
 }
 
+/* window of the minimum read RTT, seconds */
+#define OSC_READ_RTT_WINDOW	10
+/* minimum duration of a read bandwidth sample, usec */
+#define OSC_READ_BW_SAMPLE	(100 * USEC_PER_MSEC)
+
+/**
+ * Account a completed read RPC into the bandwidth-delay estimate of \a cli.
+ *
+ * The delay is the minimum RPC round trip seen during the last
+ * OSC_READ_RTT_WINDOW seconds, so that it reflects the network path rather
+ * than the queueing. The bandwidth is a moving average of the aggregate
+ * read throughput measured over samples of at least OSC_READ_BW_SAMPLE,
+ * it drops when the OST gets congested.
+ */
+static void osc_read_bdp_update(struct client_obd *cli,
+				struct ptlrpc_request *req,
+				unsigned long transferred)
+{
+	ktime_t now = ktime_get_real();
+	s64 rtt = ktime_us_delta(now, req->rq_sent_ns);
+	s64 elapsed;
+	__u64 rate;
+
+	assert_spin_locked(&cli->cl_loi_list_lock);
+
+	if (rtt <= 0 || transferred == 0)
+		return;
+
+	if (cli->cl_read_rtt_min == 0 || rtt < cli->cl_read_rtt_min ||
+	    ktime_get_seconds() > cli->cl_read_rtt_stamp +
+				  OSC_READ_RTT_WINDOW) {
+		cli->cl_read_rtt_min = rtt;
+		cli->cl_read_rtt_stamp = ktime_get_seconds();
+	}
+
+	/* start a new sample after an idle period */
+	if (cli->cl_read_sample_bytes == 0 ||
+	    ktime_us_delta(req->rq_sent_ns, cli->cl_read_sample_last) >
+	    OSC_READ_BW_SAMPLE) {
+		cli->cl_read_sample_start = req->rq_sent_ns;
+		cli->cl_read_sample_bytes = 0;
+	}
+	cli->cl_read_sample_bytes += transferred;
+	cli->cl_read_sample_last = now;
+
+	elapsed = ktime_us_delta(now, cli->cl_read_sample_start);
+	if (elapsed < OSC_READ_BW_SAMPLE)
+		return;
+
+	rate = div64_u64(cli->cl_read_sample_bytes * USEC_PER_SEC, elapsed);
+	if (cli->cl_read_bw == 0)
+		cli->cl_read_bw = rate;
+	else
+		cli->cl_read_bw = (cli->cl_read_bw * 7 + rate) >> 3;
+	cli->cl_read_sample_bytes = 0;
+}
+
+/**
+ * Bandwidth-delay product of read RPCs to this target, by pages.
+ *
+ * \retval 0 if there is no estimate yet
+ */
+unsigned long osc_read_bdp_pages(struct client_obd *cli)
+{
+	__u64 bdp;
+
+	bdp = div64_u64(READ_ONCE(cli->cl_read_bw) *
+			READ_ONCE(cli->cl_read_rtt_min), USEC_PER_SEC);
+
+	return bdp >> PAGE_SHIFT;
+}
+
 static int brw_interpret(const struct lu_env *env,
 			 struct ptlrpc_request *req, void *args, int rc)
 {
@@ -2420,6 +2713,8 @@ static int brw_interpret(const struct lu_env *env,
 		cli->cl_w_in_flight--;
 	else
 		cli->cl_r_in_flight--;
+	if (lustre_msg_get_opc(req->rq_reqmsg) == OST_READ && rc == 0)
+		osc_read_bdp_update(cli, req, transferred);
 	osc_wake_cache_waiters(cli);
 	spin_unlock(&cli->cl_loi_list_lock);
 
@@ -2736,8 +3031,8 @@ int osc_enqueue_interpret(const struct lu_env *env, struct ptlrpc_request *req,
 	}
 
 	/* Complete obtaining the lock procedure. */
-	rc = ldlm_cli_enqueue_fini(aa->oa_exp, req, &einfo, 1, aa->oa_flags,
-				   lvb, lvb_len, lockh, rc);
+	rc = ldlm_cli_enqueue_fini(aa->oa_exp, &req->rq_pill, &einfo, 1,
+				   aa->oa_flags, lvb, lvb_len, lockh, rc);
 	/* Complete osc stuff. */
 	rc = osc_enqueue_fini(req, aa->oa_upcall, aa->oa_cookie, lockh, mode,
 			      aa->oa_flags, aa->oa_speculative, rc);
@@ -3149,7 +3444,7 @@ int osc_set_info_async(const struct lu_env *env, struct obd_export *exp,
 
 	if (KEY_IS(KEY_CACHE_LRU_SHRINK)) {
 		struct client_obd *cli = &obd->u.cli;
-		long nr = atomic_long_read(&cli->cl_lru_in_list) >> 1;
+		long nr = cli_lru_in_list(cli) >> 1;
 		long target = *(long *)val;
 
 		nr = osc_lru_shrink(env, cli, min(nr, target), true);
@@ -3278,11 +3573,9 @@ int osc_disconnect(struct obd_export *exp)
 }
 EXPORT_SYMBOL(osc_disconnect);
 
-int osc_ldlm_resource_invalidate(struct cfs_hash *hs, struct cfs_hash_bd *bd,
-				 struct hlist_node *hnode, void *arg)
+int osc_ldlm_resource_invalidate(struct ldlm_resource *res, void *arg)
 {
 	struct lu_env *env = arg;
-	struct ldlm_resource *res = cfs_hash_object(hs, hnode);
 	struct ldlm_lock *lock;
 	struct osc_object *osc = NULL;
 	ENTRY;
@@ -3344,9 +3637,9 @@ static int osc_import_event(struct obd_device *obd,
                 if (!IS_ERR(env)) {
 			osc_io_unplug(env, &obd->u.cli, NULL);
 
-			cfs_hash_for_each_nolock(ns->ns_rs_hash,
-						 osc_ldlm_resource_invalidate,
-						 env, 0);
+			ldlm_namespace_foreach_res(ns,
+						   osc_ldlm_resource_invalidate,
+						   env);
 			cl_env_put(env, &refcheck);
 
 			ldlm_namespace_cleanup(ns, LDLM_FL_LOCAL_ONLY);
@@ -3502,6 +3795,7 @@ int osc_setup(struct obd_device *obd, struct lustre_cfg *lcfg)
 	}
 
 	ns_register_cancel(obd->obd_namespace, osc_cancel_weight);
+	ns_register_lru_cost(obd->obd_namespace, osc_ldlm_lru_cost);
 
 	spin_lock(&osc_shrink_lock);
 	list_add_tail(&cli->cl_shrink_list, &osc_shrink_list);
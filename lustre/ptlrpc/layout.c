@@ -430,6 +430,11 @@ static const struct req_msg_field *ldlm_gl_callback_server[] = {
         &RMF_DLM_LVB
 };
 
+static const struct req_msg_field *ldlm_bl_callback_batch_server[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_RCS
+};
+
 static const struct req_msg_field *ldlm_intent_basic_client[] = {
 	&RMF_PTLRPC_BODY,
 	&RMF_DLM_REQ,
@@ -494,6 +499,37 @@ static const struct req_msg_field *ldlm_intent_getattr_server[] = {
 	&RMF_FILE_ENCCTX,
 };
 
+static const struct req_msg_field *mds_batch_client[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_BUT_REQUEST,
+};
+
+static const struct req_msg_field *mds_batch_server[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_BUT_REPLY,
+};
+
+/* sub-requests of MDS_BATCH are packed without ptlrpc_body */
+static const struct req_msg_field *but_getattr_client[] = {
+	&RMF_DLM_REQ,
+	&RMF_LDLM_INTENT,
+	&RMF_MDT_BODY,     /* coincides with mds_getattr_name_client[] */
+	&RMF_CAPA1,
+	&RMF_NAME,
+	&RMF_FILE_SECCTX_NAME
+};
+
+static const struct req_msg_field *but_getattr_server[] = {
+	&RMF_DLM_REP,
+	&RMF_MDT_BODY,
+	&RMF_MDT_MD,
+	&RMF_ACL,
+	&RMF_CAPA1,
+	&RMF_FILE_SECCTX,
+	&RMF_DEFAULT_MDT_MD,
+	&RMF_FILE_ENCCTX,
+};
+
 static const struct req_msg_field *ldlm_intent_create_client[] = {
 	&RMF_PTLRPC_BODY,
 	&RMF_DLM_REQ,
@@ -640,7 +676,8 @@ static const struct req_msg_field *ost_brw_client[] = {
 	&RMF_OBD_IOOBJ,
 	&RMF_NIOBUF_REMOTE,
 	&RMF_CAPA1,
-	&RMF_SHORT_IO
+	&RMF_SHORT_IO,
+	&RMF_OST_COMPR
 };
 
 static const struct req_msg_field *ost_brw_read_server[] = {
@@ -803,6 +840,8 @@ static struct req_format *req_formats[] = {
 	&RQF_MDS_HSM_REQUEST,
 	&RQF_MDS_SWAP_LAYOUTS,
 	&RQF_MDS_RMFID,
+	&RQF_MDS_BATCH,
+	&RQF_BUT_GETATTR,
 #ifdef HAVE_SERVER_SUPPORT
 	&RQF_OUT_UPDATE,
 #endif
@@ -834,6 +873,7 @@ static struct req_format *req_formats[] = {
 	&RQF_LDLM_CALLBACK,
 	&RQF_LDLM_CP_CALLBACK,
 	&RQF_LDLM_BL_CALLBACK,
+	&RQF_LDLM_BL_CALLBACK_BATCH,
 	&RQF_LDLM_GL_CALLBACK,
 	&RQF_LDLM_GL_CALLBACK_DESC,
 	&RQF_LDLM_INTENT,
@@ -1066,6 +1106,16 @@ struct req_msg_field RMF_FILE_ENCCTX =
 	DEFINE_MSGF("file_encctx", RMF_F_NO_SIZE_CHECK, -1, NULL, NULL);
 EXPORT_SYMBOL(RMF_FILE_ENCCTX);
 
+struct req_msg_field RMF_BUT_REQUEST =
+	DEFINE_MSGF("batch_update_request", 0, -1,
+		    lustre_swab_batch_update_request, NULL);
+EXPORT_SYMBOL(RMF_BUT_REQUEST);
+
+struct req_msg_field RMF_BUT_REPLY =
+	DEFINE_MSGF("batch_update_reply", 0, -1,
+		    lustre_swab_batch_update_reply, NULL);
+EXPORT_SYMBOL(RMF_BUT_REPLY);
+
 struct req_msg_field RMF_LLOGD_BODY =
         DEFINE_MSGF("llogd_body", 0,
                     sizeof(struct llogd_body), lustre_swab_llogd_body, NULL);
@@ -1239,6 +1289,12 @@ EXPORT_SYMBOL(RMF_IDX_INFO);
 struct req_msg_field RMF_SHORT_IO =
 	DEFINE_MSGF("short_io", 0, -1, NULL, NULL);
 EXPORT_SYMBOL(RMF_SHORT_IO);
+
+/* struct brw_compr_desc, all its members are __u32 */
+struct req_msg_field RMF_OST_COMPR =
+	DEFINE_MSGF("ost_compr", RMF_F_STRUCT_ARRAY, sizeof(__u32),
+		    lustre_swab_generic_32s, NULL);
+EXPORT_SYMBOL(RMF_OST_COMPR);
 struct req_msg_field RMF_HSM_USER_STATE =
 	DEFINE_MSGF("hsm_user_state", 0, sizeof(struct hsm_user_state),
 		    lustre_swab_hsm_user_state, NULL);
@@ -1554,6 +1610,11 @@ struct req_format RQF_LDLM_BL_CALLBACK =
         DEFINE_REQ_FMT0("LDLM_BL_CALLBACK", ldlm_enqueue_client, empty);
 EXPORT_SYMBOL(RQF_LDLM_BL_CALLBACK);
 
+struct req_format RQF_LDLM_BL_CALLBACK_BATCH =
+	DEFINE_REQ_FMT0("LDLM_BL_CALLBACK_BATCH", ldlm_enqueue_client,
+			ldlm_bl_callback_batch_server);
+EXPORT_SYMBOL(RQF_LDLM_BL_CALLBACK_BATCH);
+
 struct req_format RQF_LDLM_GL_CALLBACK =
         DEFINE_REQ_FMT0("LDLM_GL_CALLBACK", ldlm_enqueue_client,
                         ldlm_gl_callback_server);
@@ -1654,6 +1715,16 @@ struct req_format RQF_MDS_RMFID =
 			mds_rmfid_server);
 EXPORT_SYMBOL(RQF_MDS_RMFID);
 
+struct req_format RQF_MDS_BATCH =
+	DEFINE_REQ_FMT0("MDS_BATCH", mds_batch_client,
+			mds_batch_server);
+EXPORT_SYMBOL(RQF_MDS_BATCH);
+
+struct req_format RQF_BUT_GETATTR =
+	DEFINE_REQ_FMT0("MDS_BATCH_GETATTR", but_getattr_client,
+			but_getattr_server);
+EXPORT_SYMBOL(RQF_BUT_GETATTR);
+
 struct req_format RQF_LLOG_ORIGIN_HANDLE_CREATE =
         DEFINE_REQ_FMT0("LLOG_ORIGIN_HANDLE_CREATE",
                         llog_origin_handle_create_client, llogd_body_only);
@@ -1876,6 +1947,89 @@ void req_capsule_fini(struct req_capsule *pill)
 }
 EXPORT_SYMBOL(req_capsule_fini);
 
+/**
+ * Initialize a capsule for a sub-request of a batch RPC \a req.
+ *
+ * Unlike req_capsule_init(), the messages of such a capsule are not the ones
+ * of \a req but \a reqmsg and \a repmsg, packed inside the batch request and
+ * reply buffers.  The format \a fmt must not contain RMF_PTLRPC_BODY.
+ */
+void req_capsule_subreq_init(struct req_capsule *pill,
+			     const struct req_format *fmt,
+			     struct ptlrpc_request *req,
+			     struct lustre_msg *reqmsg,
+			     struct lustre_msg *repmsg,
+			     enum req_location loc)
+{
+	LASSERT(reqmsg != NULL);
+
+	req_capsule_init(pill, req, loc);
+	req_capsule_set(pill, fmt);
+	pill->rc_reqmsg = reqmsg;
+	pill->rc_repmsg = repmsg;
+}
+EXPORT_SYMBOL(req_capsule_subreq_init);
+
+/**
+ * Unpack and check the header of the sub-request (\a loc == RCL_CLIENT) or
+ * sub-reply (\a loc == RCL_SERVER) message of a \a pill, \a len being the
+ * space left in the batch buffer.
+ *
+ * Returns the packed size of the message or negative errno.
+ */
+int req_capsule_subreq_unpack(struct req_capsule *pill, enum req_location loc,
+			      __u32 len)
+{
+	struct lustre_msg *msg;
+	int rc;
+
+	LASSERT(req_capsule_subreq(pill));
+
+	msg = loc == RCL_CLIENT ? pill->rc_reqmsg : pill->rc_repmsg;
+	if (msg == NULL)
+		return -EPROTO;
+
+	rc = __lustre_unpack_msg(msg, len);
+	if (rc < 0)
+		return rc;
+
+	if (rc == 1) {
+		if (loc == RCL_CLIENT)
+			pill->rc_req_swab_mask |= BIT(MSG_PTLRPC_HEADER_OFF);
+		else
+			pill->rc_rep_swab_mask |= BIT(MSG_PTLRPC_HEADER_OFF);
+	}
+
+	return lustre_packed_msg_size(msg);
+}
+EXPORT_SYMBOL(req_capsule_subreq_unpack);
+
+/**
+ * Pack the sub-request message of a \a pill at \a rc_reqmsg, using the
+ * field sizes recorded in \a rc_area.  \a len is the space available.
+ *
+ * Returns the packed size of the message or -EOVERFLOW if it doesn't fit.
+ */
+int req_capsule_client_pack(struct req_capsule *pill, __u32 len)
+{
+	int count;
+	__u32 size;
+
+	LASSERT(req_capsule_subreq(pill));
+	LASSERT(pill->rc_loc == RCL_CLIENT);
+
+	count = req_capsule_filled_sizes(pill, RCL_CLIENT);
+	size = lustre_msg_size_v2(count, pill->rc_area[RCL_CLIENT]);
+	if (size > len)
+		return -EOVERFLOW;
+
+	memset(pill->rc_reqmsg, 0, size);
+	lustre_init_msg_v2(pill->rc_reqmsg, count, pill->rc_area[RCL_CLIENT],
+			   NULL);
+	return size;
+}
+EXPORT_SYMBOL(req_capsule_client_pack);
+
 static int __req_format_is_sane(const struct req_format *fmt)
 {
 	return fmt->rf_idx < ARRAY_SIZE(req_formats) &&
@@ -1887,10 +2041,38 @@ static struct lustre_msg *__req_msg(const struct req_capsule *pill,
 {
         struct ptlrpc_request *req;
 
+	if (req_capsule_subreq(pill))
+		return loc == RCL_CLIENT ? pill->rc_reqmsg : pill->rc_repmsg;
+
         req = pill->rc_req;
         return loc == RCL_CLIENT ? req->rq_reqmsg : req->rq_repmsg;
 }
 
+static bool req_capsule_need_swab(struct req_capsule *pill,
+				  enum req_location loc, __u32 index)
+{
+	__u32 mask;
+
+	if (!req_capsule_subreq(pill))
+		return ptlrpc_buf_need_swab(pill->rc_req, loc == RCL_CLIENT,
+					    index);
+
+	mask = loc == RCL_CLIENT ? pill->rc_req_swab_mask :
+				   pill->rc_rep_swab_mask;
+	return (mask & BIT(MSG_PTLRPC_HEADER_OFF)) && !(mask & BIT(index));
+}
+
+static void req_capsule_set_swabbed(struct req_capsule *pill,
+				    enum req_location loc, __u32 index)
+{
+	if (!req_capsule_subreq(pill))
+		ptlrpc_buf_set_swabbed(pill->rc_req, loc == RCL_CLIENT, index);
+	else if (loc == RCL_CLIENT)
+		pill->rc_req_swab_mask |= BIT(index);
+	else
+		pill->rc_rep_swab_mask |= BIT(index);
+}
+
 /**
  * Set the format (\a fmt) of a \a pill; format changes are not allowed here
  * (see req_capsule_extend()).
@@ -1958,8 +2140,23 @@ int req_capsule_server_pack(struct req_capsule *pill)
 	LASSERT(fmt != NULL);
 
 	count = req_capsule_filled_sizes(pill, RCL_SERVER);
-	rc = lustre_pack_reply(pill->rc_req, count,
-			       pill->rc_area[RCL_SERVER], NULL);
+	if (req_capsule_subreq(pill)) {
+		__u32 size = lustre_msg_size_v2(count,
+						pill->rc_area[RCL_SERVER]);
+
+		/* sub-reply is packed in place in the batch reply buffer */
+		if (pill->rc_repmsg == NULL || size > pill->rc_replen) {
+			rc = -EOVERFLOW;
+		} else {
+			memset(pill->rc_repmsg, 0, size);
+			lustre_init_msg_v2(pill->rc_repmsg, count,
+					   pill->rc_area[RCL_SERVER], NULL);
+			rc = 0;
+		}
+	} else {
+		rc = lustre_pack_reply(pill->rc_req, count,
+				       pill->rc_area[RCL_SERVER], NULL);
+	}
 	if (rc != 0) {
 		DEBUG_REQ(D_ERROR, pill->rc_req,
 			  "Cannot pack %d fields in format '%s'",
@@ -1969,6 +2166,19 @@ int req_capsule_server_pack(struct req_capsule *pill)
 }
 EXPORT_SYMBOL(req_capsule_server_pack);
 
+/**
+ * Returns true if the reply (or sub-reply) of a \a pill was packed already.
+ */
+bool req_capsule_server_packed(struct req_capsule *pill)
+{
+	if (req_capsule_subreq(pill))
+		return pill->rc_repmsg != NULL &&
+		       pill->rc_repmsg->lm_bufcount != 0;
+
+	return pill->rc_req->rq_repmsg != NULL;
+}
+EXPORT_SYMBOL(req_capsule_server_packed);
+
 /**
  * Returns the PTLRPC request or reply (\a loc) buffer offset of a \a pill
  * corresponding to the given RMF (\a field).
@@ -2006,12 +2216,11 @@ swabber_dumper_helper(struct req_capsule *pill,
 	int size;
 	int rc = 0;
 	bool do_swab;
-	bool inout = loc == RCL_CLIENT;
 	bool array = field->rmf_flags & RMF_F_STRUCT_ARRAY;
 
 	swabber = swabber ?: field->rmf_swabber;
 
-	if (ptlrpc_buf_need_swab(pill->rc_req, inout, offset) &&
+	if (req_capsule_need_swab(pill, loc, offset) &&
 	    (swabber != NULL || field->rmf_swab_len != NULL) && value != NULL)
 		do_swab = true;
 	else
@@ -2071,8 +2280,8 @@ swabber_dumper_helper(struct req_capsule *pill,
 			field->rmf_dumper(value);
 		}
         }
-        if (do_swab)
-                ptlrpc_buf_set_swabbed(pill->rc_req, inout, offset);
+	if (do_swab)
+		req_capsule_set_swabbed(pill, loc, offset);
 
 	return rc;
 }
@@ -2375,6 +2584,10 @@ EXPORT_SYMBOL(req_capsule_get_size);
  */
 __u32 req_capsule_msg_size(struct req_capsule *pill, enum req_location loc)
 {
+	if (req_capsule_subreq(pill))
+		return lustre_msg_size_v2(pill->rc_fmt->rf_fields[loc].nr,
+					  pill->rc_area[loc]);
+
         return lustre_msg_size(pill->rc_req->rq_import->imp_msg_magic,
                                pill->rc_fmt->rf_fields[loc].nr,
                                pill->rc_area[loc]);
@@ -2532,7 +2745,12 @@ void req_capsule_shrink(struct req_capsule *pill,
 	LASSERTF(newlen <= len, "%s:%s, oldlen=%u, newlen=%u\n",
 		 fmt->rf_name, field->rmf_name, len, newlen);
 
-	if (loc == RCL_CLIENT) {
+	if (req_capsule_subreq(pill)) {
+		/* the batch handler accounts for the sub-message size */
+		lustre_shrink_msg(msg, offset, newlen, 1);
+		if (loc == RCL_SERVER)
+			req_capsule_set_size(pill, field, loc, newlen);
+	} else if (loc == RCL_CLIENT) {
 		pill->rc_req->rq_reqlen = lustre_shrink_msg(msg, offset, newlen,
 							    1);
 	} else {
@@ -2546,6 +2764,28 @@ void req_capsule_shrink(struct req_capsule *pill,
 }
 EXPORT_SYMBOL(req_capsule_shrink);
 
+/**
+ * Grow a sub-reply field in place, the sub-reply being the last message
+ * packed in the batch reply buffer.
+ */
+static int req_capsule_subreq_grow(struct req_capsule *pill,
+				   const struct req_msg_field *field,
+				   __u32 newlen)
+{
+	__u32 offset, len;
+
+	len = req_capsule_get_size(pill, field, RCL_SERVER);
+	offset = __req_capsule_offset(pill, field, RCL_SERVER);
+
+	if (lustre_packed_msg_size(pill->rc_repmsg) - cfs_size_round(len) +
+	    cfs_size_round(newlen) > pill->rc_replen)
+		return -EOVERFLOW;
+
+	req_capsule_set_size(pill, field, RCL_SERVER, newlen);
+	lustre_grow_msg(pill->rc_repmsg, offset, newlen);
+	return 0;
+}
+
 int req_capsule_server_grow(struct req_capsule *pill,
 			    const struct req_msg_field *field,
 			    __u32 newlen)
@@ -2560,6 +2800,9 @@ int req_capsule_server_grow(struct req_capsule *pill,
 	LASSERT(req_capsule_has_field(pill, field, RCL_SERVER));
 	LASSERT(req_capsule_field_present(pill, field, RCL_SERVER));
 
+	if (req_capsule_subreq(pill))
+		return req_capsule_subreq_grow(pill, field, newlen);
+
 	len = req_capsule_get_size(pill, field, RCL_SERVER);
 	offset = __req_capsule_offset(pill, field, RCL_SERVER);
 
@@ -97,6 +97,7 @@ static struct ll_rpc_opcode {
 	{ MDS_HSM_CT_UNREGISTER, "mds_hsm_ct_unregister" },
 	{ MDS_SWAP_LAYOUTS,	"mds_swap_layouts" },
 	{ MDS_RMFID,        "mds_rmfid" },
+	{ MDS_BATCH,        "mds_batch" },
 	{ LDLM_ENQUEUE,     "ldlm_enqueue" },
 	{ LDLM_CONVERT,     "ldlm_convert" },
 	{ LDLM_CANCEL,      "ldlm_cancel" },
@@ -230,6 +231,15 @@ ptlrpc_ldebugfs_register(struct dentry *root, char *dir, char *name,
                              svc_counter_config, "req_timeout", "sec");
         lprocfs_counter_init(svc_stats, PTLRPC_REQBUF_AVAIL_CNTR,
                              svc_counter_config, "reqbuf_avail", "bufs");
+	lprocfs_counter_init(svc_stats, PTLRPC_THREAD_START_CNTR,
+			     LPROCFS_CNTR_AVGMINMAX, "thread_start", "threads");
+	lprocfs_counter_init(svc_stats, PTLRPC_THREAD_STOP_CNTR,
+			     LPROCFS_CNTR_AVGMINMAX, "thread_idle_stop",
+			     "threads");
+	lprocfs_counter_init(svc_stats, PTLRPC_REPQDEPTH_CNTR,
+			     svc_counter_config, "rep_qdepth", "reps");
+	lprocfs_counter_init(svc_stats, PTLRPC_REPBATCH_CNTR,
+			     svc_counter_config, "rep_batch", "reps");
         for (i = 0; i < EXTRA_LAST_OPC; i++) {
                 char *units;
 
@@ -471,6 +481,37 @@ static ssize_t threads_max_store(struct kobject *kobj, struct attribute *attr,
 }
 LUSTRE_RW_ATTR(threads_max);
 
+static ssize_t threads_idle_timeout_show(struct kobject *kobj,
+					 struct attribute *attr, char *buf)
+{
+	struct ptlrpc_service *svc = container_of(kobj, struct ptlrpc_service,
+						  srv_kobj);
+
+	return sprintf(buf, "%d\n", svc->srv_thread_idle_timeout);
+}
+
+static ssize_t threads_idle_timeout_store(struct kobject *kobj,
+					  struct attribute *attr,
+					  const char *buffer, size_t count)
+{
+	struct ptlrpc_service *svc = container_of(kobj, struct ptlrpc_service,
+						  srv_kobj);
+	unsigned int val;
+	int rc;
+
+	rc = kstrtouint(buffer, 10, &val);
+	if (rc < 0)
+		return rc;
+
+	if (val > INT_MAX / MSEC_PER_SEC)
+		return -ERANGE;
+
+	svc->srv_thread_idle_timeout = val;
+
+	return count;
+}
+LUSTRE_RW_ATTR(threads_idle_timeout);
+
 /**
  * Translates \e ptlrpc_nrs_pol_state values to human-readable strings.
  *
@@ -1152,6 +1193,7 @@ static struct attribute *ptlrpc_svc_attrs[] = {
 	&lustre_attr_threads_min.attr,
 	&lustre_attr_threads_started.attr,
 	&lustre_attr_threads_max.attr,
+	&lustre_attr_threads_idle_timeout.attr,
 	&lustre_attr_high_priority_ratio.attr,
 	NULL,
 };
@@ -0,0 +1,302 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * lustre/ptlrpc/nrs_deadline.c
+ *
+ * Network Request Scheduler (NRS) deadline policy
+ *
+ * Handles RPCs in Earliest Deadline First order, using the deadline computed
+ * for each request by adaptive timeouts. Under overload, FIFO may serve newer
+ * requests with plenty of slack while older ones time out and are resent by
+ * clients; serving the most urgent request first avoids that.
+ */
+/**
+ * \addtogoup nrs
+ * @{
+ */
+
+#define DEBUG_SUBSYSTEM S_RPC
+#include <obd_support.h>
+#include <obd_class.h>
+#include <libcfs/libcfs.h>
+#include "ptlrpc_internal.h"
+
+/**
+ * \name deadline
+ *
+ * The deadline policy orders RPCs by ptlrpc_request::rq_deadline, the time by
+ * which the client expects a reply (or an early reply) before it resends.
+ *
+ * @{
+ */
+
+#define NRS_POL_NAME_DEADLINE	"deadline"
+
+/**
+ * Binary heap predicate.
+ *
+ * Requests are sorted by their deadline, requests with the same deadline are
+ * sorted by their arrival order.
+ *
+ * \retval 0 e1 should be handled after e2
+ * \retval 1 e1 should be handled before e2
+ */
+static int deadline_req_compare(struct binheap_node *e1,
+				struct binheap_node *e2)
+{
+	struct ptlrpc_nrs_request *nrq1;
+	struct ptlrpc_nrs_request *nrq2;
+
+	nrq1 = container_of(e1, struct ptlrpc_nrs_request, nr_node);
+	nrq2 = container_of(e2, struct ptlrpc_nrs_request, nr_node);
+
+	if (nrq1->nr_u.deadline.dr_deadline < nrq2->nr_u.deadline.dr_deadline)
+		return 1;
+	if (nrq1->nr_u.deadline.dr_deadline > nrq2->nr_u.deadline.dr_deadline)
+		return 0;
+
+	return nrq1->nr_u.deadline.dr_sequence <
+	       nrq2->nr_u.deadline.dr_sequence;
+}
+
+static struct binheap_ops nrs_deadline_heap_ops = {
+	.hop_enter	= NULL,
+	.hop_exit	= NULL,
+	.hop_compare	= deadline_req_compare,
+};
+
+/**
+ * Is called before the policy transitions into
+ * ptlrpc_nrs_pol_state::NRS_POL_STATE_STARTED; allocates and initializes a
+ * policy-specific private data structure.
+ *
+ * \param[in] policy The policy to start
+ * \param[in] arg    Generic char buffer; unused in this policy
+ *
+ * \retval -ENOMEM OOM error
+ * \retval  0	   success
+ *
+ * \see nrs_policy_register()
+ * \see nrs_policy_ctl()
+ */
+static int nrs_deadline_start(struct ptlrpc_nrs_policy *policy, char *arg)
+{
+	struct nrs_deadline_head *head;
+
+	ENTRY;
+
+	OBD_CPT_ALLOC_PTR(head, nrs_pol2cptab(policy), nrs_pol2cptid(policy));
+	if (head == NULL)
+		RETURN(-ENOMEM);
+
+	head->dh_binheap = binheap_create(&nrs_deadline_heap_ops,
+					  CBH_FLAG_ATOMIC_GROW, 4096, NULL,
+					  nrs_pol2cptab(policy),
+					  nrs_pol2cptid(policy));
+	if (head->dh_binheap == NULL) {
+		OBD_FREE_PTR(head);
+		RETURN(-ENOMEM);
+	}
+
+	policy->pol_private = head;
+
+	RETURN(0);
+}
+
+/**
+ * Is called before the policy transitions into
+ * ptlrpc_nrs_pol_state::NRS_POL_STATE_STOPPED; deallocates the policy-specific
+ * private data structure.
+ *
+ * \param[in] policy The policy to stop
+ *
+ * \see nrs_policy_stop0()
+ */
+static void nrs_deadline_stop(struct ptlrpc_nrs_policy *policy)
+{
+	struct nrs_deadline_head *head = policy->pol_private;
+
+	LASSERT(head != NULL);
+	LASSERT(head->dh_binheap != NULL);
+	LASSERT(binheap_is_empty(head->dh_binheap));
+
+	binheap_destroy(head->dh_binheap);
+
+	OBD_FREE_PTR(head);
+}
+
+/**
+ * Is called for obtaining a deadline policy resource.
+ *
+ * \param[in]  policy	  The policy on which the request is being asked for
+ * \param[in]  nrq	  The request for which resources are being taken
+ * \param[in]  parent	  Parent resource, unused in this policy
+ * \param[out] resp	  Resources references are placed in this array
+ * \param[in]  moving_req Signifies limited caller context; unused in this
+ *			  policy
+ *
+ * \retval 1 The deadline policy only has a one-level resource hierarchy
+ *
+ * \see nrs_resource_get_safe()
+ */
+static int nrs_deadline_res_get(struct ptlrpc_nrs_policy *policy,
+				struct ptlrpc_nrs_request *nrq,
+				const struct ptlrpc_nrs_resource *parent,
+				struct ptlrpc_nrs_resource **resp,
+				bool moving_req)
+{
+	*resp = &((struct nrs_deadline_head *)policy->pol_private)->dh_res;
+	return 1;
+}
+
+/**
+ * Called when getting a request from the deadline policy for handling, or
+ * just peeking; removes the request from the policy when it is to be handled.
+ *
+ * \param[in] policy The policy
+ * \param[in] peek   When set, signifies that we just want to examine the
+ *		     request, and not handle it, so the request is not removed
+ *		     from the policy.
+ * \param[in] force  Force the policy to return a request; unused in this
+ *		     policy
+ *
+ * \retval The request with the earliest deadline
+ * \retval NULL no request available
+ *
+ * \see ptlrpc_nrs_req_get_nolock()
+ * \see nrs_request_get()
+ */
+static
+struct ptlrpc_nrs_request *nrs_deadline_req_get(struct ptlrpc_nrs_policy *policy,
+						bool peek, bool force)
+{
+	struct nrs_deadline_head *head = policy->pol_private;
+	struct binheap_node *node;
+	struct ptlrpc_nrs_request *nrq;
+
+	node = binheap_root(head->dh_binheap);
+	if (unlikely(node == NULL))
+		return NULL;
+
+	nrq = container_of(node, struct ptlrpc_nrs_request, nr_node);
+	if (likely(!peek)) {
+		struct ptlrpc_request *req = container_of(nrq,
+							  struct ptlrpc_request,
+							  rq_nrq);
+
+		binheap_remove(head->dh_binheap, &nrq->nr_node);
+
+		CDEBUG(D_RPCTRACE,
+		       "NRS: starting to handle %s request from %s, seq: %llu, deadline in %llds\n",
+		       policy->pol_desc->pd_name, libcfs_id2str(req->rq_peer),
+		       nrq->nr_u.deadline.dr_sequence,
+		       (s64)(nrq->nr_u.deadline.dr_deadline -
+			     ktime_get_real_seconds()));
+	}
+
+	return nrq;
+}
+
+/**
+ * Adds request \a nrq to \a policy's binheap of queued requests.
+ *
+ * \param[in] policy The policy
+ * \param[in] nrq    The request to add
+ *
+ * \retval 0 request added
+ * \retval -ve error from binheap_insert()
+ */
+static int nrs_deadline_req_add(struct ptlrpc_nrs_policy *policy,
+				struct ptlrpc_nrs_request *nrq)
+{
+	struct nrs_deadline_head *head = policy->pol_private;
+	struct ptlrpc_request *req = container_of(nrq, struct ptlrpc_request,
+						  rq_nrq);
+
+	nrq->nr_u.deadline.dr_deadline = req->rq_deadline;
+	nrq->nr_u.deadline.dr_sequence = head->dh_sequence++;
+
+	return binheap_insert(head->dh_binheap, &nrq->nr_node);
+}
+
+/**
+ * Removes request \a nrq from \a policy's binheap of queued requests.
+ *
+ * \param[in] policy The policy
+ * \param[in] nrq    The request to remove
+ */
+static void nrs_deadline_req_del(struct ptlrpc_nrs_policy *policy,
+				 struct ptlrpc_nrs_request *nrq)
+{
+	struct nrs_deadline_head *head = policy->pol_private;
+
+	binheap_remove(head->dh_binheap, &nrq->nr_node);
+}
+
+/**
+ * Prints a debug statement right before the request \a nrq stops being
+ * handled, reporting whether it was handled within its deadline.
+ *
+ * \param[in] policy The policy handling the request
+ * \param[in] nrq    The request being handled
+ *
+ * \see ptlrpc_server_finish_request()
+ * \see ptlrpc_nrs_req_stop_nolock()
+ */
+static void nrs_deadline_req_stop(struct ptlrpc_nrs_policy *policy,
+				  struct ptlrpc_nrs_request *nrq)
+{
+	struct ptlrpc_request *req = container_of(nrq, struct ptlrpc_request,
+						  rq_nrq);
+
+	CDEBUG(D_RPCTRACE,
+	       "NRS: finished handling %s request from %s, seq: %llu, slack %llds\n",
+	       policy->pol_desc->pd_name, libcfs_id2str(req->rq_peer),
+	       nrq->nr_u.deadline.dr_sequence,
+	       (s64)(nrq->nr_u.deadline.dr_deadline -
+		     ktime_get_real_seconds()));
+}
+
+/**
+ * Deadline policy operations
+ */
+static const struct ptlrpc_nrs_pol_ops nrs_deadline_ops = {
+	.op_policy_start	= nrs_deadline_start,
+	.op_policy_stop		= nrs_deadline_stop,
+	.op_res_get		= nrs_deadline_res_get,
+	.op_req_get		= nrs_deadline_req_get,
+	.op_req_enqueue		= nrs_deadline_req_add,
+	.op_req_dequeue		= nrs_deadline_req_del,
+	.op_req_stop		= nrs_deadline_req_stop,
+};
+
+/**
+ * Deadline policy configuration
+ */
+struct ptlrpc_nrs_pol_conf nrs_conf_deadline = {
+	.nc_name		= NRS_POL_NAME_DEADLINE,
+	.nc_ops			= &nrs_deadline_ops,
+	.nc_compat		= nrs_policy_compat_all,
+};
+
+/** @} deadline */
+
+/** @} nrs */
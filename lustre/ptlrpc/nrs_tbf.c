@@ -65,6 +65,11 @@ static int tbf_depth = 3;
 module_param(tbf_depth, int, 0644);
 MODULE_PARM_DESC(tbf_depth, "How many tokens that a client can save up");
 
+/**
+ * The maximum RPC rate.
+ */
+#define LPROCFS_NRS_RATE_MAX		65535
+
 static enum hrtimer_restart nrs_tbf_timer_cb(struct hrtimer *timer)
 {
 	struct nrs_tbf_head *head = container_of(timer, struct nrs_tbf_head,
@@ -80,6 +85,8 @@ static enum hrtimer_restart nrs_tbf_timer_cb(struct hrtimer *timer)
 
 #define NRS_TBF_DEFAULT_RULE "default"
 
+static void nrs_tbf_rule_put(struct nrs_tbf_rule *rule);
+
 static void nrs_tbf_rule_fini(struct nrs_tbf_rule *rule)
 {
 	LASSERT(atomic_read(&rule->tr_ref) == 0);
@@ -87,6 +94,8 @@ static void nrs_tbf_rule_fini(struct nrs_tbf_rule *rule)
 	LASSERT(list_empty(&rule->tr_linkage));
 
 	rule->tr_head->th_ops->o_rule_fini(rule);
+	if (rule->tr_parent)
+		nrs_tbf_rule_put(rule->tr_parent);
 	OBD_FREE_PTR(rule);
 }
 
@@ -136,10 +145,26 @@ nrs_tbf_cli_reset_value(struct nrs_tbf_head *head,
 	cli->tc_check_time = ktime_to_ns(ktime_get());
 	cli->tc_rule_sequence = atomic_read(&head->th_rule_sequence);
 	cli->tc_rule_generation = rule->tr_generation;
+	cli->tc_min_rate = rule->tr_min_rate;
+	cli->tc_min_nsecs = rule->tr_min_nsecs_per_rpc;
+	cli->tc_min_ntoken = cli->tc_min_rate ? rule->tr_depth : 0;
+	cli->tc_min_check_time = cli->tc_check_time;
+	cli->tc_min_deadline = cli->tc_check_time;
 
 	if (cli->tc_in_heap)
 		binheap_relocate(head->th_binheap,
 				 &cli->tc_node);
+
+	if (cli->tc_in_min_heap && cli->tc_min_rate == 0) {
+		binheap_remove(head->th_min_binheap, &cli->tc_min_node);
+		cli->tc_in_min_heap = false;
+	} else if (cli->tc_in_min_heap) {
+		binheap_relocate(head->th_min_binheap, &cli->tc_min_node);
+	} else if (cli->tc_in_heap && cli->tc_min_rate != 0 &&
+		   binheap_insert(head->th_min_binheap,
+				  &cli->tc_min_node) == 0) {
+		cli->tc_in_min_heap = true;
+	}
 }
 
 static void
@@ -163,6 +188,20 @@ nrs_tbf_cli_reset(struct nrs_tbf_head *head,
 	nrs_tbf_cli_reset_value(head, cli);
 }
 
+/**
+ * Prints the hierarchical attributes of a rule, if any, and terminates the
+ * rule line. Used by the o_rule_dump() methods of all TBF types.
+ */
+static void
+nrs_tbf_rule_dump_tail(struct nrs_tbf_rule *rule, struct seq_file *m)
+{
+	if (rule->tr_min_rate)
+		seq_printf(m, ", min_rate %u", rule->tr_min_rate);
+	if (rule->tr_parent)
+		seq_printf(m, ", parent %s", rule->tr_parent->tr_name);
+	seq_putc(m, '\n');
+}
+
 static int
 nrs_tbf_rule_dump(struct nrs_tbf_rule *rule, struct seq_file *m)
 {
@@ -262,6 +301,7 @@ nrs_tbf_cli_init(struct nrs_tbf_head *head,
 	atomic_set(&cli->tc_ref, 1);
 	rule = nrs_tbf_rule_match(head, cli);
 	nrs_tbf_cli_reset(head, rule, cli);
+	cli->tc_auto_start = cli->tc_check_time;
 }
 
 static void
@@ -269,6 +309,7 @@ nrs_tbf_cli_fini(struct nrs_tbf_client *cli)
 {
 	LASSERT(list_empty(&cli->tc_list));
 	LASSERT(!cli->tc_in_heap);
+	LASSERT(!cli->tc_in_min_heap);
 	LASSERT(atomic_read(&cli->tc_ref) == 0);
 	spin_lock(&cli->tc_rule_lock);
 	nrs_tbf_cli_rule_put(cli);
@@ -284,9 +325,14 @@ nrs_tbf_rule_start(struct ptlrpc_nrs_policy *policy,
 	struct nrs_tbf_rule	*rule;
 	struct nrs_tbf_rule	*tmp_rule;
 	struct nrs_tbf_rule	*next_rule;
+	struct nrs_tbf_rule	*parent = NULL;
 	char			*next_name = start->u.tc_start.ts_next_name;
+	char			*parent_name = start->u.tc_start.ts_parent_name;
 	int			 rc;
 
+	if (start->u.tc_start.ts_min_rate > start->u.tc_start.ts_rpc_rate)
+		return -EINVAL;
+
 	rule = nrs_tbf_rule_find(head, start->tc_name);
 	if (rule) {
 		nrs_tbf_rule_put(rule);
@@ -302,6 +348,12 @@ nrs_tbf_rule_start(struct ptlrpc_nrs_policy *policy,
 	rule->tr_flags = start->u.tc_start.ts_rule_flags;
 	rule->tr_nsecs_per_rpc = NSEC_PER_SEC / rule->tr_rpc_rate;
 	rule->tr_depth = tbf_depth;
+	rule->tr_min_rate = start->u.tc_start.ts_min_rate;
+	if (rule->tr_min_rate)
+		rule->tr_min_nsecs_per_rpc = NSEC_PER_SEC / rule->tr_min_rate;
+	rule->tr_ntoken = rule->tr_depth;
+	rule->tr_check_time = ktime_to_ns(ktime_get());
+	rule->tr_auto_hot_time = rule->tr_check_time;
 	atomic_set(&rule->tr_ref, 1);
 	INIT_LIST_HEAD(&rule->tr_cli_list);
 	INIT_LIST_HEAD(&rule->tr_nids);
@@ -325,6 +377,20 @@ nrs_tbf_rule_start(struct ptlrpc_nrs_policy *policy,
 		return -EEXIST;
 	}
 
+	if (parent_name) {
+		parent = nrs_tbf_rule_find_nolock(head, parent_name);
+		/* only two levels: a parent can't have a parent itself */
+		if (!parent || parent->tr_parent) {
+			spin_unlock(&head->th_rule_lock);
+			if (parent)
+				nrs_tbf_rule_put(parent);
+			nrs_tbf_rule_put(rule);
+			return parent ? -EINVAL : -ENOENT;
+		}
+		/* the reference is dropped by nrs_tbf_rule_fini() */
+		rule->tr_parent = parent;
+	}
+
 	if (next_name) {
 		next_rule = nrs_tbf_rule_find_nolock(head, next_name);
 		if (!next_rule) {
@@ -347,8 +413,9 @@ nrs_tbf_rule_start(struct ptlrpc_nrs_policy *policy,
 		head->th_rule = rule;
 	}
 
-	CDEBUG(D_RPCTRACE, "TBF starts rule@%p rate %u gen %llu\n",
-	       rule, rule->tr_rpc_rate, rule->tr_generation);
+	CDEBUG(D_RPCTRACE, "TBF starts rule@%p rate %u min %u parent %s gen %llu\n",
+	       rule, rule->tr_rpc_rate, rule->tr_min_rate,
+	       parent ? parent->tr_name : "none", rule->tr_generation);
 
 	return 0;
 }
@@ -403,9 +470,11 @@ static int
 nrs_tbf_rule_change_rate(struct ptlrpc_nrs_policy *policy,
 			 struct nrs_tbf_head *head,
 			 char *name,
-			 __u64 rate)
+			 __u64 rate,
+			 struct nrs_tbf_cmd_change *change)
 {
 	struct nrs_tbf_rule *rule;
+	__u64 min_rate;
 
 	assert_spin_locked(&policy->pol_nrs->nrs_lock);
 
@@ -413,8 +482,19 @@ nrs_tbf_rule_change_rate(struct ptlrpc_nrs_policy *policy,
 	if (rule == NULL)
 		return -ENOENT;
 
+	if (rate == 0)
+		rate = rule->tr_rpc_rate;
+	min_rate = change->tc_min_rate_set ? change->tc_min_rate :
+					     rule->tr_min_rate;
+	if (min_rate > rate) {
+		nrs_tbf_rule_put(rule);
+		return -EINVAL;
+	}
+
 	rule->tr_rpc_rate = rate;
 	rule->tr_nsecs_per_rpc = NSEC_PER_SEC / rule->tr_rpc_rate;
+	rule->tr_min_rate = min_rate;
+	rule->tr_min_nsecs_per_rpc = min_rate ? NSEC_PER_SEC / min_rate : 0;
 	rule->tr_generation++;
 	nrs_tbf_rule_put(rule);
 
@@ -430,9 +510,9 @@ nrs_tbf_rule_change(struct ptlrpc_nrs_policy *policy,
 	char	*next_name = change->u.tc_change.tc_next_name;
 	int	 rc;
 
-	if (rate != 0) {
+	if (rate != 0 || change->u.tc_change.tc_min_rate_set) {
 		rc = nrs_tbf_rule_change_rate(policy, head, change->tc_name,
-					      rate);
+					      rate, &change->u.tc_change);
 		if (rc)
 			return rc;
 	}
@@ -453,6 +533,7 @@ nrs_tbf_rule_stop(struct ptlrpc_nrs_policy *policy,
 		  struct nrs_tbf_cmd *stop)
 {
 	struct nrs_tbf_rule *rule;
+	struct nrs_tbf_rule *tmp;
 
 	assert_spin_locked(&policy->pol_nrs->nrs_lock);
 
@@ -463,8 +544,23 @@ nrs_tbf_rule_stop(struct ptlrpc_nrs_policy *policy,
 	if (rule == NULL)
 		return -ENOENT;
 
+	/*
+	 * Children of the rule need to be stopped first. Keep th_rule_lock
+	 * until the rule is unlinked, so nrs_tbf_rule_start() can't attach
+	 * a new child to it in the meantime.
+	 */
+	spin_lock(&head->th_rule_lock);
+	list_for_each_entry(tmp, &head->th_list, tr_linkage) {
+		if (tmp->tr_parent == rule) {
+			spin_unlock(&head->th_rule_lock);
+			nrs_tbf_rule_put(rule);
+			return -EBUSY;
+		}
+	}
+
 	list_del_init(&rule->tr_linkage);
 	rule->tr_flags |= NTRS_STOPPING;
+	spin_unlock(&head->th_rule_lock);
 	nrs_tbf_rule_put(rule);
 	nrs_tbf_rule_put(rule);
 
@@ -542,6 +638,39 @@ static struct binheap_ops nrs_tbf_heap_ops = {
 	.hop_compare	= tbf_cli_compare,
 };
 
+/**
+ * Binary heap predicate of the heap of classes with a guaranteed minimum
+ * rate, ordered by the deadline of their next guaranteed token.
+ *
+ * \param[in] e1 the first binheap node to compare
+ * \param[in] e2 the second binheap node to compare
+ *
+ * \retval 0 e1 > e2
+ * \retval 1 e1 < e2
+ */
+static int
+tbf_cli_min_compare(struct binheap_node *e1, struct binheap_node *e2)
+{
+	struct nrs_tbf_client *cli1;
+	struct nrs_tbf_client *cli2;
+
+	cli1 = container_of(e1, struct nrs_tbf_client, tc_min_node);
+	cli2 = container_of(e2, struct nrs_tbf_client, tc_min_node);
+
+	if (cli1->tc_min_deadline < cli2->tc_min_deadline)
+		return 1;
+	else if (cli1->tc_min_deadline > cli2->tc_min_deadline)
+		return 0;
+
+	return cli1->tc_min_check_time <= cli2->tc_min_check_time;
+}
+
+static struct binheap_ops nrs_tbf_min_heap_ops = {
+	.hop_enter	= NULL,
+	.hop_exit	= NULL,
+	.hop_compare	= tbf_cli_min_compare,
+};
+
 static unsigned nrs_tbf_jobid_hop_hash(struct cfs_hash *hs, const void *key,
 				  unsigned mask)
 {
@@ -998,9 +1127,10 @@ static int nrs_tbf_jobid_rule_init(struct ptlrpc_nrs_policy *policy,
 static int
 nrs_tbf_jobid_rule_dump(struct nrs_tbf_rule *rule, struct seq_file *m)
 {
-	seq_printf(m, "%s {%s} %u, ref %d\n", rule->tr_name,
+	seq_printf(m, "%s {%s} %u, ref %d", rule->tr_name,
 		   rule->tr_jobids_str, rule->tr_rpc_rate,
 		   atomic_read(&rule->tr_ref) - 1);
+	nrs_tbf_rule_dump_tail(rule, m);
 	return 0;
 }
 
@@ -1203,9 +1333,10 @@ static int nrs_tbf_nid_rule_init(struct ptlrpc_nrs_policy *policy,
 static int
 nrs_tbf_nid_rule_dump(struct nrs_tbf_rule *rule, struct seq_file *m)
 {
-	seq_printf(m, "%s {%s} %u, ref %d\n", rule->tr_name,
+	seq_printf(m, "%s {%s} %u, ref %d", rule->tr_name,
 		   rule->tr_nids_str, rule->tr_rpc_rate,
 		   atomic_read(&rule->tr_ref) - 1);
+	nrs_tbf_rule_dump_tail(rule, m);
 	return 0;
 }
 
@@ -2057,9 +2188,10 @@ nrs_tbf_rule_init(struct ptlrpc_nrs_policy *policy,
 static int
 nrs_tbf_generic_rule_dump(struct nrs_tbf_rule *rule, struct seq_file *m)
 {
-	seq_printf(m, "%s %s %u, ref %d\n", rule->tr_name,
+	seq_printf(m, "%s %s %u, ref %d", rule->tr_name,
 		   rule->tr_conds_str, rule->tr_rpc_rate,
 		   atomic_read(&rule->tr_ref) - 1);
+	nrs_tbf_rule_dump_tail(rule, m);
 	return 0;
 }
 
@@ -2347,9 +2479,10 @@ static int nrs_tbf_opcode_rule_init(struct ptlrpc_nrs_policy *policy,
 static int
 nrs_tbf_opcode_rule_dump(struct nrs_tbf_rule *rule, struct seq_file *m)
 {
-	seq_printf(m, "%s {%s} %u, ref %d\n", rule->tr_name,
+	seq_printf(m, "%s {%s} %u, ref %d", rule->tr_name,
 		   rule->tr_opcodes_str, rule->tr_rpc_rate,
 		   atomic_read(&rule->tr_ref) - 1);
+	nrs_tbf_rule_dump_tail(rule, m);
 	return 0;
 }
 
@@ -2662,9 +2795,10 @@ nrs_tbf_id_rule_init(struct ptlrpc_nrs_policy *policy,
 static int
 nrs_tbf_id_rule_dump(struct nrs_tbf_rule *rule, struct seq_file *m)
 {
-	seq_printf(m, "%s {%s} %u, ref %d\n", rule->tr_name,
+	seq_printf(m, "%s {%s} %u, ref %d", rule->tr_name,
 		   rule->tr_ids_str, rule->tr_rpc_rate,
 		   atomic_read(&rule->tr_ref) - 1);
+	nrs_tbf_rule_dump_tail(rule, m);
 	return 0;
 }
 
@@ -2791,17 +2925,29 @@ static int nrs_tbf_start(struct ptlrpc_nrs_policy *policy, char *arg)
 	if (head->th_binheap == NULL)
 		GOTO(out_free_head, rc = -ENOMEM);
 
+	head->th_min_binheap = binheap_create(&nrs_tbf_min_heap_ops,
+					      CBH_FLAG_ATOMIC_GROW, 4096, NULL,
+					      nrs_pol2cptab(policy),
+					      nrs_pol2cptid(policy));
+	if (head->th_min_binheap == NULL)
+		GOTO(out_free_heap, rc = -ENOMEM);
+
 	atomic_set(&head->th_rule_sequence, 0);
 	spin_lock_init(&head->th_rule_lock);
 	INIT_LIST_HEAD(&head->th_list);
 	hrtimer_init(&head->th_timer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
 	head->th_timer.function = nrs_tbf_timer_cb;
+	head->th_auto.ta_interval = NRS_TBF_AUTO_INTERVAL;
+	head->th_auto.ta_expire = NRS_TBF_AUTO_EXPIRE;
+	head->th_auto.ta_start = ktime_to_ns(ktime_get());
 	rc = head->th_ops->o_startup(policy, head);
 	if (rc)
-		GOTO(out_free_heap, rc);
+		GOTO(out_free_min_heap, rc);
 
 	policy->pol_private = head;
 	return 0;
+out_free_min_heap:
+	binheap_destroy(head->th_min_binheap);
 out_free_heap:
 	binheap_destroy(head->th_binheap);
 out_free_head:
@@ -2838,11 +2984,360 @@ static void nrs_tbf_stop(struct ptlrpc_nrs_policy *policy)
 	LASSERT(head->th_binheap != NULL);
 	LASSERT(binheap_is_empty(head->th_binheap));
 	binheap_destroy(head->th_binheap);
+	LASSERT(binheap_is_empty(head->th_min_binheap));
+	binheap_destroy(head->th_min_binheap);
 	OBD_FREE_PTR(head);
 	nrs->nrs_throttling = 0;
 	wake_up(&policy->pol_nrs->nrs_svcpt->scp_waitq);
 }
 
+static const char *nrs_tbf_auto_action_names[] = {
+	[NRS_TBF_AUTO_START]	= "start",
+	[NRS_TBF_AUTO_CHANGE]	= "change",
+	[NRS_TBF_AUTO_STOP]	= "stop",
+};
+
+/**
+ * Records an action of the autotuner in the audit log of \a head. Starting
+ * and stopping rules is also reported on the console.
+ */
+static void nrs_tbf_auto_log(struct ptlrpc_nrs_policy *policy,
+			     struct nrs_tbf_head *head,
+			     enum nrs_tbf_auto_action action,
+			     const char *name, const char *jobid,
+			     __u32 rate, __u32 limit)
+{
+	struct nrs_tbf_auto *ta = &head->th_auto;
+	struct nrs_tbf_auto_event *tae;
+	struct ptlrpc_service_part *svcpt = policy->pol_nrs->nrs_svcpt;
+
+	tae = &ta->ta_log[ta->ta_nevents++ % NRS_TBF_AUTO_LOG_SIZE];
+	tae->tae_time = ktime_get_real_seconds();
+	tae->tae_action = action;
+	strlcpy(tae->tae_rule, name, sizeof(tae->tae_rule));
+	strlcpy(tae->tae_jobid, jobid, sizeof(tae->tae_jobid));
+	tae->tae_rate = rate;
+	tae->tae_limit = limit;
+
+	if (action == NRS_TBF_AUTO_CHANGE)
+		CDEBUG(D_RPCTRACE,
+		       "%s: CPT %d: TBF changes rule %s jobid %s: %u RPC/s, limit %u\n",
+		       svcpt->scp_service->srv_name, svcpt->scp_cpt, name,
+		       jobid, rate, limit);
+	else
+		LCONSOLE_INFO("%s: CPT %d: TBF %s rule %s jobid %s: %u RPC/s, limit %u\n",
+			      svcpt->scp_service->srv_name, svcpt->scp_cpt,
+			      nrs_tbf_auto_action_names[action], name, jobid,
+			      rate, limit);
+}
+
+/**
+ * Rule the autotuner decided to start under nrs_lock, it is started once
+ * the lock is dropped.
+ */
+struct nrs_tbf_auto_new {
+	char	tan_name[MAX_TBF_NAME];
+	char	tan_jobid[LUSTRE_JOBID_SIZE];
+	/** RPC/s of the job measured in the last window. */
+	__u32	tan_rate;
+	/** RPC/s limit of the rule. */
+	__u32	tan_limit;
+};
+
+/**
+ * Checks whether an automatic rule older than rule \a name limits the same
+ * job already.
+ */
+static bool nrs_tbf_auto_duplicate(struct nrs_tbf_head *head,
+				   const char *name, const char *jobid)
+{
+	struct nrs_tbf_rule *rule;
+	struct nrs_tbf_rule *tmp;
+	bool found = false;
+
+	spin_lock(&head->th_rule_lock);
+	rule = nrs_tbf_rule_find_nolock(head, name);
+	if (rule == NULL)
+		goto out;
+
+	/* new rules are added on the top of the list */
+	tmp = rule;
+	list_for_each_entry_continue(tmp, &head->th_list, tr_linkage) {
+		if ((tmp->tr_flags & NTRS_AUTO) &&
+		    !(tmp->tr_flags & NTRS_STOPPING) &&
+		    strcmp(tmp->tr_jobids_str, jobid) == 0) {
+			found = true;
+			break;
+		}
+	}
+	nrs_tbf_rule_put(rule);
+out:
+	spin_unlock(&head->th_rule_lock);
+
+	return found;
+}
+
+/**
+ * Starts the rule \a new limiting a job. Allocating the rule can sleep, so
+ * this is called without nrs_lock, and the rule is stopped again if another
+ * one has been started for the job in the meantime.
+ */
+static int nrs_tbf_auto_start(struct ptlrpc_nrs_policy *policy,
+			      struct nrs_tbf_head *head,
+			      struct nrs_tbf_auto_new *new)
+{
+	struct nrs_tbf_cmd start;
+	struct cfs_lstr id;
+	int rc;
+
+	memset(&start, 0, sizeof(start));
+	start.tc_cmd = NRS_CTL_TBF_START_RULE;
+	start.tc_name = new->tan_name;
+	start.u.tc_start.ts_rpc_rate = new->tan_limit;
+	start.u.tc_start.ts_rule_flags = NTRS_AUTO;
+	start.u.tc_start.ts_jobids_str = new->tan_jobid;
+	INIT_LIST_HEAD(&start.u.tc_start.ts_jobids);
+	id.ls_str = new->tan_jobid;
+	id.ls_len = strlen(new->tan_jobid);
+	rc = nrs_tbf_jobid_list_add(&id, &start.u.tc_start.ts_jobids);
+	if (rc)
+		return rc;
+
+	rc = nrs_tbf_rule_start(policy, head, &start);
+	nrs_tbf_jobid_list_free(&start.u.tc_start.ts_jobids);
+	if (rc)
+		return rc;
+
+	spin_lock(&policy->pol_nrs->nrs_lock);
+	if (nrs_tbf_auto_duplicate(head, new->tan_name, new->tan_jobid)) {
+		start.tc_cmd = NRS_CTL_TBF_STOP_RULE;
+		nrs_tbf_rule_stop(policy, head, &start);
+		rc = -EEXIST;
+	} else {
+		nrs_tbf_auto_log(policy, head, NRS_TBF_AUTO_START,
+				 new->tan_name, new->tan_jobid,
+				 new->tan_rate, new->tan_limit);
+	}
+	spin_unlock(&policy->pol_nrs->nrs_lock);
+
+	return rc;
+}
+
+/**
+ * Stops the automatic rules whose job has not been hot since \a expire
+ * nanoseconds, or all of them if \a all is set.
+ */
+static void nrs_tbf_auto_expire(struct ptlrpc_nrs_policy *policy,
+				struct nrs_tbf_head *head,
+				__u64 expire, bool all)
+{
+	struct nrs_tbf_rule *rule;
+	struct nrs_tbf_cmd stop;
+	char name[MAX_TBF_NAME];
+	char jobid[LUSTRE_JOBID_SIZE];
+	__u32 limit = 0;
+	bool found;
+
+	memset(&stop, 0, sizeof(stop));
+	stop.tc_cmd = NRS_CTL_TBF_STOP_RULE;
+	stop.tc_name = name;
+	do {
+		found = false;
+		spin_lock(&head->th_rule_lock);
+		list_for_each_entry(rule, &head->th_list, tr_linkage) {
+			if (!(rule->tr_flags & NTRS_AUTO) ||
+			    (!all && rule->tr_auto_hot_time >= expire))
+				continue;
+			strlcpy(name, rule->tr_name, sizeof(name));
+			strlcpy(jobid, rule->tr_jobids_str, sizeof(jobid));
+			limit = rule->tr_rpc_rate;
+			found = true;
+			break;
+		}
+		spin_unlock(&head->th_rule_lock);
+
+		if (found && nrs_tbf_rule_stop(policy, head, &stop) == 0)
+			nrs_tbf_auto_log(policy, head, NRS_TBF_AUTO_STOP, name,
+					 jobid, 0, limit);
+	} while (found);
+}
+
+/**
+ * Autotuner of the jobid TBF policy.
+ *
+ * The RPC rate of each job is sampled by nrs_tbf_res_get() over windows of
+ * nrs_tbf_auto::ta_interval seconds. A job above nrs_tbf_auto::ta_share
+ * percent of the capacity of the partition, and not limited by any rule but
+ * the default one, gets a rule limiting it to that share. The limit of the
+ * rule follows the capacity, and the rule is stopped once the job has stayed
+ * below 90% of the limit for nrs_tbf_auto::ta_expire seconds.
+ *
+ * \param[in] policy	the policy instance
+ * \param[in] head	the TBF policy instance
+ * \param[in] cli	the class sampled, or NULL
+ * \param[in] rate	RPC/s of \a cli in the last window
+ * \param[in] expire	whether to look for cooled down rules
+ * \param[in] now	current time in nanoseconds
+ * \param[out] new	the rule to start for the job of \a cli
+ *
+ * \retval true if \a new has to be started by nrs_tbf_auto_start()
+ */
+static bool nrs_tbf_auto_check(struct ptlrpc_nrs_policy *policy,
+			       struct nrs_tbf_head *head,
+			       struct nrs_tbf_client *cli, __u32 rate,
+			       bool expire, __u64 now,
+			       struct nrs_tbf_auto_new *new)
+{
+	struct nrs_tbf_auto *ta = &head->th_auto;
+	struct nrs_tbf_cmd_change change = { 0 };
+	struct nrs_tbf_rule *rule;
+	bool start = false;
+	__u64 limit;
+
+	assert_spin_locked(&policy->pol_nrs->nrs_lock);
+
+	if (ta->ta_share == 0)
+		return false;
+
+	limit = ta->ta_capacity ? ta->ta_capacity : ta->ta_measured;
+	limit = limit * ta->ta_share;
+	do_div(limit, 100);
+	if (limit >= LPROCFS_NRS_RATE_MAX)
+		limit = LPROCFS_NRS_RATE_MAX - 1;
+	if (cli != NULL && limit > 0) {
+		spin_lock(&cli->tc_rule_lock);
+		rule = cli->tc_rule;
+		atomic_inc(&rule->tr_ref);
+		spin_unlock(&cli->tc_rule_lock);
+
+		/* the jobid has to be usable as is in a jobid list */
+		if ((rule->tr_flags & NTRS_DEFAULT) && rate > limit &&
+		    cli->tc_jobid[0] != '\0' &&
+		    !strpbrk(cli->tc_jobid, " *{}")) {
+			snprintf(new->tan_name, sizeof(new->tan_name),
+				 "auto_%u", ++ta->ta_sequence);
+			strlcpy(new->tan_jobid, cli->tc_jobid,
+				sizeof(new->tan_jobid));
+			new->tan_rate = rate;
+			new->tan_limit = limit;
+			start = true;
+		} else if ((rule->tr_flags & NTRS_AUTO) &&
+			   !(rule->tr_flags & NTRS_STOPPING)) {
+			if (rate * 10ULL >= limit * 9)
+				rule->tr_auto_hot_time = now;
+			if (rule->tr_rpc_rate != limit &&
+			    nrs_tbf_rule_change_rate(policy, head,
+						     rule->tr_name, limit,
+						     &change) == 0)
+				nrs_tbf_auto_log(policy, head,
+						 NRS_TBF_AUTO_CHANGE,
+						 rule->tr_name,
+						 rule->tr_jobids_str,
+						 rate, limit);
+		}
+		nrs_tbf_rule_put(rule);
+	}
+
+	if (expire && now > (__u64)ta->ta_expire * NSEC_PER_SEC)
+		nrs_tbf_auto_expire(policy, head,
+				    now - (__u64)ta->ta_expire * NSEC_PER_SEC,
+				    false);
+
+	return start;
+}
+
+/**
+ * Samples the RPC rate of \a cli and of the partition for the autotuner.
+ *
+ * \param[in]  head	the TBF policy instance
+ * \param[in]  cli	the class of the new request
+ * \param[in]  now	current time in nanoseconds
+ * \param[out] rate	RPC/s of \a cli in the window which just ended
+ * \param[out] expire	set if the window of the partition just ended
+ *
+ * \retval true if the window of \a cli just ended
+ */
+static bool nrs_tbf_auto_sample(struct nrs_tbf_head *head,
+				struct nrs_tbf_client *cli, __u64 now,
+				__u32 *rate, bool *expire)
+{
+	struct nrs_tbf_auto *ta = &head->th_auto;
+	__u64 window = (__u64)ta->ta_interval * NSEC_PER_SEC;
+	__u64 nrpcs;
+
+	if (ta->ta_share == 0)
+		return false;
+
+	if (now >= ta->ta_start + window) {
+		nrpcs = (ta->ta_ndone - ta->ta_ndone_start) * NSEC_PER_SEC;
+		do_div(nrpcs, now - ta->ta_start);
+		ta->ta_measured = max_t(__u64, nrpcs,
+					ta->ta_measured - ta->ta_measured / 8);
+		ta->ta_ndone_start = ta->ta_ndone;
+		ta->ta_start = now;
+		*expire = true;
+	}
+
+	cli->tc_auto_nrpcs++;
+	if (now < cli->tc_auto_start + window)
+		return false;
+
+	nrpcs = cli->tc_auto_nrpcs * NSEC_PER_SEC;
+	do_div(nrpcs, now - cli->tc_auto_start);
+	*rate = nrpcs;
+	cli->tc_auto_nrpcs = 0;
+	cli->tc_auto_start = now;
+
+	return true;
+}
+
+static void nrs_tbf_auto_dump(struct nrs_tbf_head *head, struct seq_file *m)
+{
+	struct nrs_tbf_auto *ta = &head->th_auto;
+	struct nrs_tbf_auto_event *tae;
+	__u64 i;
+
+	seq_printf(m, "share %u, capacity %u, measured %u, interval %u, expire %u\n",
+		   ta->ta_share, ta->ta_capacity, ta->ta_measured,
+		   ta->ta_interval, ta->ta_expire);
+
+	i = ta->ta_nevents > NRS_TBF_AUTO_LOG_SIZE ?
+	    ta->ta_nevents - NRS_TBF_AUTO_LOG_SIZE : 0;
+	for (; i < ta->ta_nevents; i++) {
+		tae = &ta->ta_log[i % NRS_TBF_AUTO_LOG_SIZE];
+		seq_printf(m, "%lld %s %s {%s} rate %u, limit %u\n",
+			   (s64)tae->tae_time,
+			   nrs_tbf_auto_action_names[tae->tae_action],
+			   tae->tae_rule, tae->tae_jobid, tae->tae_rate,
+			   tae->tae_limit);
+	}
+}
+
+static int nrs_tbf_auto_set(struct ptlrpc_nrs_policy *policy,
+			    struct nrs_tbf_head *head,
+			    struct nrs_tbf_auto_cmd *cmd)
+{
+	struct nrs_tbf_auto *ta = &head->th_auto;
+
+	if ((cmd->tac_valid & NRS_TBF_AUTO_SHARE) && cmd->tac_share != 0 &&
+	    !(head->th_type_flag & NRS_TBF_FLAG_JOBID))
+		return -EOPNOTSUPP;
+
+	if (cmd->tac_valid & NRS_TBF_AUTO_CAPACITY)
+		ta->ta_capacity = cmd->tac_capacity;
+	if (cmd->tac_valid & NRS_TBF_AUTO_INTERVAL)
+		ta->ta_interval = cmd->tac_interval;
+	if (cmd->tac_valid & NRS_TBF_AUTO_EXPIRE)
+		ta->ta_expire = cmd->tac_expire;
+	if (cmd->tac_valid & NRS_TBF_AUTO_SHARE) {
+		ta->ta_share = cmd->tac_share;
+		if (ta->ta_share == 0)
+			nrs_tbf_auto_expire(policy, head, 0, true);
+	}
+
+	return 0;
+}
+
 /**
  * Performs a policy-specific ctl function on TBF policy instances; similar
  * to ioctl.
@@ -2907,6 +3402,26 @@ static int nrs_tbf_ctl(struct ptlrpc_nrs_policy *policy,
 		*(__u32 *)arg = head->th_type_flag;
 		}
 		break;
+	/**
+	 * Read the settings and the audit log of the autotuner.
+	 */
+	case NRS_CTL_TBF_RD_AUTO: {
+		struct nrs_tbf_head *head = policy->pol_private;
+		struct seq_file *m = arg;
+
+		seq_printf(m, "CPT %d:\n", policy->pol_nrs->nrs_svcpt->scp_cpt);
+		nrs_tbf_auto_dump(head, m);
+		}
+		break;
+	/**
+	 * Write the settings of the autotuner.
+	 */
+	case NRS_CTL_TBF_WR_AUTO: {
+		struct nrs_tbf_head *head = policy->pol_private;
+
+		rc = nrs_tbf_auto_set(policy, head, arg);
+		}
+		break;
 	}
 
 	RETURN(rc);
@@ -2935,6 +3450,12 @@ static int nrs_tbf_res_get(struct ptlrpc_nrs_policy *policy,
 	struct nrs_tbf_client *cli;
 	struct nrs_tbf_client *tmp;
 	struct ptlrpc_request *req;
+	struct nrs_tbf_auto_new new;
+	bool		       sampled = false;
+	bool		       expire = false;
+	bool		       start;
+	__u32		       rate = 0;
+	__u64		       now = 0;
 
 	if (parent == NULL) {
 		*resp = &((struct nrs_tbf_head *)policy->pol_private)->th_res;
@@ -2971,7 +3492,22 @@ static int nrs_tbf_res_get(struct ptlrpc_nrs_policy *policy,
 			   cli->tc_rule->tr_generation) {
 			nrs_tbf_cli_reset_value(head, cli);
 		}
+		if (!moving_req) {
+			now = ktime_to_ns(ktime_get());
+			sampled = nrs_tbf_auto_sample(head, cli, now, &rate,
+						      &expire);
+		}
 		spin_unlock(&policy->pol_nrs->nrs_svcpt->scp_req_lock);
+
+		if (sampled || expire) {
+			spin_lock(&policy->pol_nrs->nrs_lock);
+			start = nrs_tbf_auto_check(policy, head,
+						   sampled ? cli : NULL,
+						   rate, expire, now, &new);
+			spin_unlock(&policy->pol_nrs->nrs_lock);
+			if (start)
+				nrs_tbf_auto_start(policy, head, &new);
+		}
 		goto out;
 	}
 
@@ -3018,6 +3554,199 @@ static void nrs_tbf_res_put(struct ptlrpc_nrs_policy *policy,
 	head->th_ops->o_cli_put(head, cli);
 }
 
+/**
+ * Refills the bucket shared by the children of \a rule.
+ */
+static void nrs_tbf_rule_refill(struct nrs_tbf_rule *rule, __u64 now)
+{
+	__u64 ntoken;
+
+	if (now <= rule->tr_check_time)
+		return;
+
+	ntoken = now - rule->tr_check_time;
+	do_div(ntoken, rule->tr_nsecs_per_rpc);
+	if (ntoken == 0)
+		return;
+
+	rule->tr_ntoken += ntoken;
+	rule->tr_check_time += ntoken * rule->tr_nsecs_per_rpc;
+	if (rule->tr_ntoken >= rule->tr_depth) {
+		rule->tr_ntoken = rule->tr_depth;
+		rule->tr_check_time = now;
+	}
+}
+
+/**
+ * Refills the guaranteed bucket of \a cli.
+ *
+ * \retval true if \a cli has a guaranteed token
+ */
+static bool nrs_tbf_cli_min_refill(struct nrs_tbf_client *cli, __u64 now)
+{
+	__u64 ntoken;
+
+	if (now > cli->tc_min_check_time) {
+		ntoken = now - cli->tc_min_check_time;
+		do_div(ntoken, cli->tc_min_nsecs);
+		if (ntoken > 0) {
+			cli->tc_min_ntoken += ntoken;
+			cli->tc_min_check_time += ntoken * cli->tc_min_nsecs;
+			if (cli->tc_min_ntoken >= cli->tc_depth) {
+				cli->tc_min_ntoken = cli->tc_depth;
+				cli->tc_min_check_time = now;
+			}
+		}
+	}
+
+	return cli->tc_min_ntoken > 0;
+}
+
+/**
+ * Accounts an RPC of \a cli against its guaranteed rate, whichever heap it
+ * was dequeued from, so that only the classes below their minimum rate are
+ * served first.
+ */
+static void nrs_tbf_cli_min_charge(struct nrs_tbf_client *cli, __u64 now)
+{
+	if (cli->tc_min_rate == 0)
+		return;
+
+	if (nrs_tbf_cli_min_refill(cli, now))
+		cli->tc_min_ntoken--;
+
+	cli->tc_min_deadline = cli->tc_min_check_time;
+	if (cli->tc_min_ntoken == 0)
+		cli->tc_min_deadline += cli->tc_min_nsecs;
+}
+
+/**
+ * Accounts an RPC of \a cli served at its guaranteed rate against its own
+ * and its parent's buckets. These are not enforced, since the minimum rate
+ * of a rule can't be higher than its maximum rate.
+ */
+static void nrs_tbf_cli_charge(struct nrs_tbf_client *cli, __u64 now)
+{
+	struct nrs_tbf_rule *parent = cli->tc_rule->tr_parent;
+	__u64 ntoken;
+
+	LASSERT(now >= cli->tc_check_time);
+	ntoken = (now - cli->tc_check_time) * cli->tc_rpc_rate;
+	do_div(ntoken, NSEC_PER_SEC);
+	ntoken += cli->tc_ntoken;
+	if (ntoken > cli->tc_depth)
+		ntoken = cli->tc_depth;
+	if (ntoken > 0)
+		ntoken--;
+	cli->tc_ntoken = ntoken;
+	cli->tc_check_time = now;
+
+	if (parent != NULL) {
+		nrs_tbf_rule_refill(parent, now);
+		if (parent->tr_ntoken > 0)
+			parent->tr_ntoken--;
+	}
+}
+
+/**
+ * Removes the first request of \a cli from its queue, and updates the
+ * position of \a cli in the heaps.
+ */
+static struct ptlrpc_nrs_request *
+nrs_tbf_cli_dequeue(struct nrs_tbf_head *head, struct nrs_tbf_client *cli,
+		    __u64 now)
+{
+	struct ptlrpc_nrs_request *nrq;
+
+	nrq = list_entry(cli->tc_list.next, struct ptlrpc_nrs_request,
+			 nr_u.tbf.tr_list);
+	list_del_init(&nrq->nr_u.tbf.tr_list);
+	if (list_empty(&cli->tc_list)) {
+		binheap_remove(head->th_binheap, &cli->tc_node);
+		cli->tc_in_heap = false;
+		if (cli->tc_in_min_heap) {
+			binheap_remove(head->th_min_binheap,
+				       &cli->tc_min_node);
+			cli->tc_in_min_heap = false;
+		}
+	} else {
+		if (!(cli->tc_rule->tr_flags & NTRS_REALTIME))
+			cli->tc_deadline = now + cli->tc_nsecs;
+		binheap_relocate(head->th_binheap, &cli->tc_node);
+		if (cli->tc_in_min_heap)
+			binheap_relocate(head->th_min_binheap,
+					 &cli->tc_min_node);
+	}
+
+	return nrq;
+}
+
+/**
+ * Gets a request from the classes which are below their guaranteed minimum
+ * rate, these are served before any other class.
+ */
+static struct ptlrpc_nrs_request *
+nrs_tbf_req_get_min(struct nrs_tbf_head *head)
+{
+	struct nrs_tbf_client *cli;
+	struct binheap_node *node;
+	__u64 now;
+
+	node = binheap_root(head->th_min_binheap);
+	if (node == NULL)
+		return NULL;
+
+	now = ktime_to_ns(ktime_get());
+	do {
+		cli = container_of(node, struct nrs_tbf_client, tc_min_node);
+		LASSERT(cli->tc_in_min_heap);
+		if (nrs_tbf_cli_min_refill(cli, now)) {
+			nrs_tbf_cli_charge(cli, now);
+			nrs_tbf_cli_min_charge(cli, now);
+			CDEBUG(D_RPCTRACE,
+			       "TBF dequeues at min rate: class@%p min %u token %llu\n",
+			       cli, cli->tc_min_rate, cli->tc_min_ntoken);
+			return nrs_tbf_cli_dequeue(head, cli, now);
+		}
+
+		/* the heap key may be stale, only fixed on dequeue */
+		if (cli->tc_min_deadline > now)
+			break;
+		cli->tc_min_deadline = cli->tc_min_check_time +
+				       cli->tc_min_nsecs;
+		binheap_relocate(head->th_min_binheap, node);
+	} while ((node = binheap_root(head->th_min_binheap)) !=
+		 &cli->tc_min_node);
+
+	return NULL;
+}
+
+/**
+ * Throttles the policy until \a deadline, or until the next guaranteed token
+ * of a class if that comes earlier.
+ */
+static void nrs_tbf_throttle(struct ptlrpc_nrs_policy *policy,
+			     struct nrs_tbf_head *head, __u64 deadline)
+{
+	struct binheap_node *node;
+	ktime_t time;
+
+	node = binheap_root(head->th_min_binheap);
+	if (node != NULL) {
+		struct nrs_tbf_client *cli;
+
+		cli = container_of(node, struct nrs_tbf_client, tc_min_node);
+		if (cli->tc_min_deadline < deadline)
+			deadline = cli->tc_min_deadline;
+	}
+
+	policy->pol_nrs->nrs_throttling = 1;
+	head->th_deadline = deadline;
+	time = ktime_set(0, 0);
+	time = ktime_add_ns(time, deadline);
+	hrtimer_start(&head->th_timer, time, HRTIMER_MODE_ABS);
+}
+
 /**
  * Called when getting a request from the TBF policy for handling, or just
  * peeking; removes the request from the policy when it is to be handled.
@@ -3049,6 +3778,13 @@ struct ptlrpc_nrs_request *nrs_tbf_req_get(struct ptlrpc_nrs_policy *policy,
 	if (!peek && policy->pol_nrs->nrs_throttling)
 		return NULL;
 
+again:
+	if (!peek) {
+		nrq = nrs_tbf_req_get_min(head);
+		if (nrq != NULL)
+			return nrq;
+	}
+
 	node = binheap_root(head->th_binheap);
 	if (unlikely(node == NULL))
 		return NULL;
@@ -3061,6 +3797,7 @@ struct ptlrpc_nrs_request *nrs_tbf_req_get(struct ptlrpc_nrs_policy *policy,
 				     nr_u.tbf.tr_list);
 	} else {
 		struct nrs_tbf_rule *rule = cli->tc_rule;
+		struct nrs_tbf_rule *parent = rule->tr_parent;
 		__u64 now = ktime_to_ns(ktime_get());
 		__u64 passed;
 		__u64 ntoken;
@@ -3086,28 +3823,23 @@ struct ptlrpc_nrs_request *nrs_tbf_req_get(struct ptlrpc_nrs_policy *policy,
 		} else if (ntoken > cli->tc_depth)
 			ntoken = cli->tc_depth;
 
-		if (ntoken > 0) {
-			struct ptlrpc_request *req;
-			nrq = list_entry(cli->tc_list.next,
-					     struct ptlrpc_nrs_request,
-					     nr_u.tbf.tr_list);
-			req = container_of(nrq,
-					   struct ptlrpc_request,
-					   rq_nrq);
-			ntoken--;
+		if (parent != NULL)
+			nrs_tbf_rule_refill(parent, now);
+
+		/*
+		 * Every RPC of a class with a parent takes a token from the
+		 * bucket shared with its siblings. A class out of its own
+		 * tokens borrows the unused ones of its siblings.
+		 */
+		if (parent != NULL ? parent->tr_ntoken > 0 : ntoken > 0) {
+			if (ntoken > 0)
+				ntoken--;
+			if (parent != NULL)
+				parent->tr_ntoken--;
 			cli->tc_ntoken = ntoken;
 			cli->tc_check_time = now;
-			list_del_init(&nrq->nr_u.tbf.tr_list);
-			if (list_empty(&cli->tc_list)) {
-				binheap_remove(head->th_binheap,
-					       &cli->tc_node);
-				cli->tc_in_heap = false;
-			} else {
-				if (!(rule->tr_flags & NTRS_REALTIME))
-					cli->tc_deadline = now + cli->tc_nsecs;
-				binheap_relocate(head->th_binheap,
-						 &cli->tc_node);
-			}
+			nrs_tbf_cli_min_charge(cli, now);
+			nrq = nrs_tbf_cli_dequeue(head, cli, now);
 			CDEBUG(D_RPCTRACE,
 			       "TBF dequeues: class@%p rate %u gen %llu "
 			       "token %llu, rule@%p rate %u gen %llu\n",
@@ -3116,22 +3848,36 @@ struct ptlrpc_nrs_request *nrs_tbf_req_get(struct ptlrpc_nrs_policy *policy,
 			       cli->tc_rule, cli->tc_rule->tr_rpc_rate,
 			       cli->tc_rule->tr_generation);
 		} else {
-			ktime_t time;
+			struct binheap_node *root;
 
-			if (rule->tr_flags & NTRS_REALTIME) {
+			if (parent != NULL) {
+				/* wait for the bucket shared by siblings */
+				deadline = parent->tr_check_time +
+					   parent->tr_nsecs_per_rpc;
+				cli->tc_deadline = deadline;
+				if (rule->tr_flags & NTRS_REALTIME)
+					cli->tc_nsecs_resid = old_resid;
+				binheap_relocate(head->th_binheap,
+						 &cli->tc_node);
+				/*
+				 * Try the new root unless it is not due
+				 * before @deadline, e.g. a sibling already
+				 * waiting for the same bucket.
+				 */
+				root = binheap_root(head->th_binheap);
+				if (root != node &&
+				    container_of(root, struct nrs_tbf_client,
+						 tc_node)->tc_deadline < deadline)
+					goto again;
+			} else if (rule->tr_flags & NTRS_REALTIME) {
 				cli->tc_deadline = deadline;
 				cli->tc_nsecs_resid = old_resid;
 				binheap_relocate(head->th_binheap,
 						 &cli->tc_node);
 				if (node != binheap_root(head->th_binheap))
-					return nrs_tbf_req_get(policy,
-							       peek, force);
+					goto again;
 			}
-			policy->pol_nrs->nrs_throttling = 1;
-			head->th_deadline = deadline;
-			time = ktime_set(0, 0);
-			time = ktime_add_ns(time, deadline);
-			hrtimer_start(&head->th_timer, time, HRTIMER_MODE_ABS);
+			nrs_tbf_throttle(policy, head, deadline);
 		}
 	}
 
@@ -3162,8 +3908,21 @@ static int nrs_tbf_req_add(struct ptlrpc_nrs_policy *policy,
 			    struct nrs_tbf_head, th_res);
 	if (list_empty(&cli->tc_list)) {
 		LASSERT(!cli->tc_in_heap);
+		LASSERT(!cli->tc_in_min_heap);
 		cli->tc_deadline = cli->tc_check_time + cli->tc_nsecs;
 		rc = binheap_insert(head->th_binheap, &cli->tc_node);
+		if (rc == 0 && cli->tc_min_rate != 0) {
+			cli->tc_min_deadline = cli->tc_min_check_time;
+			if (cli->tc_min_ntoken == 0)
+				cli->tc_min_deadline += cli->tc_min_nsecs;
+			rc = binheap_insert(head->th_min_binheap,
+					    &cli->tc_min_node);
+			if (rc == 0)
+				cli->tc_in_min_heap = true;
+			else
+				binheap_remove(head->th_binheap,
+					       &cli->tc_node);
+		}
 		if (rc == 0) {
 			cli->tc_in_heap = true;
 			nrq->nr_u.tbf.tr_sequence = head->th_sequence++;
@@ -3171,6 +3930,10 @@ static int nrs_tbf_req_add(struct ptlrpc_nrs_policy *policy,
 					  &cli->tc_list);
 			if (policy->pol_nrs->nrs_throttling) {
 				__u64 deadline = cli->tc_deadline;
+
+				if (cli->tc_in_min_heap &&
+				    cli->tc_min_deadline < deadline)
+					deadline = cli->tc_min_deadline;
 				if ((head->th_deadline > deadline) &&
 				    (hrtimer_try_to_cancel(&head->th_timer)
 				     >= 0)) {
@@ -3227,9 +3990,17 @@ static void nrs_tbf_req_del(struct ptlrpc_nrs_policy *policy,
 		binheap_remove(head->th_binheap,
 			       &cli->tc_node);
 		cli->tc_in_heap = false;
+		if (cli->tc_in_min_heap) {
+			binheap_remove(head->th_min_binheap,
+				       &cli->tc_min_node);
+			cli->tc_in_min_heap = false;
+		}
 	} else {
 		binheap_relocate(head->th_binheap,
 				 &cli->tc_node);
+		if (cli->tc_in_min_heap)
+			binheap_relocate(head->th_min_binheap,
+					 &cli->tc_min_node);
 	}
 }
 
@@ -3246,11 +4017,13 @@ static void nrs_tbf_req_del(struct ptlrpc_nrs_policy *policy,
 static void nrs_tbf_req_stop(struct ptlrpc_nrs_policy *policy,
 			      struct ptlrpc_nrs_request *nrq)
 {
+	struct nrs_tbf_head *head = policy->pol_private;
 	struct ptlrpc_request *req = container_of(nrq, struct ptlrpc_request,
 						  rq_nrq);
 
 	assert_spin_locked(&policy->pol_nrs->nrs_svcpt->scp_req_lock);
 
+	head->th_auto.ta_ndone++;
 	CDEBUG(D_RPCTRACE, "NRS stop %s request from %s, seq: %llu\n",
 	       policy->pol_desc->pd_name, libcfs_id2str(req->rq_peer),
 	       nrq->nr_u.tbf.tr_sequence);
@@ -3260,11 +4033,6 @@ static void nrs_tbf_req_stop(struct ptlrpc_nrs_policy *policy,
  * debugfs interface
  */
 
-/**
- * The maximum RPC rate.
- */
-#define LPROCFS_NRS_RATE_MAX		65535
-
 static int
 ptlrpc_lprocfs_nrs_tbf_rule_seq_show(struct seq_file *m, void *data)
 {
@@ -3427,6 +4195,30 @@ nrs_tbf_parse_value_pair(struct nrs_tbf_cmd *cmd, char *buffer)
 			cmd->u.tc_change.tc_next_name = val;
 		else
 			return -EINVAL;
+	} else if (strcmp(key, "min_rate") == 0) {
+		rc = kstrtoull(val, 10, &rate);
+		if (rc)
+			return rc;
+
+		if (rate >= LPROCFS_NRS_RATE_MAX)
+			return -EINVAL;
+
+		if (cmd->tc_cmd == NRS_CTL_TBF_START_RULE) {
+			cmd->u.tc_start.ts_min_rate = rate;
+		} else if (cmd->tc_cmd == NRS_CTL_TBF_CHANGE_RULE) {
+			cmd->u.tc_change.tc_min_rate = rate;
+			cmd->u.tc_change.tc_min_rate_set = true;
+		} else {
+			return -EINVAL;
+		}
+	} else if (strcmp(key, "parent") == 0) {
+		if (!name_is_valid(val))
+			return -EINVAL;
+
+		if (cmd->tc_cmd == NRS_CTL_TBF_START_RULE)
+			cmd->u.tc_start.ts_parent_name = val;
+		else
+			return -EINVAL;
 	} else if (strcmp(key, "realtime") == 0) {
 		unsigned long realtime;
 
@@ -3464,6 +4256,7 @@ nrs_tbf_parse_value_pairs(struct nrs_tbf_cmd *cmd, char *buffer)
 		break;
 	case NRS_CTL_TBF_CHANGE_RULE:
 		if (cmd->u.tc_change.tc_rpc_rate == 0 &&
+		    !cmd->u.tc_change.tc_min_rate_set &&
 		    cmd->u.tc_change.tc_next_name == NULL)
 			return -EINVAL;
 		break;
@@ -3647,6 +4440,142 @@ out:
 
 LDEBUGFS_SEQ_FOPS(ptlrpc_lprocfs_nrs_tbf_rule);
 
+/**
+ * Shows the settings and the audit log of the TBF autotuner, e.g.:
+ *
+ * regular_requests:
+ * CPT 0:
+ * share 50, capacity 0, measured 2300, interval 10, expire 60
+ * 1602345678 start auto_1 {dd.500} rate 1800, limit 1150
+ */
+static int
+ptlrpc_lprocfs_nrs_tbf_auto_seq_show(struct seq_file *m, void *data)
+{
+	struct ptlrpc_service *svc = m->private;
+	int rc;
+
+	seq_printf(m, "regular_requests:\n");
+	rc = ptlrpc_nrs_policy_control(svc, PTLRPC_NRS_QUEUE_REG,
+				       NRS_POL_NAME_TBF,
+				       NRS_CTL_TBF_RD_AUTO,
+				       false, m);
+	if (rc == -ENOSPC)
+		return 0;
+	if (rc != 0 && rc != -ENODEV)
+		return rc;
+
+	if (!nrs_svc_has_hp(svc))
+		return rc;
+
+	seq_printf(m, "high_priority_requests:\n");
+	rc = ptlrpc_nrs_policy_control(svc, PTLRPC_NRS_QUEUE_HP,
+				       NRS_POL_NAME_TBF,
+				       NRS_CTL_TBF_RD_AUTO,
+				       false, m);
+	if (rc == -ENOSPC)
+		return 0;
+
+	return rc;
+}
+
+/**
+ * Changes the settings of the TBF autotuner, the format is
+ *
+ * [reg|hp] [share=PERCENT] [capacity=RPCS] [interval=SECS] [expire=SECS]
+ *
+ * e.g.
+ * lctl set_param ost.OSS.ost_io.nrs_tbf_auto="share=50 capacity=4000"
+ *
+ * The autotuner is disabled with share=0, which also stops the rules it has
+ * started. It needs the TBF jobid policy.
+ */
+static ssize_t
+ptlrpc_lprocfs_nrs_tbf_auto_seq_write(struct file *file,
+				      const char __user *buffer,
+				      size_t count, loff_t *off)
+{
+	struct seq_file		  *m = file->private_data;
+	struct ptlrpc_service	  *svc = m->private;
+	enum ptlrpc_nrs_queue_type queue = PTLRPC_NRS_QUEUE_BOTH;
+	struct nrs_tbf_auto_cmd	   cmd = { 0 };
+	char			   kernbuf[128];
+	char			  *val = kernbuf;
+	char			  *token;
+	char			  *key;
+	unsigned int		   value;
+	int			   rc;
+
+	if (count > sizeof(kernbuf) - 1)
+		return -EINVAL;
+
+	if (copy_from_user(kernbuf, buffer, count))
+		return -EFAULT;
+	kernbuf[count] = '\0';
+
+	while ((token = strsep(&val, " \n")) != NULL) {
+		if (*token == '\0')
+			continue;
+
+		if (strcmp(token, "reg") == 0) {
+			queue = PTLRPC_NRS_QUEUE_REG;
+			continue;
+		}
+		if (strcmp(token, "hp") == 0) {
+			queue = PTLRPC_NRS_QUEUE_HP;
+			continue;
+		}
+
+		key = strsep(&token, "=");
+		if (token == NULL)
+			return -EINVAL;
+
+		rc = kstrtouint(token, 10, &value);
+		if (rc)
+			return rc;
+
+		if (strcmp(key, "share") == 0) {
+			if (value > 100)
+				return -EINVAL;
+			cmd.tac_share = value;
+			cmd.tac_valid |= NRS_TBF_AUTO_SHARE;
+		} else if (strcmp(key, "capacity") == 0) {
+			cmd.tac_capacity = value;
+			cmd.tac_valid |= NRS_TBF_AUTO_CAPACITY;
+		} else if (strcmp(key, "interval") == 0) {
+			if (value == 0 || value > 3600)
+				return -EINVAL;
+			cmd.tac_interval = value;
+			cmd.tac_valid |= NRS_TBF_AUTO_INTERVAL;
+		} else if (strcmp(key, "expire") == 0) {
+			if (value > 86400)
+				return -EINVAL;
+			cmd.tac_expire = value;
+			cmd.tac_valid |= NRS_TBF_AUTO_EXPIRE;
+		} else {
+			return -EINVAL;
+		}
+	}
+
+	if (cmd.tac_valid == 0)
+		return -EINVAL;
+
+	if (queue == PTLRPC_NRS_QUEUE_HP && !nrs_svc_has_hp(svc))
+		return -ENODEV;
+	else if (queue == PTLRPC_NRS_QUEUE_BOTH && !nrs_svc_has_hp(svc))
+		queue = PTLRPC_NRS_QUEUE_REG;
+
+	mutex_lock(&nrs_core.nrs_mutex);
+	rc = ptlrpc_nrs_policy_control(svc, queue,
+				       NRS_POL_NAME_TBF,
+				       NRS_CTL_TBF_WR_AUTO,
+				       false, &cmd);
+	mutex_unlock(&nrs_core.nrs_mutex);
+
+	return rc ? rc : count;
+}
+
+LDEBUGFS_SEQ_FOPS(ptlrpc_lprocfs_nrs_tbf_auto);
+
 /**
  * Initializes a TBF policy's lprocfs interface for service \a svc
  *
@@ -3661,6 +4590,9 @@ static int nrs_tbf_lprocfs_init(struct ptlrpc_service *svc)
 		{ .name		= "nrs_tbf_rule",
 		  .fops		= &ptlrpc_lprocfs_nrs_tbf_rule_fops,
 		  .data = svc },
+		{ .name		= "nrs_tbf_auto",
+		  .fops		= &ptlrpc_lprocfs_nrs_tbf_auto_fops,
+		  .data = svc },
 		{ NULL }
 	};
 
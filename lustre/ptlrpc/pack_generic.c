@@ -592,8 +592,8 @@ static int lustre_unpack_msg_v2(struct lustre_msg_v2 *m, int len)
 		__swab32s(&m->lm_repsize);
 		__swab32s(&m->lm_cksum);
 		__swab32s(&m->lm_flags);
-		BUILD_BUG_ON(offsetof(typeof(*m), lm_padding_2) == 0);
-		BUILD_BUG_ON(offsetof(typeof(*m), lm_padding_3) == 0);
+		__swab32s(&m->lm_opc);
+		__swab32s(&m->lm_result);
 	}
 
 	if (m->lm_bufcount == 0 || m->lm_bufcount > PTLRPC_MAX_BUFCOUNT) {
@@ -1781,10 +1781,13 @@ void lustre_swab_connect(struct obd_connect_data *ocd)
 		__swab64s(&ocd->ocd_maxbytes);
 	if (ocd->ocd_connect_flags & OBD_CONNECT_MULTIMODRPCS)
 		__swab16s(&ocd->ocd_maxmodrpcs);
-	BUILD_BUG_ON(offsetof(typeof(*ocd), padding0) == 0);
 	BUILD_BUG_ON(offsetof(typeof(*ocd), padding1) == 0);
 	if (ocd->ocd_connect_flags & OBD_CONNECT_FLAGS2)
 		__swab64s(&ocd->ocd_connect_flags2);
+	/* ocd_compr_types precedes ocd_connect_flags2, swab it afterwards */
+	if (ocd->ocd_connect_flags & OBD_CONNECT_FLAGS2 &&
+	    ocd->ocd_connect_flags2 & OBD_CONNECT2_COMPRESS)
+		__swab16s(&ocd->ocd_compr_types);
 	BUILD_BUG_ON(offsetof(typeof(*ocd), padding3) == 0);
 	BUILD_BUG_ON(offsetof(typeof(*ocd), padding4) == 0);
 	BUILD_BUG_ON(offsetof(typeof(*ocd), padding5) == 0);
@@ -3000,3 +3003,23 @@ void lustre_swab_ladvise_hdr(struct ladvise_hdr *ladvise_hdr)
 	__swab64s(&ladvise_hdr->lah_value3);
 }
 EXPORT_SYMBOL(lustre_swab_ladvise_hdr);
+
+/*
+ * Only the batch headers are swabbed here, each sub-message is swabbed by
+ * __lustre_unpack_msg() when it is unpacked by the handler or interpreter.
+ */
+void lustre_swab_batch_update_request(struct batch_update_request *burq)
+{
+	__swab32s(&burq->burq_magic);
+	__swab16s(&burq->burq_count);
+	__swab16s(&burq->burq_padding);
+	__swab32s(&burq->burq_reply_size);
+	__swab32s(&burq->burq_padding2);
+}
+
+void lustre_swab_batch_update_reply(struct batch_update_reply *burp)
+{
+	__swab32s(&burp->burp_magic);
+	__swab16s(&burp->burp_count);
+	__swab16s(&burp->burp_padding);
+}
@@ -33,6 +33,7 @@
 
 #include <linux/kthread.h>
 #include <linux/ratelimit.h>
+#include <linux/sort.h>
 
 #include <obd_support.h>
 #include <obd_class.h>
@@ -57,6 +58,10 @@ module_param(at_early_margin, int, 0644);
 MODULE_PARM_DESC(at_early_margin, "How soon before an RPC deadline to send an early reply");
 module_param(at_extra, int, 0644);
 MODULE_PARM_DESC(at_extra, "How much extra time to give with each early reply");
+static int thread_idle_timeout;
+module_param(thread_idle_timeout, int, 0644);
+MODULE_PARM_DESC(thread_idle_timeout,
+		 "Stop service threads above threads_min after being idle this long (sec), 0 to disable");
 
 /* forward ref */
 static int ptlrpc_server_post_idle_rqbds(struct ptlrpc_service_part *svcpt);
@@ -208,6 +213,8 @@ struct ptlrpc_hr_thread {
 	spinlock_t			hrt_lock;
 	wait_queue_head_t		hrt_waitq;
 	struct list_head		hrt_queue;
+	/* # of replies in hrt_queue, protected by hrt_lock */
+	unsigned int			hrt_nqueued;
 	struct ptlrpc_hr_partition	*hrt_partition;
 };
 
@@ -255,6 +262,12 @@ static struct ptlrpc_hr_service		ptlrpc_hr;
  */
 #define MAX_SCHEDULED 256
 
+/**
+ * maximum number of committed replies taken off exp_uncommitted_replies
+ * under one hold of exp_uncommitted_replies_lock
+ */
+#define MAX_COMMITTED 32
+
 /**
  * Initialize a reply batch.
  *
@@ -291,6 +304,22 @@ struct ptlrpc_hr_thread *ptlrpc_hr_select(struct ptlrpc_service_part *svcpt)
 	return &hrp->hrp_thrs[rotor % hrp->hrp_nthrs];
 }
 
+/**
+ * Account \a nr replies queued to an hr thread which then has \a qdepth
+ * replies pending.
+ */
+static void ptlrpc_hr_stats(struct ptlrpc_service_part *svcpt,
+			    unsigned int nr, unsigned int qdepth)
+{
+	struct lprocfs_stats *svc_stats = svcpt->scp_service->srv_stats;
+
+	if (svc_stats == NULL)
+		return;
+
+	lprocfs_counter_add(svc_stats, PTLRPC_REPQDEPTH_CNTR, qdepth);
+	lprocfs_counter_add(svc_stats, PTLRPC_REPBATCH_CNTR, nr);
+}
+
 /**
  * Dispatch all replies accumulated in the batch to one from
  * dedicated reply handling threads.
@@ -301,14 +330,18 @@ static void rs_batch_dispatch(struct rs_batch *b)
 {
 	if (b->rsb_n_replies != 0) {
 		struct ptlrpc_hr_thread	*hrt;
+		unsigned int qdepth;
 
 		hrt = ptlrpc_hr_select(b->rsb_svcpt);
 
 		spin_lock(&hrt->hrt_lock);
 		list_splice_init(&b->rsb_replies, &hrt->hrt_queue);
+		hrt->hrt_nqueued += b->rsb_n_replies;
+		qdepth = hrt->hrt_nqueued;
 		spin_unlock(&hrt->hrt_lock);
 
 		wake_up(&hrt->hrt_waitq);
+		ptlrpc_hr_stats(b->rsb_svcpt, b->rsb_n_replies, qdepth);
 		b->rsb_n_replies = 0;
 	}
 }
@@ -316,6 +349,8 @@ static void rs_batch_dispatch(struct rs_batch *b)
 /**
  * Add a reply to a batch.
  * Add one reply object to a batch, schedule batched replies if overload.
+ * The reply was already marked committed by ptlrpc_commit_replies(), it is
+ * skipped if an ACK got it scheduled or handled in the meantime.
  *
  * \param b batch
  * \param rs reply
@@ -333,13 +368,11 @@ static void rs_batch_add(struct rs_batch *b, struct ptlrpc_reply_state *rs)
 		b->rsb_svcpt = svcpt;
 	}
 	spin_lock(&rs->rs_lock);
-	rs->rs_scheduled_ever = 1;
-	if (rs->rs_scheduled == 0) {
+	if (rs->rs_scheduled == 0 && rs->rs_handled == 0) {
 		list_move(&rs->rs_list, &b->rsb_replies);
 		rs->rs_scheduled = 1;
 		b->rsb_n_replies++;
 	}
-	rs->rs_committed = 1;
 	spin_unlock(&rs->rs_lock);
 }
 
@@ -368,6 +401,7 @@ static void rs_batch_fini(struct rs_batch *b)
 void ptlrpc_dispatch_difficult_reply(struct ptlrpc_reply_state *rs)
 {
 	struct ptlrpc_hr_thread *hrt;
+	unsigned int qdepth;
 
 	ENTRY;
 
@@ -377,9 +411,11 @@ void ptlrpc_dispatch_difficult_reply(struct ptlrpc_reply_state *rs)
 
 	spin_lock(&hrt->hrt_lock);
 	list_add_tail(&rs->rs_list, &hrt->hrt_queue);
+	qdepth = ++hrt->hrt_nqueued;
 	spin_unlock(&hrt->hrt_lock);
 
 	wake_up(&hrt->hrt_waitq);
+	ptlrpc_hr_stats(rs->rs_svcpt, 1, qdepth);
 	EXIT;
 }
 
@@ -404,33 +440,80 @@ void ptlrpc_schedule_difficult_reply(struct ptlrpc_reply_state *rs)
 }
 EXPORT_SYMBOL(ptlrpc_schedule_difficult_reply);
 
+static int rs_svcpt_cmp(const void *a, const void *b)
+{
+	const struct ptlrpc_reply_state *rs1;
+	const struct ptlrpc_reply_state *rs2;
+
+	rs1 = *(const struct ptlrpc_reply_state **)a;
+	rs2 = *(const struct ptlrpc_reply_state **)b;
+
+	if (rs1->rs_svcpt == rs2->rs_svcpt)
+		return 0;
+	return rs1->rs_svcpt < rs2->rs_svcpt ? -1 : 1;
+}
+
 void ptlrpc_commit_replies(struct obd_export *exp)
 {
+	struct ptlrpc_reply_state *rss[MAX_COMMITTED];
 	struct ptlrpc_reply_state *rs, *nxt;
 	DECLARE_RS_BATCH(batch);
+	int nr;
+	int i;
 
 	ENTRY;
 
-	rs_batch_init(&batch);
 	/*
 	 * Find any replies that have been committed and get their service
 	 * to attend to complete them.
+	 *
+	 * Replies are only taken off exp_uncommitted_replies and marked
+	 * committed under exp_uncommitted_replies_lock, so that concurrent
+	 * commit callbacks and the hr threads don't wait for the scheduling.
+	 * The collected replies are then sorted by service partition, each
+	 * scp_rep_lock is taken once for all replies of that partition and
+	 * they are dispatched in a batch to the hr threads of that CPT.
 	 */
+	do {
+		nr = 0;
+		spin_lock(&exp->exp_uncommitted_replies_lock);
+		list_for_each_entry_safe(rs, nxt, &exp->exp_uncommitted_replies,
+					 rs_obd_list) {
+			LASSERT(rs->rs_difficult);
+			/* VBR: per-export last_committed */
+			LASSERT(rs->rs_export);
+			if (rs->rs_transno > exp->exp_last_committed)
+				continue;
 
-	/* CAVEAT EMPTOR: spinlock ordering!!! */
-	spin_lock(&exp->exp_uncommitted_replies_lock);
-	list_for_each_entry_safe(rs, nxt, &exp->exp_uncommitted_replies,
-				 rs_obd_list) {
-		LASSERT(rs->rs_difficult);
-		/* VBR: per-export last_committed */
-		LASSERT(rs->rs_export);
-		if (rs->rs_transno <= exp->exp_last_committed) {
 			list_del_init(&rs->rs_obd_list);
-			rs_batch_add(&batch, rs);
+			/* ptlrpc_handle_rs() skips the list once this is set */
+			spin_lock(&rs->rs_lock);
+			rs->rs_scheduled_ever = 1;
+			rs->rs_committed = 1;
+			spin_unlock(&rs->rs_lock);
+			/* rs may be handled before it is added to batch */
+			ptlrpc_rs_addref(rs);
+			rss[nr++] = rs;
+			if (nr == MAX_COMMITTED)
+				break;
 		}
-	}
-	spin_unlock(&exp->exp_uncommitted_replies_lock);
-	rs_batch_fini(&batch);
+		spin_unlock(&exp->exp_uncommitted_replies_lock);
+
+		if (nr == 0)
+			break;
+
+		sort(rss, nr, sizeof(rss[0]), rs_svcpt_cmp, NULL);
+
+		rs_batch_init(&batch);
+		for (i = 0; i < nr; i++)
+			rs_batch_add(&batch, rss[i]);
+		rs_batch_fini(&batch);
+
+		/* not under scp_rep_lock, the last put may free emergency rs */
+		for (i = 0; i < nr; i++)
+			ptlrpc_rs_decref(rss[i]);
+	} while (nr == MAX_COMMITTED);
+
 	EXIT;
 }
 
@@ -594,6 +677,7 @@ static void ptlrpc_server_nthreads_check(struct ptlrpc_service *svc,
 	nthrs = max(nthrs, tc->tc_nthrs_init);
 	svc->srv_nthrs_cpt_limit = nthrs;
 	svc->srv_nthrs_cpt_init = init;
+	svc->srv_thread_idle_timeout = max(thread_idle_timeout, 0);
 
 	if (nthrs * svc->srv_ncpts > tc->tc_nthrs_max) {
 		CDEBUG(D_OTHER,
@@ -2610,6 +2694,57 @@ static inline void ptlrpc_thread_stop(struct ptlrpc_thread *thread)
 	spin_unlock(&svcpt->scp_lock);
 }
 
+/**
+ * Whether an idle thread of \a svcpt should wait with a timeout, so that
+ * the partition can shrink back to srv_nthrs_cpt_init threads once the load
+ * that made it grow has gone.
+ */
+static inline bool ptlrpc_threads_reapable(struct ptlrpc_service_part *svcpt)
+{
+	struct ptlrpc_service *svc = svcpt->scp_service;
+
+	return svc->srv_thread_idle_timeout > 0 &&
+	       svcpt->scp_thr_nextid > svc->srv_nthrs_cpt_init;
+}
+
+/**
+ * Called by a thread which didn't get any work for the whole idle timeout,
+ * meaning the partition has more threads than its load needs. Stop the
+ * highest numbered thread, so that thread index values stay contiguous.
+ * It may be busy right now, in that case it stops after its current request.
+ */
+static void ptlrpc_threads_reap_idle(struct ptlrpc_service_part *svcpt)
+{
+	struct ptlrpc_service *svc = svcpt->scp_service;
+	struct ptlrpc_thread *thread;
+
+	spin_lock(&svcpt->scp_lock);
+	if (svc->srv_is_stopping || !ptlrpc_threads_reapable(svcpt) ||
+	    svcpt->scp_nthrs_starting != 0)
+		goto out;
+
+	list_for_each_entry(thread, &svcpt->scp_threads, t_link) {
+		if (thread->t_id != svcpt->scp_thr_nextid - 1 ||
+		    !thread_is_running(thread) || thread_is_stopping(thread))
+			continue;
+
+		CDEBUG(D_RPCTRACE, "%s: stopping idle thread %s, %d running\n",
+		       svc->srv_name, thread->t_name,
+		       svcpt->scp_nthrs_running);
+		thread_add_flags(thread, SVC_IDLE);
+		ptlrpc_stop_thread(thread);
+		svcpt->scp_thr_nextid--;
+		/* the thread can't exit without taking scp_lock */
+		wake_up_process(thread->t_task);
+		if (svc->srv_stats)
+			lprocfs_counter_incr(svc->srv_stats,
+					     PTLRPC_THREAD_STOP_CNTR);
+		break;
+	}
+out:
+	spin_unlock(&svcpt->scp_lock);
+}
+
 static inline int ptlrpc_rqbd_pending(struct ptlrpc_service_part *svcpt)
 {
 	return !list_empty(&svcpt->scp_rqbd_idle) &&
@@ -2691,11 +2826,20 @@ static __attribute__((__noinline__)) int
 ptlrpc_wait_event(struct ptlrpc_service_part *svcpt,
 		  struct ptlrpc_thread *thread)
 {
+	long timeout = svcpt->scp_rqbd_timeout;
+	bool idle = false;
+
 	ptlrpc_watchdog_disable(&thread->t_watchdog);
 
 	cond_resched();
 
-	if (svcpt->scp_rqbd_timeout == 0)
+	if (timeout == 0 && ptlrpc_threads_reapable(svcpt)) {
+		timeout = cfs_time_seconds(
+			svcpt->scp_service->srv_thread_idle_timeout);
+		idle = true;
+	}
+
+	if (timeout == 0)
 		/* Don't exit while there are replies to be handled */
 		wait_event_idle_exclusive_lifo(
 			svcpt->scp_waitq,
@@ -2711,8 +2855,12 @@ ptlrpc_wait_event(struct ptlrpc_service_part *svcpt,
 			 ptlrpc_server_request_pending(svcpt, false) ||
 			 ptlrpc_rqbd_pending(svcpt) ||
 			 ptlrpc_at_check(svcpt),
-			 svcpt->scp_rqbd_timeout) == 0)
-		svcpt->scp_rqbd_timeout = 0;
+			 timeout) == 0) {
+		if (idle)
+			ptlrpc_threads_reap_idle(svcpt);
+		else
+			svcpt->scp_rqbd_timeout = 0;
+	}
 
 	if (ptlrpc_thread_stopping(thread))
 		return -EINTR;
@@ -2813,6 +2961,9 @@ static int ptlrpc_main(void *arg)
 	svcpt->scp_nthrs_running++;
 	spin_unlock(&svcpt->scp_lock);
 
+	if (svc->srv_stats)
+		lprocfs_counter_incr(svc->srv_stats, PTLRPC_THREAD_START_CNTR);
+
 	/* wake up our creator in case he's still waiting. */
 	wake_up(&thread->t_ctl_waitq);
 
@@ -2914,6 +3065,22 @@ out:
 	thread_add_flags(thread, SVC_STOPPED);
 
 	wake_up(&thread->t_ctl_waitq);
+
+	/* Free the threads stopped for being idle earlier, nobody waits for
+	 * them. Churn would otherwise pile them up until service shutdown. */
+	if (!svc->srv_is_stopping) {
+		struct ptlrpc_thread *tmp;
+		struct ptlrpc_thread *idle;
+
+		list_for_each_entry_safe(idle, tmp, &svcpt->scp_threads,
+					 t_link) {
+			if (idle != thread && thread_is_stopped(idle) &&
+			    (idle->t_flags & SVC_IDLE)) {
+				list_del(&idle->t_link);
+				OBD_FREE_PTR(idle);
+			}
+		}
+	}
 	spin_unlock(&svcpt->scp_lock);
 
 	return rc;
@@ -2927,6 +3094,7 @@ static int hrt_dont_sleep(struct ptlrpc_hr_thread *hrt,
 	spin_lock(&hrt->hrt_lock);
 
 	list_splice_init(&hrt->hrt_queue, replies);
+	hrt->hrt_nqueued = 0;
 	result = ptlrpc_hr.hr_stopping || !list_empty(replies);
 
 	spin_unlock(&hrt->hrt_lock);
@@ -42,6 +42,7 @@
 #include <obd.h>
 #include <obd_class.h>
 #include <obd_cksum.h>
+#include <obd_compress.h>
 #include <lustre_lfsck.h>
 #include <lustre_nodemap.h>
 #include <lustre_acl.h>
@@ -1388,11 +1389,15 @@ int tgt_enqueue(struct tgt_session_info *tsi)
 	 * tsi->tsi_dlm_cbs was set by the *_req_handle() function.
 	 */
 	LASSERT(tsi->tsi_dlm_req != NULL);
-	rc = ldlm_handle_enqueue0(tsi->tsi_exp->exp_obd->obd_namespace, req,
-				  tsi->tsi_dlm_req, &tgt_dlm_cbs);
+	rc = ldlm_handle_enqueue(tsi->tsi_exp->exp_obd->obd_namespace,
+				 tsi->tsi_pill, tsi->tsi_dlm_req, &tgt_dlm_cbs);
 	if (rc)
 		RETURN(err_serious(rc));
 
+	/* sub-request status is in its reply, see ldlm_handle_enqueue() */
+	if (req_capsule_subreq(tsi->tsi_pill))
+		RETURN(0);
+
 	switch (LUT_FAIL_CLASS(tsi->tsi_reply_fail_id)) {
 	case LUT_FAIL_MDT:
 		tsi->tsi_reply_fail_id = OBD_FAIL_MDS_LDLM_REPLY_NET;
@@ -2447,6 +2452,229 @@ static int tgt_shortio2pages(struct niobuf_local *local, int npages,
 	return 0;
 }
 
+/* compressed bulk of a write RPC, see struct brw_compr_desc */
+struct tgt_compr_bulk {
+	struct brw_compr_desc	 *tcb_desc;
+	struct page		**tcb_pages;
+	int			  tcb_page_count;
+};
+
+static void tgt_compr_bulk_fini(struct tgt_compr_bulk *tcb)
+{
+	int i;
+
+	if (tcb->tcb_pages == NULL)
+		return;
+
+	for (i = 0; i < tcb->tcb_page_count; i++) {
+		if (tcb->tcb_pages[i] != NULL)
+			__free_page(tcb->tcb_pages[i]);
+	}
+	OBD_FREE_PTR_ARRAY_LARGE(tcb->tcb_pages, tcb->tcb_page_count);
+	tcb->tcb_pages = NULL;
+}
+
+/*
+ * Check the compressed bulk descriptor against the niobufs and prepare the
+ * bulk to receive the compressed data into.
+ */
+static int tgt_compr_bulk_prep(struct ptlrpc_request *req,
+			       struct obd_ioobj *ioo,
+			       struct niobuf_remote *rnb, int niocount,
+			       int npages, struct tgt_compr_bulk *tcb,
+			       struct ptlrpc_bulk_desc **descp)
+{
+	struct brw_compr_desc *bcd;
+	struct ptlrpc_bulk_desc *desc;
+	__u32 size;
+	__u32 count = 0;
+	__u32 nob = 0;
+	int i;
+
+	ENTRY;
+
+	bcd = req_capsule_client_get(&req->rq_pill, &RMF_OST_COMPR);
+	size = req_capsule_get_size(&req->rq_pill, &RMF_OST_COMPR, RCL_CLIENT);
+	if (!exp_connect_compress(req->rq_export) ||
+	    bcd == NULL || size < sizeof(*bcd) ||
+	    size != offsetof(struct brw_compr_desc,
+			     bcd_sizes[bcd->bcd_count]) ||
+	    bcd->bcd_chunk_bits < PAGE_SHIFT ||
+	    bcd->bcd_chunk_bits > OBD_COMPR_CHUNK_BITS_MAX)
+		RETURN(-EPROTO);
+
+	for (i = 0; i < niocount; i++) {
+		__u64 offset = rnb[i].rnb_offset;
+		__u32 len = rnb[i].rnb_len;
+
+		while (len > 0) {
+			__u32 plen = obd_compr_piece_len(offset, len,
+							 bcd->bcd_chunk_bits);
+
+			if (count == bcd->bcd_count ||
+			    bcd->bcd_sizes[count] == 0 ||
+			    bcd->bcd_sizes[count] > plen)
+				RETURN(-EPROTO);
+
+			nob += bcd->bcd_sizes[count++];
+			offset += plen;
+			len -= plen;
+		}
+	}
+	if (count != bcd->bcd_count)
+		RETURN(-EPROTO);
+
+	tcb->tcb_desc = bcd;
+	tcb->tcb_page_count = DIV_ROUND_UP(nob, PAGE_SIZE);
+	if (tcb->tcb_page_count > npages)
+		RETURN(-EPROTO);
+
+	OBD_ALLOC_PTR_ARRAY_LARGE(tcb->tcb_pages, tcb->tcb_page_count);
+	if (tcb->tcb_pages == NULL)
+		RETURN(-ENOMEM);
+
+	desc = ptlrpc_prep_bulk_exp(req, tcb->tcb_page_count,
+				    ioobj_max_brw_get(ioo),
+				    PTLRPC_BULK_GET_SINK, OST_BULK_PORTAL,
+				    &ptlrpc_bulk_kiov_nopin_ops);
+	if (desc == NULL)
+		RETURN(-ENOMEM);
+	*descp = desc;
+
+	for (i = 0; i < tcb->tcb_page_count; i++) {
+		tcb->tcb_pages[i] = alloc_page(GFP_NOFS);
+		if (tcb->tcb_pages[i] == NULL)
+			RETURN(-ENOMEM);
+
+		desc->bd_frag_ops->add_kiov_frag(desc, tcb->tcb_pages[i], 0,
+				min_t(__u32, PAGE_SIZE, nob - i * PAGE_SIZE));
+	}
+
+	RETURN(0);
+}
+
+/* copy @len bytes from offset @off of the compressed bulk to @buf */
+static void tgt_compr_bulk_copy(struct tgt_compr_bulk *tcb, __u32 off,
+				char *buf, __u32 len)
+{
+	while (len > 0) {
+		unsigned int poff = off & ~PAGE_MASK;
+		unsigned int count = min_t(__u32, len, PAGE_SIZE - poff);
+		char *ptr;
+
+		ptr = kmap_atomic(tcb->tcb_pages[off >> PAGE_SHIFT]);
+		memcpy(buf, ptr + poff, count);
+		kunmap_atomic(ptr);
+		buf += count;
+		off += count;
+		len -= count;
+	}
+}
+
+/* copy @len bytes of @buf to the local pages, starting at @idx + @off */
+static void tgt_compr_buf2pages(struct niobuf_local *local, int *idx,
+				__u32 *off, const char *buf, __u32 len)
+{
+	while (len > 0) {
+		struct niobuf_local *lnb = &local[*idx];
+		unsigned int count = min_t(__u32, len, lnb->lnb_len - *off);
+		char *ptr;
+
+		ptr = kmap_atomic(lnb->lnb_page);
+		memcpy(ptr + (lnb->lnb_page_offset & ~PAGE_MASK) + *off, buf,
+		       count);
+		kunmap_atomic(ptr);
+		buf += count;
+		len -= count;
+		*off += count;
+		if (*off == lnb->lnb_len) {
+			(*idx)++;
+			*off = 0;
+		}
+	}
+}
+
+/* decompress the received bulk into the local pages */
+static int tgt_compr_bulk2pages(struct tgt_session_info *tsi,
+				struct tgt_compr_bulk *tcb,
+				struct niobuf_remote *rnb, int niocount,
+				struct niobuf_local *local)
+{
+	struct brw_compr_desc *bcd = tcb->tcb_desc;
+	__u32 chunk_size = 1U << bcd->bcd_chunk_bits;
+	struct crypto_comp *cc;
+	char *src = NULL;
+	char *dst = NULL;
+	__u32 count = 0;
+	__u32 coff = 0;
+	__u32 loff = 0;
+	int idx = 0;
+	int rc = 0;
+	int i;
+
+	ENTRY;
+
+	cc = obd_compr_alloc(bcd->bcd_type);
+	if (IS_ERR(cc)) {
+		rc = PTR_ERR(cc);
+		CERROR("%s: cannot use %s decompression: rc = %d\n",
+		       tgt_name(tsi->tsi_tgt),
+		       obd_compr_type2name(bcd->bcd_type), rc);
+		RETURN(rc);
+	}
+
+	OBD_ALLOC_LARGE(src, chunk_size);
+	OBD_ALLOC_LARGE(dst, chunk_size);
+	if (src == NULL || dst == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	for (i = 0; i < niocount; i++) {
+		__u64 offset = rnb[i].rnb_offset;
+		__u32 len = rnb[i].rnb_len;
+
+		while (len > 0) {
+			__u32 plen = obd_compr_piece_len(offset, len,
+							 bcd->bcd_chunk_bits);
+			__u32 wire_size = bcd->bcd_sizes[count++];
+			unsigned int dlen = plen;
+
+			tgt_compr_bulk_copy(tcb, coff, src, wire_size);
+			coff += wire_size;
+
+			if (wire_size == plen) {
+				tgt_compr_buf2pages(local, &idx, &loff, src,
+						    plen);
+			} else {
+				rc = crypto_comp_decompress(cc, src, wire_size,
+							    dst, &dlen);
+				if (rc == 0 && dlen != plen)
+					rc = -EIO;
+				if (rc) {
+					CERROR("%s: cannot decompress %u bytes at %llu from %s: rc = %d\n",
+					       tgt_name(tsi->tsi_tgt), plen,
+					       offset,
+					       obd_export_nid2str(tsi->tsi_exp),
+					       rc);
+					GOTO(out, rc = -EIO);
+				}
+				tgt_compr_buf2pages(local, &idx, &loff, dst,
+						    plen);
+			}
+			offset += plen;
+			len -= plen;
+		}
+	}
+	EXIT;
+out:
+	if (dst)
+		OBD_FREE_LARGE(dst, chunk_size);
+	if (src)
+		OBD_FREE_LARGE(src, chunk_size);
+	obd_compr_free(cc);
+
+	return rc;
+}
+
 static void tgt_warn_on_cksum(struct ptlrpc_request *req,
 			      struct ptlrpc_bulk_desc *desc,
 			      struct niobuf_local *local_nb, int npages,
@@ -2510,6 +2738,7 @@ int tgt_brw_write(struct tgt_session_info *tsi)
 	enum cksum_types cksum_type = OBD_CKSUM_CRC32;
 	bool			 no_reply = false, mmap;
 	struct tgt_thread_big_cache *tbc = req->rq_svc_thread->t_data;
+	struct tgt_compr_bulk tcb = { NULL };
 	bool wait_sync = false;
 	const char *obd_name = exp->exp_obd->obd_name;
 	/* '1' for consistency with code that checks !mpflag to restore */
@@ -2640,6 +2869,19 @@ int tgt_brw_write(struct tgt_session_info *tsi)
 		rc = tgt_shortio2pages(local_nb, npages, short_io_buf,
 				       short_io_size);
 		desc = NULL;
+	} else if (req_capsule_get_size(&req->rq_pill, &RMF_OST_COMPR,
+					RCL_CLIENT) > 0) {
+		/* the data is decompressed to local pages after transfer */
+		rc = tgt_compr_bulk_prep(req, ioo, remote_nb, niocount, npages,
+					 &tcb, &desc);
+		if (rc != 0)
+			GOTO(skip_transfer, rc);
+
+		rc = sptlrpc_svc_prep_bulk(req, desc);
+		if (rc != 0)
+			GOTO(skip_transfer, rc);
+
+		rc = target_bulk_io(exp, desc);
 	} else {
 		desc = ptlrpc_prep_bulk_exp(req, npages, ioobj_max_brw_get(ioo),
 					    PTLRPC_BULK_GET_SINK,
@@ -2664,6 +2906,10 @@ int tgt_brw_write(struct tgt_session_info *tsi)
 
 	no_reply = rc != 0;
 
+	if (rc == 0 && tcb.tcb_desc != NULL)
+		rc = tgt_compr_bulk2pages(tsi, &tcb, remote_nb, niocount,
+					  local_nb);
+
 skip_transfer:
 	if (body->oa.o_valid & OBD_MD_FLCKSUM && rc == 0) {
 		static int cksum_counter;
@@ -2750,6 +2996,7 @@ out_lock:
 	tgt_brw_unlock(exp, ioo, remote_nb, &lockh, LCK_PW);
 	if (desc)
 		ptlrpc_free_bulk(desc);
+	tgt_compr_bulk_fini(&tcb);
 out:
 	if (unlikely(no_reply || (exp->exp_obd->obd_no_transno && wait_sync))) {
 		req->rq_no_reply = 1;
@@ -1235,6 +1235,137 @@ EOF
 }
 run_test 104 "Set/check response_tracking param"
 
+test_105() {
+	local tyaml="$TMP/sanity-lnet-$testnum-expected.yaml"
+
+	reinit_dlc || return $?
+
+	# Default value is '0'
+	local val=$($LNETCTL global show | awk '/select_policy/{print $NF}')
+	[[ $val -ne 0 ]] &&
+		error "Expect 0 found $val"
+
+	echo "Set < 0; Should fail"
+	do_lnetctl set select_policy -1 &&
+		error "should have failed $?"
+
+	echo "Set > 1; Should fail"
+	do_lnetctl set select_policy 2 &&
+		error "should have failed $?"
+
+	echo "Check valid values; Should succeed"
+	local i
+	for ((i = 0; i < 2; i++)); do
+		reinit_dlc || return $?
+		do_lnetctl set select_policy $i ||
+			error "should have succeeded $?"
+		$LNETCTL global show | grep -q "select_policy: $i" ||
+			error "Failed to set select_policy to $i"
+		reinit_dlc || return $?
+		cat <<EOF > $tyaml
+global:
+    select_policy: $i
+EOF
+		do_lnetctl import < $tyaml ||
+			error "should have succeeded $?"
+		$LNETCTL global show | grep -q "select_policy: $i" ||
+			error "Failed to set select_policy to $i"
+	done
+
+	echo "Check selection stats are reported"
+	$LNETCTL net show -v 2 | grep -q "selection stats" ||
+		error "No selection stats for local NIs"
+	return 0
+}
+run_test 105 "Set/check select_policy param and selection stats"
+
+test_106() {
+	reinit_dlc || return $?
+
+	do_lnetctl set routing 1 || error "Failed to enable routing $?"
+	$LNETCTL routing show | grep -q "wait_max_us:" ||
+		error "No blocked message stats for the router buffers"
+
+	local ncpt=$($LNETCTL routing show | grep -c "cpt\[")
+	local small=$($LNETCTL routing show |
+		      awk '/^buffers:/{b=1} b && /small:/{print $NF}')
+	local nbufs=$((4096 * ncpt))
+
+	(( small > nbufs )) || skip "Need more than $nbufs small buffers"
+
+	echo "Shrink small buffers from $small to $nbufs"
+	do_lnetctl set small_buffers $nbufs ||
+		error "Failed to set small buffers $?"
+	# idle buffers are freed right away
+	small=$($LNETCTL routing show |
+		awk '/^buffers:/{b=1} b && /small:/{print $NF}')
+	(( small == nbufs )) || error "Expect $nbufs small buffers found $small"
+
+	do_lnetctl set routing 0 || error "Failed to disable routing $?"
+}
+run_test 106 "Router buffer pools release idle buffers when shrunk"
+
+small_router_buffers() {
+	$LNETCTL routing show |
+		awk '/^buffers:/{b=1} b && /small:/{print $NF}'
+}
+
+wait_small_router_buffers() {
+	local expect=$1
+	local small
+	local i
+
+	for ((i = 0; i < 40; i++)); do
+		small=$(small_router_buffers)
+		(( small == expect )) && return 0
+		sleep 1
+	done
+	echo "Expect $expect small buffers found $small"
+	return 1
+}
+
+test_107() {
+	local param=/sys/module/lnet/parameters/router_buffers_max_factor
+	local old_factor
+	local small
+
+	[[ -w $param ]] || skip "router_buffers_max_factor not supported"
+	old_factor=$(cat $param)
+	stack_trap "echo $old_factor > $param" EXIT
+
+	reinit_dlc || return $?
+	do_lnetctl set routing 1 || error "Failed to enable routing $?"
+	small=$(small_router_buffers)
+	echo "$small small buffers configured"
+
+#define CFS_FAIL_LNET_RTRPOOL_BUSY	0xe001
+	# pretend the small buffer pools (index 1) are fully used
+	$LCTL set_param fail_loc=0xe001 fail_val=1
+	stack_trap "$LCTL set_param fail_loc=0 fail_val=0" EXIT
+
+	echo "No growth with router_buffers_max_factor=1"
+	echo 1 > $param
+	sleep 5
+	(( $(small_router_buffers) == small )) ||
+		error "small buffers grew to $(small_router_buffers)"
+
+	echo "Growth up to router_buffers_max_factor=2"
+	echo 2 > $param
+	wait_small_router_buffers $((small * 2)) ||
+		error "small buffers did not grow to twice their size"
+	sleep 3
+	(( $(small_router_buffers) == small * 2 )) ||
+		error "small buffers grew beyond twice their size"
+
+	echo "Idle pools shrink back to their configured size"
+	$LCTL set_param fail_loc=0 fail_val=0
+	wait_small_router_buffers $small ||
+		error "small buffers did not shrink back"
+
+	do_lnetctl set routing 0 || error "Failed to disable routing $?"
+}
+run_test 107 "Router buffer pools grow and shrink by demand"
+
 ### load lnet in default namespace, configure in target namespace
 
 test_200() {
@@ -78,7 +78,7 @@ if (( $LINUX_VERSION_CODE >= $(version_code 4.18.0) &&
 fi
 
 #                                  5          12     8   12  (min)"
-[ "$SLOW" = "no" ] && EXCEPT_SLOW="27m 64b 68 71 115 135 136 300o"
+[ "$SLOW" = "no" ] && EXCEPT_SLOW="27m 64b 68 71 115a 135 136 300o"
 
 if [ "$mds1_FSTYPE" = "zfs" ]; then
 	# bug number for skipped test:
@@ -9416,6 +9416,44 @@ test_77l() {
 }
 run_test 77l "preferred checksum type is remembered after reconnected"
 
+test_77m() {
+	local osc=$($LCTL dl | awk '/-osc-[^M]/ { print $4; exit }')
+	local orig_type
+	local raw
+	local wire
+
+	$LCTL get_param -n osc.$osc.import | grep -q "compress" ||
+		skip "OST does not support compressed writes"
+	$LCTL get_param -n osc.$osc.compress_type | grep -qw lz4 ||
+		skip_env "lz4 compression is not available"
+
+	orig_type=$($LCTL get_param -n osc.$osc.compress_type |
+		    sed -e 's/.*\[\(.*\)\].*/\1/')
+	stack_trap "$LCTL set_param osc.*.compress_type=$orig_type" EXIT
+	$LCTL set_param osc.*.compress_type=lz4 ||
+		error "cannot set compress_type=lz4"
+	$LCTL set_param osc.*.osc_stats=0
+
+	$LFS setstripe -c 1 -i 0 $DIR/$tfile
+	# compressible data, with a tail not aligned to the chunk size
+	yes "lustre compression test" | head -c 4200000 > $TMP/$tfile
+	stack_trap "rm -f $TMP/$tfile" EXIT
+	dd if=$TMP/$tfile of=$DIR/$tfile bs=1M oflag=sync ||
+		error "write $DIR/$tfile failed"
+
+	raw=$($LCTL get_param -n osc.$osc.osc_stats |
+	      awk '/compressed_write_bytes/ { print $2 }')
+	wire=$($LCTL get_param -n osc.$osc.osc_stats |
+	       awk '/compressed_wire_bytes/ { print $2 }')
+	echo "compressed $raw bytes into $wire bytes"
+	(( raw > 0 )) || error "no data was compressed"
+	(( wire < raw )) || error "compressed size $wire >= $raw"
+
+	cancel_lru_locks osc
+	cmp $TMP/$tfile $DIR/$tfile || error "data mismatch after compression"
+}
+run_test 77m "compressed bulk write"
+
 [ "$ORIG_CSUM" ] && set_checksums $ORIG_CSUM || true
 rm -f $F77_TMP
 unset F77_TMP
@@ -10099,6 +10137,32 @@ test_101j() {
 }
 run_test 101j "A complete read block should be submitted when no RA"
 
+test_101k() {
+	local file=$DIR/$tfile
+
+	$LFS setstripe -i 0 -c 1 $file || error "setstripe $file failed"
+	dd if=/dev/urandom of=$file bs=1M count=64 || error "dd $file failed"
+	local sum=$(md5sum < $file)
+
+	local adaptive=$($LCTL get_param -n llite.*.read_ahead_adaptive |
+			 head -n 1)
+	stack_trap "$LCTL set_param -n llite.*.read_ahead_adaptive=$adaptive"
+	$LCTL set_param -n llite.*.read_ahead_adaptive=1 ||
+		error "enable read_ahead_adaptive failed"
+
+	cancel_lru_locks osc
+	$LCTL set_param -n llite.*.read_ahead_stats=0
+	[[ "$(md5sum < $file)" == "$sum" ]] || error "$file data mismatch"
+	$LCTL get_param llite.*.read_ahead_stats
+
+	$LCTL get_param osc.$FSNAME-OST0000-osc-[^M]*.read_bdp
+	local rtt=$($LCTL get_param -n osc.$FSNAME-OST0000-osc-[^M]*.read_bdp |
+		    awk '/rtt_min_us/ { print $2 }')
+	(( rtt > 0 )) || error "no read RTT estimate"
+	rm -f $file
+}
+run_test 101k "readahead window sized from bandwidth-delay product"
+
 setup_test102() {
 	test_mkdir $DIR/$tdir
 	chown $RUNAS_ID $DIR/$tdir
@@ -10985,11 +11049,12 @@ run_test 110 "filename length checking"
 #
 # Purpose: To verify dynamic thread (OSS) creation.
 #
-test_115() {
+test_115a() { # was previously test_115()
 	[ $PARALLEL == "yes" ] && skip "skip parallel run"
 	remote_ost_nodsh && skip "remote OST with nodsh"
 
-	# Lustre does not stop service threads once they are started.
+	# Lustre does not stop service threads once they are started, unless
+	# threads_idle_timeout is set.
 	# Reset number of running threads to default.
 	stopall
 	setupall
@@ -11087,7 +11152,49 @@ test_115() {
 		      "than thread_max."
 	fi
 }
-run_test 115 "verify dynamic thread creation===================="
+run_test 115a "verify dynamic thread creation===================="
+
+test_115b() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run"
+	remote_ost_nodsh && skip "remote OST with nodsh"
+
+	local param="ost.OSS.ost_io"
+	local save_params="$TMP/sanity-$TESTNAME.parameters"
+	local started
+	local now
+	local stopped
+	local i
+
+	started=$(do_facet ost1 "$LCTL get_param -n $param.threads_started")
+	[ -z "$started" ] && error "no OSS threads"
+	(( started >= 8 )) || skip "only $started ost_io threads running"
+
+	save_lustre_params ost1 "$param.threads_min" > $save_params
+	save_lustre_params ost1 "$param.threads_idle_timeout" >> $save_params
+	stack_trap "restore_lustre_params < $save_params; rm -f $save_params"
+
+	do_facet ost1 "$LCTL set_param $param.threads_min=$((started / 2))" ||
+		error "cannot set threads_min to $((started / 2))"
+	do_facet ost1 "$LCTL set_param $param.threads_idle_timeout=1" ||
+		error "cannot set threads_idle_timeout"
+
+	$LFS setstripe -c 1 -i 0 $DIR/$tfile || error "setstripe failed"
+	# wake up some threads so they go back to sleep with the idle timeout
+	for ((i = 0; i < 30; i++)); do
+		dd if=/dev/zero of=$DIR/$tfile bs=1M count=1 oflag=direct \
+			2>/dev/null
+		now=$(do_facet ost1 "$LCTL get_param -n $param.threads_started")
+		(( now < started )) && break
+		sleep 1
+	done
+	echo "ost_io threads: $started before, $now after"
+	(( now < started )) || error "idle ost_io threads were not stopped"
+
+	stopped=$(do_facet ost1 "$LCTL get_param -n $param.stats" |
+		  awk '/^thread_idle_stop/ { print $2 }')
+	(( stopped > 0 )) || error "thread_idle_stop not counted"
+}
+run_test 115b "stop idle service threads above threads_min"
 
 free_min_max () {
 	wait_delete_completed
@@ -11699,6 +11806,34 @@ test_118n()
 }
 run_test 118n "statfs() sends OST_STATFS requests in parallel"
 
+test_118o()
+{
+	local nthreads=8
+	local count=16
+	local begin
+	local i
+
+	$LFS setstripe -c 1 -i 0 $DIR/$tfile || error "setstripe failed"
+	# reference file, written by a single thread
+	dd if=/dev/urandom of=$TMP/$tfile bs=1M count=$((nthreads * count)) ||
+		error "dd to $TMP/$tfile failed"
+	stack_trap "rm -f $TMP/$tfile" EXIT
+
+	# writers to disjoint regions of one object share its extent tree
+	begin=$SECONDS
+	for ((i = 0; i < nthreads; i++)); do
+		dd if=$TMP/$tfile of=$DIR/$tfile bs=1M count=$count \
+			skip=$((i * count)) seek=$((i * count)) \
+			conv=notrunc 2>/dev/null &
+	done
+	wait
+	echo "$nthreads writers took $((SECONDS - begin))s"
+
+	cancel_lru_locks osc
+	cmp $TMP/$tfile $DIR/$tfile || error "data mismatch after parallel write"
+}
+run_test 118o "parallel writers to disjoint regions of a shared file"
+
 test_119a() # bug 11737
 {
         BSIZE=$((512 * 1024))
@@ -12204,6 +12339,38 @@ test_123c() {
 }
 run_test 123c "Can not initialize inode warning on DNE statahead"
 
+test_123d() {
+	local num=1000
+	local batch_max
+	local rpcs
+
+	$LCTL get_param -n mdc.*.connect_flags | grep -q batch_rpc ||
+		skip "server does not support batch RPC"
+
+	test_mkdir -i 0 -c 1 $DIR/$tdir
+	createmany -o $DIR/$tdir/$tfile-%d $num ||
+		error "createmany $num files failed"
+
+	batch_max=$($LCTL get_param -n llite.*.statahead_batch_max | head -n 1)
+	stack_trap "$LCTL set_param llite.*.statahead_batch_max=$batch_max"
+	$LCTL set_param llite.*.statahead_batch_max=64
+
+	cancel_lru_locks mdc
+	$LCTL set_param mdc.*.rpc_stats=clear
+	ls -l $DIR/$tdir > /dev/null || error "ls -l $DIR/$tdir failed"
+	$LCTL get_param -n llite.*.statahead_stats
+	$LCTL get_param mdc.*.rpc_stats
+
+	rpcs=$($LCTL get_param -n mdc.*.rpc_stats |
+		awk '/sub-reqs per rpc/ { batch = 1; next }
+		     batch && /^[0-9]+:/ { sum += $2 }
+		     END { print sum + 0 }')
+	(( rpcs > 0 )) || error "statahead did not send batch RPCs"
+	(( rpcs < num / 2 )) ||
+		error "too many batch RPCs $rpcs for $num files"
+}
+run_test 123d "statahead batches getattr requests into MDS_BATCH RPCs"
+
 test_124a() {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run"
 	$LCTL get_param -n mdc.*.connect_flags | grep -q lru_resize ||
@@ -12454,6 +12621,101 @@ test_124d() {
 }
 run_test 124d "cancel very aged locks if lru-resize diasbaled"
 
+test_124e() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run"
+
+	local nthreads=$(nproc)
+	local nr=${TEST124E_NR:-200}
+	local nsdir="ldlm.namespaces.*-OST0000-osc-[^mM]*"
+	local stime
+	local etime
+	local pids=""
+	local pid
+	local count
+	local i
+	local j
+
+	(( nthreads > 32 )) && nthreads=32
+
+	test_mkdir $DIR/$tdir
+	$LFS setstripe -c 1 -i 0 $DIR/$tdir || error "setstripe failed"
+	for ((i = 0; i < nthreads; i++)); do
+		test_mkdir $DIR/$tdir/t$i
+		createmany -o $DIR/$tdir/t$i/f $nr > /dev/null ||
+			error "failed to create $nr files in $DIR/$tdir/t$i"
+	done
+	cancel_lru_locks osc
+
+	# every append enqueues a lock on a different OST object
+	stime=$(date +%s.%N)
+	for ((i = 0; i < nthreads; i++)); do
+		(
+			for ((j = 0; j < nr; j++)); do
+				echo x >> $DIR/$tdir/t$i/f$j || exit 1
+			done
+		) &
+		pids="$pids $!"
+	done
+	for pid in $pids; do
+		wait $pid || error "appends by $pid failed"
+	done
+	etime=$(date +%s.%N)
+
+	echo "$((nthreads * nr)) enqueues by $nthreads threads in" \
+	     "$(echo "$etime - $stime" | bc) seconds," \
+	     "$(echo "$nthreads * $nr / ($etime - $stime)" | bc) enqueues/s"
+
+	cancel_lru_locks osc
+	count=$($LCTL get_param -n $nsdir.resource_count)
+	(( count == 0 )) || error "$count resources left after lock cancel"
+}
+run_test 124e "concurrent lock enqueue on many resources (performance test)"
+
+test_124f() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run"
+
+	local nsdir="ldlm.namespaces.*-OST0000-osc-[^mM]*"
+	local osc="osc.*-OST0000-osc-[^mM]*"
+	local cost_max=$($LCTL get_param -n $nsdir.lru_cost_max 2>/dev/null)
+	local nr=10
+	local used
+	local i
+
+	[[ -n "$cost_max" ]] || skip "no cost-aware lock LRU"
+	(( cost_max > 0 )) || skip "cost-aware lock LRU disabled"
+
+	test_mkdir $DIR/$tdir
+	$LFS setstripe -c 1 -i 0 $DIR/$tdir || error "setstripe failed"
+
+	lru_resize_disable osc 100
+	stack_trap "lru_resize_enable osc" EXIT
+	cancel_lru_locks osc
+
+	# older locks protect cached pages
+	for ((i = 0; i < nr; i++)); do
+		dd if=/dev/zero of=$DIR/$tdir/big$i bs=1M count=1 ||
+			error "dd to big$i failed"
+	done
+	sync
+	# newer locks have nothing cached under them
+	for ((i = 0; i < nr; i++)); do
+		dd if=/dev/zero of=$DIR/$tdir/dio$i bs=1M count=1 \
+			oflag=direct || error "dd to dio$i failed"
+	done
+	$LCTL get_param $nsdir.lock_unused_count $osc.osc_cached_mb
+
+	# shrink the lock LRU by half, the locks without pages should go first
+	$LCTL set_param $nsdir.lru_size=$nr
+	sleep 2
+	$LCTL get_param $nsdir.lock_unused_count $osc.osc_cached_mb
+
+	used=$($LCTL get_param -n $osc.osc_cached_mb |
+	       awk '/^used_mb:/ { print $2 }')
+	(( used >= nr * 3 / 4 )) ||
+		error "only $used MiB cached left, locks with pages cancelled"
+}
+run_test 124f "cost-aware lock LRU keeps locks protecting cached pages"
+
 test_125() { # 13358
 	$LCTL get_param -n llite.*.client_type | grep -q local ||
 		skip "must run as local client"
@@ -20525,6 +20787,47 @@ test_255c() {
 }
 run_test 255c "suite of ladvise lockahead tests"
 
+test_255d() {
+	local file=$DIR/$tfile
+
+	dd if=/dev/zero of=$file bs=1M count=16 || error "dd $file failed"
+	stack_trap "rm -f $file" EXIT
+
+	ladvise_no_type prefetch $file && skip "prefetch ladvise not supported"
+
+	cancel_lru_locks osc
+	$LCTL set_param -n llite.*.read_ahead_stats 0
+
+	$LFS ladvise -a prefetch -s 4M -l 4M $file ||
+		error "ladvise prefetch failed"
+	$LCTL get_param llite.*.read_ahead_stats
+
+	local hints=$($LCTL get_param -n llite.*.read_ahead_stats |
+		      get_named_value 'prefetch hint' | cut -d" " -f1 | calc_total)
+	(( hints > 0 )) || error "prefetch hint was not queued"
+
+	# wait for the async readahead work to read the extent
+	local async
+	for ((i = 0; i < 20; i++)); do
+		async=$($LCTL get_param -n llite.*.read_ahead_stats |
+			get_named_value 'async readahead' | cut -d" " -f1 |
+			calc_total)
+		(( async > 0 )) && break
+		sleep 0.5
+	done
+	(( async > 0 )) || error "prefetch was not done"
+
+	$LCTL set_param -n llite.*.read_ahead_stats 0
+	dd if=$file of=/dev/null bs=4k skip=1024 count=1024 ||
+		error "read $file failed"
+	$LCTL get_param llite.*.read_ahead_stats
+
+	local miss=$($LCTL get_param -n llite.*.read_ahead_stats |
+		     get_named_value 'misses' | cut -d" " -f1 | calc_total)
+	(( miss == 0 )) || error "$miss pages missed after prefetch"
+}
+run_test 255d "check 'lfs ladvise -a prefetch'"
+
 test_256() {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run"
 	remote_mds_nodsh && skip "remote MDS with nodsh"
@@ -20684,6 +20987,38 @@ test_260() {
 }
 run_test 260 "Check mdc_close fail"
 
+test_261() {
+	[ $MDSCOUNT -lt 2 ] && skip_env "needs >= 2 MDTs"
+	remote_mds_nodsh && skip "remote MDS with nodsh"
+
+	local param="mds.MDS.mdt.stats"
+	local batch
+
+	test_mkdir -i 0 -c 1 $DIR/$tdir
+	do_facet mds1 $LCTL set_param $param=clear
+
+	# cross-MDT operations save remote locks in difficult replies, which
+	# are scheduled to the reply handling threads on transaction commit
+	for i in $(seq 32); do
+		$LFS mkdir -i 1 -c 1 $DIR/$tdir/d$i ||
+			error "mkdir $DIR/$tdir/d$i failed"
+	done
+	do_facet mds1 "$LCTL set_param -n osd*.*MDT0000.force_sync=1"
+	for i in $(seq 10); do
+		batch=$(do_facet mds1 $LCTL get_param -n $param |
+			awk '/^rep_batch/ { print $2 }')
+		[ -n "$batch" ] && break
+		sleep 1
+	done
+
+	do_facet mds1 $LCTL get_param $param | grep "^rep_"
+	[ -n "$batch" ] && [ $batch -gt 0 ] ||
+		error "no reply states counted in $param"
+	do_facet mds1 $LCTL get_param -n $param | grep -q "^rep_qdepth" ||
+		error "no rep_qdepth in $param"
+}
+run_test 261 "reply states are counted in service stats"
+
 ### Data-on-MDT sanity tests ###
 test_270a() {
 	[ $MDS1_VERSION -lt $(version_code 2.10.55) ] &&
@@ -21690,6 +22025,37 @@ test_278() {
 }
 run_test 278 "Race starting MDS between MDTs stop/start"
 
+test_279() {
+	local osc=$($LCTL get_param -N osc.$FSNAME-OST0000-osc-[^M]*)
+	local pids=()
+
+	test_mkdir $DIR/$tdir
+	$LFS setstripe -i 0 -c 1 $DIR/$tdir || error "setstripe $tdir failed"
+	stack_trap "rm -rf $DIR/$tdir" EXIT
+
+	for ((i = 0; i < 4; i++)); do
+		dd if=/dev/zero of=$DIR/$tdir/$tfile.$i bs=1M count=8 &
+		pids+=($!)
+	done
+	wait ${pids[@]} || error "dd failed"
+	sync
+
+	$LCTL get_param $osc.osc_cached_mb
+	local cnt=$($LCTL get_param -n $osc.osc_cached_mb |
+		    awk '/^cpt_lru_cnt:/ { for (i = 2; i <= NF; i++) n += $i }
+			 END { print n }')
+	(( cnt >= 32 * 1048576 / PAGE_SIZE )) ||
+		error "expected at least 32MiB in LRU, got $cnt pages"
+
+	$LCTL set_param $osc.osc_cached_mb=0 || error "shrink LRU failed"
+	$LCTL get_param $osc.osc_cached_mb
+	cnt=$($LCTL get_param -n $osc.osc_cached_mb |
+	      awk '/^cpt_lru_cnt:/ { for (i = 2; i <= NF; i++) n += $i }
+		   END { print n }')
+	(( cnt == 0 )) || error "$cnt pages left in LRU partitions"
+}
+run_test 279 "LRU pages accounted and shrunk in all CPT partitions"
+
 test_280() {
 	[ $MGS_VERSION -lt $(version_code 2.13.52) ] &&
 		skip "Need MGS version at least 2.13.52"
@@ -23051,9 +23417,11 @@ test_398d() { #  LU-13846
 
 	diff $DIR/$tfile $aio_file || "file diff after aiocp"
 
-	# make sure we don't crash and fail properly
-	aiocp -a 512 -b 64M -s 64M -f O_DIRECT $DIR/$tfile $aio_file &&
-		error "aio not aligned with PAGE SIZE should fail"
+	# buffers not aligned with PAGE_SIZE go through bounce pages
+	$TRUNCATE $aio_file 0
+	aiocp -a 512 -b 64M -s 64M -f O_DIRECT $DIR/$tfile $aio_file ||
+		error "aio not aligned with PAGE SIZE failed"
+	diff $DIR/$tfile $aio_file || error "file diff after unaligned aiocp"
 
 	rm -rf $DIR/$tfile $aio_file
 }
@@ -23066,6 +23434,118 @@ test_398e() {
 }
 run_test 398e "O_Direct open cleared by fcntl doesn't cause hang"
 
+test_398f() {
+	local file=$TMP/$tfile
+
+	$LFS setstripe -c -1 -S 1M $DIR/$tfile ||
+		error "setstripe $DIR/$tfile failed"
+	stack_trap "rm -f $file" EXIT
+
+	dd if=/dev/urandom of=$file bs=1M count=5 ||
+		error "cannot create $file"
+	# record size and file offsets not aligned to PAGE_SIZE
+	dd if=$file of=$DIR/$tfile bs=12345 oflag=direct ||
+		error "unaligned direct write failed"
+	cancel_lru_locks osc
+	cmp $file $DIR/$tfile || error "data mismatch after direct write"
+
+	dd if=$DIR/$tfile of=$file.2 bs=777 iflag=direct ||
+		error "unaligned direct read failed"
+	cmp $file $file.2 || error "data mismatch after direct read"
+	rm -f $file.2
+
+	# small direct write in the middle of the file
+	dd if=/dev/urandom of=$file bs=100 count=1 seek=4099 conv=notrunc
+	dd if=$file of=$DIR/$tfile bs=100 count=1 skip=4099 seek=4099 \
+		oflag=direct conv=notrunc || error "small direct write failed"
+	cancel_lru_locks osc
+	cmp $file $DIR/$tfile || error "data mismatch after small write"
+}
+run_test 398f "unaligned direct IO through bounce pages"
+
+test_398g() {
+	local file=$TMP/$tfile
+	local saved
+	local cached_mb
+
+	saved=$($LCTL get_param -n llite.*.hybrid_io | head -n1)
+	[[ -n "$saved" ]] || skip "hybrid IO is not supported"
+	stack_trap "$LCTL set_param -n llite.*.hybrid_io=$saved" EXIT
+	saved=$($LCTL get_param -n llite.*.hybrid_io_write_threshold_bytes |
+		head -n1)
+	stack_trap "$LCTL set_param -n llite.*.hybrid_io_write_threshold_bytes=$saved" EXIT
+	saved=$($LCTL get_param -n llite.*.hybrid_io_read_threshold_bytes |
+		head -n1)
+	stack_trap "$LCTL set_param -n llite.*.hybrid_io_read_threshold_bytes=$saved" EXIT
+
+	$LCTL set_param llite.*.hybrid_io=1 ||
+		skip "hybrid IO cannot be enabled"
+	$LCTL set_param llite.*.hybrid_io_write_threshold_bytes=4M \
+		llite.*.hybrid_io_read_threshold_bytes=4M
+
+	$LFS setstripe -c -1 -S 1M $DIR/$tfile ||
+		error "setstripe $DIR/$tfile failed"
+	stack_trap "rm -f $file" EXIT
+	dd if=/dev/urandom of=$file bs=1M count=32 ||
+		error "cannot create $file"
+
+	# a buffered page in the middle must not hide the direct write
+	dd if=/dev/zero of=$DIR/$tfile bs=4k count=1 seek=1000 ||
+		error "small write failed"
+	cancel_lru_locks osc
+	dd if=$DIR/$tfile of=/dev/null bs=4k count=1 skip=1000 ||
+		error "small read failed"
+
+	dd if=$file of=$DIR/$tfile bs=8M conv=notrunc ||
+		error "hybrid write failed"
+	cached_mb=$($LCTL get_param -n llite.*.max_cached_mb |
+		    awk '/^used_mb/ { print $2 }' | head -n1)
+	echo "used_mb after write: $cached_mb"
+	(( cached_mb < 16 )) || error "$cached_mb MiB cached after hybrid write"
+	cmp $file $DIR/$tfile || error "data mismatch after hybrid write"
+
+	cancel_lru_locks osc
+	dd if=$DIR/$tfile of=$file.2 bs=8M || error "hybrid read failed"
+	cached_mb=$($LCTL get_param -n llite.*.max_cached_mb |
+		    awk '/^used_mb/ { print $2 }' | head -n1)
+	echo "used_mb after read: $cached_mb"
+	(( cached_mb < 16 )) || error "$cached_mb MiB cached after hybrid read"
+	cmp $file $file.2 || error "data mismatch after hybrid read"
+	rm -f $file.2
+}
+run_test 398g "large buffered IO is done as direct IO with hybrid_io"
+
+test_398h() {
+	[[ $OSTCOUNT -ge 2 ]] || skip_env "needs >= 2 OSTs"
+
+	local file=$TMP/$tfile
+	local saved
+	local val
+
+	saved=$($LCTL get_param -n lov.*.parallel_dio | head -n1)
+	[[ -n "$saved" ]] || skip "no parallel direct IO support"
+	stack_trap "$LCTL set_param -n lov.*.parallel_dio=$saved" EXIT
+
+	$LFS setstripe -c -1 -S 1M $DIR/$tfile ||
+		error "setstripe $DIR/$tfile failed"
+	stack_trap "rm -f $file $file.2" EXIT
+	dd if=/dev/urandom of=$file bs=1M count=$((OSTCOUNT * 8)) ||
+		error "cannot create $file"
+
+	for val in 0 1; do
+		$LCTL set_param lov.*.parallel_dio=$val
+		dd if=$file of=$DIR/$tfile bs=$((OSTCOUNT * 4))M \
+			oflag=direct || error "direct write failed"
+		cancel_lru_locks osc
+		dd if=$DIR/$tfile of=$file.2 bs=$((OSTCOUNT * 4))M \
+			iflag=direct || error "direct read failed"
+		cmp $file $file.2 ||
+			error "data mismatch with parallel_dio=$val"
+		rm -f $file.2
+	done
+}
+run_test 398h "direct IO across stripes with and without parallel submit"
+
 test_fake_rw() {
 	local read_write=$1
 	if [ "$read_write" = "write" ]; then
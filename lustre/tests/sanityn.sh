@@ -963,6 +963,132 @@ test_32b() { # bug 11270
 }
 run_test 32b "lockless i/o"
 
+test_32c() {
+	remote_ost_nodsh && skip "remote OST with nodsh" && return
+
+	local facets=$(get_facets OST)
+	local p="$TMP/$TESTSUITE-$TESTNAME.parameters"
+	local count
+	local i
+
+	save_lustre_params $facets \
+		"ldlm.namespaces.filter-*.expand_conflicts" > $p
+	save_lustre_params $facets \
+		"ldlm.namespaces.filter-*.contention_seconds" >> $p
+	stack_trap "restore_lustre_params < $p; rm -f $p" EXIT
+
+	do_nodes $(comma_list $(osts_nodes)) \
+		"lctl set_param -n ldlm.namespaces.filter-*.expand_conflicts=4 \
+			ldlm.namespaces.filter-*.contention_seconds=60"
+
+	$LFS setstripe -c 1 -i 0 $DIR1/$tfile || error "setstripe failed"
+	cancel_lru_locks $OSC
+
+	# two clients writing interleaved chunks of the same object
+	for i in {0..9}; do
+		dd if=/dev/zero of=$DIR1/$tfile bs=64k count=1 \
+			seek=$((i * 2)) conv=notrunc > /dev/null 2>&1 ||
+			error "dd to $DIR1/$tfile failed"
+		dd if=/dev/zero of=$DIR2/$tfile bs=64k count=1 \
+			seek=$((i * 2 + 1)) conv=notrunc > /dev/null 2>&1 ||
+			error "dd to $DIR2/$tfile failed"
+	done
+
+	# expanded locks are revoked by every write of the other client,
+	# non-expanded ones are kept cached
+	count=$($LCTL get_param -n \
+		ldlm.namespaces.*-OST0000-osc-*.lock_count | calc_sum)
+	echo "$count locks cached by clients"
+	(( count >= 8 )) ||
+		error "locks on interleaved resource are still expanded"
+
+	rm -f $DIR1/$tfile
+}
+run_test 32c "no lock expansion for interleaved writers"
+
+test_32d() {
+	local nsdir="ldlm.namespaces.*-OST0000-osc-[^mM]*"
+	local nr=32
+	local count
+	local blk1
+	local blk2
+	local i
+
+	$LCTL get_param -n $OSC.*-OST0000-osc-[^mM]*.connect_flags |
+		grep -q batch_bl_ast || skip "no batched blocking AST support"
+
+	$LFS setstripe -c 1 -i 0 $DIR1/$tfile || error "setstripe failed"
+	dd if=/dev/zero of=$DIR1/$tfile bs=64k count=$nr ||
+		error "dd to $DIR1/$tfile failed"
+	cancel_lru_locks $OSC
+
+	# many non-expanded read locks of the first client on one object
+	for ((i = 0; i < nr; i++)); do
+		$LFS ladvise -a lockahead --mode READ --start $((i * 64))k \
+			--length 64k $DIR1/$tfile ||
+			error "lockahead $i on $DIR1/$tfile failed"
+	done
+	sleep 1
+	count=$($LCTL get_param -n $nsdir.lock_count | calc_sum)
+	echo "$count locks cached by clients"
+	(( count >= nr )) || skip "only $count lockahead locks granted"
+
+	blk1=$($LCTL get_param -n ldlm.services.ldlm_cbd.stats |
+	       awk '/ldlm_bl_callback/ { print $2 }')
+	# the write of the second client conflicts with all of them
+	dd if=/dev/zero of=$DIR2/$tfile bs=64k count=$nr conv=notrunc ||
+		error "dd to $DIR2/$tfile failed"
+	blk2=$($LCTL get_param -n ldlm.services.ldlm_cbd.stats |
+	       awk '/ldlm_bl_callback/ { print $2 }')
+
+	echo "$((blk2 - blk1)) blocking AST RPCs for $count locks"
+	(( blk2 - blk1 < nr / 2 )) ||
+		error "$((blk2 - blk1)) blocking AST RPCs, not batched"
+
+	rm -f $DIR1/$tfile
+}
+run_test 32d "batched blocking ASTs for many conflicting locks"
+
+test_32e() {
+	local before=$(date +%s)
+	local evict
+	local blk1
+	local blk2
+	local i
+
+	$LCTL get_param -n $OSC.*-OST0000-osc-[^mM]*.connect_flags |
+		grep -q batch_bl_ast || skip "no batched blocking AST support"
+
+	$LFS setstripe -c 1 -i 0 $DIR1/$tfile || error "setstripe failed"
+	cancel_lru_locks $OSC
+
+	blk1=$($LCTL get_param -n ldlm.services.ldlm_cbd.stats |
+	       awk '/ldlm_bl_callback/ { print $2 }')
+	# every write conflicts with the single lock of the other client
+	for ((i = 0; i < 4; i++)); do
+		dd if=/dev/zero of=$DIR1/$tfile bs=4k count=1 conv=notrunc ||
+			error "dd to $DIR1/$tfile failed"
+		dd if=/dev/zero of=$DIR2/$tfile bs=4k count=1 conv=notrunc ||
+			error "dd to $DIR2/$tfile failed"
+	done
+	blk2=$($LCTL get_param -n ldlm.services.ldlm_cbd.stats |
+	       awk '/ldlm_bl_callback/ { print $2 }')
+	echo "$((blk2 - blk1)) blocking AST RPCs"
+	(( blk2 > blk1 )) || error "no blocking AST was sent"
+
+	evict=$(do_facet client $LCTL get_param \
+		osc.$FSNAME-OST*-osc-*/state |
+	    awk -F"[ [,]" '/EVICTED ]$/ { if (t<$5) {t=$5;} } END { print t }')
+
+	[ -z "$evict" ] || [[ $evict -le $before ]] ||
+		(do_facet client $LCTL get_param \
+			osc.$FSNAME-OST*-osc-*/state;
+		    error "eviction happened: $evict before:$before")
+
+	rm -f $DIR1/$tfile
+}
+run_test 32e "batched blocking AST of a single conflicting lock"
+
 print_jbd_stat () {
     local dev
     local mdts=$(get_facets MDS)
@@ -3900,6 +4026,16 @@ tbf_verify() {
 	cleanup_tbf_verify || error "rm -rf $dir failed"
 }
 
+# writes $3 MiB with O_DIRECT through the dd-like program $1 into $2 and
+# prints the resulting rate in IOPS
+tbf_dd_rate() {
+	local start=$SECONDS
+
+	$1 if=/dev/zero of=$2 bs=1M count=$3 oflag=direct >/dev/null 2>&1 ||
+		error "$1 to $2 failed"
+	bc <<< "scale=6; $3 / ($SECONDS - $start + 1)"
+}
+
 test_77e() {
 	local rc
 
@@ -4417,6 +4553,197 @@ test_77n() { #LU-10802
 }
 run_test 77n "check wildcard support for TBF JobID NRS policy"
 
+test_77o() {
+	local nodes=$(comma_list $(mdts_nodes) $(osts_nodes))
+	local rc=0
+
+	do_nodes $(comma_list $(osts_nodes)) \
+		lctl set_param ost.OSS.ost_io.nrs_policies="deadline" || rc=$?
+	[[ $rc -eq 3 ]] && skip "no NRS exists"
+	[[ $rc -ne 0 ]] && skip "no deadline NRS policy"
+	do_nodes $(comma_list $(mdts_nodes)) \
+		lctl set_param mds.MDS.mdt.nrs_policies="deadline" ||
+		error "failed to set deadline policy on MDT"
+	stack_trap "do_nodes $nodes lctl set_param \
+		ost.OSS.ost_io.nrs_policies=fifo \
+		mds.MDS.mdt.nrs_policies=fifo" EXIT
+
+	do_facet ost1 lctl get_param ost.OSS.ost_io.nrs_policies |
+		grep -A1 "name: deadline" | grep -q "state: started" ||
+		error "deadline policy is not started"
+
+	nrs_write_read
+	# nrs_write_read removed $tdir
+	mkdir $DIR/$tdir || error "mkdir $DIR/$tdir failed"
+	createmany -o $DIR/$tdir/f- 100 || error "create failed"
+	unlinkmany $DIR/$tdir/f- 100 || error "unlink failed"
+	rmdir $DIR/$tdir
+}
+run_test 77o "check deadline NRS policy"
+
+test_77p() {
+	local nodes=$(comma_list $(osts_nodes))
+	local rule=ost.OSS.ost_io.nrs_tbf_rule
+
+	if [ "$OST1_VERSION" -lt $(version_code 2.14.51) ]; then
+		skip "Need OST version at least 2.14.51"
+	fi
+
+	# Configure jobid_var
+	local saved_jobid_var=$($LCTL get_param -n jobid_var)
+	if [ $saved_jobid_var != procname_uid ]; then
+		set_persistent_param_and_check client \
+			"jobid_var" "$FSNAME.sys.jobid_var" procname_uid
+	fi
+
+	do_nodes $nodes lctl set_param ost.OSS.ost_io.nrs_policies="tbf\ jobid" ||
+		error "failed to set TBF jobid policy"
+
+	do_nodes $nodes lctl set_param \
+		$rule="start\ hier_all\ jobid={hier_none}\ rate=40" ||
+		error "failed to start parent rule"
+	do_nodes $nodes lctl set_param \
+		$rule="start\ hier_dd\ jobid={dd.*}\ rate=20\ min_rate=10\ parent=hier_all" \
+		$rule="start\ hier_ls\ jobid={ls.*}\ rate=20\ parent=hier_all" ||
+		error "failed to start child rules"
+
+	do_nodes $nodes lctl set_param \
+		$rule="start\ hier_bad\ jobid={cat.*}\ rate=20\ parent=hier_dd" &&
+		error "a child rule should not be a parent"
+	do_nodes $nodes lctl set_param \
+		$rule="start\ hier_bad\ jobid={cat.*}\ rate=10\ min_rate=20" &&
+		error "min_rate should not be above rate"
+
+	do_facet ost1 lctl get_param -n $rule | grep hier_dd |
+		grep "min_rate 10" | grep -q "parent hier_all" ||
+		error "no min_rate/parent in the hier_dd rule"
+	do_nodes $nodes lctl set_param $rule="stop\ hier_all" &&
+		error "parent rule should not stop while it has children"
+
+	do_nodes $nodes lctl set_param $rule="change\ hier_dd\ min_rate=5" ||
+		error "failed to change min_rate"
+	do_facet ost1 lctl get_param -n $rule | grep hier_dd |
+		grep -q "min_rate 5" || error "min_rate of hier_dd not changed"
+
+	# hier_dd borrows the tokens of the idle hier_ls, up to the parent rate
+	nrs_write_read
+	tbf_verify 40 40
+
+	local np=$(check_cpt_number ost1)
+	local count
+	local rate
+
+	mkdir $DIR/$tdir || error "mkdir $DIR/$tdir failed"
+	$LFS setstripe -c 1 -i 0 $DIR/$tdir ||
+		error "setstripe to $DIR/$tdir failed"
+
+	# the write rate of hier_dd must exceed its own limit
+	count=$((40 * np * 10))
+	rate=$(tbf_dd_rate dd $DIR/$tdir/tbf $count)
+	echo "hier_dd write rate with an idle sibling is $rate IOPS"
+	[ $(bc <<< "$rate > 1.1 * $np * 20") -eq 1 ] ||
+		error "hier_dd ($rate) did not borrow above its rate ($np * 20)"
+
+	# a loaded sibling must leave hier_dd at least its min_rate
+	cp $(which dd) $TMP/tbfload || error "cp dd to $TMP/tbfload failed"
+	do_nodes $nodes lctl set_param \
+		$rule="start\ hier_load\ jobid={tbfload.*}\ rate=40\ parent=hier_all" \
+		$rule="change\ hier_dd\ min_rate=15" ||
+		error "failed to start hier_load rule"
+
+	local pids=""
+	local i
+
+	for ((i = 0; i < 8; i++)); do
+		$TMP/tbfload if=/dev/zero of=$DIR/$tdir/load.$i bs=1M \
+			count=100000 oflag=direct 2>/dev/null &
+		pids="$pids $!"
+	done
+	sleep 2
+
+	count=$((15 * np * 10))
+	rate=$(tbf_dd_rate dd $DIR/$tdir/tbf $count)
+	echo "hier_dd write rate with a loaded sibling is $rate IOPS"
+	kill $pids
+	wait $pids 2>/dev/null
+	rm -f $TMP/tbfload
+	rm -rf $DIR/$tdir
+	[ $(bc <<< "$rate >= 0.8 * $np * 15") -eq 1 ] ||
+		error "hier_dd ($rate) got less than its min_rate ($np * 15)"
+
+	do_nodes $nodes lctl set_param $rule="stop\ hier_dd" \
+		$rule="stop\ hier_ls" $rule="stop\ hier_load" \
+		$rule="stop\ hier_all" ost.OSS.ost_io.nrs_policies="fifo"
+
+	# sleep 3 seconds to wait the tbf policy stop completely,
+	# or the next test case is possible get -EAGAIN when
+	# setting the tbf policy
+	sleep 3
+	if [ $saved_jobid_var != procname_uid ]; then
+		set_persistent_param_and_check client \
+			"jobid_var" "$FSNAME.sys.jobid_var" $saved_jobid_var
+	fi
+}
+run_test 77p "check hierarchical TBF rules with minimum rates"
+
+test_77q() {
+	local nodes=$(comma_list $(osts_nodes))
+	local dir=$DIR/$tdir
+
+	if [ "$OST1_VERSION" -lt $(version_code 2.14.51) ]; then
+		skip "Need OST version at least 2.14.51"
+	fi
+
+	# Configure jobid_var
+	local saved_jobid_var=$($LCTL get_param -n jobid_var)
+	if [ $saved_jobid_var != procname_uid ]; then
+		set_persistent_param_and_check client \
+			"jobid_var" "$FSNAME.sys.jobid_var" procname_uid
+	fi
+
+	do_nodes $nodes lctl set_param ost.OSS.ost_io.nrs_policies="tbf\ jobid" ||
+		error "failed to set TBF jobid policy"
+	do_nodes $nodes lctl set_param ost.OSS.ost_io.nrs_tbf_auto="share=101" &&
+		error "share above 100% should be refused"
+	# any job above 20 RPC/s gets limited
+	do_nodes $nodes lctl set_param \
+		ost.OSS.ost_io.nrs_tbf_auto="share=20\ capacity=100\ interval=1" ||
+		error "failed to enable the TBF autotuner"
+
+	mkdir $dir || error "mkdir $dir failed"
+	$LFS setstripe -c 1 -i 0 $dir || error "setstripe to $dir failed"
+	dd if=/dev/zero of=$dir/$tfile bs=4k count=100000 oflag=direct &
+	local pid=$!
+	sleep 5
+	kill $pid
+	wait $pid
+
+	do_facet ost1 lctl get_param -n ost.OSS.ost_io.nrs_tbf_rule |
+		grep "auto_" | grep -q "{dd.$UID}" ||
+		error "no automatic rule for dd.$UID"
+	do_facet ost1 lctl get_param -n ost.OSS.ost_io.nrs_tbf_auto |
+		grep -q "start auto_.* {dd.$UID}" ||
+		error "no audit log entry for dd.$UID"
+
+	# disabling the autotuner stops its rules
+	do_nodes $nodes lctl set_param ost.OSS.ost_io.nrs_tbf_auto="share=0" ||
+		error "failed to disable the TBF autotuner"
+	do_facet ost1 lctl get_param -n ost.OSS.ost_io.nrs_tbf_rule |
+		grep -q "auto_" && error "automatic rules not stopped"
+	do_facet ost1 lctl get_param -n ost.OSS.ost_io.nrs_tbf_auto |
+		grep -q "stop auto_.* {dd.$UID}" ||
+		error "no audit log entry of the stop"
+
+	do_nodes $nodes lctl set_param ost.OSS.ost_io.nrs_policies="fifo"
+	# sleep 3 seconds to wait the tbf policy stop completely
+	sleep 3
+	if [ $saved_jobid_var != procname_uid ]; then
+		set_persistent_param_and_check client \
+			"jobid_var" "$FSNAME.sys.jobid_var" $saved_jobid_var
+	fi
+}
+run_test 77q "check automatic TBF rules for hot jobs"
+
 test_78() { #LU-6673
 	local rc
 
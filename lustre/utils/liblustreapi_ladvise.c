@@ -43,6 +43,9 @@
 /*
  * Give file access advices
  *
+ * Several advices can be given at once, e.g. a list of LU_LADVISE_PREFETCH
+ * extents that the application is going to read or fault on soon.
+ *
  * \param fd       File to give advice on.
  * \param ladvise  Advice to give.
  *
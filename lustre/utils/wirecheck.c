@@ -357,6 +357,7 @@ check_lu_ladvise(void)
 	CHECK_VALUE(LU_LADVISE_DONTNEED);
 	CHECK_VALUE(LU_LADVISE_LOCKNOEXPAND);
 	CHECK_VALUE(LU_LADVISE_LOCKAHEAD);
+	CHECK_VALUE(LU_LADVISE_PREFETCH);
 }
 
 static void
@@ -396,8 +397,8 @@ check_lustre_msg_v2(void)
 	CHECK_MEMBER(lustre_msg_v2, lm_repsize);
 	CHECK_MEMBER(lustre_msg_v2, lm_cksum);
 	CHECK_MEMBER(lustre_msg_v2, lm_flags);
-	CHECK_MEMBER(lustre_msg_v2, lm_padding_2);
-	CHECK_MEMBER(lustre_msg_v2, lm_padding_3);
+	CHECK_MEMBER(lustre_msg_v2, lm_opc);
+	CHECK_MEMBER(lustre_msg_v2, lm_result);
 	CHECK_MEMBER(lustre_msg_v2, lm_buflens[0]);
 
 	CHECK_VALUE_X(LUSTRE_MSG_MAGIC_V2);
@@ -528,7 +529,7 @@ check_obd_connect_data(void)
 	CHECK_MEMBER(obd_connect_data, ocd_instance);
 	CHECK_MEMBER(obd_connect_data, ocd_maxbytes);
 	CHECK_MEMBER(obd_connect_data, ocd_maxmodrpcs);
-	CHECK_MEMBER(obd_connect_data, padding0);
+	CHECK_MEMBER(obd_connect_data, ocd_compr_types);
 	CHECK_MEMBER(obd_connect_data, padding1);
 	CHECK_MEMBER(obd_connect_data, ocd_connect_flags2);
 	CHECK_MEMBER(obd_connect_data, padding3);
@@ -627,6 +628,9 @@ check_obd_connect_data(void)
 	CHECK_DEFINE_64X(OBD_CONNECT2_GETATTR_PFID);
 	CHECK_DEFINE_64X(OBD_CONNECT2_LSEEK);
 	CHECK_DEFINE_64X(OBD_CONNECT2_DOM_LVB);
+	CHECK_DEFINE_64X(OBD_CONNECT2_BATCH_RPC);
+	CHECK_DEFINE_64X(OBD_CONNECT2_COMPRESS);
+	CHECK_DEFINE_64X(OBD_CONNECT2_BATCH_BL_AST);
 
 	CHECK_VALUE_X(OBD_CKSUM_CRC32);
 	CHECK_VALUE_X(OBD_CKSUM_ADLER);
@@ -1065,6 +1069,23 @@ check_niobuf_remote(void)
 	CHECK_DEFINE_X(OBD_BRW_RDMA_ONLY);
 }
 
+static void
+check_brw_compr_desc(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(brw_compr_desc);
+	CHECK_MEMBER(brw_compr_desc, bcd_type);
+	CHECK_MEMBER(brw_compr_desc, bcd_chunk_bits);
+	CHECK_MEMBER(brw_compr_desc, bcd_count);
+	CHECK_MEMBER(brw_compr_desc, bcd_sizes[0]);
+
+	CHECK_VALUE(LL_COMPR_TYPE_NONE);
+	CHECK_VALUE(LL_COMPR_TYPE_LZ4);
+	CHECK_VALUE(LL_COMPR_TYPE_LZ4HC);
+	CHECK_VALUE(LL_COMPR_TYPE_DEFLATE);
+	CHECK_VALUE(LL_COMPR_TYPE_ZSTD);
+}
+
 static void
 check_ost_body(void)
 {
@@ -2457,6 +2478,32 @@ static void check_out_update_buffer(void)
 	CHECK_MEMBER(out_update_buffer, oub_padding);
 }
 
+static void check_batch_update_request(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(batch_update_request);
+	CHECK_MEMBER(batch_update_request, burq_magic);
+	CHECK_MEMBER(batch_update_request, burq_count);
+	CHECK_MEMBER(batch_update_request, burq_padding);
+	CHECK_MEMBER(batch_update_request, burq_reply_size);
+	CHECK_MEMBER(batch_update_request, burq_padding2);
+	CHECK_MEMBER(batch_update_request, burq_reqmsg);
+
+	CHECK_CDEFINE(BUT_REQUEST_MAGIC);
+}
+
+static void check_batch_update_reply(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(batch_update_reply);
+	CHECK_MEMBER(batch_update_reply, burp_magic);
+	CHECK_MEMBER(batch_update_reply, burp_count);
+	CHECK_MEMBER(batch_update_reply, burp_padding);
+	CHECK_MEMBER(batch_update_reply, burp_repmsg);
+
+	CHECK_CDEFINE(BUT_REPLY_MAGIC);
+}
+
 static void check_nodemap_cluster_rec(void)
 {
 	BLANK_LINE();
@@ -2800,6 +2847,7 @@ main(int argc, char **argv)
 	CHECK_VALUE(MDS_HSM_CT_UNREGISTER);
 	CHECK_VALUE(MDS_SWAP_LAYOUTS);
 	CHECK_VALUE(MDS_RMFID);
+	CHECK_VALUE(MDS_BATCH);
 	CHECK_VALUE(MDS_LAST_OPC);
 
 	CHECK_VALUE(REINT_SETATTR);
@@ -2981,6 +3029,7 @@ main(int argc, char **argv)
 	check_obd_quotactl();
 	check_obd_idx_read();
 	check_niobuf_remote();
+	check_brw_compr_desc();
 	check_ost_body();
 	check_ll_fid();
 	check_mds_op_bias();
@@ -3070,6 +3119,9 @@ main(int argc, char **argv)
 	check_out_update_header();
 	check_out_update_buffer();
 
+	check_batch_update_request();
+	check_batch_update_reply();
+
 	check_nodemap_cluster_rec();
 	check_nodemap_range_rec();
 	check_nodemap_id_rec();
@@ -213,7 +213,9 @@ void lustre_assert_wire_constants(void)
 		 (long long)MDS_SWAP_LAYOUTS);
 	LASSERTF(MDS_RMFID == 62, "found %lld\n",
 		 (long long)MDS_RMFID);
-	LASSERTF(MDS_LAST_OPC == 63, "found %lld\n",
+	LASSERTF(MDS_BATCH == 63, "found %lld\n",
+		 (long long)MDS_BATCH);
+	LASSERTF(MDS_LAST_OPC == 64, "found %lld\n",
 		 (long long)MDS_LAST_OPC);
 	LASSERTF(REINT_SETATTR == 1, "found %lld\n",
 		 (long long)REINT_SETATTR);
@@ -771,6 +773,8 @@ void lustre_assert_wire_constants(void)
 		 (long long)LU_LADVISE_LOCKNOEXPAND);
 	LASSERTF(LU_LADVISE_LOCKAHEAD == 4, "found %lld\n",
 		 (long long)LU_LADVISE_LOCKAHEAD);
+	LASSERTF(LU_LADVISE_PREFETCH == 5, "found %lld\n",
+		 (long long)LU_LADVISE_PREFETCH);
 
 	/* Checks for struct ladvise_hdr */
 	LASSERTF((int)sizeof(struct ladvise_hdr) == 32, "found %lld\n",
@@ -842,14 +846,14 @@ void lustre_assert_wire_constants(void)
 		 (long long)(int)offsetof(struct lustre_msg_v2, lm_flags));
 	LASSERTF((int)sizeof(((struct lustre_msg_v2 *)0)->lm_flags) == 4, "found %lld\n",
 		 (long long)(int)sizeof(((struct lustre_msg_v2 *)0)->lm_flags));
-	LASSERTF((int)offsetof(struct lustre_msg_v2, lm_padding_2) == 24, "found %lld\n",
-		 (long long)(int)offsetof(struct lustre_msg_v2, lm_padding_2));
-	LASSERTF((int)sizeof(((struct lustre_msg_v2 *)0)->lm_padding_2) == 4, "found %lld\n",
-		 (long long)(int)sizeof(((struct lustre_msg_v2 *)0)->lm_padding_2));
-	LASSERTF((int)offsetof(struct lustre_msg_v2, lm_padding_3) == 28, "found %lld\n",
-		 (long long)(int)offsetof(struct lustre_msg_v2, lm_padding_3));
-	LASSERTF((int)sizeof(((struct lustre_msg_v2 *)0)->lm_padding_3) == 4, "found %lld\n",
-		 (long long)(int)sizeof(((struct lustre_msg_v2 *)0)->lm_padding_3));
+	LASSERTF((int)offsetof(struct lustre_msg_v2, lm_opc) == 24, "found %lld\n",
+		 (long long)(int)offsetof(struct lustre_msg_v2, lm_opc));
+	LASSERTF((int)sizeof(((struct lustre_msg_v2 *)0)->lm_opc) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct lustre_msg_v2 *)0)->lm_opc));
+	LASSERTF((int)offsetof(struct lustre_msg_v2, lm_result) == 28, "found %lld\n",
+		 (long long)(int)offsetof(struct lustre_msg_v2, lm_result));
+	LASSERTF((int)sizeof(((struct lustre_msg_v2 *)0)->lm_result) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct lustre_msg_v2 *)0)->lm_result));
 	LASSERTF((int)offsetof(struct lustre_msg_v2, lm_buflens[0]) == 32, "found %lld\n",
 		 (long long)(int)offsetof(struct lustre_msg_v2, lm_buflens[0]));
 	LASSERTF((int)sizeof(((struct lustre_msg_v2 *)0)->lm_buflens[0]) == 4, "found %lld\n",
@@ -1186,10 +1190,10 @@ void lustre_assert_wire_constants(void)
 		 (long long)(int)offsetof(struct obd_connect_data, ocd_maxmodrpcs));
 	LASSERTF((int)sizeof(((struct obd_connect_data *)0)->ocd_maxmodrpcs) == 2, "found %lld\n",
 		 (long long)(int)sizeof(((struct obd_connect_data *)0)->ocd_maxmodrpcs));
-	LASSERTF((int)offsetof(struct obd_connect_data, padding0) == 74, "found %lld\n",
-		 (long long)(int)offsetof(struct obd_connect_data, padding0));
-	LASSERTF((int)sizeof(((struct obd_connect_data *)0)->padding0) == 2, "found %lld\n",
-		 (long long)(int)sizeof(((struct obd_connect_data *)0)->padding0));
+	LASSERTF((int)offsetof(struct obd_connect_data, ocd_compr_types) == 74, "found %lld\n",
+		 (long long)(int)offsetof(struct obd_connect_data, ocd_compr_types));
+	LASSERTF((int)sizeof(((struct obd_connect_data *)0)->ocd_compr_types) == 2, "found %lld\n",
+		 (long long)(int)sizeof(((struct obd_connect_data *)0)->ocd_compr_types));
 	LASSERTF((int)offsetof(struct obd_connect_data, padding1) == 76, "found %lld\n",
 		 (long long)(int)offsetof(struct obd_connect_data, padding1));
 	LASSERTF((int)sizeof(((struct obd_connect_data *)0)->padding1) == 4, "found %lld\n",
@@ -1414,6 +1418,12 @@ void lustre_assert_wire_constants(void)
 		 OBD_CONNECT2_LSEEK);
 	LASSERTF(OBD_CONNECT2_DOM_LVB == 0x80000ULL, "found 0x%.16llxULL\n",
 		 OBD_CONNECT2_DOM_LVB);
+	LASSERTF(OBD_CONNECT2_BATCH_RPC == 0x100000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_BATCH_RPC);
+	LASSERTF(OBD_CONNECT2_COMPRESS == 0x200000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_COMPRESS);
+	LASSERTF(OBD_CONNECT2_BATCH_BL_AST == 0x400000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_BATCH_BL_AST);
 	LASSERTF(OBD_CKSUM_CRC32 == 0x00000001UL, "found 0x%.8xUL\n",
 		(unsigned)OBD_CKSUM_CRC32);
 	LASSERTF(OBD_CKSUM_ADLER == 0x00000002UL, "found 0x%.8xUL\n",
@@ -2354,6 +2364,36 @@ void lustre_assert_wire_constants(void)
 	LASSERTF(OBD_BRW_RDMA_ONLY == 0x20000, "found 0x%.8x\n",
 		OBD_BRW_RDMA_ONLY);
 
+	/* Checks for struct brw_compr_desc */
+	LASSERTF((int)sizeof(struct brw_compr_desc) == 12, "found %lld\n",
+		 (long long)(int)sizeof(struct brw_compr_desc));
+	LASSERTF((int)offsetof(struct brw_compr_desc, bcd_type) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct brw_compr_desc, bcd_type));
+	LASSERTF((int)sizeof(((struct brw_compr_desc *)0)->bcd_type) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct brw_compr_desc *)0)->bcd_type));
+	LASSERTF((int)offsetof(struct brw_compr_desc, bcd_chunk_bits) == 4, "found %lld\n",
+		 (long long)(int)offsetof(struct brw_compr_desc, bcd_chunk_bits));
+	LASSERTF((int)sizeof(((struct brw_compr_desc *)0)->bcd_chunk_bits) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct brw_compr_desc *)0)->bcd_chunk_bits));
+	LASSERTF((int)offsetof(struct brw_compr_desc, bcd_count) == 8, "found %lld\n",
+		 (long long)(int)offsetof(struct brw_compr_desc, bcd_count));
+	LASSERTF((int)sizeof(((struct brw_compr_desc *)0)->bcd_count) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct brw_compr_desc *)0)->bcd_count));
+	LASSERTF((int)offsetof(struct brw_compr_desc, bcd_sizes[0]) == 12, "found %lld\n",
+		 (long long)(int)offsetof(struct brw_compr_desc, bcd_sizes[0]));
+	LASSERTF((int)sizeof(((struct brw_compr_desc *)0)->bcd_sizes[0]) == 0, "found %lld\n",
+		 (long long)(int)sizeof(((struct brw_compr_desc *)0)->bcd_sizes[0]));
+	LASSERTF(LL_COMPR_TYPE_NONE == 0, "found %lld\n",
+		 (long long)LL_COMPR_TYPE_NONE);
+	LASSERTF(LL_COMPR_TYPE_LZ4 == 1, "found %lld\n",
+		 (long long)LL_COMPR_TYPE_LZ4);
+	LASSERTF(LL_COMPR_TYPE_LZ4HC == 2, "found %lld\n",
+		 (long long)LL_COMPR_TYPE_LZ4HC);
+	LASSERTF(LL_COMPR_TYPE_DEFLATE == 3, "found %lld\n",
+		 (long long)LL_COMPR_TYPE_DEFLATE);
+	LASSERTF(LL_COMPR_TYPE_ZSTD == 4, "found %lld\n",
+		 (long long)LL_COMPR_TYPE_ZSTD);
+
 	/* Checks for struct ost_body */
 	LASSERTF((int)sizeof(struct ost_body) == 208, "found %lld\n",
 		 (long long)(int)sizeof(struct ost_body));
@@ -5314,6 +5354,56 @@ void lustre_assert_wire_constants(void)
 	LASSERTF((int)sizeof(((struct out_update_buffer *)0)->oub_padding) == 4, "found %lld\n",
 		 (long long)(int)sizeof(((struct out_update_buffer *)0)->oub_padding));
 
+	/* Checks for struct batch_update_request */
+	LASSERTF((int)sizeof(struct batch_update_request) == 16, "found %lld\n",
+		 (long long)(int)sizeof(struct batch_update_request));
+	LASSERTF((int)offsetof(struct batch_update_request, burq_magic) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct batch_update_request, burq_magic));
+	LASSERTF((int)sizeof(((struct batch_update_request *)0)->burq_magic) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct batch_update_request *)0)->burq_magic));
+	LASSERTF((int)offsetof(struct batch_update_request, burq_count) == 4, "found %lld\n",
+		 (long long)(int)offsetof(struct batch_update_request, burq_count));
+	LASSERTF((int)sizeof(((struct batch_update_request *)0)->burq_count) == 2, "found %lld\n",
+		 (long long)(int)sizeof(((struct batch_update_request *)0)->burq_count));
+	LASSERTF((int)offsetof(struct batch_update_request, burq_padding) == 6, "found %lld\n",
+		 (long long)(int)offsetof(struct batch_update_request, burq_padding));
+	LASSERTF((int)sizeof(((struct batch_update_request *)0)->burq_padding) == 2, "found %lld\n",
+		 (long long)(int)sizeof(((struct batch_update_request *)0)->burq_padding));
+	LASSERTF((int)offsetof(struct batch_update_request, burq_reply_size) == 8, "found %lld\n",
+		 (long long)(int)offsetof(struct batch_update_request, burq_reply_size));
+	LASSERTF((int)sizeof(((struct batch_update_request *)0)->burq_reply_size) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct batch_update_request *)0)->burq_reply_size));
+	LASSERTF((int)offsetof(struct batch_update_request, burq_padding2) == 12, "found %lld\n",
+		 (long long)(int)offsetof(struct batch_update_request, burq_padding2));
+	LASSERTF((int)sizeof(((struct batch_update_request *)0)->burq_padding2) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct batch_update_request *)0)->burq_padding2));
+	LASSERTF((int)offsetof(struct batch_update_request, burq_reqmsg) == 16, "found %lld\n",
+		 (long long)(int)offsetof(struct batch_update_request, burq_reqmsg));
+	LASSERTF((int)sizeof(((struct batch_update_request *)0)->burq_reqmsg) == 0, "found %lld\n",
+		 (long long)(int)sizeof(((struct batch_update_request *)0)->burq_reqmsg));
+	BUILD_BUG_ON(BUT_REQUEST_MAGIC != 0xBADE0001);
+
+	/* Checks for struct batch_update_reply */
+	LASSERTF((int)sizeof(struct batch_update_reply) == 8, "found %lld\n",
+		 (long long)(int)sizeof(struct batch_update_reply));
+	LASSERTF((int)offsetof(struct batch_update_reply, burp_magic) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct batch_update_reply, burp_magic));
+	LASSERTF((int)sizeof(((struct batch_update_reply *)0)->burp_magic) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct batch_update_reply *)0)->burp_magic));
+	LASSERTF((int)offsetof(struct batch_update_reply, burp_count) == 4, "found %lld\n",
+		 (long long)(int)offsetof(struct batch_update_reply, burp_count));
+	LASSERTF((int)sizeof(((struct batch_update_reply *)0)->burp_count) == 2, "found %lld\n",
+		 (long long)(int)sizeof(((struct batch_update_reply *)0)->burp_count));
+	LASSERTF((int)offsetof(struct batch_update_reply, burp_padding) == 6, "found %lld\n",
+		 (long long)(int)offsetof(struct batch_update_reply, burp_padding));
+	LASSERTF((int)sizeof(((struct batch_update_reply *)0)->burp_padding) == 2, "found %lld\n",
+		 (long long)(int)sizeof(((struct batch_update_reply *)0)->burp_padding));
+	LASSERTF((int)offsetof(struct batch_update_reply, burp_repmsg) == 8, "found %lld\n",
+		 (long long)(int)offsetof(struct batch_update_reply, burp_repmsg));
+	LASSERTF((int)sizeof(((struct batch_update_reply *)0)->burp_repmsg) == 0, "found %lld\n",
+		 (long long)(int)sizeof(((struct batch_update_reply *)0)->burp_repmsg));
+	BUILD_BUG_ON(BUT_REPLY_MAGIC != 0x00AD0001);
+
 	/* Checks for struct nodemap_cluster_rec */
 	LASSERTF((int)sizeof(struct nodemap_cluster_rec) == 32, "found %lld\n",
 		 (long long)(int)sizeof(struct nodemap_cluster_rec));